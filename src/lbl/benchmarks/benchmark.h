@@ -0,0 +1,144 @@
+#pragma once
+
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <boost/program_options.hpp>
+
+#include "lbl/utils.h"
+#include "utils/conditional_omp.h"
+#include "utils/git_revision.h"
+
+using namespace std;
+
+namespace oxlm {
+
+struct BenchmarkResult {
+  string name;
+  size_t iterations;
+  size_t itemsPerIteration;
+  double totalTime;
+};
+
+/**
+ * Minimal harness for microbenchmarks.
+ *
+ * Each benchmark is a function which processes a fixed number of items (e.g.
+ * tokens or queries) per call. The function is called once to warm up and then
+ * repeatedly until at least --min-time seconds have passed. The results of all
+ * the benchmarks in a binary are written as a single JSON document (to
+ * --output or to <suite>.json), so that they can be compared across commits.
+ *
+ * Benchmarks are run on synthetic data generated from fixed seeds, so the
+ * inputs are identical from one run to the next.
+ */
+class BenchmarkRunner {
+ public:
+  BenchmarkRunner(const string& suite, int argc, char** argv)
+      : suite(suite), sink(0) {
+    namespace po = boost::program_options;
+    po::options_description desc("Command line options");
+    desc.add_options()
+        ("help,h", "Print help message.")
+        ("min-time", po::value<double>()->default_value(1),
+            "Minimum number of seconds each benchmark is run for.")
+        ("filter", po::value<string>()->default_value(""),
+            "Only run the benchmarks whose name contains this string.")
+        ("output,o", po::value<string>()->default_value(suite + ".json"),
+            "File where the results are written in JSON format.");
+
+    po::variables_map vm;
+    po::store(po::parse_command_line(argc, argv, desc), vm);
+    if (vm.count("help")) {
+      cout << desc << endl;
+      exit(0);
+    }
+    po::notify(vm);
+
+    minTime = vm["min-time"].as<double>();
+    filter = vm["filter"].as<string>();
+    outputFile = vm["output"].as<string>();
+  }
+
+  /**
+   * Runs function() until minTime seconds have passed. items is the number of
+   * items processed by a single call.
+   */
+  template<class Function>
+  void run(const string& name, size_t items, const Function& function) {
+    if (name.find(filter) == string::npos) {
+      return;
+    }
+
+    function();
+
+    BenchmarkResult result = {name, 0, items, 0};
+    auto start_time = GetTime();
+    do {
+      function();
+      ++result.iterations;
+      result.totalTime = GetDuration(start_time, GetTime());
+    } while (result.totalTime < minTime);
+
+    results.push_back(result);
+    cerr << "BENCHMARK " << name << ": " << result.iterations
+         << " iterations, " << getNanosPerItem(result) << " ns/item" << endl;
+  }
+
+  /**
+   * Keeps the compiler from optimizing away the computations whose results
+   * are otherwise unused.
+   */
+  void consume(double value) {
+    sink += value;
+  }
+
+  /**
+   * Writes the results of all the benchmarks run so far.
+   */
+  int finish() const {
+    ofstream fout(outputFile);
+    fout << setprecision(9);
+    fout << "{" << endl;
+    fout << "  \"suite\": \"" << suite << "\"," << endl;
+    fout << "  \"git_revision\": \"" << GIT_REVISION << "\"," << endl;
+    fout << "  \"threads\": " << omp_get_max_threads() << "," << endl;
+    fout << "  \"min_time\": " << minTime << "," << endl;
+    fout << "  \"benchmarks\": [" << endl;
+    for (size_t i = 0; i < results.size(); ++i) {
+      const BenchmarkResult& result = results[i];
+      fout << "    {"
+           << "\"name\": \"" << result.name << "\", "
+           << "\"iterations\": " << result.iterations << ", "
+           << "\"items_per_iteration\": " << result.itemsPerIteration << ", "
+           << "\"total_time\": " << result.totalTime << ", "
+           << "\"ns_per_item\": " << getNanosPerItem(result) << ", "
+           << "\"items_per_second\": " << 1e9 / getNanosPerItem(result)
+           << "}" << (i + 1 < results.size() ? "," : "") << endl;
+    }
+    fout << "  ]" << endl;
+    fout << "}" << endl;
+
+    cerr << "Benchmark results written to " << outputFile
+         << " (checksum: " << sink << ")..." << endl;
+    return 0;
+  }
+
+ private:
+  static double getNanosPerItem(const BenchmarkResult& result) {
+    return 1e9 * result.totalTime
+        / (result.iterations * max<size_t>(result.itemsPerIteration, 1));
+  }
+
+  string suite;
+  double minTime;
+  string filter;
+  string outputFile;
+  double sink;
+  vector<BenchmarkResult> results;
+};
+
+} // namespace oxlm
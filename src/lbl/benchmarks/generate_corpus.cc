@@ -0,0 +1,69 @@
+#include <iostream>
+
+#include <boost/program_options.hpp>
+
+#include "lbl/benchmarks/synthetic_corpus.h"
+
+using namespace boost::program_options;
+using namespace oxlm;
+
+/**
+ * Writes a synthetic Zipfian corpus which can be used as input for the
+ * training tools. If --alignment-output is set, a parallel corpus (source |||
+ * target) and its word alignments are written instead.
+ */
+int main(int argc, char** argv) {
+  options_description desc("Command line options");
+  desc.add_options()
+      ("help,h", "Print help message.")
+      ("output,o", value<string>()->required(),
+          "File where the corpus is written.")
+      ("tokens", value<int>()->default_value(1000000),
+          "Number of (target) tokens in the corpus.")
+      ("vocab-size", value<int>()->default_value(10000),
+          "Number of distinct (target) words.")
+      ("source-vocab-size", value<int>()->default_value(10000),
+          "Number of distinct source words (parallel corpora only).")
+      ("exponent", value<double>()->default_value(1.0),
+          "Exponent of the Zipfian distribution.")
+      ("sentence-length", value<int>()->default_value(20),
+          "Average sentence length.")
+      ("seed", value<int>()->default_value(1),
+          "Seed of the random number generator.")
+      ("alignment-output", value<string>(),
+          "File where the word alignments of a parallel corpus are written.")
+      ("unaligned-rate", value<double>()->default_value(0.1),
+          "Fraction of unaligned target words (parallel corpora only).")
+      ("tree-output", value<string>(),
+          "File where a binary class tree over the vocabulary is written.");
+
+  variables_map vm;
+  store(parse_command_line(argc, argv, desc), vm);
+  if (vm.count("help")) {
+    cout << desc << endl;
+    return 0;
+  }
+  notify(vm);
+
+  int seed = vm["seed"].as<int>();
+  double exponent = vm["exponent"].as<double>();
+  SyntheticCorpus corpus(vm["vocab-size"].as<int>(), exponent, seed);
+  if (vm.count("alignment-output")) {
+    SyntheticCorpus source(
+        vm["source-vocab-size"].as<int>(), exponent, seed + 1, "s");
+    corpus.writeParallel(
+        source, vm["output"].as<string>(),
+        vm["alignment-output"].as<string>(), vm["tokens"].as<int>(),
+        vm["sentence-length"].as<int>(), vm["unaligned-rate"].as<double>());
+  } else {
+    corpus.write(
+        vm["output"].as<string>(), vm["tokens"].as<int>(),
+        vm["sentence-length"].as<int>());
+  }
+
+  if (vm.count("tree-output")) {
+    corpus.writeTree(vm["tree-output"].as<string>());
+  }
+
+  return 0;
+}
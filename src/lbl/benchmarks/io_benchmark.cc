@@ -0,0 +1,74 @@
+#include <boost/filesystem.hpp>
+#include <boost/make_shared.hpp>
+
+#include "lbl/benchmarks/benchmark.h"
+#include "lbl/benchmarks/synthetic_corpus.h"
+#include "lbl/model.h"
+
+using namespace oxlm;
+
+static const int VOCAB_SIZE = 10000;
+static const int NUM_TOKENS = 1000000;
+static const int MODEL_TOKENS = 50000;
+
+/**
+ * Benchmarks saving and loading a freshly initialized model. The items are
+ * the bytes of the serialized model.
+ */
+template<class Model>
+void BenchmarkModel(
+    BenchmarkRunner& runner, const string& name,
+    const boost::shared_ptr<ModelData>& config) {
+  // Training for 0 iterations only initializes the weights.
+  config->iterations = 0;
+  config->model_output_file = "benchmark_model.bin";
+  Model model(config);
+  model.learn();
+  model.save();
+
+  size_t model_size = boost::filesystem::file_size(config->model_output_file);
+  runner.run(name + "/save", model_size, [&]() {
+    model.save();
+  });
+
+  runner.run(name + "/load", model_size, [&]() {
+    Model loaded_model;
+    loaded_model.load(config->model_output_file);
+  });
+
+  boost::filesystem::remove(config->model_output_file);
+}
+
+int main(int argc, char** argv) {
+  BenchmarkRunner runner("io_benchmark", argc, argv);
+
+  SyntheticCorpus synthetic_corpus(VOCAB_SIZE, 1.0, 1);
+  synthetic_corpus.write("benchmark_corpus.txt", NUM_TOKENS, 20);
+  runner.run("Corpus/load", NUM_TOKENS, [&]() {
+    boost::shared_ptr<Vocabulary> vocab = boost::make_shared<Vocabulary>();
+    Corpus corpus("benchmark_corpus.txt", vocab, false);
+    runner.consume(corpus.size());
+  });
+
+  synthetic_corpus.write("benchmark_model_corpus.txt", MODEL_TOKENS, 20);
+  boost::shared_ptr<ModelData> config = boost::make_shared<ModelData>();
+  config->training_file = "benchmark_model_corpus.txt";
+  config->ngram_order = 5;
+  config->word_representation_size = 100;
+  config->classes = 50;
+  config->activation = RECTIFIER;
+  config->min_ngram_freq = 1;
+
+  BenchmarkModel<LM>(runner, "LM", boost::make_shared<ModelData>(*config));
+  BenchmarkModel<FactoredLM>(
+      runner, "FactoredLM", boost::make_shared<ModelData>(*config));
+
+  boost::shared_ptr<ModelData> maxent_config =
+      boost::make_shared<ModelData>(*config);
+  maxent_config->feature_context_size = 4;
+  BenchmarkModel<FactoredMaxentLM>(runner, "FactoredMaxentLM", maxent_config);
+
+  boost::filesystem::remove("benchmark_corpus.txt");
+  boost::filesystem::remove("benchmark_model_corpus.txt");
+  return runner.finish();
+}
@@ -0,0 +1,105 @@
+#include <boost/filesystem.hpp>
+#include <boost/make_shared.hpp>
+
+#include "lbl/benchmarks/benchmark.h"
+#include "lbl/benchmarks/synthetic_corpus.h"
+#include "lbl/bloom_filter.h"
+#include "lbl/class_context_hasher.h"
+#include "lbl/collision_global_feature_store.h"
+#include "lbl/context_cache.h"
+#include "lbl/context_processor.h"
+#include "lbl/feature_no_op_filter.h"
+#include "lbl/model_utils.h"
+#include "lbl/ngram.h"
+#include "lbl/query_cache.h"
+
+using namespace oxlm;
+
+static const int VOCAB_SIZE = 10000;
+static const int NUM_TOKENS = 100000;
+static const int NGRAM_ORDER = 5;
+static const int VECTOR_SIZE = 100;
+static const int HASH_SPACE = 10000000;
+
+int main(int argc, char** argv) {
+  BenchmarkRunner runner("lookup_benchmark", argc, argv);
+
+  SyntheticCorpus synthetic_corpus(VOCAB_SIZE, 1.0, 1);
+  synthetic_corpus.write("benchmark_corpus.txt", NUM_TOKENS, 20);
+  boost::shared_ptr<ModelData> config = boost::make_shared<ModelData>();
+  config->training_file = "benchmark_corpus.txt";
+  boost::shared_ptr<Vocabulary> vocab = boost::make_shared<Vocabulary>();
+  boost::shared_ptr<Corpus> corpus = readTrainingCorpus(config, vocab);
+
+  ContextProcessor processor(corpus, NGRAM_ORDER - 1);
+  vector<vector<int>> contexts;
+  vector<NGram> ngrams;
+  for (size_t i = 0; i < corpus->size(); ++i) {
+    contexts.push_back(processor.extract(i));
+    ngrams.push_back(NGram(corpus->at(i), contexts.back()));
+  }
+
+  ContextCache context_cache;
+  runner.run("ContextCache/set", contexts.size(), [&]() {
+    context_cache.clear();
+    for (size_t i = 0; i < contexts.size(); ++i) {
+      context_cache.set(contexts[i], i);
+    }
+  });
+
+  runner.run("ContextCache/get", contexts.size(), [&]() {
+    for (const vector<int>& context: contexts) {
+      runner.consume(context_cache.get(context).first);
+    }
+  });
+
+  QueryCache query_cache;
+  runner.run("QueryCache/put", ngrams.size(), [&]() {
+    query_cache.clear();
+    for (size_t i = 0; i < ngrams.size(); ++i) {
+      query_cache.put(ngrams[i], i);
+    }
+  });
+
+  runner.run("QueryCache/get", ngrams.size(), [&]() {
+    for (const NGram& ngram: ngrams) {
+      runner.consume(query_cache.get(ngram).first);
+    }
+  });
+
+  BloomFilter<NGram> bloom_filter(ngrams.size(), 1, 0.01);
+  runner.run("BloomFilter/increment", ngrams.size(), [&]() {
+    for (const NGram& ngram: ngrams) {
+      bloom_filter.increment(ngram);
+    }
+  });
+
+  runner.run("BloomFilter/contains", ngrams.size(), [&]() {
+    for (const NGram& ngram: ngrams) {
+      runner.consume(bloom_filter.contains(ngram));
+    }
+  });
+
+  boost::shared_ptr<GlobalCollisionSpace> space =
+      boost::make_shared<GlobalCollisionSpace>(HASH_SPACE);
+  boost::shared_ptr<ClassContextHasher> hasher =
+      boost::make_shared<ClassContextHasher>(HASH_SPACE);
+  boost::shared_ptr<FeatureNoOpFilter> filter =
+      boost::make_shared<FeatureNoOpFilter>(VECTOR_SIZE);
+  CollisionGlobalFeatureStore store(
+      VECTOR_SIZE, HASH_SPACE, NGRAM_ORDER - 1, space, hasher, filter);
+  mt19937 generator(1);
+  normal_distribution<Real> distribution(0, 0.1);
+  for (int i = 0; i < HASH_SPACE; ++i) {
+    store.updateFeature(make_pair(i, 0), distribution(generator));
+  }
+
+  runner.run("CollisionGlobalFeatureStore/get", contexts.size(), [&]() {
+    for (const vector<int>& context: contexts) {
+      runner.consume(store.get(context).sum());
+    }
+  });
+
+  boost::filesystem::remove("benchmark_corpus.txt");
+  return runner.finish();
+}
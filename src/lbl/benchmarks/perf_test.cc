@@ -0,0 +1,386 @@
+#include <sys/resource.h>
+
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+
+#include <boost/filesystem.hpp>
+#include <boost/make_shared.hpp>
+#include <boost/program_options.hpp>
+#include <boost/property_tree/json_parser.hpp>
+#include <boost/property_tree/ptree.hpp>
+
+#include "lbl/benchmarks/synthetic_corpus.h"
+#include "lbl/exceptions.h"
+#include "lbl/model.h"
+#include "utils/conditional_omp.h"
+#include "utils/git_revision.h"
+
+using namespace boost::program_options;
+using namespace oxlm;
+
+/**
+ * End-to-end performance test: trains a model of the given type on a
+ * synthetic Zipfian corpus for a fixed number of minibatches, saves it, loads
+ * it back and scores a fixed test set. The measurements are compared against
+ * the stored baselines.
+ *
+ * Throughput metrics (tokens/sec, queries/sec) regress if they drop below
+ * baseline * (1 - tolerance). Cost metrics (peak RSS, load time) regress if
+ * they exceed baseline * (1 + tolerance). The test perplexity regresses if it
+ * exceeds baseline * (1 + perplexity tolerance), so that changes which make
+ * training faster by breaking it are caught as well.
+ */
+
+static const int VOCAB_SIZE = 20000;
+static const int SOURCE_VOCAB_SIZE = 20000;
+static const int LOAD_REPETITIONS = 5;
+static const int SENTENCE_LENGTH = 20;
+static const string STATS_FILE = "perf_stats.json";
+
+typedef map<string, double> Metrics;
+
+static const vector<string> THROUGHPUT_METRICS = {
+    "tokens_per_second", "queries_per_second"};
+static const vector<string> COST_METRICS = {"peak_rss_mb", "load_seconds"};
+static const string PERPLEXITY_METRIC = "perplexity";
+
+static string GetModelName(ModelType model_type) {
+  switch (model_type) {
+    case NLM:
+      return "lm";
+    case FACTORED_NLM:
+      return "factored_lm";
+    case FACTORED_MAXENT_NLM:
+      return "factored_maxent_lm";
+    case SOURCE_FACTORED_NLM:
+      return "source_factored_lm";
+    case FACTORED_TREE_NLM:
+      return "factored_tree_lm";
+    default:
+      throw UnknownModelException();
+  }
+}
+
+static double GetSeconds(const Time& start_time) {
+  return chrono::duration_cast<chrono::nanoseconds>(
+      GetTime() - start_time).count() / 1e9;
+}
+
+static double GetPeakRSS() {
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  // ru_maxrss is measured in kilobytes on Linux.
+  return usage.ru_maxrss / 1024.0;
+}
+
+/**
+ * Copies the first num_lines lines of input to output.
+ */
+static void CopyLines(
+    const string& input, const string& output, int num_lines) {
+  ifstream fin(input);
+  ofstream fout(output);
+  string line;
+  for (int i = 0; i < num_lines && getline(fin, line); ++i) {
+    fout << line << "\n";
+  }
+}
+
+/**
+ * Returns the training throughput from the training statistics logged after
+ * every minibatch. The first minibatch (minibatch_counter starts at 1) is
+ * skipped as warm-up: it pays for the first touch of the weights and the
+ * gradient buffers, which would skew the throughput of the short runs.
+ * Reading the corpus, creating the metadata and the evaluation at the end of
+ * the iteration happen outside the logged minibatches.
+ */
+static double GetTrainingThroughput(const string& stats_file) {
+  ifstream fin(stats_file);
+  string line;
+  double tokens = 0, seconds = 0;
+  while (getline(fin, line)) {
+    boost::property_tree::ptree stats;
+    istringstream stream(line);
+    boost::property_tree::read_json(stream, stats);
+    if (stats.get<int>("minibatch") > 1) {
+      tokens += stats.get<double>("tokens");
+      seconds += stats.get<double>("seconds");
+    }
+  }
+
+  return seconds > 0 ? tokens / seconds : 0;
+}
+
+template<class Model>
+Metrics RunModel(const boost::shared_ptr<ModelData>& config) {
+  Metrics metrics;
+
+  Model model(config);
+  model.learn();
+  metrics["tokens_per_second"] = GetTrainingThroughput(config->stats_file);
+
+  // Loading is fast for small models, so the load time is averaged over a few
+  // repetitions to reduce the noise.
+  model.save();
+  Model loaded_model;
+  auto start_time = GetTime();
+  for (int i = 0; i < LOAD_REPETITIONS; ++i) {
+    loaded_model = Model();
+    loaded_model.load(config->model_output_file);
+  }
+  metrics["load_seconds"] = GetSeconds(start_time) / LOAD_REPETITIONS;
+
+  boost::shared_ptr<Corpus> test_corpus =
+      readTestCorpus(config, loaded_model.getVocab());
+  loaded_model.clearCache();
+  Real log_likelihood = 0;
+  start_time = GetTime();
+  #pragma omp parallel
+  loaded_model.evaluate(test_corpus, log_likelihood);
+  metrics["queries_per_second"] = test_corpus->size() / GetSeconds(start_time);
+  metrics["perplexity"] = perplexity(log_likelihood, test_corpus->size());
+
+  metrics["peak_rss_mb"] = GetPeakRSS();
+  return metrics;
+}
+
+static Metrics Run(
+    ModelType model_type, const boost::shared_ptr<ModelData>& config) {
+  switch (model_type) {
+    case NLM:
+      return RunModel<LM>(config);
+    case FACTORED_NLM:
+      return RunModel<FactoredLM>(config);
+    case FACTORED_MAXENT_NLM:
+      return RunModel<FactoredMaxentLM>(config);
+    case SOURCE_FACTORED_NLM:
+      return RunModel<SourceFactoredLM>(config);
+    case FACTORED_TREE_NLM:
+      return RunModel<FactoredTreeLM>(config);
+    default:
+      throw UnknownModelException();
+  }
+}
+
+/**
+ * Returns the number of metrics which regressed compared to baseline.
+ */
+static int Compare(
+    const Metrics& metrics, const boost::property_tree::ptree& baseline,
+    double tolerance, double perplexity_tolerance) {
+  int num_regressions = 0;
+  for (const auto& metric: metrics) {
+    auto expected = baseline.get_optional<double>(metric.first);
+    if (!expected) {
+      continue;
+    }
+
+    bool throughput = find(THROUGHPUT_METRICS.begin(), THROUGHPUT_METRICS.end(),
+                           metric.first) != THROUGHPUT_METRICS.end();
+    bool cost = find(COST_METRICS.begin(), COST_METRICS.end(), metric.first)
+        != COST_METRICS.end();
+    bool regression =
+        (throughput && metric.second < *expected * (1 - tolerance))
+        || (cost && metric.second > *expected * (1 + tolerance))
+        || (metric.first == PERPLEXITY_METRIC
+            && metric.second > *expected * (1 + perplexity_tolerance));
+    cout << "  " << metric.first << ": " << metric.second
+         << " (baseline: " << *expected << ")"
+         << (regression ? " REGRESSION" : "") << endl;
+    num_regressions += regression;
+  }
+
+  return num_regressions;
+}
+
+static void WriteMetrics(
+    ostream& out, const Metrics& metrics, const string& indent) {
+  out << "{";
+  bool first_metric = true;
+  for (const auto& metric: metrics) {
+    out << (first_metric ? "\n" : ",\n") << indent << "  \"" << metric.first
+        << "\": " << metric.second;
+    first_metric = false;
+  }
+  out << "\n" << indent << "}";
+}
+
+/**
+ * Replaces the baseline of model_name with metrics.
+ */
+static void UpdateBaselines(
+    const string& filename, const string& model_name, const Metrics& metrics) {
+  map<string, Metrics> baselines;
+  if (boost::filesystem::exists(filename)) {
+    boost::property_tree::ptree tree;
+    boost::property_tree::read_json(filename, tree);
+    for (const auto& model: tree) {
+      for (const auto& metric: model.second) {
+        baselines[model.first][metric.first] =
+            metric.second.get_value<double>();
+      }
+    }
+  }
+  baselines[model_name] = metrics;
+
+  ofstream fout(filename);
+  fout << setprecision(6) << "{";
+  bool first_model = true;
+  for (const auto& baseline: baselines) {
+    fout << (first_model ? "\n" : ",\n") << "  \"" << baseline.first << "\": ";
+    WriteMetrics(fout, baseline.second, "  ");
+    first_model = false;
+  }
+  fout << "\n}" << endl;
+}
+
+int main(int argc, char** argv) {
+  options_description desc("Command line options");
+  desc.add_options()
+      ("help,h", "Print help message.")
+      ("type,t", value<int>()->required(), "Model type")
+      ("minibatches", value<int>()->default_value(50),
+          "Number of minibatches the model is trained for.")
+      ("minibatch-size", value<int>()->default_value(1000),
+          "Number of tokens in a minibatch.")
+      ("test-sentences", value<int>()->default_value(500),
+          "Number of sentences in the test set.")
+      ("threads", value<int>()->default_value(1),
+          "Number of threads used for training and scoring.")
+      ("baselines", value<string>()->default_value("perf_baselines.json"),
+          "File containing the baseline metrics of every model type.")
+      ("tolerance", value<double>()->default_value(0.5),
+          "Relative difference from the baseline tolerated before a metric "
+          "is reported as a regression.")
+      ("perplexity-tolerance", value<double>()->default_value(0.01),
+          "Relative increase of the test perplexity tolerated before it is "
+          "reported as a regression.")
+      ("update-baselines", "Store the results as the new baseline.")
+      ("output,o", value<string>(),
+          "File where the results are written in JSON format "
+          "(default: perf_test_<model>.json).");
+
+  variables_map vm;
+  store(parse_command_line(argc, argv, desc), vm);
+  if (vm.count("help")) {
+    cout << desc << endl;
+    return 0;
+  }
+  notify(vm);
+
+  ModelType model_type = static_cast<ModelType>(vm["type"].as<int>());
+  string model_name = GetModelName(model_type);
+  string output_file = vm.count("output")
+      ? vm["output"].as<string>() : "perf_test_" + model_name + ".json";
+
+  boost::shared_ptr<ModelData> config = boost::make_shared<ModelData>();
+  config->minibatch_size = vm["minibatch-size"].as<int>();
+  config->threads = vm["threads"].as<int>();
+  config->iterations = 1;
+  config->evaluate_frequency = numeric_limits<int>::max();
+  config->minibatch_threshold = numeric_limits<int>::max();
+  config->ngram_order = 5;
+  config->word_representation_size = 100;
+  config->l2_lbl = 2;
+  config->step_size = 0.06;
+  config->randomise = false;
+  config->activation = SIGMOID;
+  config->classes = 50;
+  config->training_file = "perf_training.txt";
+  config->test_file = "perf_test.txt";
+  config->model_output_file = "perf_model.bin";
+  // The training throughput is measured from the statistics of every
+  // minibatch.
+  config->stats_frequency = 1;
+  config->stats_file = STATS_FILE;
+
+  // The corpora are generated from fixed seeds, so the inputs are identical
+  // from one run to the next. The test set is a prefix of the training set,
+  // so it has no unknown words.
+  int num_tokens = vm["minibatches"].as<int>() * config->minibatch_size;
+  int test_sentences = vm["test-sentences"].as<int>();
+  SyntheticCorpus target(VOCAB_SIZE, 1.0, 1);
+  vector<string> files = {
+      config->training_file, config->test_file, config->model_output_file,
+      config->stats_file};
+  // The statistics are appended to the log file.
+  boost::filesystem::remove(config->stats_file);
+  if (model_type == SOURCE_FACTORED_NLM) {
+    SyntheticCorpus source(SOURCE_VOCAB_SIZE, 1.0, 2, "s");
+    config->source_order = 3;
+    config->alignment_file = "perf_training.align";
+    config->test_alignment_file = "perf_test.align";
+    target.writeParallel(
+        source, config->training_file, config->alignment_file, num_tokens,
+        SENTENCE_LENGTH);
+    CopyLines(config->alignment_file, config->test_alignment_file,
+              test_sentences);
+    files.push_back(config->alignment_file);
+    files.push_back(config->test_alignment_file);
+  } else {
+    target.write(config->training_file, num_tokens, SENTENCE_LENGTH);
+  }
+  CopyLines(config->training_file, config->test_file, test_sentences);
+
+  if (model_type == FACTORED_MAXENT_NLM) {
+    config->feature_context_size = 4;
+    config->min_ngram_freq = 1;
+  } else if (model_type == FACTORED_TREE_NLM) {
+    config->tree_file = "perf_tree.txt";
+    target.writeTree(config->tree_file);
+    files.push_back(config->tree_file);
+  }
+
+  Metrics metrics = Run(model_type, config);
+  for (const string& file: files) {
+    boost::filesystem::remove(file);
+  }
+
+  ofstream fout(output_file);
+  fout << setprecision(9);
+  fout << "{" << endl;
+  fout << "  \"model\": \"" << model_name << "\"," << endl;
+  fout << "  \"git_revision\": \"" << GIT_REVISION << "\"," << endl;
+  fout << "  \"threads\": " << config->threads << "," << endl;
+  fout << "  \"training_tokens\": " << num_tokens << "," << endl;
+  fout << "  \"metrics\": ";
+  WriteMetrics(fout, metrics, "  ");
+  fout << endl << "}" << endl;
+  cout << "Results written to " << output_file << "..." << endl;
+
+  string baselines_file = vm["baselines"].as<string>();
+  if (vm.count("update-baselines")) {
+    UpdateBaselines(baselines_file, model_name, metrics);
+    cout << "Baseline for " << model_name << " written to "
+         << baselines_file << "..." << endl;
+    return 0;
+  }
+
+  if (!boost::filesystem::exists(baselines_file)) {
+    cout << "No baselines found in " << baselines_file << "..." << endl;
+    return 0;
+  }
+
+  boost::property_tree::ptree baselines;
+  boost::property_tree::read_json(baselines_file, baselines);
+  auto baseline = baselines.get_child_optional(model_name);
+  if (!baseline) {
+    cout << "No baseline found for " << model_name << "..." << endl;
+    return 0;
+  }
+
+  cout << "Comparing " << model_name << " against the baseline:" << endl;
+  int num_regressions = Compare(
+      metrics, *baseline, vm["tolerance"].as<double>(),
+      vm["perplexity-tolerance"].as<double>());
+  if (num_regressions > 0) {
+    cout << num_regressions << " metric(s) regressed for " << model_name
+         << "..." << endl;
+    return 1;
+  }
+
+  return 0;
+}
@@ -0,0 +1,150 @@
+#pragma once
+
+#include <cmath>
+#include <fstream>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace oxlm {
+
+/**
+ * Generates reproducible text where the words follow a Zipfian distribution,
+ * i.e. the probability of the word with rank r is proportional to
+ * 1 / (r + 1)^exponent.
+ *
+ * The words are named <prefix>0, <prefix>1, ... in decreasing order of their
+ * frequency (the default prefix is w).
+ */
+class SyntheticCorpus {
+ public:
+  SyntheticCorpus(
+      int vocab_size, double exponent, int seed, const string& prefix = "w")
+      : vocabSize(vocab_size), prefix(prefix), generator(seed) {
+    vector<double> weights(vocab_size);
+    for (int i = 0; i < vocab_size; ++i) {
+      weights[i] = 1 / pow(i + 1, exponent);
+    }
+    distribution = discrete_distribution<int>(weights.begin(), weights.end());
+  }
+
+  string getWord(int rank) const {
+    return prefix + to_string(rank);
+  }
+
+  /**
+   * Writes num_tokens words to filename, split into sentences with uniformly
+   * distributed lengths between 1 and 2 * sentence_length - 1.
+   */
+  void write(const string& filename, int num_tokens, int sentence_length) {
+    uniform_int_distribution<int> length_distribution(
+        1, 2 * sentence_length - 1);
+
+    ofstream fout(filename);
+    while (num_tokens > 0) {
+      int length = min(num_tokens, length_distribution(generator));
+      writeSentence(fout, length);
+      fout << "\n";
+      num_tokens -= length;
+    }
+  }
+
+  /**
+   * Writes num_tokens target words to filename in the format expected by
+   * ParallelCorpus (source ||| target), drawing the source sentences from
+   * source. The source sentences have the same length distribution as the
+   * target sentences.
+   *
+   * The word alignments are written to alignment_filename: every target word
+   * is linked to the source word at the same relative position in the
+   * sentence, except for a fraction of unaligned_rate unaligned words.
+   */
+  void writeParallel(
+      SyntheticCorpus& source, const string& filename,
+      const string& alignment_filename, int num_tokens, int sentence_length,
+      double unaligned_rate = 0.1) {
+    uniform_int_distribution<int> length_distribution(
+        1, 2 * sentence_length - 1);
+    bernoulli_distribution unaligned_distribution(unaligned_rate);
+
+    ofstream fout(filename), aout(alignment_filename);
+    while (num_tokens > 0) {
+      int source_length = length_distribution(generator);
+      int length = min(num_tokens, length_distribution(generator));
+      source.writeSentence(fout, source_length);
+      fout << " ||| ";
+      writeSentence(fout, length);
+      fout << "\n";
+
+      bool first_link = true;
+      for (int i = 0; i < length; ++i) {
+        if (!unaligned_distribution(generator)) {
+          aout << (first_link ? "" : " ") << i * source_length / length
+               << "-" << i;
+          first_link = false;
+        }
+      }
+      aout << "\n";
+      num_tokens -= length;
+    }
+  }
+
+  /**
+   * Writes a balanced binary tree over the vocabulary (including <s> and
+   * </s>) in the format expected by ClassTree.
+   */
+  void writeTree(const string& filename) const {
+    vector<string> words = {"<s>", "</s>"};
+    for (int i = 0; i < vocabSize; ++i) {
+      words.push_back(getWord(i));
+    }
+
+    ofstream fout(filename);
+    fout << words.size() << "\n";
+    for (const string& word: words) {
+      fout << word << "\n";
+    }
+
+    vector<vector<int>> merges;
+    vector<int> level(words.size());
+    iota(level.begin(), level.end(), 0);
+    while (level.size() > 1) {
+      vector<int> next_level;
+      for (size_t i = 0; i < level.size(); i += 2) {
+        if (i + 1 < level.size()) {
+          next_level.push_back(words.size() + merges.size());
+          merges.push_back({level[i], level[i + 1]});
+        } else {
+          next_level.push_back(level[i]);
+        }
+      }
+      level = next_level;
+    }
+
+    fout << merges.size() << "\n";
+    for (const vector<int>& merge: merges) {
+      fout << merge.size();
+      for (int node: merge) {
+        fout << " " << node;
+      }
+      fout << "\n";
+    }
+  }
+
+ private:
+  void writeSentence(ofstream& fout, int length) {
+    for (int i = 0; i < length; ++i) {
+      fout << getWord(distribution(generator)) << (i + 1 < length ? " " : "");
+    }
+  }
+
+  int vocabSize;
+  string prefix;
+  mt19937 generator;
+  discrete_distribution<int> distribution;
+};
+
+} // namespace oxlm
@@ -0,0 +1,125 @@
+#include <boost/filesystem.hpp>
+#include <boost/make_shared.hpp>
+
+#include "lbl/benchmarks/benchmark.h"
+#include "lbl/benchmarks/synthetic_corpus.h"
+#include "lbl/context_processor.h"
+#include "lbl/model.h"
+#include "lbl/model_utils.h"
+
+using namespace oxlm;
+
+static const int VOCAB_SIZE = 2000;
+static const int NUM_TOKENS = 20000;
+static const int MINIBATCH_SIZE = 1000;
+static const int NUM_QUERIES = 2000;
+
+/**
+ * Benchmarks the gradient and the scoring calls of a model type on a freshly
+ * initialized set of weights (the cost of these calls does not depend on the
+ * values of the weights).
+ */
+template<class GlobalWeights, class MinibatchWeights, class Metadata>
+void BenchmarkWeights(
+    BenchmarkRunner& runner, const string& name,
+    const boost::shared_ptr<ModelData>& config) {
+  boost::shared_ptr<Vocabulary> vocab;
+  boost::shared_ptr<Metadata> metadata =
+      boost::make_shared<Metadata>(config, vocab);
+  boost::shared_ptr<Corpus> corpus = readTrainingCorpus(config, vocab);
+  metadata->initialize(corpus);
+  boost::shared_ptr<GlobalWeights> weights =
+      boost::make_shared<GlobalWeights>(config, metadata, corpus);
+
+  vector<int> minibatch(MINIBATCH_SIZE);
+  iota(minibatch.begin(), minibatch.end(), 0);
+  boost::shared_ptr<MinibatchWeights> gradient =
+      boost::make_shared<MinibatchWeights>(config, metadata);
+  gradient->init(corpus, minibatch);
+  runner.run(name + "/getGradient", minibatch.size(), [&]() {
+    Real objective = 0;
+    MinibatchWords words;
+    weights->getGradient(corpus, minibatch, gradient, objective, words);
+    gradient->clear(words, false);
+    runner.consume(objective);
+  });
+
+  runner.run(name + "/getLogLikelihood", minibatch.size(), [&]() {
+    runner.consume(weights->getLogLikelihood(corpus, minibatch));
+  });
+
+  vector<int> queries(NUM_QUERIES);
+  iota(queries.begin(), queries.end(), MINIBATCH_SIZE);
+  ContextProcessor processor(corpus, config->ngram_order - 1);
+  vector<vector<int>> contexts;
+  for (int i: queries) {
+    contexts.push_back(processor.extract(i));
+  }
+
+  runner.run(name + "/getLogProb", queries.size(), [&]() {
+    weights->clearCache();
+    for (size_t i = 0; i < queries.size(); ++i) {
+      runner.consume(weights->getLogProb(corpus->at(queries[i]), contexts[i]));
+    }
+  });
+
+  runner.run(name + "/getLogProbCached", queries.size(), [&]() {
+    for (size_t i = 0; i < queries.size(); ++i) {
+      runner.consume(weights->getLogProb(corpus->at(queries[i]), contexts[i]));
+    }
+  });
+
+  runner.run(name + "/getUnnormalizedScore", queries.size(), [&]() {
+    for (size_t i = 0; i < queries.size(); ++i) {
+      runner.consume(weights->getUnnormalizedScore(
+          corpus->at(queries[i]), contexts[i]));
+    }
+  });
+}
+
+int main(int argc, char** argv) {
+  BenchmarkRunner runner("weights_benchmark", argc, argv);
+
+  SyntheticCorpus synthetic_corpus(VOCAB_SIZE, 1.0, 1);
+  synthetic_corpus.write("benchmark_corpus.txt", NUM_TOKENS, 20);
+  synthetic_corpus.writeTree("benchmark_tree.txt");
+
+  boost::shared_ptr<ModelData> config = boost::make_shared<ModelData>();
+  config->training_file = "benchmark_corpus.txt";
+  config->ngram_order = 5;
+  config->word_representation_size = 100;
+  config->classes = 50;
+  config->activation = RECTIFIER;
+  config->min_ngram_freq = 1;
+
+  BenchmarkWeights<Weights, Weights, Metadata>(
+      runner, "Weights", boost::make_shared<ModelData>(*config));
+  BenchmarkWeights<FactoredWeights, FactoredWeights, FactoredMetadata>(
+      runner, "FactoredWeights", boost::make_shared<ModelData>(*config));
+
+  boost::shared_ptr<ModelData> tree_config =
+      boost::make_shared<ModelData>(*config);
+  tree_config->tree_file = "benchmark_tree.txt";
+  BenchmarkWeights<FactoredTreeWeights, FactoredTreeWeights, TreeMetadata>(
+      runner, "FactoredTreeWeights", tree_config);
+
+  boost::shared_ptr<ModelData> maxent_config =
+      boost::make_shared<ModelData>(*config);
+  maxent_config->feature_context_size = 4;
+  BenchmarkWeights<GlobalFactoredMaxentWeights,
+                   MinibatchFactoredMaxentWeights,
+                   FactoredMaxentMetadata>(
+      runner, "GlobalFactoredMaxentWeights", maxent_config);
+
+  boost::shared_ptr<ModelData> collision_config =
+      boost::make_shared<ModelData>(*maxent_config);
+  collision_config->hash_space = 1000000;
+  BenchmarkWeights<GlobalFactoredMaxentWeights,
+                   MinibatchFactoredMaxentWeights,
+                   FactoredMaxentMetadata>(
+      runner, "GlobalFactoredMaxentWeights/collisions", collision_config);
+
+  boost::filesystem::remove("benchmark_corpus.txt");
+  boost::filesystem::remove("benchmark_tree.txt");
+  return runner.finish();
+}
@@ -0,0 +1,254 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include <boost/align/aligned_allocator.hpp>
+#include <boost/serialization/serialization.hpp>
+#include <boost/serialization/vector.hpp>
+
+#include "lbl/utils.h"
+
+using namespace std;
+
+namespace oxlm {
+
+/**
+ * Counting Bloom filter where all the probes for an item fall in a single
+ * 64-byte block (one cache line).
+ *
+ * Each item is hashed once with the 128-bit Murmur hash: the first half
+ * selects the block and the second half generates the in-block probes via
+ * double hashing. Counters are packed in 1, 2, 4 or 8 bits (the smallest width
+ * that holds min_frequency), so they never straddle a 64-bit word. When
+ * min_frequency saturates the counters (e.g. min_frequency = 1 with 1-bit
+ * counters), a lookup reduces to a masked compare of the whole block.
+ *
+ * For the same memory, the false positive rate is slightly higher than the one
+ * of BloomFilter<T>, because the items are not spread uniformly across blocks.
+ *
+ * Requires hash<T> to provide getFullHash(item).
+ */
+template<class T>
+class BlockedBloomFilter {
+ public:
+  BlockedBloomFilter() {}
+
+  BlockedBloomFilter(int num_items, int min_frequency, Real error_rate) :
+      minFrequency(min_frequency), errorRate(error_rate) {
+    cout << "Creating Blocked Bloom Filter for " << num_items
+         << " contexts..." << endl;
+    assert(0 < minFrequency && minFrequency < 256);
+    int bucket_size = ceil(log2(minFrequency + 1));
+    counterBits = 1;
+    while (counterBits < bucket_size) {
+      counterBits <<= 1;
+    }
+
+    size_t num_counters = -num_items * log(errorRate) / (log(2) * log(2));
+    numBlocks = max<size_t>(
+        1, (num_counters + getCountersPerBlock() - 1) / getCountersPerBlock());
+    cout << "Blocked Bloom Filter size: " << numBlocks << " blocks..." << endl;
+    numProbes = round(
+        numBlocks * getCountersPerBlock() * log(2) / max(num_items, 1));
+    if (numProbes < 1) {
+      numProbes = 1;
+    } else if (numProbes > MAX_PROBES) {
+      numProbes = MAX_PROBES;
+    }
+
+    words.resize(numBlocks * WORDS_PER_BLOCK, 0);
+  }
+
+  void increment(const T& item) {
+    int positions[MAX_PROBES], values[MAX_PROBES];
+    uint64_t* block = words.data() + getProbes(item, positions);
+
+    int min_value = minFrequency;
+    for (int i = 0; i < numProbes; ++i) {
+      values[i] = getValue(block, positions[i]);
+      min_value = min(min_value, values[i]);
+    }
+
+    if (min_value < minFrequency) {
+      for (int i = 0; i < numProbes; ++i) {
+        if (min_value == values[i]) {
+          setValue(block, positions[i], min_value + 1);
+        }
+      }
+    }
+  }
+
+  bool contains(const T& item) const {
+    int positions[MAX_PROBES];
+    const uint64_t* block = words.data() + getProbes(item, positions);
+
+    if (static_cast<uint64_t>(minFrequency) != getCounterMask()) {
+      for (int i = 0; i < numProbes; ++i) {
+        if (getValue(block, positions[i]) < minFrequency) {
+          return false;
+        }
+      }
+      return true;
+    }
+
+    // Saturated counters: the item is present iff all the bits of all the
+    // probed counters are set.
+    alignas(16) uint64_t mask[WORDS_PER_BLOCK] = {0};
+    for (int i = 0; i < numProbes; ++i) {
+      int bit = positions[i] * counterBits;
+      mask[bit >> 6] |= getCounterMask() << (bit & 63);
+    }
+
+#ifdef __SSE2__
+    __m128i missing = _mm_setzero_si128();
+    for (int i = 0; i < WORDS_PER_BLOCK; i += 2) {
+      __m128i block_bits = _mm_load_si128(
+          reinterpret_cast<const __m128i*>(block + i));
+      __m128i mask_bits = _mm_load_si128(
+          reinterpret_cast<const __m128i*>(mask + i));
+      missing = _mm_or_si128(missing, _mm_andnot_si128(block_bits, mask_bits));
+    }
+    return _mm_movemask_epi8(
+        _mm_cmpeq_epi8(missing, _mm_setzero_si128())) == 0xFFFF;
+#else
+    uint64_t missing = 0;
+    for (int i = 0; i < WORDS_PER_BLOCK; ++i) {
+      missing |= mask[i] & ~block[i];
+    }
+    return missing == 0;
+#endif
+  }
+
+  /**
+   * Adds the counters of a filter with the same parameters, saturating at
+   * min_frequency. The merged filter has no false negatives. With
+   * min_frequency = 1, it is identical to populating a single filter.
+   */
+  void merge(const BlockedBloomFilter<T>& other) {
+    assert(words.size() == other.words.size()
+        && counterBits == other.counterBits);
+    if (counterBits == 1) {
+      for (size_t i = 0; i < words.size(); ++i) {
+        words[i] |= other.words[i];
+      }
+      return;
+    }
+
+    for (size_t i = 0; i < numBlocks; ++i) {
+      uint64_t* block = words.data() + i * WORDS_PER_BLOCK;
+      const uint64_t* other_block = other.words.data() + i * WORDS_PER_BLOCK;
+      for (int j = 0; j < getCountersPerBlock(); ++j) {
+        int value = getValue(block, j) + getValue(other_block, j);
+        setValue(block, j, min(value, minFrequency));
+      }
+    }
+  }
+
+  /**
+   * Estimates the false positive rate from the fraction of counters that
+   * reached min_frequency in each block.
+   */
+  Real estimateErrorRate() const {
+    double error_rate = 0;
+    for (size_t i = 0; i < numBlocks; ++i) {
+      const uint64_t* block = words.data() + i * WORDS_PER_BLOCK;
+      int num_full_counters = 0;
+      for (int j = 0; j < getCountersPerBlock(); ++j) {
+        num_full_counters += getValue(block, j) >= minFrequency;
+      }
+      error_rate += pow(
+          static_cast<double>(num_full_counters) / getCountersPerBlock(),
+          numProbes);
+    }
+
+    return error_rate / numBlocks;
+  }
+
+  size_t memoryUsage() const {
+    return words.capacity() * sizeof(uint64_t);
+  }
+
+  bool operator==(const BlockedBloomFilter<T>& other) const {
+    return numBlocks == other.numBlocks
+        && counterBits == other.counterBits
+        && numProbes == other.numProbes
+        && minFrequency == other.minFrequency
+        && errorRate == other.errorRate
+        && hashFunction == other.hashFunction
+        && words == other.words;
+  }
+
+ private:
+  int getCountersPerBlock() const {
+    return WORDS_PER_BLOCK * 64 / counterBits;
+  }
+
+  uint64_t getCounterMask() const {
+    return (1ULL << counterBits) - 1;
+  }
+
+  /**
+   * Writes the positions of the probed counters within the block and returns
+   * the offset of the block in words.
+   */
+  size_t getProbes(const T& item, int* positions) const {
+    pair<size_t, size_t> key = hashFunction.getFullHash(item);
+
+    // The number of counters per block is a power of 2, so an odd step visits
+    // distinct counters for the first getCountersPerBlock() probes.
+    uint32_t position = key.second;
+    uint32_t step = (key.second >> 32) | 1;
+    uint32_t counter_mask = getCountersPerBlock() - 1;
+    for (int i = 0; i < numProbes; ++i) {
+      positions[i] = position & counter_mask;
+      position += step;
+    }
+
+    return (key.first % numBlocks) * WORDS_PER_BLOCK;
+  }
+
+  int getValue(const uint64_t* block, int position) const {
+    int bit = position * counterBits;
+    return (block[bit >> 6] >> (bit & 63)) & getCounterMask();
+  }
+
+  void setValue(uint64_t* block, int position, int value) {
+    assert(value <= minFrequency);
+    int bit = position * counterBits;
+    uint64_t& word = block[bit >> 6];
+    word &= ~(getCounterMask() << (bit & 63));
+    word |= static_cast<uint64_t>(value) << (bit & 63);
+  }
+
+  friend class boost::serialization::access;
+
+  template<class Archive>
+  void serialize(Archive& ar, const unsigned int version) {
+    ar & numBlocks;
+    ar & counterBits;
+    ar & numProbes;
+    ar & minFrequency;
+    ar & errorRate;
+    ar & hashFunction;
+    ar & words;
+  }
+
+  static const int WORDS_PER_BLOCK = 8;
+  static const int MAX_PROBES = 64;
+
+  size_t numBlocks;
+  int counterBits;
+  int numProbes;
+  int minFrequency;
+  Real errorRate;
+  hash<T> hashFunction;
+  // Aligned so that every block occupies exactly one cache line.
+  vector<uint64_t, boost::alignment::aligned_allocator<uint64_t, 64>> words;
+};
+
+} // namespace oxlm
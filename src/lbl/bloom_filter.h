@@ -60,6 +60,36 @@ class BloomFilter {
     return true;
   }
 
+  /**
+   * Adds the counters of a filter with the same parameters, saturating at
+   * min_frequency. The merged filter has no false negatives. With
+   * min_frequency = 1, it is identical to populating a single filter.
+   */
+  void merge(const BloomFilter<T>& other) {
+    assert(numBuckets == other.numBuckets && bucketSize == other.bucketSize);
+    for (int i = 0; i < numBuckets; ++i) {
+      int key = bucketSize * i;
+      setValue(key, min(getValue(key) + other.getValue(key), minFrequency));
+    }
+  }
+
+  /**
+   * Estimates the false positive rate from the fraction of buckets that
+   * reached min_frequency.
+   */
+  Real estimateErrorRate() const {
+    int num_full_buckets = 0;
+    for (int i = 0; i < numBuckets; ++i) {
+      num_full_buckets += getValue(bucketSize * i) >= minFrequency;
+    }
+
+    return pow(static_cast<Real>(num_full_buckets) / numBuckets, hashes.size());
+  }
+
+  size_t memoryUsage() const {
+    return bits.capacity() / 8;
+  }
+
   bool operator==(const BloomFilter<T>& other) const {
     return numBuckets == other.numBuckets
         && bucketSize == other.bucketSize
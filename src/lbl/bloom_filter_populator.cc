@@ -5,7 +5,9 @@
 #include "lbl/class_context_hasher.h"
 #include "lbl/context_processor.h"
 #include "lbl/feature_context_generator.h"
+#include "lbl/hyper_log_log.h"
 #include "lbl/word_context_hasher.h"
+#include "utils/conditional_omp.h"
 
 namespace oxlm {
 
@@ -16,12 +18,40 @@ BloomFilterPopulator::BloomFilterPopulator(
     const boost::shared_ptr<WordToClassIndex>& index,
     const boost::shared_ptr<FeatureContextMapper>& mapper,
     const boost::shared_ptr<ModelData>& config) {
-  // This is only an underestimate of the number of distinct n-grams in the
-  // training data (feature contexts do not include the predict word) =>
-  // #(feature_contexts) < #(ngrams).
-  bloomFilter = boost::make_shared<BloomFilter<NGram>>(
-      mapper->getNumContexts(), 1, config->filter_error_rate);
+  // The number of feature contexts is only an underestimate of the number of
+  // distinct n-grams inserted in the filter (feature contexts do not include
+  // the predicted word) => #(feature_contexts) < #(ngrams). Count the n-grams
+  // with a HyperLogLog sketch (~0.8% standard error) instead.
+  boost::shared_ptr<HyperLogLog<NGram>> counter =
+      boost::make_shared<HyperLogLog<NGram>>(14);
+  populate(corpus, index, config, counter);
+  int num_ngrams = max(1.0, round(counter->estimate()));
+  cout << "Estimated number of distinct n-grams: " << num_ngrams
+       << " (" << mapper->getNumContexts() << " feature contexts)..." << endl;
 
+  Real error_rate;
+  if (config->blocked_bloom_filter) {
+    blockedBloomFilter = boost::make_shared<BlockedBloomFilter<NGram>>(
+        num_ngrams, 1, config->filter_error_rate);
+    populate(corpus, index, config, blockedBloomFilter);
+    error_rate = blockedBloomFilter->estimateErrorRate();
+  } else {
+    bloomFilter = boost::make_shared<BloomFilter<NGram>>(
+        num_ngrams, 1, config->filter_error_rate);
+    populate(corpus, index, config, bloomFilter);
+    error_rate = bloomFilter->estimateErrorRate();
+  }
+
+  cout << "Bloom filter error rate: " << error_rate << " estimated, "
+       << config->filter_error_rate << " target..." << endl;
+}
+
+template<class Filter>
+void BloomFilterPopulator::populate(
+    const boost::shared_ptr<Corpus>& corpus,
+    const boost::shared_ptr<WordToClassIndex>& index,
+    const boost::shared_ptr<ModelData>& config,
+    const boost::shared_ptr<Filter>& filter) {
   ContextProcessor processor(corpus, config->ngram_order - 1);
   FeatureContextGenerator generator(config->feature_context_size);
   ClassContextHasher class_hasher(config->hash_space);
@@ -30,25 +60,68 @@ BloomFilterPopulator::BloomFilterPopulator(
     word_hashers.push_back(WordContextHasher(i, config->hash_space));
   }
 
-  for (size_t i = 0; i < corpus->size(); ++i) {
-    int word_id = corpus->at(i);
-    int class_id = index->getClass(word_id);
-    int word_class_id = index->getWordIndexInClass(word_id);
-    vector<int> context = processor.extract(i);
-    for (const auto& feature_context: generator.getFeatureContexts(context)) {
-      bloomFilter->increment(
-          class_hasher.getPrediction(class_id, feature_context));
-      bloomFilter->increment(
-          word_hashers[class_id].getPrediction(word_class_id, feature_context));
+  // The first thread writes directly to the output filter.
+  vector<boost::shared_ptr<Filter>> partial_filters(omp_get_max_threads());
+  partial_filters[0] = filter;
+  for (size_t i = 1; i < partial_filters.size(); ++i) {
+    partial_filters[i] = boost::make_shared<Filter>(*filter);
+  }
+
+  #pragma omp parallel
+  {
+    int thread_id = omp_get_thread_num();
+    pair<size_t, size_t> range =
+        GetSlice(corpus->size(), thread_id, omp_get_num_threads());
+
+    Filter& partial_filter = *partial_filters[thread_id];
+    for (size_t i = range.first; i < range.second; ++i) {
+      int word_id = corpus->at(i);
+      int class_id = index->getClass(word_id);
+      int word_class_id = index->getWordIndexInClass(word_id);
+      vector<int> context = processor.extract(i);
+      for (const auto& feature_context:
+          generator.getFeatureContexts(context)) {
+        partial_filter.increment(
+            class_hasher.getPrediction(class_id, feature_context));
+        partial_filter.increment(word_hashers[class_id].getPrediction(
+            word_class_id, feature_context));
+      }
     }
   }
+
+  for (size_t i = 1; i < partial_filters.size(); ++i) {
+    filter->merge(*partial_filters[i]);
+    partial_filters[i].reset();
+  }
 }
 
 boost::shared_ptr<BloomFilter<NGram>> BloomFilterPopulator::get() const {
   return bloomFilter;
 }
 
+boost::shared_ptr<BlockedBloomFilter<NGram>>
+    BloomFilterPopulator::getBlocked() const {
+  return blockedBloomFilter;
+}
+
+size_t BloomFilterPopulator::memoryUsage() const {
+  size_t bytes = 0;
+  if (bloomFilter != nullptr) {
+    bytes += bloomFilter->memoryUsage();
+  }
+  if (blockedBloomFilter != nullptr) {
+    bytes += blockedBloomFilter->memoryUsage();
+  }
+
+  return bytes;
+}
+
 bool BloomFilterPopulator::operator==(const BloomFilterPopulator& other) const {
+  if (blockedBloomFilter || other.blockedBloomFilter) {
+    return blockedBloomFilter && other.blockedBloomFilter
+        && *blockedBloomFilter == *other.blockedBloomFilter;
+  }
+
   return *bloomFilter == *other.bloomFilter;
 }
 
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "lbl/blocked_bloom_filter.h"
 #include "lbl/bloom_filter.h"
 #include "lbl/config.h"
 #include "lbl/feature_context_mapper.h"
@@ -9,6 +10,7 @@
 #include "lbl/parallel_corpus.h"
 
 #include <boost/serialization/shared_ptr.hpp>
+#include <boost/serialization/version.hpp>
 
 namespace oxlm {
 
@@ -22,19 +24,47 @@ class BloomFilterPopulator {
       const boost::shared_ptr<FeatureContextMapper>& mapper,
       const boost::shared_ptr<ModelData>& config);
 
+  /**
+   * Returns the Bloom filter, unless the populator was configured to use a
+   * blocked Bloom filter (in which case nullptr is returned).
+   */
   boost::shared_ptr<BloomFilter<NGram>> get() const;
 
+  boost::shared_ptr<BlockedBloomFilter<NGram>> getBlocked() const;
+
+  size_t memoryUsage() const;
+
   bool operator==(const BloomFilterPopulator& other) const;
 
  private:
+  /**
+   * Adds the class and word n-grams observed in the corpus to filter (a Bloom
+   * filter or a cardinality estimator). Every thread populates its own copy
+   * of the filter from a slice of the corpus. The copies are merged into
+   * filter at the end.
+   */
+  template<class Filter>
+  static void populate(
+      const boost::shared_ptr<Corpus>& corpus,
+      const boost::shared_ptr<WordToClassIndex>& index,
+      const boost::shared_ptr<ModelData>& config,
+      const boost::shared_ptr<Filter>& filter);
+
   friend class boost::serialization::access;
 
   template<class Archive>
   void serialize(Archive& ar, const unsigned int version) {
     ar & bloomFilter;
+    // Version 0 archives predate the blocked Bloom filters.
+    if (version > 0) {
+      ar & blockedBloomFilter;
+    }
   }
 
   boost::shared_ptr<BloomFilter<NGram>> bloomFilter;
+  boost::shared_ptr<BlockedBloomFilter<NGram>> blockedBloomFilter;
 };
 
 } // namespace oxlm
+
+BOOST_CLASS_VERSION(oxlm::BloomFilterPopulator, 1)
@@ -7,6 +7,8 @@
 #include <boost/filesystem.hpp>
 #include <boost/make_shared.hpp>
 
+#include "lbl/tracer.h"
+
 using namespace std;
 using namespace oxlm;
 
@@ -17,10 +19,11 @@ FF_LBLLM<Model>::FF_LBLLM(
     const string& filename,
     const string& feature_name,
     bool normalized,
-    bool persistent_cache)
+    bool persistent_cache,
+    bool memory_report)
     : fid(FD::Convert(feature_name)),
       fidOOV(FD::Convert(feature_name + "_OOV")),
-      filename(filename), normalized(normalized),
+      filename(filename), normalized(normalized), memoryReport(memory_report),
       persistentCache(persistent_cache), cacheHits(0), totalHits(0) {
   model.load(filename);
 
@@ -41,10 +44,22 @@ FF_LBLLM<Model>::FF_LBLLM(
   kSTOP = vocab->convert("</s>");
   kUNKNOWN = vocab->convert("<unk>");
   kSTAR = vocab->convert("<{STAR}>");
+
+  if (memoryReport) {
+    printMemoryReport();
+  }
+}
+
+template<class Model>
+void FF_LBLLM<Model>::printMemoryReport() const {
+  MemoryReport report = model.getMemoryReport();
+  report.add("query cache", cache.memoryUsage());
+  report.print(cerr);
 }
 
 template<class Model>
 void FF_LBLLM<Model>::savePersistentCache() {
+  TraceScope scope("FF_LBLLM::savePersistentCache");
   if (persistentCache && cacheFile.size()) {
     ofstream f(cacheFile);
     boost::archive::binary_oarchive oa(f);
@@ -57,6 +72,7 @@ void FF_LBLLM<Model>::savePersistentCache() {
 
 template<class Model>
 void FF_LBLLM<Model>::loadPersistentCache(int sentence_id) {
+  TraceScope scope("FF_LBLLM::loadPersistentCache");
   if (persistentCache) {
     cacheFile = filename + "." + to_string(sentence_id) + ".cache.bin";
     if (boost::filesystem::exists(cacheFile)) {
@@ -74,6 +90,11 @@ void FF_LBLLM<Model>::loadPersistentCache(int sentence_id) {
 
 template<class Model>
 void FF_LBLLM<Model>::PrepareForInput(const SentenceMetadata& smeta) {
+  TraceScope scope("FF_LBLLM::PrepareForInput");
+  if (memoryReport) {
+    // Includes the caches populated while decoding the previous sentence.
+    printMemoryReport();
+  }
   model.clearCache();
 
   savePersistentCache();
@@ -86,6 +107,7 @@ void FF_LBLLM<Model>::TraversalFeaturesImpl(
     const SentenceMetadata& smeta, const HG::Edge& edge,
     const vector<const void*>& prev_states, SparseVector<double>* features,
     SparseVector<double>* estimated_features, void* next_state) const {
+  TraceScope scope("FF_LBLLM::TraversalFeaturesImpl");
   vector<int> symbols = ruleConverter->convertTargetSide(
       edge.rule_->e(), prev_states);
 
@@ -112,6 +134,7 @@ void FF_LBLLM<Model>::TraversalFeaturesImpl(
 template<class Model>
 void FF_LBLLM<Model>::FinalTraversalFeatures(
     const void* prev_state, SparseVector<double>* features) const {
+  TraceScope scope("FF_LBLLM::FinalTraversalFeatures");
   vector<int> symbols = stateConverter->getTerminals(prev_state);
   symbols.insert(symbols.begin(), kSTART);
   symbols.push_back(kSTOP);
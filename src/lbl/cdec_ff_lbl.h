@@ -25,7 +25,8 @@ class FF_LBLLM : public FeatureFunction {
       const string& filename,
       const string& feature_name,
       bool normalized,
-      bool persistent_cache);
+      bool persistent_cache,
+      bool memory_report);
 
   virtual void PrepareForInput(const SentenceMetadata& smeta);
 
@@ -41,6 +42,8 @@ class FF_LBLLM : public FeatureFunction {
       const void* prev_state, SparseVector<double>* features) const;
 
  private:
+  void printMemoryReport() const;
+
   void savePersistentCache();
 
   void loadPersistentCache(int sentence_id);
@@ -73,6 +76,8 @@ class FF_LBLLM : public FeatureFunction {
 
   bool normalized;
 
+  bool memoryReport;
+
   bool persistentCache;
   string cacheFile;
   mutable QueryCache cache;
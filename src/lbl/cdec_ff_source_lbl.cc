@@ -16,6 +16,7 @@
 #include "lbl/model.h"
 #include "lbl/query_cache.h"
 #include "lbl/parallel_vocabulary.h"
+#include "lbl/tracer.h"
 
 using namespace oxlm;
 
@@ -25,10 +26,11 @@ FF_SourceLBLLM::FF_SourceLBLLM(
     const string& filename,
     const string& feature_name,
     bool normalized,
-    bool persistent_cache)
+    bool persistent_cache,
+    bool memory_report)
     : fid(FD::Convert(feature_name)),
       fidOOV(FD::Convert(feature_name + "_OOV")),
-      filename(filename), normalized(normalized),
+      filename(filename), normalized(normalized), memoryReport(memory_report),
       persistentCache(persistent_cache), cacheHits(0), totalHits(0) {
   model.load(filename);
 
@@ -59,9 +61,20 @@ FF_SourceLBLLM::FF_SourceLBLLM(
   kSTOP = vocab->convert("</s>");
   kUNKNOWN = vocab->convert("<unk>");
   kSTAR = vocab->convert("<{STAR}>");
+
+  if (memoryReport) {
+    printMemoryReport();
+  }
+}
+
+void FF_SourceLBLLM::printMemoryReport() const {
+  MemoryReport report = model.getMemoryReport();
+  report.add("query cache", cache.memoryUsage());
+  report.print(cerr);
 }
 
 void FF_SourceLBLLM::savePersistentCache() {
+  TraceScope scope("FF_SourceLBLLM::savePersistentCache");
   if (persistentCache && cacheFile.size()) {
     ofstream f(cacheFile);
     boost::archive::binary_oarchive oa(f);
@@ -73,6 +86,7 @@ void FF_SourceLBLLM::savePersistentCache() {
 }
 
 void FF_SourceLBLLM::loadPersistentCache(int sentence_id) {
+  TraceScope scope("FF_SourceLBLLM::loadPersistentCache");
   if (persistentCache) {
     cacheFile = filename + "." + to_string(sentence_id) + ".cache.bin";
     if (boost::filesystem::exists(cacheFile)) {
@@ -114,6 +128,11 @@ const vector<WordID> FF_SourceLBLLM::GetSourceSentence(
 }
 
 void FF_SourceLBLLM::PrepareForInput(const SentenceMetadata& smeta) {
+  TraceScope scope("FF_SourceLBLLM::PrepareForInput");
+  if (memoryReport) {
+    // Includes the caches populated while decoding the previous sentence.
+    printMemoryReport();
+  }
   model.clearCache();
 
   savePersistentCache();
@@ -434,6 +453,7 @@ void FF_SourceLBLLM::TraversalFeaturesImpl(
     const SentenceMetadata& smeta, const HG::Edge& edge,
     const vector<const void*>& prev_states, SparseVector<double>* features,
     SparseVector<double>* estimated_features, void* next_state) const {
+  TraceScope scope("FF_SourceLBLLM::TraversalFeaturesImpl");
 
   const vector<int>& source = edge.rule_->f();
   const vector<int>& target = edge.rule_->e();
@@ -499,6 +519,7 @@ void FF_SourceLBLLM::TraversalFeaturesImpl(
 
 void FF_SourceLBLLM::FinalTraversalFeatures(
     const void* prev_state, SparseVector<double>* features) const {
+  TraceScope scope("FF_SourceLBLLM::FinalTraversalFeatures");
   // When we have a full sentence we evaluate one more time, this time
   // surrounding the sentence with <s> and </s>.
   // Note: <s> and </s> are always affiliated with the first and last
@@ -39,7 +39,8 @@ class FF_SourceLBLLM : public FeatureFunction {
         const string& filename,
         const string& feature_name,
         bool normalized,
-        bool persistent_cache);
+        bool persistent_cache,
+        bool memory_report);
 
   virtual void PrepareForInput(const SentenceMetadata& smeta);
 
@@ -55,6 +56,8 @@ class FF_SourceLBLLM : public FeatureFunction {
       const void* prev_state, SparseVector<double>* features) const;
 
  private:
+  void printMemoryReport() const;
+
   void savePersistentCache();
 
   void loadPersistentCache(int sentence_id);
@@ -136,6 +139,8 @@ class FF_SourceLBLLM : public FeatureFunction {
 
   bool normalized;
 
+  bool memoryReport;
+
   bool persistentCache;
   string cacheFile;
   mutable QueryCache cache;
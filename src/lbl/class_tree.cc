@@ -76,7 +76,7 @@ int ClassTree::getParent(int node) const {
   return parent[node];
 }
 
-vector<int> ClassTree::getChildren(int node) const {
+const vector<int>& ClassTree::getChildren(int node) const {
   return children[node];
 }
 
@@ -25,7 +25,7 @@ class ClassTree {
 
   int getParent(int node) const;
 
-  vector<int> getChildren(int node) const;
+  const vector<int>& getChildren(int node) const;
 
   int childIndex(int node) const;
 
@@ -2,16 +2,20 @@
 
 #include <boost/make_shared.hpp>
 
+#include "lbl/blocked_bloom_filter.h"
 #include "lbl/bloom_filter.h"
 #include "lbl/class_context_extractor.h"
 #include "lbl/class_context_hasher.h"
+#include "lbl/compact_filter_populator.h"
 #include "lbl/context_processor.h"
 #include "lbl/feature_approximate_filter.h"
+#include "lbl/feature_compact_filter.h"
 #include "lbl/feature_context_generator.h"
 #include "lbl/feature_exact_filter.h"
 #include "lbl/feature_no_op_filter.h"
 #include "lbl/word_context_extractor.h"
 #include "lbl/word_context_hasher.h"
+#include "utils/conditional_omp.h"
 
 namespace oxlm {
 
@@ -21,9 +25,11 @@ CollisionCounter::CollisionCounter(
     const boost::shared_ptr<FeatureContextMapper>& mapper,
     const boost::shared_ptr<FeatureMatcher>& matcher,
     const boost::shared_ptr<BloomFilterPopulator>& populator,
+    const boost::shared_ptr<CompactFilterPopulator>& compact_populator,
     const boost::shared_ptr<ModelData>& config)
-    : corpus(corpus), index(index), mapper(mapper), matcher(matcher),
-      populator(populator), config(config),
+    : config(config), corpus(corpus), index(index), mapper(mapper),
+      matcher(matcher), populator(populator),
+      compactPopulator(compact_populator),
       observedWordQueries(index->getNumClasses()) {
   int num_classes = index->getNumClasses();
   boost::shared_ptr<ContextProcessor> processor =
@@ -34,12 +40,21 @@ CollisionCounter::CollisionCounter(
 
   GlobalFeatureIndexesPairPtr feature_indexes_pair;
   boost::shared_ptr<BloomFilter<NGram>> bloom_filter;
+  boost::shared_ptr<BlockedBloomFilter<NGram>> blocked_bloom_filter;
   boost::shared_ptr<FeatureFilter> class_filter;
   if (config->filter_contexts) {
-    if (config->filter_error_rate > 0) {
-      bloom_filter = populator->get();
-      class_filter = boost::make_shared<FeatureApproximateFilter>(
-          num_classes, class_hasher, bloom_filter);
+    if (config->compact_filter) {
+      class_filter = compactPopulator->getClassFilter();
+    } else if (config->filter_error_rate > 0) {
+      if (config->blocked_bloom_filter) {
+        blocked_bloom_filter = populator->getBlocked();
+        class_filter = boost::make_shared<FeatureApproximateFilter>(
+            num_classes, class_hasher, blocked_bloom_filter);
+      } else {
+        bloom_filter = populator->get();
+        class_filter = boost::make_shared<FeatureApproximateFilter>(
+            num_classes, class_hasher, bloom_filter);
+      }
     } else {
       feature_indexes_pair = matcher->getGlobalFeatures();
       class_filter = boost::make_shared<FeatureExactFilter>(
@@ -56,9 +71,16 @@ CollisionCounter::CollisionCounter(
     word_hashers[i] = boost::make_shared<WordContextHasher>(
         i, config->hash_space);
     if (config->filter_contexts) {
-      if (config->filter_error_rate > 0) {
-        word_filters[i] = boost::make_shared<FeatureApproximateFilter>(
-            index->getClassSize(i), word_hashers[i], bloom_filter);
+      if (config->compact_filter) {
+        word_filters[i] = compactPopulator->getWordFilter(i);
+      } else if (config->filter_error_rate > 0) {
+        if (config->blocked_bloom_filter) {
+          word_filters[i] = boost::make_shared<FeatureApproximateFilter>(
+              index->getClassSize(i), word_hashers[i], blocked_bloom_filter);
+        } else {
+          word_filters[i] = boost::make_shared<FeatureApproximateFilter>(
+              index->getClassSize(i), word_hashers[i], bloom_filter);
+        }
       } else {
         word_filters[i] = boost::make_shared<FeatureExactFilter>(
             feature_indexes_pair->getWordIndexes(i),
@@ -71,27 +93,57 @@ CollisionCounter::CollisionCounter(
   }
 
   auto start_time = GetTime();
-  for (size_t i = 0; i < corpus->size(); ++i) {
-    int class_id = index->getClass(corpus->at(i));
-    vector<int> context = processor->extract(i);
-    vector<FeatureContext> feature_contexts =
-        generator.getFeatureContexts(context);
+  // Every thread collects the queries observed in a slice of the corpus. The
+  // first thread writes directly to the output sets.
+  int num_threads = omp_get_max_threads();
+  vector<unordered_set<NGram>> class_queries(num_threads);
+  vector<vector<unordered_set<NGram>>> word_queries(
+      num_threads, vector<unordered_set<NGram>>(num_classes));
+  vector<unordered_set<int>> keys(num_threads);
+  #pragma omp parallel
+  {
+    int thread_id = omp_get_thread_num();
+    pair<size_t, size_t> range =
+        GetSlice(corpus->size(), thread_id, omp_get_num_threads());
 
-    for (const FeatureContext& feature_context: feature_contexts) {
-      int key = class_hasher->getKey(feature_context);
-      for (int index: class_filter->getIndexes(feature_context)) {
-        observedClassQueries.insert(NGram(index, feature_context.data));
-        observedKeys.insert((key + index) % config->hash_space);
-      }
+    unordered_set<NGram>& observed_class_queries =
+        thread_id == 0 ? observedClassQueries : class_queries[thread_id];
+    vector<unordered_set<NGram>>& observed_word_queries =
+        thread_id == 0 ? observedWordQueries : word_queries[thread_id];
+    unordered_set<int>& observed_keys =
+        thread_id == 0 ? observedKeys : keys[thread_id];
+    for (size_t i = range.first; i < range.second; ++i) {
+      int class_id = index->getClass(corpus->at(i));
+      vector<int> context = processor->extract(i);
+      vector<FeatureContext> feature_contexts =
+          generator.getFeatureContexts(context);
+
+      for (const FeatureContext& feature_context: feature_contexts) {
+        int key = class_hasher->getKey(feature_context);
+        for (int index: class_filter->getIndexes(feature_context)) {
+          observed_class_queries.insert(NGram(index, feature_context.data));
+          observed_keys.insert((key + index) % config->hash_space);
+        }
 
-      key = word_hashers[class_id]->getKey(feature_context);
-      for (int index: word_filters[class_id]->getIndexes(feature_context)) {
-        observedWordQueries[class_id]
-            .insert(NGram(index, class_id, feature_context.data));
-        observedKeys.insert((key + index) % config->hash_space);
+        key = word_hashers[class_id]->getKey(feature_context);
+        for (int index: word_filters[class_id]->getIndexes(feature_context)) {
+          observed_word_queries[class_id]
+              .insert(NGram(index, class_id, feature_context.data));
+          observed_keys.insert((key + index) % config->hash_space);
+        }
       }
     }
   }
+
+  for (int i = 1; i < num_threads; ++i) {
+    observedClassQueries.insert(
+        class_queries[i].begin(), class_queries[i].end());
+    for (int j = 0; j < num_classes; ++j) {
+      observedWordQueries[j].insert(
+          word_queries[i][j].begin(), word_queries[i][j].end());
+    }
+    observedKeys.insert(keys[i].begin(), keys[i].end());
+  }
   cout << "Counting collisions took " << GetDuration(start_time, GetTime())
        << " seconds..." << endl;
 }
@@ -3,6 +3,7 @@
 #include <unordered_set>
 
 #include "lbl/bloom_filter_populator.h"
+#include "lbl/compact_filter_populator.h"
 #include "lbl/config.h"
 #include "lbl/feature_context_mapper.h"
 #include "lbl/feature_matcher.h"
@@ -20,6 +21,7 @@ class CollisionCounter {
       const boost::shared_ptr<FeatureContextMapper>& mapper,
       const boost::shared_ptr<FeatureMatcher>& matcher,
       const boost::shared_ptr<BloomFilterPopulator>& populator,
+      const boost::shared_ptr<CompactFilterPopulator>& compact_populator,
       const boost::shared_ptr<ModelData>& config);
 
   int count() const;
@@ -31,6 +33,7 @@ class CollisionCounter {
   boost::shared_ptr<FeatureContextMapper> mapper;
   boost::shared_ptr<FeatureMatcher> matcher;
   boost::shared_ptr<BloomFilterPopulator> populator;
+  boost::shared_ptr<CompactFilterPopulator> compactPopulator;
   unordered_set<NGram> observedClassQueries;
   vector<unordered_set<NGram>> observedWordQueries;
   unordered_set<int> observedKeys;
@@ -15,12 +15,63 @@ CollisionGlobalFeatureStore::CollisionGlobalFeatureStore(
       generator(feature_context_size), hasher(hasher), filter(filter),
       space(space) {}
 
+int CollisionGlobalFeatureStore::getPosition(
+    int key, int feature_index) const {
+  // Equivalent to (key + feature_index) % hashSpaceSize, since key is always
+  // smaller than hashSpaceSize.
+  int position = key + feature_index;
+  while (position >= hashSpaceSize) {
+    position -= hashSpaceSize;
+  }
+  return position;
+}
+
+void CollisionGlobalFeatureStore::prefetchBucket(int key) const {
+  const int CACHE_LINE_SIZE = 64 / sizeof(Real);
+  for (int i = 0; i < vectorSize; i += CACHE_LINE_SIZE) {
+    __builtin_prefetch(space->featureWeights + getPosition(key, i));
+  }
+}
+
+/**
+ * The weights of a feature context occupy the vectorSize consecutive
+ * positions starting at its key, wrapping around the end of the collision
+ * space. Each contiguous run is added with a single vectorized operation.
+ */
+void CollisionGlobalFeatureStore::addBucket(
+    int key, VectorReal& result) const {
+  int start = 0;
+  int position = key;
+  while (start < vectorSize) {
+    int length = min(vectorSize - start, hashSpaceSize - position);
+    result.segment(start, length) +=
+        VectorRealMap(space->featureWeights + position, length);
+    start += length;
+    position = 0;
+  }
+}
+
 VectorReal CollisionGlobalFeatureStore::get(const vector<int>& context) const {
+  vector<FeatureContext> feature_contexts =
+      generator.getFeatureContexts(context);
+  // The buckets are scattered randomly in the collision space, so all of them
+  // are prefetched before any is read to overlap the cache misses.
+  vector<int> keys(feature_contexts.size());
+  for (size_t i = 0; i < feature_contexts.size(); ++i) {
+    keys[i] = hasher->getKey(feature_contexts[i]);
+    prefetchBucket(keys[i]);
+  }
+
   VectorReal result = VectorReal::Zero(vectorSize);
-  for (const auto& feature_context: generator.getFeatureContexts(context)) {
-    int key = hasher->getKey(feature_context);
-    for (int i: filter->getIndexes(feature_context)) {
-      result(i) += space->featureWeights[(key + i) % hashSpaceSize];
+  for (size_t i = 0; i < feature_contexts.size(); ++i) {
+    vector<int> indexes = filter->getIndexes(feature_contexts[i]);
+    if (indexes.size() == static_cast<size_t>(vectorSize)) {
+      // The filter does not exclude any index, so the whole bucket is used.
+      addBucket(keys[i], result);
+    } else {
+      for (int index: indexes) {
+        result(index) += space->featureWeights[getPosition(keys[i], index)];
+      }
     }
   }
 
@@ -33,7 +84,7 @@ Real CollisionGlobalFeatureStore::getValue(
   for (const auto& feature_context: generator.getFeatureContexts(context)) {
     int key = hasher->getKey(feature_context);
     if (filter->hasIndex(feature_context, feature_index)) {
-      result += space->featureWeights[(key + feature_index) % hashSpaceSize];
+      result += space->featureWeights[getPosition(key, feature_index)];
     }
   }
 
@@ -94,6 +145,11 @@ size_t CollisionGlobalFeatureStore::size() const {
   return hashSpaceSize;
 }
 
+size_t CollisionGlobalFeatureStore::memoryUsage() const {
+  // The weights live in the collision space, which is shared by all stores.
+  return 0;
+}
+
 boost::shared_ptr<CollisionGlobalFeatureStore> CollisionGlobalFeatureStore::cast(
     const boost::shared_ptr<GlobalFeatureStore>& base_store) {
   boost::shared_ptr<CollisionGlobalFeatureStore> store =
@@ -129,6 +185,39 @@ void CollisionGlobalFeatureStore::updateFeature(
   space->featureWeights[index.first] += value;
 }
 
+void CollisionGlobalFeatureStore::getUpdatedEntries(
+    const boost::shared_ptr<MinibatchFeatureStore>& base_store,
+    unordered_set<int>& entries) const {
+  boost::shared_ptr<CollisionMinibatchFeatureStore> store =
+      CollisionMinibatchFeatureStore::cast(base_store);
+  for (const auto& entry: store->featureWeights) {
+    entries.insert(entry.first);
+  }
+}
+
+vector<Real> CollisionGlobalFeatureStore::getEntries(
+    const vector<int>& entries) const {
+  vector<Real> values;
+  for (int key: entries) {
+    values.push_back(space->featureWeights[key]);
+  }
+
+  return values;
+}
+
+void CollisionGlobalFeatureStore::setEntries(
+    const vector<int>& entries, const vector<Real>& values) {
+  assert(entries.size() == values.size());
+  for (size_t i = 0; i < entries.size(); ++i) {
+    space->featureWeights[entries[i]] = values[i];
+  }
+}
+
+boost::shared_ptr<GlobalCollisionSpace>
+    CollisionGlobalFeatureStore::getSpace() const {
+  return space;
+}
+
 CollisionGlobalFeatureStore::~CollisionGlobalFeatureStore() {}
 
 } // namespace oxlm
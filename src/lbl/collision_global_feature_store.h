@@ -44,6 +44,8 @@ class CollisionGlobalFeatureStore : public GlobalFeatureStore {
 
   virtual size_t size() const;
 
+  virtual size_t memoryUsage() const;
+
   static boost::shared_ptr<CollisionGlobalFeatureStore> cast(
       const boost::shared_ptr<GlobalFeatureStore>& base_store);
 
@@ -53,13 +55,30 @@ class CollisionGlobalFeatureStore : public GlobalFeatureStore {
 
   virtual vector<pair<int, int>> getFeatureIndexes() const;
 
+  virtual void getUpdatedEntries(
+      const boost::shared_ptr<MinibatchFeatureStore>& base_minibatch_store,
+      unordered_set<int>& entries) const;
+
+  virtual vector<Real> getEntries(const vector<int>& entries) const;
+
+  virtual void setEntries(
+      const vector<int>& entries, const vector<Real>& values);
+
   virtual void updateFeature(const pair<int, int>& index, Real value);
 
+  boost::shared_ptr<GlobalCollisionSpace> getSpace() const;
+
   virtual ~CollisionGlobalFeatureStore();
 
  private:
   void deepCopy(const CollisionGlobalFeatureStore& other);
 
+  int getPosition(int key, int feature_index) const;
+
+  void prefetchBucket(int key) const;
+
+  void addBucket(int key, VectorReal& result) const;
+
   friend class boost::serialization::access;
 
   template<class Archive>
@@ -44,14 +44,32 @@ void CollisionMinibatchFeatureStore::update(
   }
 }
 
+void CollisionMinibatchFeatureStore::updateValue(
+    int feature_index, const vector<int>& context, Real value) {
+  for (const auto& feature_context: generator.getFeatureContexts(context)) {
+    int key = hasher->getKey(feature_context);
+    if (filter->hasIndex(feature_context, feature_index)) {
+      featureWeights[(key + feature_index) % hashSpace] += value;
+    }
+  }
+}
+
 size_t CollisionMinibatchFeatureStore::size() const {
   return featureWeights.size();
 }
 
+size_t CollisionMinibatchFeatureStore::memoryUsage() const {
+  return featureWeights.memoryUsage();
+}
+
 void CollisionMinibatchFeatureStore::clear() {
   featureWeights.clear();
 }
 
+void CollisionMinibatchFeatureStore::reserve(size_t size) {
+  featureWeights.reserve(size);
+}
+
 Real CollisionMinibatchFeatureStore::getFeature(const pair<int, int>& index) const {
   auto it = featureWeights.find(index.first);
   return it == featureWeights.end() ? 0 : it->second;
@@ -5,6 +5,7 @@
 #include "lbl/feature_context_generator.h"
 #include "lbl/feature_context_hasher.h"
 #include "lbl/feature_filter.h"
+#include "lbl/flat_hash_map.h"
 #include "lbl/minibatch_feature_store.h"
 
 namespace oxlm {
@@ -22,10 +23,17 @@ class CollisionMinibatchFeatureStore : public MinibatchFeatureStore {
 
   virtual void update(const boost::shared_ptr<MinibatchFeatureStore>& store);
 
+  virtual void updateValue(
+      int feature_index, const vector<int>& context, Real value);
+
   virtual size_t size() const;
 
+  virtual size_t memoryUsage() const;
+
   virtual void clear();
 
+  virtual void reserve(size_t size);
+
   virtual Real getFeature(const pair<int, int>& index) const;
 
   static boost::shared_ptr<CollisionMinibatchFeatureStore> cast(
@@ -40,7 +48,7 @@ class CollisionMinibatchFeatureStore : public MinibatchFeatureStore {
   FeatureContextGenerator generator;
   boost::shared_ptr<FeatureContextHasher> hasher;
   boost::shared_ptr<FeatureFilter> filter;
-  unordered_map<int, Real> featureWeights;
+  FlatHashMap<int, Real> featureWeights;
 };
 
 } // namespace oxlm
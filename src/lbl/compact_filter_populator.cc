@@ -0,0 +1,130 @@
+#include "lbl/compact_filter_populator.h"
+
+#include <algorithm>
+
+#include <boost/make_shared.hpp>
+
+#include "utils/conditional_omp.h"
+
+namespace oxlm {
+
+CompactFilterPopulator::CompactFilterPopulator() {}
+
+CompactFilterPopulator::CompactFilterPopulator(
+    const boost::shared_ptr<Corpus>& corpus,
+    const boost::shared_ptr<WordToClassIndex>& index,
+    const boost::shared_ptr<ContextProcessor>& processor,
+    const boost::shared_ptr<FeatureContextGenerator>& generator,
+    const boost::shared_ptr<NGramFilter>& filter) {
+  int num_classes = index->getNumClasses();
+  int num_threads = omp_get_max_threads();
+  vector<vector<pair<size_t, int>>> class_matches(num_threads);
+  vector<vector<vector<pair<size_t, int>>>> word_matches(
+      num_threads, vector<vector<pair<size_t, int>>>(num_classes));
+  #pragma omp parallel
+  {
+    int thread_id = omp_get_thread_num();
+    pair<size_t, size_t> range =
+        GetSlice(corpus->size(), thread_id, omp_get_num_threads());
+
+    hash<FeatureContext> hash_function;
+    size_t num_class_matches = 0;
+    vector<size_t> num_word_matches(num_classes);
+    for (size_t i = range.first; i < range.second; ++i) {
+      int word_id = corpus->at(i);
+      int class_id = index->getClass(word_id);
+      int word_class_id = index->getWordIndexInClass(word_id);
+      vector<int> context = processor->extract(i);
+
+      vector<FeatureContext> feature_contexts =
+          generator->getFeatureContexts(context);
+      feature_contexts = filter->filter(word_id, class_id, feature_contexts);
+      for (const FeatureContext& feature_context: feature_contexts) {
+        size_t key = hash_function(feature_context);
+        addMatch(class_matches[thread_id], num_class_matches, key, class_id);
+        addMatch(
+            word_matches[thread_id][class_id], num_word_matches[class_id],
+            key, word_class_id);
+      }
+    }
+  }
+
+  for (int i = 1; i < num_threads; ++i) {
+    class_matches[0].insert(
+        class_matches[0].end(),
+        class_matches[i].begin(), class_matches[i].end());
+    for (int j = 0; j < num_classes; ++j) {
+      word_matches[0][j].insert(
+          word_matches[0][j].end(),
+          word_matches[i][j].begin(), word_matches[i][j].end());
+    }
+  }
+
+  setFilters(move(class_matches[0]), move(word_matches[0]));
+}
+
+CompactFilterPopulator::CompactFilterPopulator(
+    vector<pair<size_t, int>> class_matches,
+    vector<vector<pair<size_t, int>>> word_matches) {
+  setFilters(move(class_matches), move(word_matches));
+}
+
+boost::shared_ptr<FeatureCompactFilter> CompactFilterPopulator::getClassFilter() const {
+  return classFilter;
+}
+
+boost::shared_ptr<FeatureCompactFilter> CompactFilterPopulator::getWordFilter(
+    int class_id) const {
+  return wordFilters[class_id];
+}
+
+size_t CompactFilterPopulator::memoryUsage() const {
+  size_t bytes = classFilter->memoryUsage();
+  for (const auto& filter: wordFilters) {
+    bytes += filter->memoryUsage();
+  }
+
+  return bytes;
+}
+
+void CompactFilterPopulator::setFilters(
+    vector<pair<size_t, int>> class_matches,
+    vector<vector<pair<size_t, int>>> word_matches) {
+  classFilter = boost::make_shared<FeatureCompactFilter>(move(class_matches));
+  for (auto& matches: word_matches) {
+    wordFilters.push_back(
+        boost::make_shared<FeatureCompactFilter>(move(matches)));
+  }
+}
+
+void CompactFilterPopulator::addMatch(
+    vector<pair<size_t, int>>& matches, size_t& num_distinct,
+    size_t key, int candidate) {
+  matches.push_back(make_pair(key, candidate));
+  // Frequent n-grams are repeated many times in the corpus. Drop duplicates
+  // every time the number of matches doubles to keep the memory footprint
+  // close to the number of distinct matches.
+  if (matches.size() >= 2 * num_distinct + 1000000) {
+    sort(matches.begin(), matches.end());
+    matches.erase(unique(matches.begin(), matches.end()), matches.end());
+    num_distinct = matches.size();
+  }
+}
+
+bool CompactFilterPopulator::operator==(
+    const CompactFilterPopulator& other) const {
+  if (!(*classFilter == *other.classFilter)
+      || wordFilters.size() != other.wordFilters.size()) {
+    return false;
+  }
+
+  for (size_t i = 0; i < wordFilters.size(); ++i) {
+    if (!(*wordFilters[i] == *other.wordFilters[i])) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+} // namespace oxlm
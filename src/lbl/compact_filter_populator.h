@@ -0,0 +1,74 @@
+#pragma once
+
+#include <vector>
+
+#include <boost/serialization/shared_ptr.hpp>
+#include <boost/serialization/vector.hpp>
+
+#include "lbl/context_processor.h"
+#include "lbl/feature_compact_filter.h"
+#include "lbl/feature_context_generator.h"
+#include "lbl/ngram_filter.h"
+#include "lbl/utils.h"
+#include "lbl/word_to_class_index.h"
+
+namespace oxlm {
+
+/**
+ * Builds the compact filters for the class feature store and for the word
+ * feature stores of every class in a single pass over the training corpus.
+ * The filters match the same n-grams as the exact filters.
+ */
+class CompactFilterPopulator {
+ public:
+  CompactFilterPopulator();
+
+  CompactFilterPopulator(
+      const boost::shared_ptr<Corpus>& corpus,
+      const boost::shared_ptr<WordToClassIndex>& index,
+      const boost::shared_ptr<ContextProcessor>& processor,
+      const boost::shared_ptr<FeatureContextGenerator>& generator,
+      const boost::shared_ptr<NGramFilter>& filter);
+
+  /**
+   * Builds the filters from lists of (feature context hash, candidate) pairs.
+   * The lists may contain duplicates.
+   */
+  CompactFilterPopulator(
+      vector<pair<size_t, int>> class_matches,
+      vector<vector<pair<size_t, int>>> word_matches);
+
+  boost::shared_ptr<FeatureCompactFilter> getClassFilter() const;
+
+  boost::shared_ptr<FeatureCompactFilter> getWordFilter(int class_id) const;
+
+  size_t memoryUsage() const;
+
+  bool operator==(const CompactFilterPopulator& other) const;
+
+  /**
+   * Appends a (feature context hash, candidate) pair to matches, dropping
+   * duplicates every time the list doubles in size.
+   */
+  static void addMatch(
+      vector<pair<size_t, int>>& matches, size_t& num_distinct,
+      size_t key, int candidate);
+
+ private:
+  void setFilters(
+      vector<pair<size_t, int>> class_matches,
+      vector<vector<pair<size_t, int>>> word_matches);
+
+  friend class boost::serialization::access;
+
+  template<class Archive>
+  void serialize(Archive& ar, const unsigned int version) {
+    ar & classFilter;
+    ar & wordFilters;
+  }
+
+  boost::shared_ptr<FeatureCompactFilter> classFilter;
+  vector<boost::shared_ptr<FeatureCompactFilter>> wordFilters;
+};
+
+} // namespace oxlm
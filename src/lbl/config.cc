@@ -5,18 +5,21 @@
 namespace oxlm {
 
 ModelData::ModelData()
-    : iterations(0), evaluate_frequency(1), minibatch_size(0),
+    : iterations(0), evaluate_frequency(1), stats_frequency(0),
+      checkpoint_frequency(0), delta_checkpoints(0), minibatch_size(0),
       minibatch_threshold(0), instances(0), ngram_order(0),
       feature_context_size(0), l2_lbl(0), l2_maxent(0),
-      word_representation_size(0), threads(1), step_size(0), classes(0),
+      word_representation_size(0), threads(1),
+      prefetch_minibatches(1), step_size(0), classes(0),
       randomise(false), reclass(false), diagonal_contexts(false),
       uniform(false), pseudo_likelihood_cne(false), mixture(false),
       lbfgs(false), lbfgs_vectors(0), test_tokens(0), gnorm_threshold(0),
       eta(0), multinomial_step_size(0), random_weights(false), hash_space(0),
       count_collisions(false), filter_contexts(false), filter_error_rate(0),
-      max_ngrams(0), min_ngram_freq(0), vocab_size(0), noise_samples(0),
+      compact_filter(false), blocked_bloom_filter(false), max_ngrams(0),
+      min_ngram_freq(0), ngram_sketch_memory(0), vocab_size(0), noise_samples(0),
       activation(IDENTITY), source_order(0), source_vocab_size(0),
-      hidden_layers(0) {}
+      hidden_layers(0), row_wise_adagrad(false) {}
 
 bool ModelData::operator==(const ModelData& other) const {
   if (fabs(l2_lbl - other.l2_lbl) > EPS ||
@@ -36,6 +39,8 @@ bool ModelData::operator==(const ModelData& other) const {
       && hash_space == other.hash_space
       && filter_contexts == other.filter_contexts
       && fabs(filter_error_rate - other.filter_error_rate) < EPS
+      && compact_filter == other.compact_filter
+      && blocked_bloom_filter == other.blocked_bloom_filter
       && activation == other.activation
       && source_order == other.source_order
       && hidden_layers == other.hidden_layers;
@@ -60,10 +65,21 @@ ostream& operator<<(ostream& out, const ModelData& config) {
   out << "# iterations = " << config.iterations << endl;
   out << "# minibatch size = " << config.minibatch_size << endl;
   out << "# evaluate frequency = " << config.evaluate_frequency << endl;
+  out << "# stats frequency = " << config.stats_frequency << endl;
+  if (config.stats_file.size()) {
+    out << "# stats file = " << config.stats_file << endl;
+  }
+  if (config.checkpoint_file.size()) {
+    out << "# checkpoint file = " << config.checkpoint_file << endl;
+    out << "# checkpoint frequency = " << config.checkpoint_frequency << endl;
+    out << "# delta checkpoints = " << config.delta_checkpoints << endl;
+  }
   out << "# minibatch threshold = " << config.minibatch_threshold << endl;
   out << "# lambda = " << config.l2_lbl << endl;
   out << "# step size = " << config.step_size << endl;
+  out << "# row-wise adagrad = " << config.row_wise_adagrad << endl;
   out << "# threads = " << config.threads << endl;
+  out << "# prefetch minibatches = " << config.prefetch_minibatches << endl;
   out << "# randomise = " << config.randomise << endl;
   out << "# diagonal contexts = " << config.diagonal_contexts << endl;
   out << "# activation = " << config.activation << endl;
@@ -74,9 +90,12 @@ ostream& operator<<(ostream& out, const ModelData& config) {
     out << "# lambda maxent = " << config.l2_maxent << endl;
     out << "# max n-grams = " << config.max_ngrams << endl;
     out << "# min n-gram frequency = " << config.min_ngram_freq << endl;
+    out << "# n-gram sketch memory = " << config.ngram_sketch_memory << endl;
     out << "# hash space = " << config.hash_space << endl;
     out << "# filter contexts = " << config.filter_contexts << endl;
     out << "# filter error rate = " << config.filter_error_rate << endl;
+    out << "# compact filter = " << config.compact_filter << endl;
+    out << "# blocked bloom filter = " << config.blocked_bloom_filter << endl;
   }
 
   if (config.source_vocab_size > 0 || config.source_order > 0) {
@@ -88,6 +107,7 @@ ostream& operator<<(ostream& out, const ModelData& config) {
   }
 
   out << "################################" << endl;
+  return out;
 }
 
 } // namespace oxlm
@@ -7,6 +7,7 @@
 #include <boost/lexical_cast.hpp>
 #include <boost/shared_ptr.hpp>
 #include <boost/serialization/serialization.hpp>
+#include <boost/serialization/version.hpp>
 
 using namespace std;
 
@@ -27,6 +28,11 @@ struct ModelData {
   string      test_alignment_file;
   int         iterations;
   int         evaluate_frequency;
+  int         stats_frequency;
+  string      stats_file;
+  string      checkpoint_file;
+  int         checkpoint_frequency;
+  int         delta_checkpoints;
   int         minibatch_size;
   int         minibatch_threshold;
   int         instances;
@@ -38,6 +44,7 @@ struct ModelData {
   float       l2_maxent;
   int         word_representation_size;
   int         threads;
+  int         prefetch_minibatches;
   float       step_size;
   int         classes;
   string      class_file;
@@ -59,14 +66,18 @@ struct ModelData {
   bool        count_collisions;
   bool        filter_contexts;
   float       filter_error_rate;
+  bool        compact_filter;
+  bool        blocked_bloom_filter;
   int         max_ngrams;
   int         min_ngram_freq;
+  int         ngram_sketch_memory;
   int         vocab_size;
   int         noise_samples;
   Activation  activation;
   int         source_vocab_size;
   int         source_order;
   int         hidden_layers;
+  bool        row_wise_adagrad;
 
   bool operator==(const ModelData& other) const;
 
@@ -96,6 +107,14 @@ struct ModelData {
     ar & hash_space;
     ar & filter_contexts;
     ar & filter_error_rate;
+    // Version 0 configurations predate the compact filters and version 1
+    // configurations predate the blocked Bloom filters.
+    if (version > 0) {
+      ar & compact_filter;
+    }
+    if (version > 1) {
+      ar & blocked_bloom_filter;
+    }
     ar & vocab_size;
     ar & noise_samples;
     ar & activation;
@@ -108,3 +127,5 @@ struct ModelData {
 ostream& operator<<(ostream& out, const ModelData& config);
 
 } // namespace oxlm
+
+BOOST_CLASS_VERSION(oxlm::ModelData, 2)
@@ -1,5 +1,7 @@
 #include "lbl/context_cache.h"
 
+#include "lbl/memory_report.h"
+
 namespace oxlm {
 
 pair<Real, bool> ContextCache::get(const vector<int>& context) {
@@ -28,4 +30,19 @@ void ContextCache::clear() {
   cache->clear();
 }
 
+size_t ContextCache::memoryUsage() const {
+  if (!cache.get()) {
+    return 0;
+  }
+
+  // Every node stores the context, the normalizer and the hash table links.
+  size_t bytes = cache->bucket_count() * sizeof(void*);
+  for (const auto& entry: *cache) {
+    bytes += sizeof(entry) + 2 * sizeof(void*)
+        + MemoryReport::getContainerBytes(entry.first);
+  }
+
+  return bytes;
+}
+
 } // namespace oxlm
@@ -27,6 +27,11 @@ class ContextCache {
 
   void clear();
 
+  /**
+   * Returns the size of the cache of the calling thread.
+   */
+  size_t memoryUsage() const;
+
  private:
   boost::thread_specific_ptr<ContextMap> cache;
 };
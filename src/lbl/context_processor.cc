@@ -6,22 +6,42 @@ ContextProcessor::ContextProcessor(
     const boost::shared_ptr<Corpus>& corpus, int context_size,
     int start_id, int end_id)
     : corpus(corpus), contextSize(context_size),
-      startId(start_id), endId(end_id) {}
+      startId(start_id), endId(end_id) {
+  assert(end_id == corpus->getEndId());
+  assert(context_size <= Corpus::MAX_SENTENCE_POSITION);
+}
 
-vector<WordId> ContextProcessor::extract(long long position) const {
-  vector<WordId> context;
+int ContextProcessor::getContextWidth() const {
+  return contextSize;
+}
 
+void ContextProcessor::extract(long long position, WordId* context) const {
   // The context is constructed starting from the most recent word:
   // context = [w_{n-1}, w_{n-2}, ...]
-  bool sentence_start = position == 0;
-  for (int i = 1; i <= contextSize; ++i) {
-    long long index = position - i;
-    sentence_start |= index < 0 || corpus->at(index) == endId;
-    int word_id = sentence_start ? startId : corpus->at(index);
-    context.push_back(word_id);
+  // The words before the start of the sentence are replaced by the start
+  // symbol.
+  int num_words = min(corpus->getSentencePosition(position), contextSize);
+  for (int i = 0; i < num_words; ++i) {
+    context[i] = corpus->at(position - i - 1);
   }
+  fill(context + num_words, context + contextSize, startId);
+}
 
+vector<WordId> ContextProcessor::extract(long long position) const {
+  vector<WordId> context(getContextWidth());
+  extract(position, context.data());
   return context;
 }
 
+void ContextProcessor::extractMany(
+    const vector<int>& positions, vector<WordId>& contexts) const {
+  int context_width = getContextWidth();
+  contexts.resize(positions.size() * context_width);
+  for (size_t i = 0; i < positions.size(); ++i) {
+    extract(positions[i], &contexts[i * context_width]);
+  }
+}
+
+ContextProcessor::~ContextProcessor() {}
+
 } // namespace oxlm
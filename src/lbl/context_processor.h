@@ -9,13 +9,41 @@ using namespace std;
 
 namespace oxlm {
 
+/**
+ * Extracts the n-gram contexts of the words in a corpus. The sentence
+ * boundaries are precomputed by the corpus, so extracting a context is a
+ * single pass over the context words.
+ */
 class ContextProcessor {
  public:
+  /**
+   * end_id must match the end of sentence id of the corpus.
+   */
   ContextProcessor(
       const boost::shared_ptr<Corpus>& corpus, int context_size,
       int start_id = 0, int end_id = 1);
 
-  virtual vector<WordId> extract(long long position) const;
+  /**
+   * Returns the number of words in a context.
+   */
+  virtual int getContextWidth() const;
+
+  /**
+   * Writes the context of the word at position to context, which must have
+   * room for getContextWidth() words.
+   */
+  virtual void extract(long long position, WordId* context) const;
+
+  vector<WordId> extract(long long position) const;
+
+  /**
+   * Writes the contexts of the words at positions to contexts, one after the
+   * other (getContextWidth() words each).
+   */
+  void extractMany(
+      const vector<int>& positions, vector<WordId>& contexts) const;
+
+  virtual ~ContextProcessor();
 
  protected:
   boost::shared_ptr<Corpus> corpus;
@@ -4,7 +4,9 @@
 
 namespace oxlm {
 
-Corpus::Corpus() {}
+const int Corpus::MAX_SENTENCE_POSITION;
+
+Corpus::Corpus() : endId(1) {}
 
 /*
  * Reads a monolingual corpus.
@@ -16,7 +18,7 @@ Corpus::Corpus(
   // If the vocabulary has been set (i.e. contains more than <s> and </s> and
   // therefore has size > 2), make it immutable.
   bool immutable_vocab = vocab->size() > 2;
-  int end_id = convert("</s>", vocab, immutable_vocab, convert_unknowns);
+  endId = convert("</s>", vocab, immutable_vocab, convert_unknowns);
 
   ifstream in(filename);
   string line;
@@ -35,15 +37,20 @@ Corpus::Corpus(
     while (line_stream >> token) {
       data.push_back(convert(token, vocab, immutable_vocab, convert_unknowns));
     }
-    data.push_back(end_id);
+    data.push_back(endId);
   }
 
   if ((line_id / 100000) % 100 != 0) {
     cerr << endl;
   }
+
+  indexSentences();
 }
 
-Corpus::Corpus(const vector<int>& data) : data(data) {}
+Corpus::Corpus(const vector<int>& data, int end_id)
+    : data(data), endId(end_id) {
+  indexSentences();
+}
 
 int Corpus::at(int index) const {
   return data[index];
@@ -53,6 +60,28 @@ size_t Corpus::size() const {
   return data.size();
 }
 
+int Corpus::getEndId() const {
+  return endId;
+}
+
+int Corpus::getSentencePosition(long long index) const {
+  return sentencePositions[index];
+}
+
+size_t Corpus::memoryUsage() const {
+  return data.size() * sizeof(int) + sentencePositions.size();
+}
+
+void Corpus::indexSentences() {
+  sentencePositions.resize(data.size());
+  int position = 0;
+  for (size_t i = 0; i < data.size(); ++i) {
+    sentencePositions[i] = position;
+    position =
+        data[i] == endId ? 0 : min(position + 1, MAX_SENTENCE_POSITION);
+  }
+}
+
 Corpus::~Corpus() {}
 
 } // namespace oxlm
@@ -1,5 +1,8 @@
 #pragma once
 
+#include <boost/serialization/split_member.hpp>
+#include <boost/serialization/version.hpp>
+
 #include "lbl/archive_export.h"
 #include "lbl/vocabulary.h"
 
@@ -14,26 +17,56 @@ class Corpus {
       const boost::shared_ptr<Vocabulary>& vocab,
       bool convert_unknowns);
 
-	Corpus(const vector<int>& data);
+	Corpus(const vector<int>& data, int end_id = 1);
 
 	int at(int index) const;
 
   size_t size() const;
 
+  int getEndId() const;
+
+  /**
+   * Returns the number of words preceding index in its sentence, capped at
+   * MAX_SENTENCE_POSITION. The positions are precomputed, so that contexts are
+   * extracted without scanning for the start of the sentence.
+   */
+  int getSentencePosition(long long index) const;
+
+  virtual size_t memoryUsage() const;
+
   virtual ~Corpus();
 
+  static const int MAX_SENTENCE_POSITION = 255;
+
  private:
 	friend class boost::serialization::access;
 
-	template<class Archive>
-	void serialize(Archive& ar, const unsigned int version) {
-		ar & data;
-	}
+  template<class Archive>
+  void save(Archive& ar, const unsigned int version) const {
+    ar << data;
+    ar << endId;
+  }
+
+  template<class Archive>
+  void load(Archive& ar, const unsigned int version) {
+    ar >> data;
+    if (version > 0) {
+      ar >> endId;
+    }
+    indexSentences();
+  }
+
+  BOOST_SERIALIZATION_SPLIT_MEMBER();
 
  protected:
+  void indexSentences();
+
 	vector<int> data;
+  int endId;
+  vector<unsigned char> sentencePositions;
 };
 
 } // namespace oxlm
 
 BOOST_CLASS_EXPORT_KEY(oxlm::Corpus)
+BOOST_CLASS_VERSION(oxlm::Corpus, 1)
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "lbl/utils.h"
+
+using namespace std;
+
+namespace oxlm {
+
+/**
+ * Count-min sketch over 64-bit keys (e.g. n-gram hashes).
+ *
+ * The counters are arranged in depth rows of width counters. A key increments
+ * one counter in every row and its frequency is estimated by the smallest of
+ * these counters, so the estimate never underestimates the true frequency and
+ * overestimates it by at most e * total / width with probability
+ * 1 - exp(-depth).
+ *
+ * increment() may be called concurrently from several threads.
+ *
+ * Reference: Cormode and Muthukrishnan, An improved data stream summary: the
+ * count-min sketch and its applications, 2005.
+ */
+class CountMinSketch {
+ public:
+  CountMinSketch(size_t memory, int depth)
+      : depth(depth) {
+    assert(depth > 0);
+    width = max<size_t>(1, memory / (depth * sizeof(uint32_t)));
+    counters.resize(width * depth, 0);
+    cout << "Creating count-min sketch with " << depth << " x " << width
+         << " counters..." << endl;
+  }
+
+  void increment(size_t key) {
+    for (int i = 0; i < depth; ++i) {
+      uint32_t& counter = counters[getPosition(key, i)];
+      #pragma omp atomic
+      ++counter;
+    }
+  }
+
+  int estimate(size_t key) const {
+    uint32_t result = counters[getPosition(key, 0)];
+    for (int i = 1; i < depth; ++i) {
+      result = min(result, counters[getPosition(key, i)]);
+    }
+    return min<uint32_t>(result, numeric_limits<int>::max());
+  }
+
+  /**
+   * Returns the number of increments. Every increment adds 1 to exactly one
+   * counter of each row, so this is the sum of the first row (there is no
+   * shared total for the threads to contend on).
+   */
+  size_t size() const {
+    size_t total = 0;
+    for (size_t i = 0; i < width; ++i) {
+      total += counters[i];
+    }
+    return total;
+  }
+
+  size_t memoryUsage() const {
+    return counters.capacity() * sizeof(uint32_t);
+  }
+
+ private:
+  /**
+   * The rows are indexed via double hashing: h1 + i * h2, where h1 and h2 are
+   * the two halves of the (already well mixed) key.
+   */
+  size_t getPosition(size_t key, int row) const {
+    uint64_t h1 = key, h2 = (key >> 32 | key << 32) | 1;
+    uint64_t h = h1 + row * h2;
+    // Maps h uniformly to [0, width) without a division.
+    return row * width
+        + static_cast<size_t>((static_cast<__uint128_t>(h) * width) >> 64);
+  }
+
+  int depth;
+  size_t width;
+  vector<uint32_t> counters;
+};
+
+} // namespace oxlm
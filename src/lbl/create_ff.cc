@@ -11,7 +11,8 @@ namespace po = boost::program_options;
 
 void ParseOptions(
     const string& input, string& filename, string& feature_name,
-    oxlm::ModelType& model_type, bool& normalized, bool& persistent_cache) {
+    oxlm::ModelType& model_type, bool& normalized, bool& persistent_cache,
+    bool& memory_report) {
   po::options_description options("LBL language model options");
   options.add_options()
       ("file,f", po::value<string>()->required(),
@@ -23,7 +24,10 @@ void ParseOptions(
       ("normalized", po::value<bool>()->required()->default_value(true),
           "Normalize the output of the neural network")
       ("persistent-cache",
-          "Cache queries persistently between consecutive decoder runs");
+          "Cache queries persistently between consecutive decoder runs")
+      ("memory-report",
+          "Print the memory used by the model and the caches after loading "
+          "the model and before every sentence");
 
   po::variables_map vm;
   vector<string> args;
@@ -36,28 +40,34 @@ void ParseOptions(
   model_type = static_cast<oxlm::ModelType>(vm["type"].as<int>());
   normalized = vm["normalized"].as<bool>();
   persistent_cache = vm.count("persistent-cache");
+  memory_report = vm.count("memory-report");
 }
 
 extern "C" FeatureFunction* create_ff(const string& str) {
   string filename, feature_name;
   oxlm::ModelType model_type;
-  bool normalized, persistent_cache;
+  bool normalized, persistent_cache, memory_report;
   ParseOptions(
-      str, filename, feature_name, model_type, normalized, persistent_cache);
+      str, filename, feature_name, model_type, normalized, persistent_cache,
+      memory_report);
 
   switch (model_type) {
     case NLM:
       return new FF_LBLLM<LM>(
-          filename, feature_name, normalized, persistent_cache);
+          filename, feature_name, normalized, persistent_cache,
+          memory_report);
     case FACTORED_NLM:
       return new FF_LBLLM<FactoredLM>(
-          filename, feature_name, normalized, persistent_cache);
+          filename, feature_name, normalized, persistent_cache,
+          memory_report);
     case FACTORED_MAXENT_NLM:
       return new FF_LBLLM<FactoredMaxentLM>(
-          filename, feature_name, normalized, persistent_cache);
+          filename, feature_name, normalized, persistent_cache,
+          memory_report);
     case SOURCE_FACTORED_NLM:
       return new FF_SourceLBLLM(
-          filename, feature_name, normalized, persistent_cache);
+          filename, feature_name, normalized, persistent_cache,
+          memory_report);
     default:
       throw UnknownModelException();
   }
@@ -18,4 +18,23 @@ class UnknownActivationException : public exception {
   }
 };
 
+class IncompatibleCheckpointException : public exception {
+  virtual const char* what() const throw() {
+    return "The checkpoint was created with a different model configuration";
+  }
+};
+
+class UndefinedFeatureException : public exception {
+  virtual const char* what() const throw() {
+    return "The gradient updates a feature which is not defined in the sparse "
+           "feature store";
+  }
+};
+
+class FeatureStoreOverflowException : public exception {
+  virtual const char* what() const throw() {
+    return "The sparse feature store cannot hold more than 2^31 - 1 features";
+  }
+};
+
 } // namespace oxlm
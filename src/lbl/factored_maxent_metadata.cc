@@ -3,6 +3,7 @@
 #include <boost/make_shared.hpp>
 
 #include "lbl/collision_counter.h"
+#include "lbl/feature_index_builder.h"
 
 namespace oxlm {
 
@@ -19,9 +20,11 @@ FactoredMaxentMetadata::FactoredMaxentMetadata(
     const boost::shared_ptr<WordToClassIndex>& index,
     const boost::shared_ptr<FeatureContextMapper>& mapper,
     const boost::shared_ptr<BloomFilterPopulator>& populator,
-    const boost::shared_ptr<FeatureMatcher>& matcher)
+    const boost::shared_ptr<FeatureMatcher>& matcher,
+    const boost::shared_ptr<CompactFilterPopulator>& compact_populator)
     : FactoredMetadata(config, vocab, index),
-      mapper(mapper), populator(populator), matcher(matcher) {}
+      mapper(mapper), populator(populator), matcher(matcher),
+      compactPopulator(compact_populator) {}
 
 void FactoredMaxentMetadata::initialize(
     const boost::shared_ptr<Corpus>& corpus) {
@@ -37,26 +40,43 @@ void FactoredMaxentMetadata::initialize(
     boost::shared_ptr<NGramFilter> filter =
         boost::make_shared<NGramFilter>(
             corpus, index, processor, generator, config->max_ngrams,
-            config->min_ngram_freq);
+            config->min_ngram_freq,
+            static_cast<size_t>(config->ngram_sketch_memory) << 20);
     cout << "Done creating the n-gram filter..." << endl;
 
-    mapper = boost::make_shared<FeatureContextMapper>(
-        corpus, index, processor, generator, filter);
-    cout << "Done creating the feature context mapper..." << endl;
-    if (config->filter_contexts && config->filter_error_rate) {
+    if (config->filter_contexts && config->filter_error_rate
+        && !config->compact_filter) {
+      mapper = boost::make_shared<FeatureContextMapper>(
+          corpus, index, processor, generator, filter);
+      cout << "Done creating the feature context mapper..." << endl;
+      // The Bloom filter is sized based on the number of feature contexts, so
+      // it needs a separate pass over the corpus.
       populator = boost::make_shared<BloomFilterPopulator>(
           corpus, index, mapper, config);
       cout << "Done creating the Bloom filter populator..." << endl;
     } else {
-      matcher = boost::make_shared<FeatureMatcher>(
-          corpus, index, processor, generator, filter, mapper);
-      cout << "Done creating the feature matcher..." << endl;
+      // The mapper and the compact filters or the feature matcher are built
+      // in a single pass over the corpus.
+      bool compact_filter = config->filter_contexts && config->compact_filter;
+      FeatureIndexBuilder builder(
+          corpus, index, processor, generator, filter,
+          !compact_filter, compact_filter);
+      mapper = builder.getMapper();
+      cout << "Done creating the feature context mapper..." << endl;
+      if (compact_filter) {
+        compactPopulator = builder.getCompactPopulator();
+        cout << "Done creating the compact filters..." << endl;
+      } else {
+        matcher = boost::make_shared<FeatureMatcher>(
+            corpus, index, generator, mapper, builder.getFeatureIndexes());
+        cout << "Done creating the feature matcher..." << endl;
+      }
     }
   }
 
   if (config->hash_space > 0 && config->count_collisions) {
       CollisionCounter counter(
-          corpus, index, mapper, matcher, populator, config);
+          corpus, index, mapper, matcher, populator, compactPopulator, config);
       counter.count();
   }
 }
@@ -73,4 +93,24 @@ boost::shared_ptr<FeatureMatcher> FactoredMaxentMetadata::getMatcher() const {
   return matcher;
 }
 
+boost::shared_ptr<CompactFilterPopulator> FactoredMaxentMetadata::getCompactPopulator() const {
+  return compactPopulator;
+}
+
+void FactoredMaxentMetadata::reportMemory(MemoryReport& report) const {
+  FactoredMetadata::reportMemory(report);
+  if (mapper != nullptr) {
+    report.add("feature context mapper", mapper->memoryUsage());
+  }
+  if (populator != nullptr) {
+    report.add("Bloom filter", populator->memoryUsage());
+  }
+  if (compactPopulator != nullptr) {
+    report.add("compact filters", compactPopulator->memoryUsage());
+  }
+  if (matcher != nullptr) {
+    report.add("feature matcher", matcher->memoryUsage());
+  }
+}
+
 } // namespace oxlm
@@ -1,6 +1,9 @@
 #pragma once
 
+#include <boost/serialization/version.hpp>
+
 #include "lbl/bloom_filter_populator.h"
+#include "lbl/compact_filter_populator.h"
 #include "lbl/factored_metadata.h"
 #include "lbl/feature_context_generator.h"
 #include "lbl/feature_context_mapper.h"
@@ -23,7 +26,8 @@ class FactoredMaxentMetadata : public FactoredMetadata {
       const boost::shared_ptr<WordToClassIndex>& index,
       const boost::shared_ptr<FeatureContextMapper>& mapper,
       const boost::shared_ptr<BloomFilterPopulator>& populator,
-      const boost::shared_ptr<FeatureMatcher>& matcher);
+      const boost::shared_ptr<FeatureMatcher>& matcher,
+      const boost::shared_ptr<CompactFilterPopulator>& compact_populator);
 
   void initialize(const boost::shared_ptr<Corpus>& corpus);
 
@@ -33,6 +37,13 @@ class FactoredMaxentMetadata : public FactoredMetadata {
 
   boost::shared_ptr<FeatureMatcher> getMatcher() const;
 
+  boost::shared_ptr<CompactFilterPopulator> getCompactPopulator() const;
+
+  /**
+   * Only the components used by the model's configuration are reported.
+   */
+  void reportMemory(MemoryReport& report) const;
+
  private:
   friend class boost::serialization::access;
 
@@ -43,12 +54,19 @@ class FactoredMaxentMetadata : public FactoredMetadata {
     ar & mapper;
     ar & populator;
     ar & matcher;
+    // Version 0 models predate the compact filters.
+    if (version > 0) {
+      ar & compactPopulator;
+    }
   }
 
  protected:
   boost::shared_ptr<FeatureContextMapper> mapper;
   boost::shared_ptr<BloomFilterPopulator> populator;
   boost::shared_ptr<FeatureMatcher> matcher;
+  boost::shared_ptr<CompactFilterPopulator> compactPopulator;
 };
 
 } // namespace oxlm
+
+BOOST_CLASS_VERSION(oxlm::FactoredMaxentMetadata, 1)
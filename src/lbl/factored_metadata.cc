@@ -45,6 +45,12 @@ VectorReal FactoredMetadata::getClassBias() const {
   return classBias;
 }
 
+void FactoredMetadata::reportMemory(MemoryReport& report) const {
+  Metadata::reportMemory(report);
+  report.add("class bias", classBias.size() * sizeof(Real));
+  report.add("word to class index", index->memoryUsage());
+}
+
 bool FactoredMetadata::operator==(const FactoredMetadata& other) const {
   return Metadata::operator==(other)
       && classBias == other.classBias
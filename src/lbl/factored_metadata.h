@@ -32,6 +32,8 @@ class FactoredMetadata : public Metadata {
 
   VectorReal getClassBias() const;
 
+  void reportMemory(MemoryReport& report) const;
+
   bool operator==(const FactoredMetadata& other) const;
 
  private:
@@ -1,18 +1,26 @@
 #include "lbl/factored_tree_weights.h"
 
+#include <random>
+
 #include <boost/make_shared.hpp>
 
 #include "lbl/context_processor.h"
 #include "lbl/operators.h"
+#include "utils/conditional_omp.h"
 
 namespace oxlm {
 
+const size_t MIN_NODE_INSTANCES = 4;
+const size_t MIN_NODE_CHILDREN = 4;
+
 FactoredTreeWeights::FactoredTreeWeights() : Weights() {}
 
 FactoredTreeWeights::FactoredTreeWeights(
     const boost::shared_ptr<ModelData>& config,
-    const boost::shared_ptr<TreeMetadata>& metadata)
-    : Weights(config), metadata(metadata), tree(metadata->getTree()) {
+    const boost::shared_ptr<TreeMetadata>& metadata,
+    bool row_wise_adagrad)
+    : Weights(config, row_wise_adagrad), metadata(metadata),
+      tree(metadata->getTree()) {
   allocate();
   W.setZero();
 }
@@ -75,10 +83,11 @@ void FactoredTreeWeights::allocate() {
   int num_context_words = config->vocab_size;
   int num_output_words = tree->size();
   int word_width = config->word_representation_size;
+  int vector_width = getWordVectorWidth();
   int context_width = config->ngram_order - 1;
 
-  int Q_size = word_width * num_context_words;
-  int R_size = word_width * num_output_words;
+  int Q_size = vector_width * num_context_words;
+  int R_size = vector_width * num_output_words;
   int C_size = config->diagonal_contexts ? word_width : word_width * word_width;
   int H_size = word_width * word_width;
   int B_size = num_output_words;
@@ -108,18 +117,19 @@ void FactoredTreeWeights::setModelParameters() {
   int num_context_words = config->vocab_size;
   int num_output_words = tree->size();
   int word_width = config->word_representation_size;
+  int vector_width = getWordVectorWidth();
   int context_width = config->ngram_order - 1;
 
-  int Q_size = word_width * num_context_words;
-  int R_size = word_width * num_output_words;
+  int Q_size = vector_width * num_context_words;
+  int R_size = vector_width * num_output_words;
   int C_size = config->diagonal_contexts ? word_width : word_width * word_width;
   int H_size = word_width * word_width;
   int B_size = num_output_words;
 
   new (&W) WeightsType(data, size);
 
-  new (&Q) WordVectorsType(data, word_width, num_context_words);
-  new (&R) WordVectorsType(data + Q_size, word_width, num_output_words);
+  new (&Q) WordVectorsType(data, vector_width, num_context_words);
+  new (&R) WordVectorsType(data + Q_size, vector_width, num_output_words);
 
   Real* start = data + Q_size + R_size;
   for (int i = 0; i < context_width; ++i) {
@@ -141,40 +151,112 @@ void FactoredTreeWeights::setModelParameters() {
 
 const Eigen::Block<const WordVectorsType> FactoredTreeWeights::classR(
     int node) const {
-  vector<int> children = tree->getChildren(node);
+  const vector<int>& children = tree->getChildren(node);
   return R.block(0, children[0], R.rows(), children.size());
 }
 
 Eigen::Block<WordVectorsType> FactoredTreeWeights::classR(int node) {
-  vector<int> children = tree->getChildren(node);
+  const vector<int>& children = tree->getChildren(node);
   return R.block(0, children[0], R.rows(), children.size());
 }
 
 const Eigen::VectorBlock<const WeightsType> FactoredTreeWeights::classB(
     int node) const {
-  vector<int> children = tree->getChildren(node);
+  const vector<int>& children = tree->getChildren(node);
   return B.segment(children[0], children.size());
 }
 
 Eigen::VectorBlock<WeightsType> FactoredTreeWeights::classB(int node) {
-  vector<int> children = tree->getChildren(node);
+  const vector<int>& children = tree->getChildren(node);
   return B.segment(children[0], children.size());
 }
 
+/**
+ * Returns the (node, instance, depth) triples for all the internal nodes on
+ * the root to leaf paths of the target words, sorted by node. Nodes are
+ * labeled in breadth first order, so walking the sorted triples processes the
+ * tree level by level, visiting every node once per task.
+ */
+vector<FactoredTreeWeights::NodeInstance> FactoredTreeWeights::getNodeInstances(
+    const boost::shared_ptr<Corpus>& corpus,
+    const vector<int>& indices) const {
+  vector<NodeInstance> instances;
+  for (size_t i = 0; i < indices.size(); ++i) {
+    int node = tree->getNode(corpus->at(indices[i]));
+    for (int depth = 0; node != tree->getRoot(); ++depth) {
+      int parent = tree->getParent(node);
+      instances.push_back({parent, static_cast<int>(i), depth});
+      node = parent;
+    }
+  }
+
+  stable_sort(instances.begin(), instances.end(),
+      [](const NodeInstance& a, const NodeInstance& b) -> bool {
+        return a.node < b.node;
+      });
+
+  return instances;
+}
+
+/**
+ * Gathering the prediction vectors into a matrix product only pays off for
+ * nodes which are visited by several instances and have enough children. On
+ * binary nodes, the per instance matrix-vector products are faster.
+ */
+bool FactoredTreeWeights::isBatchedNode(int node, size_t num_instances) const {
+  return num_instances >= MIN_NODE_INSTANCES
+      && tree->getChildren(node).size() >= MIN_NODE_CHILDREN;
+}
+
 vector<vector<VectorReal>> FactoredTreeWeights::getProbabilities(
     const boost::shared_ptr<Corpus>& corpus,
     const vector<int>& indices,
     const vector<MatrixReal>& forward_weights) const {
+  const MatrixReal& prediction_vectors = forward_weights.back();
   vector<vector<VectorReal>> probs(indices.size());
-  for (size_t i = 0; i < indices.size(); ++i) {
-    int word_id = corpus->at(indices[i]);
-    int node = tree->getNode(word_id);
-    while (node != tree->getRoot()) {
-      int parent = tree->getParent(node);
-      VectorReal predictions = classR(parent).transpose() * forward_weights.back().col(i) + classB(parent);
-      probs[i].push_back(softMax(predictions));
-      node = parent;
+  vector<NodeInstance> instances = getNodeInstances(corpus, indices);
+  for (const auto& instance: instances) {
+    vector<VectorReal>& instance_probs = probs[instance.instance];
+    if (instance_probs.size() <= static_cast<size_t>(instance.depth)) {
+      instance_probs.resize(instance.depth + 1);
+    }
+  }
+
+  MatrixReal node_vectors, predictions;
+  size_t start = 0;
+  while (start < instances.size()) {
+    int node = instances[start].node;
+    size_t end = start;
+    while (end < instances.size() && instances[end].node == node) {
+      ++end;
+    }
+
+    size_t group_size = end - start;
+    if (!isBatchedNode(node, group_size)) {
+      for (size_t k = start; k < end; ++k) {
+        const NodeInstance& instance = instances[k];
+        VectorReal scores =
+            classR(node).transpose() * prediction_vectors.col(instance.instance)
+            + classB(node);
+        probs[instance.instance][instance.depth] = softMax(scores);
+      }
+    } else {
+      node_vectors.resize(prediction_vectors.rows(), group_size);
+      for (size_t k = start; k < end; ++k) {
+        node_vectors.col(k - start) =
+            prediction_vectors.col(instances[k].instance);
+      }
+
+      predictions.noalias() = classR(node).transpose() * node_vectors;
+      predictions.colwise() += classB(node);
+      for (size_t k = start; k < end; ++k) {
+        const NodeInstance& instance = instances[k];
+        probs[instance.instance][instance.depth] =
+            softMax(predictions.col(k - start));
+      }
     }
+
+    start = end;
   }
 
   return probs;
@@ -208,25 +290,59 @@ void FactoredTreeWeights::getProjectionGradient(
     const boost::shared_ptr<FactoredTreeWeights>& gradient,
     MatrixReal& backward_weights,
     MinibatchWords& words) const {
-  int word_width = config->word_representation_size;
-  backward_weights = MatrixReal::Zero(word_width, indices.size());
   for (size_t i = 0; i < indices.size(); ++i) {
-    int word_id = corpus->at(indices[i]);
-    int node = tree->getNode(word_id);
+    int node = tree->getNode(corpus->at(indices[i]));
     for (size_t j = 0; j < probs[i].size(); ++j) {
       words.addOutputWord(node);
-
-      int parent = tree->getParent(node);
       probs[i][j](tree->childIndex(node)) -= 1;
+      node = tree->getParent(node);
+    }
+  }
 
-      gradient->classB(parent) += probs[i][j];
-      gradient->classR(parent) +=
-          forward_weights.back().col(i) * probs[i][j].transpose();
-
-      backward_weights.col(i) += classR(parent) * probs[i][j];
+  const MatrixReal& prediction_vectors = forward_weights.back();
+  backward_weights = MatrixReal::Zero(prediction_vectors.rows(), indices.size());
+  vector<NodeInstance> instances = getNodeInstances(corpus, indices);
+
+  MatrixReal node_vectors, node_probs, node_backward_weights;
+  size_t start = 0;
+  while (start < instances.size()) {
+    int node = instances[start].node;
+    size_t end = start;
+    while (end < instances.size() && instances[end].node == node) {
+      ++end;
+    }
 
-      node = parent;
+    size_t group_size = end - start;
+    if (!isBatchedNode(node, group_size)) {
+      for (size_t k = start; k < end; ++k) {
+        const NodeInstance& instance = instances[k];
+        const VectorReal& probs_k = probs[instance.instance][instance.depth];
+        gradient->classB(node) += probs_k;
+        gradient->classR(node) +=
+            prediction_vectors.col(instance.instance) * probs_k.transpose();
+        backward_weights.col(instance.instance) += classR(node) * probs_k;
+      }
+    } else {
+      int num_children = tree->getChildren(node).size();
+      node_vectors.resize(prediction_vectors.rows(), group_size);
+      node_probs.resize(num_children, group_size);
+      for (size_t k = start; k < end; ++k) {
+        const NodeInstance& instance = instances[k];
+        node_vectors.col(k - start) = prediction_vectors.col(instance.instance);
+        node_probs.col(k - start) = probs[instance.instance][instance.depth];
+      }
+
+      gradient->classB(node) += node_probs.rowwise().sum();
+      gradient->classR(node).noalias() += node_vectors * node_probs.transpose();
+
+      node_backward_weights.noalias() = classR(node) * node_probs;
+      for (size_t k = start; k < end; ++k) {
+        backward_weights.col(instances[k].instance) +=
+            node_backward_weights.col(k - start);
+      }
     }
+
+    start = end;
   }
 
   backward_weights.array() *=
@@ -269,7 +385,6 @@ Real FactoredTreeWeights::getObjective(
     int node = tree->getNode(word_id);
     for (size_t j = 0; j < probs[i].size(); ++j) {
       int parent = tree->getParent(node);
-      vector<int> children = tree->getChildren(parent);
       log_likelihood -= log(probs[i][j](tree->childIndex(node)));
       node = parent;
     }
@@ -289,13 +404,116 @@ Real FactoredTreeWeights::getLogLikelihood(
       corpus, indices, contexts, context_vectors, forward_weights, probs);
 }
 
+VectorReal FactoredTreeWeights::getLogProbs(
+    const boost::shared_ptr<Corpus>& corpus,
+    const vector<int>& indices) const {
+  vector<vector<int>> contexts;
+  vector<MatrixReal> context_vectors;
+  vector<MatrixReal> forward_weights;
+  vector<vector<VectorReal>> probs;
+  getObjective(
+      corpus, indices, contexts, context_vectors, forward_weights, probs);
+
+  VectorReal log_probs = VectorReal::Zero(indices.size());
+  for (size_t i = 0; i < indices.size(); ++i) {
+    int node = tree->getNode(corpus->at(indices[i]));
+    for (size_t j = 0; j < probs[i].size(); ++j) {
+      log_probs(i) += log(probs[i][j](tree->childIndex(node)));
+      node = tree->getParent(node);
+    }
+  }
+
+  return log_probs;
+}
+
+void FactoredTreeWeights::estimateProjectionGradient(
+    const boost::shared_ptr<Corpus>& corpus,
+    const vector<int>& indices,
+    const vector<MatrixReal>& forward_weights,
+    const boost::shared_ptr<FactoredTreeWeights>& gradient,
+    MatrixReal& backward_weights,
+    Real& log_likelihood,
+    MinibatchWords& words) const {
+  if (!nodeDists.get()) {
+    nodeDists.reset(new NodeDistributions(
+        metadata->getNodeUnigram(), tree, omp_get_thread_num()));
+  }
+
+  // Every node on the path of a target word is a binary classification
+  // between its true child and noise_samples children drawn from the unigram
+  // distribution of the node.
+  int noise_samples = config->noise_samples;
+  Real log_num_samples = log(noise_samples);
+  const MatrixReal& prediction_vectors = forward_weights.back();
+  backward_weights = MatrixReal::Zero(prediction_vectors.rows(), indices.size());
+  for (size_t i = 0; i < indices.size(); ++i) {
+    int node = tree->getNode(corpus->at(indices[i]));
+    while (node != tree->getRoot()) {
+      int parent = tree->getParent(node);
+
+      words.addOutputWord(node);
+      Real log_score = R.col(node).dot(prediction_vectors.col(i)) + B(node);
+      Real log_noise = log_num_samples + nodeDists->logProb(node);
+      Real log_norm = LogAdd(log_score, log_noise);
+
+      log_likelihood -= log_score - log_norm;
+
+      Real prob = exp(log_noise - log_norm);
+      assert(prob <= numeric_limits<Real>::max());
+      backward_weights.col(i) -= prob * R.col(node);
+
+      gradient->R.col(node) -= prob * prediction_vectors.col(i);
+      gradient->B(node) -= prob;
+
+      for (int j = 0; j < noise_samples; ++j) {
+        int noise_node = nodeDists->sample(parent);
+        words.addOutputWord(noise_node);
+        Real log_score =
+            R.col(noise_node).dot(prediction_vectors.col(i)) + B(noise_node);
+        Real log_noise = log_num_samples + nodeDists->logProb(noise_node);
+        Real log_norm = LogAdd(log_score, log_noise);
+
+        log_likelihood -= log_noise - log_norm;
+
+        Real prob = exp(log_score - log_norm);
+        assert(prob <= numeric_limits<Real>::max());
+        backward_weights.col(i) += prob * R.col(noise_node);
+
+        gradient->R.col(noise_node) += prob * prediction_vectors.col(i);
+        gradient->B(noise_node) += prob;
+      }
+
+      node = parent;
+    }
+  }
+}
+
 void FactoredTreeWeights::estimateGradient(
     const boost::shared_ptr<Corpus>& corpus,
     const vector<int>& indices,
     const boost::shared_ptr<FactoredTreeWeights>& gradient,
     Real& log_likelihood,
     MinibatchWords& words) const {
-  throw NotImplementedException();
+  vector<vector<int>> contexts;
+  vector<MatrixReal> context_vectors;
+  getContextVectors(corpus, indices, contexts, context_vectors);
+
+  setContextWords(contexts, words);
+
+  vector<MatrixReal> forward_weights =
+      propagateForwards(indices, context_vectors);
+
+  MatrixReal backward_weights;
+  estimateProjectionGradient(
+      corpus, indices, forward_weights, gradient,
+      backward_weights, log_likelihood, words);
+
+  backward_weights.array() *=
+      activationDerivative(config, forward_weights.back());
+  propagateBackwards(forward_weights, backward_weights, gradient);
+
+  getContextGradient(
+      indices, contexts, context_vectors, backward_weights, gradient);
 }
 
 Real FactoredTreeWeights::getLogProb(int word_id, vector<int> context) const {
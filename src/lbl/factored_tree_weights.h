@@ -5,8 +5,10 @@
 #include <boost/serialization/type_info_implementation.hpp>
 #include <boost/serialization/serialization.hpp>
 #include <boost/serialization/shared_ptr.hpp>
+#include <boost/thread/tss.hpp>
 
 #include "lbl/config.h"
+#include "lbl/node_distributions.h"
 #include "lbl/tree_metadata.h"
 #include "lbl/utils.h"
 #include "lbl/weights.h"
@@ -19,7 +21,8 @@ class FactoredTreeWeights : public Weights {
 
   FactoredTreeWeights(
       const boost::shared_ptr<ModelData>& config,
-      const boost::shared_ptr<TreeMetadata>& metadata);
+      const boost::shared_ptr<TreeMetadata>& metadata,
+      bool row_wise_adagrad = false);
 
   FactoredTreeWeights(
       const boost::shared_ptr<ModelData>& config,
@@ -52,6 +55,10 @@ class FactoredTreeWeights : public Weights {
       const boost::shared_ptr<Corpus>& corpus,
       const vector<int>& indices) const;
 
+  virtual VectorReal getLogProbs(
+      const boost::shared_ptr<Corpus>& corpus,
+      const vector<int>& indices) const;
+
   virtual Real getLogProb(int word_id, vector<int> context) const;
 
   virtual Real getUnnormalizedScore(int word, const vector<int>& context) const;
@@ -71,6 +78,18 @@ class FactoredTreeWeights : public Weights {
 
   Eigen::VectorBlock<WeightsType> classB(int node);
 
+  struct NodeInstance {
+    int node;
+    int instance;
+    int depth;
+  };
+
+  vector<NodeInstance> getNodeInstances(
+      const boost::shared_ptr<Corpus>& corpus,
+      const vector<int>& indices) const;
+
+  virtual bool isBatchedNode(int node, size_t num_instances) const;
+
   vector<vector<VectorReal>> getProbabilities(
       const boost::shared_ptr<Corpus>& corpus,
       const vector<int>& indices,
@@ -103,6 +122,15 @@ class FactoredTreeWeights : public Weights {
       MatrixReal& backward_weights,
       MinibatchWords& words) const;
 
+  void estimateProjectionGradient(
+      const boost::shared_ptr<Corpus>& corpus,
+      const vector<int>& indices,
+      const vector<MatrixReal>& forward_weights,
+      const boost::shared_ptr<FactoredTreeWeights>& gradient,
+      MatrixReal& backward_weights,
+      Real& log_likelihood,
+      MinibatchWords& words) const;
+
  private:
   void allocate();
 
@@ -117,6 +145,7 @@ class FactoredTreeWeights : public Weights {
     ar << config;
 
     ar << tree;
+    ar << rowWiseAdaGrad;
 
     ar << size;
     ar << boost::serialization::make_array(data, size);
@@ -129,6 +158,11 @@ class FactoredTreeWeights : public Weights {
     ar >> config;
     ar >> tree;
 
+    rowWiseAdaGrad = false;
+    if (version > 0) {
+      ar >> rowWiseAdaGrad;
+    }
+
     ar >> size;
     data = new Real[size];
     ar >> boost::serialization::make_array(data, size);
@@ -141,6 +175,11 @@ class FactoredTreeWeights : public Weights {
  protected:
   boost::shared_ptr<TreeMetadata> metadata;
   boost::shared_ptr<ClassTree> tree;
+
+ private:
+  mutable boost::thread_specific_ptr<NodeDistributions> nodeDists;
 };
 
 } // namespace oxlm
+
+BOOST_CLASS_VERSION(oxlm::FactoredTreeWeights, 1)
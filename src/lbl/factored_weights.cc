@@ -13,8 +13,9 @@ FactoredWeights::FactoredWeights()
 
 FactoredWeights::FactoredWeights(
     const boost::shared_ptr<ModelData>& config,
-    const boost::shared_ptr<FactoredMetadata>& metadata)
-    : Weights(config, metadata), metadata(metadata),
+    const boost::shared_ptr<FactoredMetadata>& metadata,
+    bool row_wise_adagrad)
+    : Weights(config, metadata, row_wise_adagrad), metadata(metadata),
       index(metadata->getIndex()),
       data(NULL), S(0, 0, 0), T(0, 0), FW(0, 0) {
   allocate();
@@ -52,6 +53,14 @@ size_t FactoredWeights::numParameters() const {
   return Weights::numParameters() + size;
 }
 
+void FactoredWeights::reportMemory(MemoryReport& report) const {
+  Weights::reportMemory(report);
+  report.add("S", S.size() * sizeof(Real));
+  report.add("T", T.size() * sizeof(Real));
+  report.add("class mutexes", mutexes.size() * (sizeof(Mutex) + sizeof(mutex)));
+  report.add("class normalizer cache", classNormalizerCache.memoryUsage());
+}
+
 void FactoredWeights::allocate() {
   int num_classes = index->getNumClasses();
   int word_width = config->word_representation_size;
@@ -95,6 +104,30 @@ Real FactoredWeights::getLogLikelihood(
       class_probs, word_probs);
 }
 
+VectorReal FactoredWeights::getLogProbs(
+    const boost::shared_ptr<Corpus>& corpus,
+    const vector<int>& indices) const {
+  vector<vector<int>> contexts;
+  vector<MatrixReal> context_vectors;
+  vector<MatrixReal> forward_weights;
+  MatrixReal class_probs;
+  vector<VectorReal> word_probs;
+  getObjective(
+      corpus, indices, contexts, context_vectors, forward_weights,
+      class_probs, word_probs);
+
+  VectorReal log_probs(indices.size());
+  for (size_t i = 0; i < indices.size(); ++i) {
+    int word_id = corpus->at(indices[i]);
+    int class_id = index->getClass(word_id);
+    int word_class_id = index->getWordIndexInClass(word_id);
+    log_probs(i) =
+        log(class_probs(class_id, i)) + log(word_probs[i](word_class_id));
+  }
+
+  return log_probs;
+}
+
 Real FactoredWeights::getObjective(
     const boost::shared_ptr<Corpus>& corpus,
     const vector<int>& indices,
@@ -143,18 +176,48 @@ void FactoredWeights::getGradient(
       class_probs, word_probs, gradient, words);
 }
 
-MatrixReal FactoredWeights::classR(int class_id) const {
+const Eigen::Block<const WordVectorsType> FactoredWeights::classR(
+    int class_id) const {
   int class_start = index->getClassMarker(class_id);
   int class_size = index->getClassSize(class_id);
   return R.block(0, class_start, R.rows(), class_size);
 }
 
-VectorReal FactoredWeights::classB(int class_id) const {
+Eigen::Block<WordVectorsType> FactoredWeights::classR(int class_id) {
+  int class_start = index->getClassMarker(class_id);
+  int class_size = index->getClassSize(class_id);
+  return R.block(0, class_start, R.rows(), class_size);
+}
+
+const Eigen::VectorBlock<const WeightsType> FactoredWeights::classB(
+    int class_id) const {
+  int class_start = index->getClassMarker(class_id);
+  int class_size = index->getClassSize(class_id);
+  return B.segment(class_start, class_size);
+}
+
+Eigen::VectorBlock<WeightsType> FactoredWeights::classB(int class_id) {
   int class_start = index->getClassMarker(class_id);
   int class_size = index->getClassSize(class_id);
   return B.segment(class_start, class_size);
 }
 
+/**
+ * Groups the positions of the training instances in indices by the class of
+ * their target words. The word level computations for each class can then be
+ * carried out with a single matrix product.
+ */
+map<int, vector<int>> FactoredWeights::getClassGroups(
+    const boost::shared_ptr<Corpus>& corpus,
+    const vector<int>& indices) const {
+  map<int, vector<int>> groups;
+  for (size_t i = 0; i < indices.size(); ++i) {
+    groups[index->getClass(corpus->at(indices[i]))].push_back(i);
+  }
+
+  return groups;
+}
+
 void FactoredWeights::getProbabilities(
     const boost::shared_ptr<Corpus>& corpus,
     const vector<int>& indices,
@@ -167,13 +230,22 @@ void FactoredWeights::getProbabilities(
     class_probs.col(i) = softMax(class_probs.col(i));
   }
 
-  for (size_t i = 0; i < indices.size(); ++i) {
-    int word_id = corpus->at(indices[i]);
-    int class_id = index->getClass(word_id);
+  int word_width = config->word_representation_size;
+  word_probs.resize(indices.size());
+  for (const auto& group: getClassGroups(corpus, indices)) {
+    int class_id = group.first;
+    const vector<int>& positions = group.second;
+
+    MatrixReal prediction_vectors(word_width, positions.size());
+    for (size_t j = 0; j < positions.size(); ++j) {
+      prediction_vectors.col(j) = forward_weights.back().col(positions[j]);
+    }
 
-    VectorReal prediction_vector = forward_weights.back().col(i);
-    VectorReal word_scores = classR(class_id).transpose() * prediction_vector + classB(class_id);
-    word_probs.push_back(softMax(word_scores));
+    MatrixReal word_scores = classR(class_id).transpose() * prediction_vectors;
+    word_scores.colwise() += classB(class_id);
+    for (size_t j = 0; j < positions.size(); ++j) {
+      word_probs[positions[j]] = softMax(word_scores.col(j));
+    }
   }
 }
 
@@ -197,28 +269,34 @@ void FactoredWeights::getFullGradient(
 
   gradient->S += forward_weights.back() * class_probs.transpose();
   gradient->T += class_probs.rowwise().sum();
-  for (size_t i = 0; i < indices.size(); ++i) {
-    int word_id = corpus->at(indices[i]);
-    int class_id = index->getClass(word_id);
+
+  int word_width = config->word_representation_size;
+  MatrixReal backward_weights = S * class_probs;
+  for (const auto& group: getClassGroups(corpus, indices)) {
+    int class_id = group.first;
     int class_start = index->getClassMarker(class_id);
     int class_size = index->getClassSize(class_id);
+    const vector<int>& positions = group.second;
 
     for (int j = 0; j < class_size; ++j) {
       words.addOutputWord(class_start + j);
     }
 
-    gradient->B.segment(class_start, class_size) += word_probs[i];
-    gradient->R.block(0, class_start, gradient->R.rows(), class_size) +=
-        forward_weights.back().col(i) * word_probs[i].transpose();
-  }
+    MatrixReal prediction_vectors(word_width, positions.size());
+    MatrixReal class_word_probs(class_size, positions.size());
+    for (size_t j = 0; j < positions.size(); ++j) {
+      prediction_vectors.col(j) = forward_weights.back().col(positions[j]);
+      class_word_probs.col(j) = word_probs[positions[j]];
+    }
 
-  MatrixReal backward_weights = S * class_probs;
-  for (size_t i = 0; i < indices.size(); ++i) {
-    int word_id = corpus->at(indices[i]);
-    int class_id = index->getClass(word_id);
-    int class_start = index->getClassMarker(class_id);
-    int class_size = index->getClassSize(class_id);
-    backward_weights.col(i) += classR(class_id) * word_probs[i];
+    gradient->classB(class_id) += class_word_probs.rowwise().sum();
+    gradient->classR(class_id).noalias() +=
+        prediction_vectors * class_word_probs.transpose();
+
+    MatrixReal class_backward_weights = classR(class_id) * class_word_probs;
+    for (size_t j = 0; j < positions.size(); ++j) {
+      backward_weights.col(positions[j]) += class_backward_weights.col(j);
+    }
   }
 
   backward_weights.array() *=
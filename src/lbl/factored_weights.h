@@ -1,5 +1,7 @@
 #pragma once
 
+#include <map>
+
 #include <boost/make_shared.hpp>
 #include <boost/thread/tss.hpp>
 
@@ -17,7 +19,8 @@ class FactoredWeights : public Weights {
 
   FactoredWeights(
       const boost::shared_ptr<ModelData>& config,
-      const boost::shared_ptr<FactoredMetadata>& metadata);
+      const boost::shared_ptr<FactoredMetadata>& metadata,
+      bool row_wise_adagrad = false);
 
   FactoredWeights(
       const boost::shared_ptr<ModelData>& config,
@@ -28,6 +31,8 @@ class FactoredWeights : public Weights {
 
   virtual size_t numParameters() const;
 
+  virtual void reportMemory(MemoryReport& report) const;
+
   void getGradient(
       const boost::shared_ptr<Corpus>& corpus,
       const vector<int>& indices,
@@ -39,6 +44,10 @@ class FactoredWeights : public Weights {
       const boost::shared_ptr<Corpus>& corpus,
       const vector<int>& indices) const;
 
+  virtual VectorReal getLogProbs(
+      const boost::shared_ptr<Corpus>& corpus,
+      const vector<int>& indices) const;
+
   bool checkGradient(
       const boost::shared_ptr<Corpus>& corpus,
       const vector<int>& indices,
@@ -71,6 +80,24 @@ class FactoredWeights : public Weights {
 
   void clear(const MinibatchWords& words, bool parallel_update);
 
+  /**
+   * The class parameters are stored in full, since they are updated after
+   * every minibatch.
+   */
+  template<class Archive>
+  void saveDelta(Archive& ar, const ParameterUpdates& updates) const {
+    Weights::saveDelta(ar, updates);
+
+    ar << boost::serialization::make_array(data, size);
+  }
+
+  template<class Archive>
+  void loadDelta(Archive& ar, const vector<Real>& regularizer_sigmas) {
+    Weights::loadDelta(ar, regularizer_sigmas);
+
+    ar >> boost::serialization::make_array(data, size);
+  }
+
   virtual Real getLogProb(int word_id, vector<int> context) const;
 
   virtual Real getUnnormalizedScore(int word, const vector<int>& context) const;
@@ -82,9 +109,17 @@ class FactoredWeights : public Weights {
   virtual ~FactoredWeights();
 
  protected:
-  MatrixReal classR(int class_id) const;
+  const Eigen::Block<const WordVectorsType> classR(int class_id) const;
 
-  VectorReal classB(int class_id) const;
+  Eigen::Block<WordVectorsType> classR(int class_id);
+
+  const Eigen::VectorBlock<const WeightsType> classB(int class_id) const;
+
+  Eigen::VectorBlock<WeightsType> classB(int class_id);
+
+  map<int, vector<int>> getClassGroups(
+      const boost::shared_ptr<Corpus>& corpus,
+      const vector<int>& indices) const;
 
   virtual Real getObjective(
       const boost::shared_ptr<Corpus>& corpus,
@@ -9,11 +9,20 @@ FeatureApproximateFilter::FeatureApproximateFilter(
     const boost::shared_ptr<BloomFilter<NGram>>& bloom_filter)
     : numCandidates(num_candidates), hasher(hasher), bloomFilter(bloom_filter) {}
 
+FeatureApproximateFilter::FeatureApproximateFilter(
+    int num_candidates, const boost::shared_ptr<FeatureContextHasher>& hasher,
+    const boost::shared_ptr<BlockedBloomFilter<NGram>>& blocked_bloom_filter)
+    : numCandidates(num_candidates), hasher(hasher),
+      blockedBloomFilter(blocked_bloom_filter) {}
+
 vector<int> FeatureApproximateFilter::getIndexes(
     const FeatureContext& feature_context) const {
   vector<int> indexes;
+  // The n-gram is built once and only its predicted word changes.
+  NGram prediction = hasher->getPrediction(0, feature_context);
   for (int index = 0; index < numCandidates; ++index) {
-    if (bloomFilter->contains(hasher->getPrediction(index, feature_context))) {
+    prediction.word = index;
+    if (contains(prediction)) {
       indexes.push_back(index);
     }
   }
@@ -22,12 +31,28 @@ vector<int> FeatureApproximateFilter::getIndexes(
 
 bool FeatureApproximateFilter::hasIndex(
     const FeatureContext& feature_context, int feature_index) const {
-  return bloomFilter->contains(
-      hasher->getPrediction(feature_index, feature_context));
+  return contains(hasher->getPrediction(feature_index, feature_context));
+}
+
+bool FeatureApproximateFilter::contains(const NGram& ngram) const {
+  if (blockedBloomFilter) {
+    return blockedBloomFilter->contains(ngram);
+  }
+
+  return bloomFilter->contains(ngram);
 }
 
 bool FeatureApproximateFilter::operator==(const FeatureApproximateFilter& other) const {
-  return numCandidates == other.numCandidates && *bloomFilter == *other.bloomFilter;
+  if (numCandidates != other.numCandidates) {
+    return false;
+  }
+
+  if (blockedBloomFilter || other.blockedBloomFilter) {
+    return blockedBloomFilter && other.blockedBloomFilter
+        && *blockedBloomFilter == *other.blockedBloomFilter;
+  }
+
+  return *bloomFilter == *other.bloomFilter;
 }
 
 FeatureApproximateFilter::~FeatureApproximateFilter() {}
@@ -4,8 +4,10 @@
 #include <boost/serialization/singleton.hpp>
 #include <boost/serialization/type_info_implementation.hpp>
 #include <boost/serialization/shared_ptr.hpp>
+#include <boost/serialization/version.hpp>
 
 #include "lbl/archive_export.h"
+#include "lbl/blocked_bloom_filter.h"
 #include "lbl/bloom_filter.h"
 #include "lbl/feature_context_hasher.h"
 #include "lbl/feature_filter.h"
@@ -21,6 +23,10 @@ class FeatureApproximateFilter : public FeatureFilter {
       int num_candidates, const boost::shared_ptr<FeatureContextHasher>& hasher,
       const boost::shared_ptr<BloomFilter<NGram>>& bloom_filter);
 
+  FeatureApproximateFilter(
+      int num_candidates, const boost::shared_ptr<FeatureContextHasher>& hasher,
+      const boost::shared_ptr<BlockedBloomFilter<NGram>>& blocked_bloom_filter);
+
   virtual vector<int> getIndexes(const FeatureContext& feature_context) const;
 
   virtual bool hasIndex(const FeatureContext& feature_context, int feature_index) const;
@@ -30,6 +36,8 @@ class FeatureApproximateFilter : public FeatureFilter {
   virtual ~FeatureApproximateFilter();
 
  private:
+  bool contains(const NGram& ngram) const;
+
   friend class boost::serialization::access;
 
   template<class Archive>
@@ -38,13 +46,19 @@ class FeatureApproximateFilter : public FeatureFilter {
     ar & numCandidates;
     ar & hasher;
     ar & bloomFilter;
+    // Version 0 archives predate the blocked Bloom filters.
+    if (version > 0) {
+      ar & blockedBloomFilter;
+    }
   }
 
   int numCandidates;
   boost::shared_ptr<FeatureContextHasher> hasher;
   boost::shared_ptr<BloomFilter<NGram>> bloomFilter;
+  boost::shared_ptr<BlockedBloomFilter<NGram>> blockedBloomFilter;
 };
 
 } // namespace oxlm
 
 BOOST_CLASS_EXPORT_KEY(oxlm::FeatureApproximateFilter)
+BOOST_CLASS_VERSION(oxlm::FeatureApproximateFilter, 1)
@@ -0,0 +1,81 @@
+#include "lbl/feature_compact_filter.h"
+
+#include <algorithm>
+
+#include "lbl/memory_report.h"
+
+namespace oxlm {
+
+FeatureCompactFilter::FeatureCompactFilter() {}
+
+FeatureCompactFilter::FeatureCompactFilter(vector<pair<size_t, int>> matches) {
+  sort(matches.begin(), matches.end());
+  matches.erase(unique(matches.begin(), matches.end()), matches.end());
+
+  candidates.reserve(matches.size());
+  for (size_t i = 0; i < matches.size(); ++i) {
+    if (i == 0 || matches[i].first != matches[i - 1].first) {
+      keys.push_back(matches[i].first);
+      offsets.push_back(candidates.size());
+    }
+    candidates.push_back(matches[i].second);
+  }
+  offsets.push_back(candidates.size());
+}
+
+vector<int> FeatureCompactFilter::getIndexes(
+    const FeatureContext& feature_context) const {
+  int pos = getContextPosition(feature_context);
+  if (pos == -1) {
+    return vector<int>();
+  }
+
+  return vector<int>(
+      candidates.begin() + offsets[pos], candidates.begin() + offsets[pos + 1]);
+}
+
+bool FeatureCompactFilter::hasIndex(
+    const FeatureContext& feature_context, int feature_index) const {
+  int pos = getContextPosition(feature_context);
+  if (pos == -1) {
+    return false;
+  }
+
+  return binary_search(
+      candidates.begin() + offsets[pos],
+      candidates.begin() + offsets[pos + 1],
+      feature_index);
+}
+
+size_t FeatureCompactFilter::getNumContexts() const {
+  return keys.size();
+}
+
+size_t FeatureCompactFilter::getNumMatches() const {
+  return candidates.size();
+}
+
+size_t FeatureCompactFilter::memoryUsage() const {
+  return MemoryReport::getContainerBytes(keys)
+      + MemoryReport::getContainerBytes(offsets)
+      + MemoryReport::getContainerBytes(candidates);
+}
+
+bool FeatureCompactFilter::operator==(const FeatureCompactFilter& other) const {
+  return keys == other.keys
+      && offsets == other.offsets
+      && candidates == other.candidates;
+}
+
+FeatureCompactFilter::~FeatureCompactFilter() {}
+
+int FeatureCompactFilter::getContextPosition(
+    const FeatureContext& feature_context) const {
+  size_t key = hashFunction(feature_context);
+  auto it = lower_bound(keys.begin(), keys.end(), key);
+  return it != keys.end() && *it == key ? it - keys.begin() : -1;
+}
+
+} // namespace oxlm
+
+BOOST_CLASS_EXPORT_IMPLEMENT(oxlm::FeatureCompactFilter)
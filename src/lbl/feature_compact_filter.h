@@ -0,0 +1,75 @@
+#pragma once
+
+#include <vector>
+
+#include <boost/serialization/extended_type_info.hpp>
+#include <boost/serialization/singleton.hpp>
+#include <boost/serialization/type_info_implementation.hpp>
+#include <boost/serialization/shared_ptr.hpp>
+#include <boost/serialization/vector.hpp>
+
+#include "lbl/archive_export.h"
+#include "lbl/feature_context.h"
+#include "lbl/feature_filter.h"
+
+namespace oxlm {
+
+/**
+ * Inverted index from feature contexts to the candidates observed after them.
+ *
+ * Feature contexts are identified by their 64 bit hash, kept in a sorted
+ * array. The candidates of the i-th context are
+ * candidates[offsets[i]..offsets[i + 1]), sorted. Unlike
+ * FeatureApproximateFilter, a lookup does not scan every candidate in the
+ * class and, unlike FeatureExactFilter, it does not need the feature context
+ * mapper or a vector per context.
+ */
+class FeatureCompactFilter : public FeatureFilter {
+ public:
+  FeatureCompactFilter();
+
+  /**
+   * Builds the index from (feature context hash, candidate) pairs. The pairs
+   * may contain duplicates.
+   */
+  FeatureCompactFilter(vector<pair<size_t, int>> matches);
+
+  virtual vector<int> getIndexes(const FeatureContext& feature_context) const;
+
+  virtual bool hasIndex(
+      const FeatureContext& feature_context, int feature_index) const;
+
+  size_t getNumContexts() const;
+
+  size_t getNumMatches() const;
+
+  size_t memoryUsage() const;
+
+  bool operator==(const FeatureCompactFilter& other) const;
+
+  virtual ~FeatureCompactFilter();
+
+ private:
+  // Returns the position of the feature context in keys or -1 if the context
+  // was not observed.
+  int getContextPosition(const FeatureContext& feature_context) const;
+
+  friend class boost::serialization::access;
+
+  template<class Archive>
+  void serialize(Archive& ar, const unsigned int version) {
+    ar & boost::serialization::base_object<FeatureFilter>(*this);
+    ar & keys;
+    ar & offsets;
+    ar & candidates;
+  }
+
+  hash<FeatureContext> hashFunction;
+  vector<size_t> keys;
+  vector<int> offsets;
+  vector<int> candidates;
+};
+
+} // namespace oxlm
+
+BOOST_CLASS_EXPORT_KEY(oxlm::FeatureCompactFilter)
@@ -2,9 +2,13 @@
 
 namespace oxlm {
 
-FeatureContext::FeatureContext() {}
+FeatureContext::FeatureContext() : hashCode(MurmurHash(data)) {}
 
-FeatureContext::FeatureContext(const vector<int>& data) : data(data) {}
+FeatureContext::FeatureContext(const vector<int>& data)
+    : data(data), hashCode(MurmurHash(data)) {}
+
+FeatureContext::FeatureContext(const vector<int>& data, size_t hash_code)
+    : data(data), hashCode(hash_code) {}
 
 bool FeatureContext::operator==(const FeatureContext& feature_context) const {
   return data == feature_context.data;
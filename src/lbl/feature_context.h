@@ -18,18 +18,37 @@ class FeatureContext {
 
   FeatureContext(const vector<int>& data);
 
+  /**
+   * Used when the hash of data is already known, e.g. when the hashes of a
+   * sequence of prefixes are computed incrementally.
+   */
+  FeatureContext(const vector<int>& data, size_t hash_code);
+
   bool operator==(const FeatureContext& feature_context) const;
 
  private:
   friend class boost::serialization::access;
 
   template<class Archive>
-  void serialize(Archive& ar, const unsigned int version) {
-    ar & data;
+  void save(Archive& ar, const unsigned int version) const {
+    ar << data;
   }
 
+  // The hash is not serialized, so the format is the same as before the hash
+  // was cached.
+  template<class Archive>
+  void load(Archive& ar, const unsigned int version) {
+    ar >> data;
+    hashCode = MurmurHash(data);
+  }
+
+  BOOST_SERIALIZATION_SPLIT_MEMBER();
+
  public:
+  // hashCode must always be equal to MurmurHash(data): construct a new
+  // feature context instead of modifying data.
   vector<int> data;
+  size_t hashCode;
 };
 
 } // namespace oxlm
@@ -38,7 +57,7 @@ namespace std {
 
 template<> struct hash<oxlm::FeatureContext> {
   inline size_t operator()(const oxlm::FeatureContext& feature_context) const {
-    return oxlm::MurmurHash(feature_context.data);
+    return feature_context.hashCode;
   }
 };
 
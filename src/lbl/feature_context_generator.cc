@@ -9,17 +9,34 @@ FeatureContextGenerator::FeatureContextGenerator(size_t feature_context_size)
 
 vector<FeatureContext> FeatureContextGenerator::getFeatureContexts(
     const vector<int>& history) const {
+  size_t num_contexts = min(featureContextSize, history.size());
   vector<FeatureContext> feature_contexts;
+  feature_contexts.reserve(num_contexts);
   vector<int> context;
-  for (size_t i = 0; i < min(featureContextSize, history.size()); ++i) {
-    context.reserve(context.size() + 1);
+  context.reserve(num_contexts);
+  PrefixHash prefix_hash;
+  for (size_t i = 0; i < num_contexts; ++i) {
     context.push_back(history[i]);
-    feature_contexts.push_back(FeatureContext(context));
+    prefix_hash.append(history[i]);
+    feature_contexts.push_back(
+        FeatureContext(context, prefix_hash.getHash()));
   }
 
   return feature_contexts;
 }
 
+vector<size_t> FeatureContextGenerator::getPrefixHashes(
+    PrefixHash prefix, const vector<int>& history) const {
+  size_t num_contexts = min(featureContextSize, history.size());
+  vector<size_t> hashes(num_contexts);
+  for (size_t i = 0; i < num_contexts; ++i) {
+    prefix.append(history[i]);
+    hashes[i] = prefix.getHash();
+  }
+
+  return hashes;
+}
+
 bool FeatureContextGenerator::operator==(
     const FeatureContextGenerator& other) const {
   return featureContextSize == other.featureContextSize;
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "lbl/feature_context.h"
+#include "lbl/prefix_hash.h"
 
 namespace oxlm {
 
@@ -12,6 +13,13 @@ class FeatureContextGenerator {
 
   vector<FeatureContext> getFeatureContexts(const vector<int>& context) const;
 
+  /**
+   * Returns the hashes of prefix followed by each feature context of the
+   * history, computed in a single pass without building the feature contexts.
+   */
+  vector<size_t> getPrefixHashes(
+      PrefixHash prefix, const vector<int>& history) const;
+
   bool operator==(const FeatureContextGenerator& other) const;
 
  private:
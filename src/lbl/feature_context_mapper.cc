@@ -2,6 +2,8 @@
 
 #include <boost/make_shared.hpp>
 
+#include "lbl/feature_index_builder.h"
+
 namespace oxlm {
 
 FeatureContextMapper::FeatureContextMapper() {}
@@ -12,28 +14,18 @@ FeatureContextMapper::FeatureContextMapper(
     const boost::shared_ptr<ContextProcessor>& processor,
     const boost::shared_ptr<FeatureContextGenerator>& generator,
     const boost::shared_ptr<NGramFilter>& filter)
+    : FeatureContextMapper(*FeatureIndexBuilder(
+          corpus, index, processor, generator, filter,
+          false, false).getMapper()) {}
+
+FeatureContextMapper::FeatureContextMapper(
+    const boost::shared_ptr<WordToClassIndex>& index,
+    const boost::shared_ptr<FeatureContextGenerator>& generator,
+    FlatHashMap<size_t, int> class_context_ids,
+    vector<FlatHashMap<size_t, int>> word_context_ids)
     : index(index), generator(generator),
-      wordContextIdsMap(index->getNumClasses()) {
-  for (size_t i = 0; i < corpus->size(); ++i) {
-    int word_id = corpus->at(i);
-    int class_id = index->getClass(word_id);
-    vector<int> context = processor->extract(i);
-
-    vector<FeatureContext> feature_contexts =
-        generator->getFeatureContexts(context);
-
-    // Map feature context to id if at least one n-gram having that context is
-    // within the topmost max_ngrams ngrams.
-    feature_contexts = filter->filter(word_id, class_id, feature_contexts);
-    for (const FeatureContext& feature_context: feature_contexts) {
-      size_t context_hash = hashFunction(feature_context);
-      classContextIdsMap.insert(make_pair(
-          context_hash, classContextIdsMap.size()));
-      wordContextIdsMap[class_id].insert(make_pair(
-          context_hash, wordContextIdsMap[class_id].size()));
-    }
-  }
-}
+      classContextIdsMap(move(class_context_ids)),
+      wordContextIdsMap(move(word_context_ids)) {}
 
 vector<int> FeatureContextMapper::getClassContextIds(
     const vector<int>& context) const {
@@ -105,6 +97,15 @@ int FeatureContextMapper::getNumWordContexts(int class_id) const {
   return wordContextIdsMap[class_id].size();
 }
 
+size_t FeatureContextMapper::memoryUsage() const {
+  size_t bytes = classContextIdsMap.memoryUsage();
+  for (const auto& word_context_ids: wordContextIdsMap) {
+    bytes += word_context_ids.memoryUsage();
+  }
+
+  return bytes;
+}
+
 bool FeatureContextMapper::operator==(const FeatureContextMapper& other) const {
   return *index == *other.index
       && *generator == *other.generator
@@ -112,4 +113,14 @@ bool FeatureContextMapper::operator==(const FeatureContextMapper& other) const {
       && wordContextIdsMap == other.wordContextIdsMap;
 }
 
+FlatHashMap<size_t, int> FeatureContextMapper::convert(
+    const unordered_map<size_t, int>& context_ids) {
+  FlatHashMap<size_t, int> result;
+  result.reserve(context_ids.size());
+  for (const auto& entry: context_ids) {
+    result.insert(entry);
+  }
+  return result;
+}
+
 } // namespace oxlm
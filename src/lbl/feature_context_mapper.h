@@ -1,12 +1,16 @@
 #pragma once
 
+#include <unordered_map>
 #include <vector>
 
 #include <boost/serialization/serialization.hpp>
+#include <boost/serialization/split_member.hpp>
+#include <boost/serialization/version.hpp>
 
 #include "lbl/context_processor.h"
 #include "lbl/feature_context.h"
 #include "lbl/feature_context_generator.h"
+#include "lbl/flat_hash_map.h"
 #include "lbl/ngram_filter.h"
 #include "lbl/utils.h"
 #include "lbl/word_to_class_index.h"
@@ -34,6 +38,15 @@ class FeatureContextMapper {
       const boost::shared_ptr<FeatureContextGenerator>& generator,
       const boost::shared_ptr<NGramFilter>& filter);
 
+  /**
+   * Wraps the maps from feature context hashes to class and word context ids.
+   */
+  FeatureContextMapper(
+      const boost::shared_ptr<WordToClassIndex>& index,
+      const boost::shared_ptr<FeatureContextGenerator>& generator,
+      FlatHashMap<size_t, int> class_context_ids,
+      vector<FlatHashMap<size_t, int>> word_context_ids);
+
   // Unobserved contexts are skipped.
   vector<int> getClassContextIds(const vector<int>& context) const;
 
@@ -55,24 +68,54 @@ class FeatureContextMapper {
 
   int getNumWordContexts(int class_id) const;
 
+  size_t memoryUsage() const;
+
   bool operator==(const FeatureContextMapper& other) const;
 
 private:
   friend class boost::serialization::access;
 
   template<class Archive>
-  void serialize(Archive& ar, const unsigned int version) {
-    ar & index;
-    ar & generator;
-    ar & classContextIdsMap;
-    ar & wordContextIdsMap;
+  void save(Archive& ar, const unsigned int version) const {
+    ar << index;
+    ar << generator;
+    ar << classContextIdsMap;
+    ar << wordContextIdsMap;
   }
 
+  template<class Archive>
+  void load(Archive& ar, const unsigned int version) {
+    ar >> index;
+    ar >> generator;
+    if (version > 0) {
+      ar >> classContextIdsMap;
+      ar >> wordContextIdsMap;
+    } else {
+      // Models saved before version 1 used unordered_maps.
+      unordered_map<size_t, int> old_class_context_ids;
+      vector<unordered_map<size_t, int>> old_word_context_ids;
+      ar >> old_class_context_ids;
+      ar >> old_word_context_ids;
+      classContextIdsMap = convert(old_class_context_ids);
+      wordContextIdsMap.clear();
+      for (const auto& context_ids: old_word_context_ids) {
+        wordContextIdsMap.push_back(convert(context_ids));
+      }
+    }
+  }
+
+  BOOST_SERIALIZATION_SPLIT_MEMBER();
+
+  static FlatHashMap<size_t, int> convert(
+      const unordered_map<size_t, int>& context_ids);
+
   boost::shared_ptr<WordToClassIndex> index;
   boost::shared_ptr<FeatureContextGenerator> generator;
   hash<FeatureContext> hashFunction;
-  unordered_map<size_t, int> classContextIdsMap;
-  vector<unordered_map<size_t, int>> wordContextIdsMap;
+  FlatHashMap<size_t, int> classContextIdsMap;
+  vector<FlatHashMap<size_t, int>> wordContextIdsMap;
 };
 
 } // namespace oxlm
+
+BOOST_CLASS_VERSION(oxlm::FeatureContextMapper, 1)
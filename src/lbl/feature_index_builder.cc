@@ -0,0 +1,208 @@
+#include "lbl/feature_index_builder.h"
+
+#include <boost/make_shared.hpp>
+
+#include "utils/conditional_omp.h"
+
+namespace oxlm {
+
+FeatureIndexBuilder::FeatureIndexBuilder(
+    const boost::shared_ptr<Corpus>& corpus,
+    const boost::shared_ptr<WordToClassIndex>& index,
+    const boost::shared_ptr<ContextProcessor>& processor,
+    const boost::shared_ptr<FeatureContextGenerator>& generator,
+    const boost::shared_ptr<NGramFilter>& filter,
+    bool build_feature_indexes, bool build_compact_filters) {
+  int num_classes = index->getNumClasses();
+  vector<Slice> slices(omp_get_max_threads());
+  #pragma omp parallel
+  {
+    int thread_id = omp_get_thread_num();
+    pair<size_t, size_t> range =
+        GetSlice(corpus->size(), thread_id, omp_get_num_threads());
+
+    Slice& slice = slices[thread_id];
+    slice.wordContexts.resize(num_classes);
+    slice.numClassMatches = 0;
+    if (build_compact_filters) {
+      slice.wordMatches.resize(num_classes);
+      slice.numWordMatches.resize(num_classes);
+    }
+
+    hash<FeatureContext> hash_function;
+    for (size_t i = range.first; i < range.second; ++i) {
+      int word_id = corpus->at(i);
+      int class_id = index->getClass(word_id);
+      int word_class_id = index->getWordIndexInClass(word_id);
+      vector<int> context = processor->extract(i);
+
+      vector<FeatureContext> feature_contexts =
+          generator->getFeatureContexts(context);
+      // Map feature context to id if at least one n-gram having that context
+      // is within the topmost max_ngrams ngrams.
+      feature_contexts = filter->filter(word_id, class_id, feature_contexts);
+      for (const FeatureContext& feature_context: feature_contexts) {
+        size_t key = hash_function(feature_context);
+        addContext(
+            slice.classContexts, key, class_id, build_feature_indexes);
+        addContext(
+            slice.wordContexts[class_id], key, word_class_id,
+            build_feature_indexes);
+
+        if (build_compact_filters) {
+          CompactFilterPopulator::addMatch(
+              slice.classMatches, slice.numClassMatches, key, class_id);
+          CompactFilterPopulator::addMatch(
+              slice.wordMatches[class_id], slice.numWordMatches[class_id],
+              key, word_class_id);
+        }
+      }
+    }
+  }
+
+  FlatHashMap<size_t, int> class_context_ids;
+  vector<FlatHashMap<size_t, int>> word_context_ids(num_classes);
+  for (const Slice& slice: slices) {
+    if (slice.wordContexts.empty()) {
+      // The thread was not part of the team.
+      continue;
+    }
+
+    mergeContexts(slice.classContexts, class_context_ids);
+    for (int i = 0; i < num_classes; ++i) {
+      mergeContexts(slice.wordContexts[i], word_context_ids[i]);
+    }
+  }
+
+  if (build_feature_indexes) {
+    GlobalFeatureIndexesPtr class_indexes =
+        boost::make_shared<GlobalFeatureIndexes>(class_context_ids.size());
+    vector<GlobalFeatureIndexesPtr> word_indexes(num_classes);
+    for (int i = 0; i < num_classes; ++i) {
+      word_indexes[i] = boost::make_shared<GlobalFeatureIndexes>(
+          word_context_ids[i].size());
+    }
+
+    vector<bool> marked;
+    for (const Slice& slice: slices) {
+      if (slice.wordContexts.empty()) {
+        continue;
+      }
+
+      mergeCandidates(
+          slice.classContexts, class_context_ids, *class_indexes, marked);
+      for (int i = 0; i < num_classes; ++i) {
+        mergeCandidates(
+            slice.wordContexts[i], word_context_ids[i], *word_indexes[i],
+            marked);
+      }
+    }
+
+    featureIndexes = boost::make_shared<GlobalFeatureIndexesPair>(
+        class_indexes, word_indexes);
+  }
+
+  if (build_compact_filters) {
+    vector<pair<size_t, int>> class_matches;
+    vector<vector<pair<size_t, int>>> word_matches(num_classes);
+    for (Slice& slice: slices) {
+      class_matches.insert(
+          class_matches.end(),
+          slice.classMatches.begin(), slice.classMatches.end());
+      vector<pair<size_t, int>>().swap(slice.classMatches);
+      for (size_t i = 0; i < slice.wordMatches.size(); ++i) {
+        word_matches[i].insert(
+            word_matches[i].end(),
+            slice.wordMatches[i].begin(), slice.wordMatches[i].end());
+        vector<pair<size_t, int>>().swap(slice.wordMatches[i]);
+      }
+    }
+
+    compactPopulator = boost::make_shared<CompactFilterPopulator>(
+        move(class_matches), move(word_matches));
+  }
+
+  mapper = boost::make_shared<FeatureContextMapper>(
+      index, generator, move(class_context_ids), move(word_context_ids));
+}
+
+boost::shared_ptr<FeatureContextMapper> FeatureIndexBuilder::getMapper() const {
+  return mapper;
+}
+
+GlobalFeatureIndexesPairPtr FeatureIndexBuilder::getFeatureIndexes() const {
+  return featureIndexes;
+}
+
+boost::shared_ptr<CompactFilterPopulator>
+    FeatureIndexBuilder::getCompactPopulator() const {
+  return compactPopulator;
+}
+
+void FeatureIndexBuilder::addContext(
+    SliceContexts& contexts, size_t key, int candidate, bool add_candidate) {
+  auto ret = contexts.ids.insert(make_pair(key, contexts.keys.size()));
+  if (ret.second) {
+    contexts.keys.push_back(key);
+    if (add_candidate) {
+      contexts.candidates.push_back(vector<int>());
+    }
+  }
+
+  if (add_candidate) {
+    int context_id = ret.first->second;
+    size_t pair_key = getPairKey(context_id, candidate);
+    if (contexts.observedCandidates.insert(make_pair(pair_key, true)).second) {
+      contexts.candidates[context_id].push_back(candidate);
+    }
+  }
+}
+
+size_t FeatureIndexBuilder::getPairKey(int context_id, int candidate) {
+  return (static_cast<size_t>(context_id) << 32)
+      | static_cast<uint32_t>(candidate);
+}
+
+void FeatureIndexBuilder::mergeContexts(
+    const SliceContexts& contexts, FlatHashMap<size_t, int>& context_ids) {
+  for (size_t key: contexts.keys) {
+    context_ids.insert(make_pair(key, context_ids.size()));
+  }
+}
+
+void FeatureIndexBuilder::mergeCandidates(
+    const SliceContexts& contexts,
+    const FlatHashMap<size_t, int>& context_ids,
+    GlobalFeatureIndexes& feature_indexes, vector<bool>& marked) {
+  for (size_t i = 0; i < contexts.keys.size(); ++i) {
+    vector<int>& indexes = feature_indexes[context_ids.at(contexts.keys[i])];
+    const vector<int>& candidates = contexts.candidates[i];
+    if (indexes.empty()) {
+      // The candidates of a slice are already unique.
+      indexes = candidates;
+      continue;
+    }
+
+    // The context was observed in an earlier slice. Mark the candidates
+    // recorded so far, append the new ones and clear the marks again, so
+    // that the merge is linear in the number of candidates.
+    for (int candidate: indexes) {
+      if (candidate >= static_cast<int>(marked.size())) {
+        marked.resize(candidate + 1);
+      }
+      marked[candidate] = true;
+    }
+    size_t num_marked = indexes.size();
+    for (int candidate: candidates) {
+      if (candidate >= static_cast<int>(marked.size())
+          || !marked[candidate]) {
+        indexes.push_back(candidate);
+      }
+    }
+    for (size_t j = 0; j < num_marked; ++j) {
+      marked[indexes[j]] = false;
+    }
+  }
+}
+
+} // namespace oxlm
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+
+#include "lbl/compact_filter_populator.h"
+#include "lbl/context_processor.h"
+#include "lbl/feature_context.h"
+#include "lbl/feature_context_generator.h"
+#include "lbl/feature_context_mapper.h"
+#include "lbl/flat_hash_map.h"
+#include "lbl/global_feature_indexes_pair.h"
+#include "lbl/ngram_filter.h"
+#include "lbl/word_to_class_index.h"
+
+using namespace std;
+
+namespace oxlm {
+
+/**
+ * Builds the feature context mapper and, optionally, the global feature
+ * indexes and the compact filters in a single parallel pass over the training
+ * corpus.
+ *
+ * The corpus is split into one contiguous slice per thread. Every thread
+ * records the feature contexts of its slice in the order in which they are
+ * first observed, together with the classes and words observed after each
+ * context. The slices are merged in corpus order, so the context ids and the
+ * order of the feature indexes are the same as for a sequential pass.
+ */
+class FeatureIndexBuilder {
+ public:
+  FeatureIndexBuilder(
+      const boost::shared_ptr<Corpus>& corpus,
+      const boost::shared_ptr<WordToClassIndex>& index,
+      const boost::shared_ptr<ContextProcessor>& processor,
+      const boost::shared_ptr<FeatureContextGenerator>& generator,
+      const boost::shared_ptr<NGramFilter>& filter,
+      bool build_feature_indexes, bool build_compact_filters);
+
+  boost::shared_ptr<FeatureContextMapper> getMapper() const;
+
+  // Returns nullptr unless build_feature_indexes is set.
+  GlobalFeatureIndexesPairPtr getFeatureIndexes() const;
+
+  // Returns nullptr unless build_compact_filters is set.
+  boost::shared_ptr<CompactFilterPopulator> getCompactPopulator() const;
+
+ private:
+  /**
+   * Feature contexts observed in a slice, with their (slice local) ids
+   * assigned in order of first occurrence. observedCandidates holds the
+   * (context id, candidate) pairs already recorded, packed by getPairKey, so
+   * that duplicate candidates are detected in constant time.
+   */
+  struct SliceContexts {
+    FlatHashMap<size_t, int> ids;
+    vector<size_t> keys;
+    vector<vector<int>> candidates;
+    FlatHashMap<size_t, bool> observedCandidates;
+  };
+
+  struct Slice {
+    SliceContexts classContexts;
+    vector<SliceContexts> wordContexts;
+    vector<pair<size_t, int>> classMatches;
+    size_t numClassMatches;
+    vector<vector<pair<size_t, int>>> wordMatches;
+    vector<size_t> numWordMatches;
+  };
+
+  static void addContext(
+      SliceContexts& contexts, size_t key, int candidate,
+      bool add_candidate);
+
+  static void mergeContexts(
+      const SliceContexts& contexts, FlatHashMap<size_t, int>& context_ids);
+
+  static size_t getPairKey(int context_id, int candidate);
+
+  static void mergeCandidates(
+      const SliceContexts& contexts,
+      const FlatHashMap<size_t, int>& context_ids,
+      GlobalFeatureIndexes& feature_indexes, vector<bool>& marked);
+
+  boost::shared_ptr<FeatureContextMapper> mapper;
+  GlobalFeatureIndexesPairPtr featureIndexes;
+  boost::shared_ptr<CompactFilterPopulator> compactPopulator;
+};
+
+} // namespace oxlm
@@ -2,6 +2,8 @@
 
 #include <boost/make_shared.hpp>
 
+#include "utils/conditional_omp.h"
+
 namespace oxlm {
 
 FeatureMatcher::FeatureMatcher() {}
@@ -14,32 +16,72 @@ FeatureMatcher::FeatureMatcher(
     const boost::shared_ptr<NGramFilter>& filter,
     const boost::shared_ptr<FeatureContextMapper>& mapper)
     : corpus(corpus), index(index), generator(generator), mapper(mapper) {
-  featureIndexes = boost::make_shared<GlobalFeatureIndexesPair>(index, mapper);
-  for (size_t i = 0; i < corpus->size(); ++i) {
-    int word_id = corpus->at(i);
-    int class_id = index->getClass(word_id);
-    int word_class_id = index->getWordIndexInClass(word_id);
-    vector<WordId> context = processor->extract(i);
+  // Every thread matches a contiguous slice of the corpus. Merging the partial
+  // indexes in corpus order preserves the order of the feature indexes.
+  vector<GlobalFeatureIndexesPairPtr> partial_indexes(omp_get_max_threads());
+  #pragma omp parallel
+  {
+    int thread_id = omp_get_thread_num();
+    pair<size_t, size_t> range =
+        GetSlice(corpus->size(), thread_id, omp_get_num_threads());
 
-    vector<FeatureContext> feature_contexts =
-        generator->getFeatureContexts(context);
-    // Add feature indexes only for the topmost max_ngrams ngrams.
-    feature_contexts = filter->filter(word_id, class_id, feature_contexts);
+    GlobalFeatureIndexesPairPtr feature_indexes =
+        boost::make_shared<GlobalFeatureIndexesPair>(index, mapper);
+    for (size_t i = range.first; i < range.second; ++i) {
+      int word_id = corpus->at(i);
+      int class_id = index->getClass(word_id);
+      int word_class_id = index->getWordIndexInClass(word_id);
+      vector<WordId> context = processor->extract(i);
 
-    for (int context_id: mapper->getClassContextIds(feature_contexts)) {
-      featureIndexes->addClassIndex(context_id, class_id);
+      vector<FeatureContext> feature_contexts =
+          generator->getFeatureContexts(context);
+      // Add feature indexes only for the topmost max_ngrams ngrams.
+      feature_contexts = filter->filter(word_id, class_id, feature_contexts);
+
+      for (int context_id: mapper->getClassContextIds(feature_contexts)) {
+        feature_indexes->addClassIndex(context_id, class_id);
+      }
+
+      for (int context_id:
+          mapper->getWordContextIds(class_id, feature_contexts)) {
+        feature_indexes->addWordIndex(class_id, context_id, word_class_id);
+      }
     }
 
-    for (int context_id: mapper->getWordContextIds(class_id, feature_contexts)) {
-      featureIndexes->addWordIndex(class_id, context_id, word_class_id);
+    partial_indexes[thread_id] = feature_indexes;
+  }
+
+  featureIndexes = partial_indexes[0];
+  for (size_t i = 1; i < partial_indexes.size(); ++i) {
+    if (partial_indexes[i] != nullptr) {
+      featureIndexes->merge(*partial_indexes[i]);
+      partial_indexes[i].reset();
     }
   }
 }
 
+FeatureMatcher::FeatureMatcher(
+    const boost::shared_ptr<Corpus>& corpus,
+    const boost::shared_ptr<WordToClassIndex>& index,
+    const boost::shared_ptr<FeatureContextGenerator>& generator,
+    const boost::shared_ptr<FeatureContextMapper>& mapper,
+    const GlobalFeatureIndexesPairPtr& feature_indexes)
+    : corpus(corpus), index(index), generator(generator), mapper(mapper),
+      featureIndexes(feature_indexes) {}
+
 GlobalFeatureIndexesPairPtr FeatureMatcher::getGlobalFeatures() const {
   return featureIndexes;
 }
 
+void FeatureMatcher::setGlobalFeatures(
+    const GlobalFeatureIndexesPairPtr& feature_indexes) {
+  featureIndexes = feature_indexes;
+}
+
+size_t FeatureMatcher::memoryUsage() const {
+  return featureIndexes->memoryUsage() + corpus->size() * sizeof(int);
+}
+
 MinibatchFeatureIndexesPairPtr FeatureMatcher::getMinibatchFeatures(
     const boost::shared_ptr<Corpus>& corpus,
     size_t feature_context_size,
@@ -48,11 +90,12 @@ MinibatchFeatureIndexesPairPtr FeatureMatcher::getMinibatchFeatures(
       boost::make_shared<ContextProcessor>(corpus, feature_context_size);
   MinibatchFeatureIndexesPairPtr minibatch_feature_indexes =
       boost::make_shared<MinibatchFeatureIndexesPair>(index);
+  vector<WordId> context(feature_context_size);
   for (int i: minibatch_indexes) {
     int word_id = corpus->at(i);
     int class_id = index->getClass(word_id);
     int word_class_id = index->getWordIndexInClass(word_id);
-    vector<WordId> context = processor->extract(i);
+    processor->extract(i, context.data());
 
     vector<FeatureContext> feature_contexts =
         generator->getFeatureContexts(context);
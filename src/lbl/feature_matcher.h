@@ -30,8 +30,26 @@ class FeatureMatcher {
       const boost::shared_ptr<NGramFilter>& filter,
       const boost::shared_ptr<FeatureContextMapper>& mapper);
 
+  FeatureMatcher(
+      const boost::shared_ptr<Corpus>& corpus,
+      const boost::shared_ptr<WordToClassIndex>& index,
+      const boost::shared_ptr<FeatureContextGenerator>& generator,
+      const boost::shared_ptr<FeatureContextMapper>& mapper,
+      const GlobalFeatureIndexesPairPtr& feature_indexes);
+
   GlobalFeatureIndexesPairPtr getGlobalFeatures() const;
 
+  /**
+   * Replaces the global feature indexes, e.g. after the features of a trained
+   * model are pruned.
+   */
+  void setGlobalFeatures(const GlobalFeatureIndexesPairPtr& feature_indexes);
+
+  /**
+   * Includes the copy of the training corpus stored with the matcher.
+   */
+  size_t memoryUsage() const;
+
   MinibatchFeatureIndexesPairPtr getMinibatchFeatures(
       const boost::shared_ptr<Corpus>& corpus,
       size_t feature_context_size,
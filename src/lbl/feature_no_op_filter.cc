@@ -1,5 +1,7 @@
 #include "lbl/feature_no_op_filter.h"
 
+#include <numeric>
+
 namespace oxlm {
 
 FeatureNoOpFilter::FeatureNoOpFilter() {}
@@ -18,6 +18,12 @@ class FeatureStore {
 
   virtual size_t size() const = 0;
 
+  /**
+   * Returns the size of the feature weights in bytes. Components shared with
+   * other stores (e.g. the collision space) are not included.
+   */
+  virtual size_t memoryUsage() const = 0;
+
   virtual ~FeatureStore();
 
  private:
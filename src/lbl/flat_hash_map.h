@@ -0,0 +1,309 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include <boost/serialization/serialization.hpp>
+#include <boost/serialization/split_member.hpp>
+
+using namespace std;
+
+namespace oxlm {
+
+/**
+ * Open addressing hash map with linear probing.
+ *
+ * Entries are kept in a single power-of-two array, so a lookup touches
+ * consecutive memory instead of chasing per-node pointers. Every slot is
+ * tagged with the generation in which it was written: a slot is occupied only
+ * if its tag matches the current generation, which makes clear() O(1) and
+ * lets the table keep its capacity across minibatches. Erasing individual
+ * keys is not supported, so no tombstones are needed.
+ */
+template<class Key, class Value, class Hash = hash<Key>>
+class FlatHashMap {
+ public:
+  typedef pair<Key, Value> value_type;
+
+ private:
+  template<class MapType, class EntryType>
+  class Iterator {
+   public:
+    typedef forward_iterator_tag iterator_category;
+    typedef EntryType value_type;
+    typedef ptrdiff_t difference_type;
+    typedef EntryType* pointer;
+    typedef EntryType& reference;
+
+    Iterator(MapType* map, size_t pos) : map(map), pos(pos) {
+      skip();
+    }
+
+    EntryType& operator*() const {
+      return map->entries[pos];
+    }
+
+    EntryType* operator->() const {
+      return &map->entries[pos];
+    }
+
+    Iterator& operator++() {
+      ++pos;
+      skip();
+      return *this;
+    }
+
+    bool operator==(const Iterator& other) const {
+      return pos == other.pos;
+    }
+
+    bool operator!=(const Iterator& other) const {
+      return pos != other.pos;
+    }
+
+   private:
+    void skip() {
+      while (pos < map->capacity() && !map->isOccupied(pos)) {
+        ++pos;
+      }
+    }
+
+    MapType* map;
+    size_t pos;
+  };
+
+ public:
+  typedef Iterator<FlatHashMap, value_type> iterator;
+  typedef Iterator<const FlatHashMap, const value_type> const_iterator;
+
+  FlatHashMap() : numEntries(0), generation(1), mask(0) {}
+
+  iterator begin() {
+    return iterator(this, 0);
+  }
+
+  iterator end() {
+    return iterator(this, capacity());
+  }
+
+  const_iterator begin() const {
+    return const_iterator(this, 0);
+  }
+
+  const_iterator end() const {
+    return const_iterator(this, capacity());
+  }
+
+  iterator find(const Key& key) {
+    return iterator(this, findPosition(key));
+  }
+
+  const_iterator find(const Key& key) const {
+    return const_iterator(this, findPosition(key));
+  }
+
+  Value& at(const Key& key) {
+    size_t pos = findPosition(key);
+    if (pos == capacity()) {
+      throw out_of_range("FlatHashMap::at");
+    }
+    return entries[pos].second;
+  }
+
+  const Value& at(const Key& key) const {
+    size_t pos = findPosition(key);
+    if (pos == capacity()) {
+      throw out_of_range("FlatHashMap::at");
+    }
+    return entries[pos].second;
+  }
+
+  Value& operator[](const Key& key) {
+    return insert(make_pair(key, Value())).first->second;
+  }
+
+  /**
+   * Inserts the entry only if the key is not already in the map. Returns the
+   * position of the key and whether the insertion took place.
+   */
+  pair<iterator, bool> insert(const value_type& entry) {
+    if (2 * (numEntries + 1) > capacity()) {
+      rehash(capacity() ? 2 * capacity() : MIN_CAPACITY);
+    }
+
+    size_t pos = getSlot(entry.first);
+    for (; isOccupied(pos); pos = (pos + 1) & mask) {
+      if (entries[pos].first == entry.first) {
+        return make_pair(iterator(this, pos), false);
+      }
+    }
+
+    generations[pos] = generation;
+    entries[pos] = entry;
+    ++numEntries;
+    return make_pair(iterator(this, pos), true);
+  }
+
+  size_t size() const {
+    return numEntries;
+  }
+
+  bool empty() const {
+    return numEntries == 0;
+  }
+
+  size_t capacity() const {
+    return generations.size();
+  }
+
+  /**
+   * Returns the size of the table in bytes (excluding any memory owned by the
+   * keys and the values).
+   */
+  size_t memoryUsage() const {
+    return generations.capacity() * sizeof(unsigned int)
+        + entries.capacity() * sizeof(value_type);
+  }
+
+  /**
+   * Makes room for num_entries entries without rehashing.
+   */
+  void reserve(size_t num_entries) {
+    size_t new_capacity = MIN_CAPACITY;
+    while (new_capacity < 2 * num_entries) {
+      new_capacity <<= 1;
+    }
+
+    if (new_capacity > capacity()) {
+      rehash(new_capacity);
+    }
+  }
+
+  /**
+   * Empties the map in constant time. The capacity is preserved.
+   */
+  void clear() {
+    numEntries = 0;
+    if (++generation == 0) {
+      // The generation counter wrapped around, so stale tags may now look
+      // live. Reset them explicitly (once every 2^32 calls).
+      fill(generations.begin(), generations.end(), 0);
+      generation = 1;
+    }
+  }
+
+  bool operator==(const FlatHashMap& other) const {
+    if (numEntries != other.numEntries) {
+      return false;
+    }
+
+    for (const auto& entry: *this) {
+      auto it = other.find(entry.first);
+      if (it == other.end() || !(it->second == entry.second)) {
+        return false;
+      }
+    }
+
+    return true;
+  }
+
+  bool operator!=(const FlatHashMap& other) const {
+    return !(*this == other);
+  }
+
+ private:
+  bool isOccupied(size_t pos) const {
+    return generations[pos] == generation;
+  }
+
+  size_t getSlot(const Key& key) const {
+    // The standard hash for integer keys is the identity function. Mix the
+    // bits so that runs of consecutive keys do not form long probe sequences.
+    uint64_t h = hashFunction(key);
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    return h & mask;
+  }
+
+  size_t findPosition(const Key& key) const {
+    if (numEntries == 0) {
+      return capacity();
+    }
+
+    for (size_t pos = getSlot(key); isOccupied(pos); pos = (pos + 1) & mask) {
+      if (entries[pos].first == key) {
+        return pos;
+      }
+    }
+
+    return capacity();
+  }
+
+  void rehash(size_t new_capacity) {
+    vector<unsigned int> old_generations(new_capacity, 0);
+    vector<value_type> old_entries(new_capacity);
+    old_generations.swap(generations);
+    old_entries.swap(entries);
+    mask = new_capacity - 1;
+
+    unsigned int old_generation = generation;
+    generation = 1;
+    numEntries = 0;
+    for (size_t i = 0; i < old_generations.size(); ++i) {
+      if (old_generations[i] == old_generation) {
+        size_t pos = getSlot(old_entries[i].first);
+        while (isOccupied(pos)) {
+          pos = (pos + 1) & mask;
+        }
+        generations[pos] = generation;
+        entries[pos] = move(old_entries[i]);
+        ++numEntries;
+      }
+    }
+  }
+
+  friend class boost::serialization::access;
+
+  template<class Archive>
+  void save(Archive& ar, const unsigned int version) const {
+    size_t num_entries = numEntries;
+    ar << num_entries;
+    for (const auto& entry: *this) {
+      ar << entry.first;
+      ar << entry.second;
+    }
+  }
+
+  template<class Archive>
+  void load(Archive& ar, const unsigned int version) {
+    size_t num_entries;
+    ar >> num_entries;
+    clear();
+    reserve(num_entries);
+    for (size_t i = 0; i < num_entries; ++i) {
+      value_type entry;
+      ar >> entry.first;
+      ar >> entry.second;
+      insert(entry);
+    }
+  }
+
+  BOOST_SERIALIZATION_SPLIT_MEMBER();
+
+  static const size_t MIN_CAPACITY = 16;
+
+  Hash hashFunction;
+  vector<unsigned int> generations;
+  vector<value_type> entries;
+  size_t numEntries;
+  unsigned int generation;
+  size_t mask;
+};
+
+} // namespace oxlm
@@ -1,5 +1,6 @@
 #include "lbl/global_collision_space.h"
 
+#include "lbl/operators.h"
 #include "utils/constants.h"
 
 namespace oxlm {
@@ -28,6 +29,22 @@ bool GlobalCollisionSpace::operator==(const GlobalCollisionSpace& other) const {
   }
 }
 
+size_t GlobalCollisionSpace::prune(Real threshold, Real shrinkage) {
+  CwiseShrinkOp<Real> op(shrinkage);
+  size_t num_weights = 0;
+  for (int i = 0; i < hashSpaceSize; ++i) {
+    Real value = op(featureWeights[i]);
+    featureWeights[i] = fabs(value) >= threshold ? value : 0;
+    num_weights += featureWeights[i] != 0;
+  }
+
+  return num_weights;
+}
+
+size_t GlobalCollisionSpace::memoryUsage() const {
+  return hashSpaceSize * sizeof(Real);
+}
+
 void GlobalCollisionSpace::deepCopy(const GlobalCollisionSpace& other) {
   hashSpaceSize = other.hashSpaceSize;
 
@@ -20,6 +20,15 @@ class GlobalCollisionSpace {
 
   bool operator==(const GlobalCollisionSpace& other) const;
 
+  /**
+   * Shrinks every weight towards 0 by shrinkage and sets the weights whose
+   * absolute value is below threshold to 0 afterwards. Returns the number of
+   * non-zero weights left. The size of the space does not change.
+   */
+  size_t prune(Real threshold, Real shrinkage);
+
+  size_t memoryUsage() const;
+
   virtual ~GlobalCollisionSpace();
 
  private:
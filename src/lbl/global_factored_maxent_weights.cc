@@ -4,12 +4,15 @@
 
 #include <boost/make_shared.hpp>
 
+#include "lbl/blocked_bloom_filter.h"
 #include "lbl/bloom_filter.h"
 #include "lbl/bloom_filter_populator.h"
 #include "lbl/class_context_extractor.h"
 #include "lbl/class_context_hasher.h"
+#include "lbl/compact_filter_populator.h"
 #include "lbl/collision_global_feature_store.h"
 #include "lbl/feature_approximate_filter.h"
+#include "lbl/feature_compact_filter.h"
 #include "lbl/feature_context_mapper.h"
 #include "lbl/feature_exact_filter.h"
 #include "lbl/feature_filter.h"
@@ -25,8 +28,9 @@ GlobalFactoredMaxentWeights::GlobalFactoredMaxentWeights() {}
 
 GlobalFactoredMaxentWeights::GlobalFactoredMaxentWeights(
     const boost::shared_ptr<ModelData>& config,
-    const boost::shared_ptr<FactoredMaxentMetadata>& metadata)
-    : FactoredWeights(config, metadata), metadata(metadata) {
+    const boost::shared_ptr<FactoredMaxentMetadata>& metadata,
+    bool row_wise_adagrad)
+    : FactoredWeights(config, metadata, row_wise_adagrad), metadata(metadata) {
   initialize();
 }
 
@@ -44,6 +48,8 @@ void GlobalFactoredMaxentWeights::initialize() {
   boost::shared_ptr<FeatureContextMapper> mapper = metadata->getMapper();
   boost::shared_ptr<BloomFilterPopulator> populator = metadata->getPopulator();
   boost::shared_ptr<FeatureMatcher> matcher = metadata->getMatcher();
+  boost::shared_ptr<CompactFilterPopulator> compact_populator =
+      metadata->getCompactPopulator();
 
   if (config->hash_space) {
     boost::shared_ptr<GlobalCollisionSpace> space =
@@ -52,12 +58,21 @@ void GlobalFactoredMaxentWeights::initialize() {
         boost::make_shared<ClassContextHasher>(config->hash_space);
     GlobalFeatureIndexesPairPtr feature_indexes_pair;
     boost::shared_ptr<BloomFilter<NGram>> bloom_filter;
+    boost::shared_ptr<BlockedBloomFilter<NGram>> blocked_bloom_filter;
     boost::shared_ptr<FeatureFilter> filter;
     if (config->filter_contexts) {
-      if (config->filter_error_rate > 0) {
-        bloom_filter = populator->get();
-        filter = boost::make_shared<FeatureApproximateFilter>(
-            num_classes, hasher, bloom_filter);
+      if (config->compact_filter) {
+        filter = compact_populator->getClassFilter();
+      } else if (config->filter_error_rate > 0) {
+        if (config->blocked_bloom_filter) {
+          blocked_bloom_filter = populator->getBlocked();
+          filter = boost::make_shared<FeatureApproximateFilter>(
+              num_classes, hasher, blocked_bloom_filter);
+        } else {
+          bloom_filter = populator->get();
+          filter = boost::make_shared<FeatureApproximateFilter>(
+              num_classes, hasher, bloom_filter);
+        }
       } else {
         feature_indexes_pair = matcher->getGlobalFeatures();
         filter = boost::make_shared<FeatureExactFilter>(
@@ -76,9 +91,16 @@ void GlobalFactoredMaxentWeights::initialize() {
       int class_size = index->getClassSize(i);
       hasher = boost::make_shared<WordContextHasher>(i, config->hash_space);
       if (config->filter_contexts) {
-        if (config->filter_error_rate) {
-          filter = boost::make_shared<FeatureApproximateFilter>(
-              class_size, hasher, bloom_filter);
+        if (config->compact_filter) {
+          filter = compact_populator->getWordFilter(i);
+        } else if (config->filter_error_rate) {
+          if (config->blocked_bloom_filter) {
+            filter = boost::make_shared<FeatureApproximateFilter>(
+                class_size, hasher, blocked_bloom_filter);
+          } else {
+            filter = boost::make_shared<FeatureApproximateFilter>(
+                class_size, hasher, bloom_filter);
+          }
         } else {
           filter = boost::make_shared<FeatureExactFilter>(
               feature_indexes_pair->getWordIndexes(i),
@@ -108,8 +130,32 @@ void GlobalFactoredMaxentWeights::initialize() {
 }
 
 size_t GlobalFactoredMaxentWeights::numParameters() const {
-  // TODO: Count parameters in feature stores.
-  return FactoredWeights::numParameters();
+  size_t num_parameters = FactoredWeights::numParameters();
+  if (config->hash_space) {
+    // The class and word stores share the same collision space.
+    num_parameters += config->hash_space;
+  } else {
+    num_parameters += SparseGlobalFeatureStore::cast(U)->getNumFeatures();
+    for (const auto& store: V) {
+      num_parameters += SparseGlobalFeatureStore::cast(store)->getNumFeatures();
+    }
+  }
+
+  return num_parameters;
+}
+
+void GlobalFactoredMaxentWeights::reportMemory(MemoryReport& report) const {
+  FactoredWeights::reportMemory(report);
+  report.add("U", U->memoryUsage());
+  size_t V_size = 0;
+  for (const auto& store: V) {
+    V_size += store->memoryUsage();
+  }
+  report.add("V", V_size);
+  if (config->hash_space) {
+    report.add("collision space",
+        CollisionGlobalFeatureStore::cast(U)->getSpace()->memoryUsage());
+  }
 }
 
 void GlobalFactoredMaxentWeights::getProbabilities(
@@ -122,16 +168,28 @@ void GlobalFactoredMaxentWeights::getProbabilities(
   class_probs = S.transpose() * forward_weights.back() + T * MatrixReal::Ones(1, indices.size());
 
   for (size_t i = 0; i < indices.size(); ++i) {
-    int word_id = corpus->at(indices[i]);
-    int class_id = index->getClass(word_id);
-
-    VectorReal prediction_vector = forward_weights.back().col(i);
     VectorReal class_scores = class_probs.col(i) + U->get(contexts[i]);
     class_probs.col(i) = softMax(class_scores);
+  }
+
+  int word_width = config->word_representation_size;
+  word_probs.resize(indices.size());
+  for (const auto& group: getClassGroups(corpus, indices)) {
+    int class_id = group.first;
+    const vector<int>& positions = group.second;
 
-    VectorReal word_scores = classR(class_id).transpose() * prediction_vector +
-                             classB(class_id) + V[class_id]->get(contexts[i]);
-    word_probs.push_back(softMax(word_scores));
+    MatrixReal prediction_vectors(word_width, positions.size());
+    for (size_t j = 0; j < positions.size(); ++j) {
+      prediction_vectors.col(j) = forward_weights.back().col(positions[j]);
+    }
+
+    MatrixReal word_scores = classR(class_id).transpose() * prediction_vectors;
+    word_scores.colwise() += classB(class_id);
+    for (size_t j = 0; j < positions.size(); ++j) {
+      VectorReal scores =
+          word_scores.col(j) + V[class_id]->get(contexts[positions[j]]);
+      word_probs[positions[j]] = softMax(scores);
+    }
   }
 }
 
@@ -241,13 +299,136 @@ bool GlobalFactoredMaxentWeights::checkGradientStore(
   return true;
 }
 
+void GlobalFactoredMaxentWeights::estimateProjectionGradient(
+    const boost::shared_ptr<Corpus>& corpus,
+    const vector<int>& indices,
+    const vector<vector<int>>& contexts,
+    const vector<MatrixReal>& forward_weights,
+    const boost::shared_ptr<MinibatchFactoredMaxentWeights>& gradient,
+    MatrixReal& backward_weights,
+    Real& log_likelihood,
+    MinibatchWords& words) const {
+  int noise_samples = config->noise_samples;
+  int word_width = config->word_representation_size;
+  Real log_num_samples = log(noise_samples);
+  VectorReal unigram = metadata->getUnigram();
+  VectorReal class_unigram = metadata->getClassBias().array().exp();
+  vector<vector<int>> noise_words = getNoiseWords(corpus, indices);
+  vector<vector<int>> noise_classes = getNoiseClasses(corpus, indices);
+
+  for (size_t i = 0; i < indices.size(); ++i) {
+    words.addOutputWord(corpus->at(indices[i]));
+    for (int word_id: noise_words[i]) {
+      words.addOutputWord(word_id);
+    }
+  }
+
+  // Same as FactoredWeights::estimateProjectionGradient, except that the
+  // scores of the target and noise samples also include the maxent feature
+  // weights. Only the features of the sampled classes and words are updated in
+  // the minibatch feature stores.
+  const MatrixReal& prediction_vectors = forward_weights.back();
+  backward_weights = MatrixReal::Zero(word_width, indices.size());
+  for (size_t i = 0; i < indices.size(); ++i) {
+    const vector<int>& context = contexts[i];
+    int word_id = corpus->at(indices[i]);
+    int class_id = index->getClass(word_id);
+    int word_class_id = index->getWordIndexInClass(word_id);
+
+    Real log_score = R.col(word_id).dot(prediction_vectors.col(i))
+        + B(word_id) + V[class_id]->getValue(word_class_id, context);
+    Real log_noise = log_num_samples + log(unigram(word_id));
+    Real log_norm = LogAdd(log_score, log_noise);
+
+    log_likelihood -= log_score - log_norm;
+
+    Real prob = exp(log_noise - log_norm);
+    assert(prob <= numeric_limits<Real>::max());
+    backward_weights.col(i) -= prob * R.col(word_id);
+
+    gradient->R.col(word_id) -= prob * prediction_vectors.col(i);
+    gradient->B(word_id) -= prob;
+    gradient->V[class_id]->updateValue(word_class_id, context, -prob);
+
+    for (int noise_word_id: noise_words[i]) {
+      int noise_word_class_id = index->getWordIndexInClass(noise_word_id);
+      Real log_score = R.col(noise_word_id).dot(prediction_vectors.col(i))
+          + B(noise_word_id)
+          + V[class_id]->getValue(noise_word_class_id, context);
+      Real log_noise = log_num_samples + log(unigram(noise_word_id));
+      Real log_norm = LogAdd(log_score, log_noise);
+
+      log_likelihood -= log_noise - log_norm;
+
+      Real prob = exp(log_score - log_norm);
+      assert(prob <= numeric_limits<Real>::max());
+      backward_weights.col(i) += prob * R.col(noise_word_id);
+
+      gradient->R.col(noise_word_id) += prob * prediction_vectors.col(i);
+      gradient->B(noise_word_id) += prob;
+      gradient->V[class_id]->updateValue(noise_word_class_id, context, prob);
+    }
+
+    log_score = S.col(class_id).dot(prediction_vectors.col(i))
+        + T(class_id) + U->getValue(class_id, context);
+    log_noise = log_num_samples + log(class_unigram(class_id));
+    log_norm = LogAdd(log_score, log_noise);
+
+    log_likelihood -= log_score - log_norm;
+
+    prob = exp(log_noise - log_norm);
+    assert(prob <= numeric_limits<Real>::max());
+    backward_weights.col(i) -= prob * S.col(class_id);
+
+    gradient->S.col(class_id) -= prob * prediction_vectors.col(i);
+    gradient->T(class_id) -= prob;
+    gradient->U->updateValue(class_id, context, -prob);
+
+    for (int noise_class_id: noise_classes[i]) {
+      Real log_score = S.col(noise_class_id).dot(prediction_vectors.col(i))
+          + T(noise_class_id) + U->getValue(noise_class_id, context);
+      Real log_noise = log_num_samples + log(class_unigram(noise_class_id));
+      Real log_norm = LogAdd(log_score, log_noise);
+
+      log_likelihood -= log_noise - log_norm;
+
+      Real prob = exp(log_score - log_norm);
+      assert(prob <= numeric_limits<Real>::max());
+      backward_weights.col(i) += prob * S.col(noise_class_id);
+
+      gradient->S.col(noise_class_id) += prob * prediction_vectors.col(i);
+      gradient->T(noise_class_id) += prob;
+      gradient->U->updateValue(noise_class_id, context, prob);
+    }
+  }
+}
+
 void GlobalFactoredMaxentWeights::estimateGradient(
     const boost::shared_ptr<Corpus>& corpus,
     const vector<int>& indices,
     const boost::shared_ptr<MinibatchFactoredMaxentWeights>& gradient,
     Real& log_likelihood,
     MinibatchWords& words) const {
-  throw NotImplementedException();
+  vector<vector<int>> contexts;
+  vector<MatrixReal> context_vectors;
+  getContextVectors(corpus, indices, contexts, context_vectors);
+
+  setContextWords(contexts, words);
+
+  vector<MatrixReal> forward_weights =
+      propagateForwards(indices, context_vectors);
+
+  MatrixReal backward_weights;
+  estimateProjectionGradient(
+      corpus, indices, contexts, forward_weights, gradient,
+      backward_weights, log_likelihood, words);
+
+  backward_weights.array() *=
+      activationDerivative(config, forward_weights.back());
+  propagateBackwards(forward_weights, backward_weights, gradient);
+
+  getContextGradient(
+      indices, contexts, context_vectors, backward_weights, gradient);
 }
 
 void GlobalFactoredMaxentWeights::updateSquared(
@@ -306,6 +487,20 @@ Real GlobalFactoredMaxentWeights::regularizerUpdate(
   return ret;
 }
 
+void GlobalFactoredMaxentWeights::trackUpdates(
+    const MinibatchWords& global_words,
+    const boost::shared_ptr<MinibatchFactoredMaxentWeights>& global_gradient,
+    ParameterUpdates& updates) const {
+  FactoredWeights::trackUpdates(global_words, global_gradient, updates);
+
+  updates.featureEntries.resize(V.size() + 1);
+  U->getUpdatedEntries(global_gradient->U, updates.featureEntries[0]);
+  for (size_t i = 0; i < V.size(); ++i) {
+    V[i]->getUpdatedEntries(
+        global_gradient->V[i], updates.featureEntries[i + 1]);
+  }
+}
+
 Real GlobalFactoredMaxentWeights::getLogProb(
     int word_id, vector<int> context) const {
   int class_id = index->getClass(word_id);
@@ -359,6 +554,36 @@ Real GlobalFactoredMaxentWeights::getUnnormalizedScore(
   return class_score + word_score;
 }
 
+size_t GlobalFactoredMaxentWeights::prune(Real threshold, Real shrinkage) {
+  size_t num_weights = 0;
+  if (config->hash_space) {
+    // The class and word stores share the same collision space.
+    num_weights = CollisionGlobalFeatureStore::cast(U)->getSpace()->prune(
+        threshold, shrinkage);
+  } else {
+    boost::shared_ptr<SparseGlobalFeatureStore> class_store =
+        SparseGlobalFeatureStore::cast(U);
+    num_weights += class_store->prune(threshold, shrinkage);
+    vector<GlobalFeatureIndexesPtr> word_indexes;
+    for (const auto& store: V) {
+      boost::shared_ptr<SparseGlobalFeatureStore> word_store =
+          SparseGlobalFeatureStore::cast(store);
+      num_weights += word_store->prune(threshold, shrinkage);
+      word_indexes.push_back(word_store->getContextFeatureIndexes());
+    }
+
+    // The minibatch stores are built from the global feature indexes, so the
+    // dropped features are removed from them as well. Otherwise, training the
+    // pruned model further would update features missing from the stores.
+    metadata->getMatcher()->setGlobalFeatures(
+        boost::make_shared<GlobalFeatureIndexesPair>(
+            class_store->getContextFeatureIndexes(), word_indexes));
+  }
+
+  clearCache();
+  return num_weights;
+}
+
 bool GlobalFactoredMaxentWeights::operator==(
     const GlobalFactoredMaxentWeights& other) const {
   if (V.size() != other.V.size()) {
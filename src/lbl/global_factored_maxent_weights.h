@@ -15,7 +15,8 @@ class GlobalFactoredMaxentWeights : public FactoredWeights {
 
   GlobalFactoredMaxentWeights(
       const boost::shared_ptr<ModelData>& config,
-      const boost::shared_ptr<FactoredMaxentMetadata>& metadata);
+      const boost::shared_ptr<FactoredMaxentMetadata>& metadata,
+      bool row_wise_adagrad = false);
 
   GlobalFactoredMaxentWeights(
       const boost::shared_ptr<ModelData>& config,
@@ -24,6 +25,8 @@ class GlobalFactoredMaxentWeights : public FactoredWeights {
 
   virtual size_t numParameters() const;
 
+  virtual void reportMemory(MemoryReport& report) const;
+
   virtual void getProbabilities(
       const boost::shared_ptr<Corpus>& corpus,
       const vector<int>& indices,
@@ -76,13 +79,72 @@ class GlobalFactoredMaxentWeights : public FactoredWeights {
       const boost::shared_ptr<MinibatchFactoredMaxentWeights>& global_gradient,
       Real minibatch_factor);
 
+  void trackUpdates(
+      const MinibatchWords& global_words,
+      const boost::shared_ptr<MinibatchFactoredMaxentWeights>& global_gradient,
+      ParameterUpdates& updates) const;
+
+  /**
+   * Only the updated entries of the feature stores are written.
+   */
+  template<class Archive>
+  void saveDelta(Archive& ar, const ParameterUpdates& updates) const {
+    FactoredWeights::saveDelta(ar, updates);
+
+    for (size_t i = 0; i <= V.size(); ++i) {
+      const auto& store = i == 0 ? U : V[i - 1];
+      vector<int> entries;
+      if (i < updates.featureEntries.size()) {
+        entries = ParameterUpdates::sorted(updates.featureEntries[i]);
+      }
+      vector<Real> values = store->getEntries(entries);
+      ar << entries;
+      ar << values;
+    }
+  }
+
+  template<class Archive>
+  void loadDelta(Archive& ar, const vector<Real>& regularizer_sigmas) {
+    FactoredWeights::loadDelta(ar, regularizer_sigmas);
+
+    for (size_t i = 0; i <= V.size(); ++i) {
+      const auto& store = i == 0 ? U : V[i - 1];
+      vector<int> entries;
+      vector<Real> values;
+      ar >> entries;
+      ar >> values;
+      store->setEntries(entries, values);
+    }
+  }
+
   virtual Real getLogProb(int word_id, vector<int> context) const;
 
   virtual Real getUnnormalizedScore(int word, const vector<int>& context) const;
 
+  /**
+   * Prunes the maxent feature weights of a trained model: every weight is
+   * shrunk towards 0 by shrinkage (L1 style) and the features whose absolute
+   * weight is below threshold are dropped. Sparse feature stores and the
+   * global feature indexes are rebuilt without the dropped features, so the
+   * pruned model can still be trained. In the collision space, the dropped
+   * weights are only set to 0 (the size of the space does not change). Returns
+   * the number of maxent weights left.
+   */
+  size_t prune(Real threshold, Real shrinkage);
+
   bool operator==(const GlobalFactoredMaxentWeights& other) const;
 
  protected:
+  void estimateProjectionGradient(
+      const boost::shared_ptr<Corpus>& corpus,
+      const vector<int>& indices,
+      const vector<vector<int>>& contexts,
+      const vector<MatrixReal>& forward_weights,
+      const boost::shared_ptr<MinibatchFactoredMaxentWeights>& gradient,
+      MatrixReal& backward_weights,
+      Real& log_likelihood,
+      MinibatchWords& words) const;
+
   bool checkGradientStore(
       const boost::shared_ptr<Corpus>& corpus,
       const vector<int>& indices,
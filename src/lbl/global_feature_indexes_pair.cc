@@ -2,6 +2,8 @@
 
 #include <boost/make_shared.hpp>
 
+#include "lbl/memory_report.h"
+
 namespace oxlm {
 
 GlobalFeatureIndexesPair::GlobalFeatureIndexesPair() {}
@@ -17,6 +19,11 @@ GlobalFeatureIndexesPair::GlobalFeatureIndexesPair(
   }
 }
 
+GlobalFeatureIndexesPair::GlobalFeatureIndexesPair(
+    const GlobalFeatureIndexesPtr& class_indexes,
+    const vector<GlobalFeatureIndexesPtr>& word_indexes)
+    : classIndexes(class_indexes), wordIndexes(word_indexes) {}
+
 GlobalFeatureIndexesPtr GlobalFeatureIndexesPair::getClassIndexes() const {
   return classIndexes;
 }
@@ -25,6 +32,20 @@ GlobalFeatureIndexesPtr GlobalFeatureIndexesPair::getWordIndexes(int class_id) c
   return wordIndexes[class_id];
 }
 
+size_t GlobalFeatureIndexesPair::memoryUsage() const {
+  size_t bytes = 0;
+  for (const auto& feature_indexes: wordIndexes) {
+    for (const auto& indexes: *feature_indexes) {
+      bytes += MemoryReport::getContainerBytes(indexes);
+    }
+  }
+  for (const auto& indexes: *classIndexes) {
+    bytes += MemoryReport::getContainerBytes(indexes);
+  }
+
+  return bytes;
+}
+
 vector<int> GlobalFeatureIndexesPair::getClassFeatures(
     int feature_context_id) const {
   return classIndexes->at(feature_context_id);
@@ -53,4 +74,20 @@ void GlobalFeatureIndexesPair::addWordIndex(
   }
 }
 
+void GlobalFeatureIndexesPair::merge(const GlobalFeatureIndexesPair& other) {
+  for (size_t i = 0; i < other.classIndexes->size(); ++i) {
+    for (int class_id: other.classIndexes->at(i)) {
+      addClassIndex(i, class_id);
+    }
+  }
+
+  for (size_t i = 0; i < other.wordIndexes.size(); ++i) {
+    for (size_t j = 0; j < other.wordIndexes[i]->size(); ++j) {
+      for (int word_class_id: other.wordIndexes[i]->at(j)) {
+        addWordIndex(i, j, word_class_id);
+      }
+    }
+  }
+}
+
 } // namespace oxlm
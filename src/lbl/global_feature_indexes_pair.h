@@ -18,10 +18,16 @@ class GlobalFeatureIndexesPair {
       const boost::shared_ptr<WordToClassIndex>& index,
       const boost::shared_ptr<FeatureContextMapper>& mapper);
 
+  GlobalFeatureIndexesPair(
+      const GlobalFeatureIndexesPtr& class_indexes,
+      const vector<GlobalFeatureIndexesPtr>& word_indexes);
+
   GlobalFeatureIndexesPtr getClassIndexes() const;
 
   GlobalFeatureIndexesPtr getWordIndexes(int class_id) const;
 
+  size_t memoryUsage() const;
+
   vector<int> getClassFeatures(int feature_context_id) const;
 
   vector<int> getWordFeatures(
@@ -32,6 +38,11 @@ class GlobalFeatureIndexesPair {
   void addWordIndex(
       int class_id, int feature_context_id, int word_class_id);
 
+  /**
+   * Appends the feature indexes of other that are missing from this pair.
+   */
+  void merge(const GlobalFeatureIndexesPair& other);
+
  private:
   friend class boost::serialization::access;
 
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <unordered_set>
+
 #include "lbl/feature_store.h"
 #include "lbl/minibatch_feature_store.h"
 
@@ -30,6 +32,27 @@ class GlobalFeatureStore : virtual public FeatureStore {
 
   virtual void updateFeature(const pair<int, int>& index, Real value) = 0;
 
+  /**
+   * Adds the entries of the store updated with the minibatch store to
+   * entries. An entry is a feature context for sparse stores and a position
+   * in the collision space for collision stores.
+   */
+  virtual void getUpdatedEntries(
+      const boost::shared_ptr<MinibatchFeatureStore>& base_minibatch_store,
+      unordered_set<int>& entries) const = 0;
+
+  /**
+   * Returns the weights of the given entries, concatenated.
+   */
+  virtual vector<Real> getEntries(const vector<int>& entries) const = 0;
+
+  /**
+   * Overwrites the weights of the given entries with values returned by
+   * getEntries.
+   */
+  virtual void setEntries(
+      const vector<int>& entries, const vector<Real>& values) = 0;
+
   virtual ~GlobalFeatureStore();
 
   virtual bool operator==(const boost::shared_ptr<GlobalFeatureStore>& other) const = 0;
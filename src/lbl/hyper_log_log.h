@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "lbl/utils.h"
+
+using namespace std;
+
+namespace oxlm {
+
+/**
+ * HyperLogLog sketch estimating the number of distinct items in a stream.
+ *
+ * Each item is hashed to 64 bits: the first precision bits select one of the
+ * 2^precision registers, and the register keeps the maximum position of the
+ * first set bit in the remaining bits. The relative standard error of the
+ * estimate is about 1.04 / sqrt(2^precision).
+ *
+ * Reference: Flajolet et al., HyperLogLog: the analysis of a near-optimal
+ * cardinality estimation algorithm, 2007.
+ */
+template<class T>
+class HyperLogLog {
+ public:
+  HyperLogLog() {}
+
+  HyperLogLog(int precision)
+      : precision(precision), registers(1 << precision, 0) {
+    assert(4 <= precision && precision <= 18);
+  }
+
+  void increment(const T& item) {
+    uint64_t key = hashFunction(item);
+    size_t index = key >> (64 - precision);
+    // Set the lowest bit so that the rank is at most 64 - precision + 1.
+    uint64_t rest = (key << precision) | (1ULL << (precision - 1));
+    uint8_t rank = __builtin_clzll(rest) + 1;
+    registers[index] = max(registers[index], rank);
+  }
+
+  /**
+   * Adds the items of a sketch with the same precision.
+   */
+  void merge(const HyperLogLog<T>& other) {
+    assert(precision == other.precision);
+    for (size_t i = 0; i < registers.size(); ++i) {
+      registers[i] = max(registers[i], other.registers[i]);
+    }
+  }
+
+  double estimate() const {
+    double num_registers = registers.size();
+    double sum = 0;
+    int num_zeros = 0;
+    for (uint8_t rank: registers) {
+      sum += ldexp(1.0, -rank);
+      num_zeros += rank == 0;
+    }
+
+    double alpha = 0.7213 / (1 + 1.079 / num_registers);
+    double estimate = alpha * num_registers * num_registers / sum;
+    if (estimate <= 2.5 * num_registers && num_zeros > 0) {
+      // Small range correction (linear counting).
+      estimate = num_registers * log(num_registers / num_zeros);
+    }
+
+    return estimate;
+  }
+
+ private:
+  int precision;
+  hash<T> hashFunction;
+  vector<uint8_t> registers;
+};
+
+} // namespace oxlm
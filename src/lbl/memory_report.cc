@@ -0,0 +1,49 @@
+#include "lbl/memory_report.h"
+
+#include <iomanip>
+
+namespace oxlm {
+
+void MemoryReport::add(const string& component, size_t bytes) {
+  components.push_back(make_pair(component, bytes));
+}
+
+void MemoryReport::add(
+    const string& prefix, const MemoryReport& other, size_t copies) {
+  for (const auto& component: other.components) {
+    add(prefix + component.first, copies * component.second);
+  }
+}
+
+size_t MemoryReport::getBytes(const string& prefix) const {
+  size_t bytes = 0;
+  for (const auto& component: components) {
+    if (component.first.compare(0, prefix.size(), prefix) == 0) {
+      bytes += component.second;
+    }
+  }
+
+  return bytes;
+}
+
+size_t MemoryReport::getTotalBytes() const {
+  return getBytes("");
+}
+
+void MemoryReport::print(ostream& out) const {
+  size_t total_bytes = getTotalBytes();
+  out << "===============================" << endl;
+  out << " Memory usage: " << endl;
+  out << fixed << setprecision(1);
+  for (const auto& component: components) {
+    out << "  " << component.first << " = " << component.second / 1048576.0
+        << " MB (" << (total_bytes ? 100.0 * component.second / total_bytes : 0)
+        << "%)" << endl;
+  }
+  out << "  Total = " << total_bytes / 1048576.0 << " MB" << endl;
+  out.unsetf(ios_base::floatfield);
+  out << setprecision(6);
+  out << "===============================" << endl;
+}
+
+} // namespace oxlm
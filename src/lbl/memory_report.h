@@ -0,0 +1,47 @@
+#pragma once
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace oxlm {
+
+/**
+ * Breakdown of the memory used by a model (and its training state) per
+ * component.
+ *
+ * The sizes are estimates: they count the payload of the underlying arrays
+ * and containers (using their capacity), but not the allocator overhead or
+ * the small fixed size members.
+ */
+class MemoryReport {
+ public:
+  void add(const string& component, size_t bytes);
+
+  /**
+   * Adds the components of other, prefixed by prefix. The sizes are
+   * multiplied by copies (e.g. for the per thread gradients).
+   */
+  void add(const string& prefix, const MemoryReport& other, size_t copies = 1);
+
+  /**
+   * Returns the total size of the components whose names start with prefix.
+   */
+  size_t getBytes(const string& prefix) const;
+
+  size_t getTotalBytes() const;
+
+  void print(ostream& out) const;
+
+  template<class Container>
+  static size_t getContainerBytes(const Container& container) {
+    return container.capacity() * sizeof(typename Container::value_type);
+  }
+
+ private:
+  vector<pair<string, size_t>> components;
+};
+
+} // namespace oxlm
@@ -0,0 +1,70 @@
+#include <iostream>
+
+#include <boost/program_options.hpp>
+
+#include "lbl/model.h"
+
+using namespace boost::program_options;
+using namespace oxlm;
+using namespace std;
+
+template<class Model>
+void merge(const string& checkpoint_file, const string& model_file) {
+  Model model;
+  model.loadFromCheckpoint(checkpoint_file);
+  model.getConfig()->model_output_file = model_file;
+  model.save();
+}
+
+/**
+ * Applies the delta checkpoints to the last full checkpoint and writes the
+ * resulting model, which can be used like any other trained model.
+ */
+int main(int argc, char** argv) {
+  options_description desc("Command line options");
+  desc.add_options()
+      ("help,h", "Print help message.")
+      ("checkpoint,c", value<string>()->required(),
+          "File containing the full checkpoint. The delta checkpoints are "
+          "read from <checkpoint>.deltas.")
+      ("type,t", value<int>()->required(), "Model type")
+      ("model-out,o", value<string>()->required(),
+          "File where the model is written.");
+
+  variables_map vm;
+  store(parse_command_line(argc, argv, desc), vm);
+
+  if (vm.count("help")) {
+    cout << desc << endl;
+    return 0;
+  }
+
+  notify(vm);
+
+  string checkpoint_file = vm["checkpoint"].as<string>();
+  string model_file = vm["model-out"].as<string>();
+  ModelType model_type = static_cast<ModelType>(vm["type"].as<int>());
+
+  switch (model_type) {
+    case NLM:
+      merge<LM>(checkpoint_file, model_file);
+      return 0;
+    case FACTORED_NLM:
+      merge<FactoredLM>(checkpoint_file, model_file);
+      return 0;
+    case FACTORED_MAXENT_NLM:
+      merge<FactoredMaxentLM>(checkpoint_file, model_file);
+      return 0;
+    case SOURCE_FACTORED_NLM:
+      merge<SourceFactoredLM>(checkpoint_file, model_file);
+      return 0;
+    case FACTORED_TREE_NLM:
+      merge<FactoredTreeLM>(checkpoint_file, model_file);
+      return 0;
+    default:
+      cout << "Unknown model type" << endl;
+      return 1;
+  }
+
+  return 0;
+}
@@ -31,6 +31,10 @@ VectorReal Metadata::getUnigram() const {
   return unigram;
 }
 
+void Metadata::reportMemory(MemoryReport& report) const {
+  report.add("unigram", unigram.size() * sizeof(Real));
+}
+
 bool Metadata::operator==(const Metadata& other) const {
   return *config == *other.config
       && unigram == other.unigram;
@@ -8,6 +8,7 @@
 #include <boost/shared_ptr.hpp>
 
 #include "lbl/config.h"
+#include "lbl/memory_report.h"
 #include "lbl/utils.h"
 #include "lbl/vocabulary.h"
 #include "lbl/parallel_corpus.h"
@@ -27,6 +28,8 @@ class Metadata {
 
   VectorReal getUnigram() const;
 
+  void reportMemory(MemoryReport& report) const;
+
   bool operator==(const Metadata& other) const;
 
  private:
@@ -0,0 +1,37 @@
+#include "lbl/minibatch_corpus.h"
+
+#include <algorithm>
+
+namespace oxlm {
+
+MinibatchCorpus::MinibatchCorpus(
+    const boost::shared_ptr<Corpus>& training_corpus, int context_width)
+    : Corpus(vector<int>(), training_corpus->getEndId()),
+      trainingCorpus(training_corpus),
+      processor(
+          training_corpus, context_width, 0, training_corpus->getEndId()) {}
+
+void MinibatchCorpus::clear() {
+  data.clear();
+  sentencePositions.clear();
+}
+
+int MinibatchCorpus::add(int position) {
+  // The context is extracted in the order [w_{n-1}, w_{n-2}, ...] and
+  // reversed in place. The words before a sentence start are already replaced
+  // by the start symbol, so no sentence boundaries are copied.
+  int context_width = processor.getContextWidth();
+  size_t offset = data.size();
+  data.resize(offset + context_width + 1);
+  processor.extract(position, &data[offset]);
+  reverse(data.begin() + offset, data.begin() + offset + context_width);
+  data.back() = trainingCorpus->at(position);
+
+  for (int i = 0; i <= context_width; ++i) {
+    sentencePositions.push_back(min(i, MAX_SENTENCE_POSITION));
+  }
+
+  return data.size() - 1;
+}
+
+} // namespace oxlm
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "lbl/context_processor.h"
+#include "lbl/corpus.h"
+
+namespace oxlm {
+
+/**
+ * Copy of the tokens of a minibatch, where every token is preceded by its
+ * context words (the most distant word first). Extracting the context of a
+ * token from this corpus yields the same words as extracting it from the
+ * training corpus, but reads a small contiguous buffer instead of random
+ * positions of the training corpus.
+ *
+ * The memory is reused when the corpus is rebuilt for the next minibatch.
+ */
+class MinibatchCorpus : public Corpus {
+ public:
+  MinibatchCorpus(
+      const boost::shared_ptr<Corpus>& training_corpus, int context_width);
+
+  void clear();
+
+  /**
+   * Appends the token at position in the training corpus and returns its
+   * position in this corpus.
+   */
+  int add(int position);
+
+ private:
+  boost::shared_ptr<Corpus> trainingCorpus;
+  ContextProcessor processor;
+};
+
+} // namespace oxlm
@@ -2,12 +2,15 @@
 
 #include <boost/make_shared.hpp>
 
+#include "lbl/blocked_bloom_filter.h"
 #include "lbl/bloom_filter.h"
 #include "lbl/bloom_filter_populator.h"
 #include "lbl/class_context_extractor.h"
 #include "lbl/class_context_hasher.h"
+#include "lbl/compact_filter_populator.h"
 #include "lbl/collision_minibatch_feature_store.h"
 #include "lbl/feature_approximate_filter.h"
+#include "lbl/feature_compact_filter.h"
 #include "lbl/feature_context_mapper.h"
 #include "lbl/feature_exact_filter.h"
 #include "lbl/feature_filter.h"
@@ -31,85 +34,167 @@ MinibatchFactoredMaxentWeights::MinibatchFactoredMaxentWeights(
   }
 }
 
+void MinibatchFactoredMaxentWeights::reportMemory(MemoryReport& report) const {
+  FactoredWeights::reportMemory(report);
+  // The sparse feature stores are created for every minibatch, the collision
+  // stores are reused.
+  report.add("U", U != nullptr ? U->memoryUsage() : 0);
+  size_t V_size = 0;
+  for (const auto& store: V) {
+    if (store != nullptr) {
+      V_size += store->memoryUsage();
+    }
+  }
+  report.add("V", V_size);
+}
+
+void MinibatchFactoredMaxentWeights::prepare(
+    PreparedMinibatch& minibatch) const {
+  if (!config->hash_space) {
+    minibatch.featureIndexes = metadata->getMatcher()->getMinibatchFeatures(
+        minibatch.corpus, config->feature_context_size, minibatch.indices);
+    // The stores of the previous minibatch prepared in this buffer may still
+    // be used by this gradient, so new stores are built.
+    buildSparseStores(
+        minibatch.featureIndexes, minibatch.classFeatureStore,
+        minibatch.wordFeatureStores);
+    minibatch.featureStoresOwner = this;
+  }
+}
+
 void MinibatchFactoredMaxentWeights::init(
     const boost::shared_ptr<Corpus>& corpus,
     const vector<int>& minibatch_indices) {
   FactoredWeights::init(corpus, minibatch_indices);
 
-  // The number of n-gram weights updated for each minibatch is relatively low
-  // compared to the number of parameters updated in the base (factored)
-  // bilinear model, so it's okay to let a single thread handle this
-  // initialization. Adding parallelization here is not trivial.
-  #pragma omp master
-  {
-    int num_classes = index->getNumClasses();
-    boost::shared_ptr<FeatureContextMapper> mapper = metadata->getMapper();
-    boost::shared_ptr<BloomFilterPopulator> populator =
-        metadata->getPopulator();
-    boost::shared_ptr<FeatureMatcher> matcher = metadata->getMatcher();
-
-    if (config->hash_space) {
-      boost::shared_ptr<FeatureContextHasher> hasher =
-          boost::make_shared<ClassContextHasher>(config->hash_space);
-      // It's fine to use the global feature indexes here because the stores are
-      // not constructed based on these indices. At filtering time, we just want
-      // to know which feature indexes match which contexts.
-      GlobalFeatureIndexesPairPtr feature_indexes_pair;
-      boost::shared_ptr<BloomFilter<NGram>> bloom_filter;
-      boost::shared_ptr<FeatureFilter> filter;
-      if (config->filter_contexts) {
-        if (config->filter_error_rate > 0) {
-          bloom_filter = populator->get();
-          filter = boost::make_shared<FeatureApproximateFilter>(
-              num_classes, hasher, bloom_filter);
-        } else {
-          feature_indexes_pair = matcher->getGlobalFeatures();
-          filter = boost::make_shared<FeatureExactFilter>(
-              feature_indexes_pair->getClassIndexes(),
-              boost::make_shared<ClassContextExtractor>(mapper));
-        }
-      } else {
-        filter = boost::make_shared<FeatureNoOpFilter>(num_classes);
+  MinibatchFeatureIndexesPairPtr minibatch_feature_indexes;
+  if (!config->hash_space) {
+    minibatch_feature_indexes = metadata->getMatcher()->getMinibatchFeatures(
+        corpus, config->feature_context_size, minibatch_indices);
+  }
+  initFeatureStores(minibatch_feature_indexes);
+}
+
+void MinibatchFactoredMaxentWeights::init(const PreparedMinibatch& minibatch) {
+  FactoredWeights::init(minibatch);
+
+  if (minibatch.featureStoresOwner == this) {
+    U = minibatch.classFeatureStore;
+    V = minibatch.wordFeatureStores;
+  } else {
+    initFeatureStores(minibatch.featureIndexes);
+  }
+}
+
+void MinibatchFactoredMaxentWeights::initFeatureStores(
+    const MinibatchFeatureIndexesPairPtr& minibatch_feature_indexes) {
+  if (config->hash_space) {
+    if (U == nullptr) {
+      initCollisionStores();
+    } else {
+      // The hashed stores and their filters do not depend on the minibatch,
+      // so they are reused: clearing them takes constant time and keeps the
+      // memory allocated for the previous minibatch.
+      U->clear();
+      for (const auto& store: V) {
+        store->clear();
       }
-      U = boost::make_shared<CollisionMinibatchFeatureStore>(
-          num_classes, config->hash_space, config->feature_context_size,
-          hasher, filter);
-
-      for (int i = 0; i < num_classes; ++i) {
-        int class_size = index->getClassSize(i);
-        hasher = boost::make_shared<WordContextHasher>(
-            i, config->hash_space);
-        if (config->filter_contexts) {
-          if (config->filter_error_rate) {
-            filter = boost::make_shared<FeatureApproximateFilter>(
-                class_size, hasher, bloom_filter);
-          } else {
-            filter = boost::make_shared<FeatureExactFilter>(
-                feature_indexes_pair->getWordIndexes(i),
-                boost::make_shared<WordContextExtractor>(i, mapper));
-          }
-        } else {
-          filter = boost::make_shared<FeatureNoOpFilter>(class_size);
-        }
-        V[i] = boost::make_shared<CollisionMinibatchFeatureStore>(
-            class_size, config->hash_space, config->feature_context_size,
-            hasher, filter);
+    }
+  } else {
+    buildSparseStores(minibatch_feature_indexes, U, V);
+  }
+}
+
+void MinibatchFactoredMaxentWeights::buildSparseStores(
+    const MinibatchFeatureIndexesPairPtr& minibatch_feature_indexes,
+    boost::shared_ptr<MinibatchFeatureStore>& class_store,
+    vector<boost::shared_ptr<MinibatchFeatureStore>>& word_stores) const {
+  int num_classes = index->getNumClasses();
+  boost::shared_ptr<FeatureContextMapper> mapper = metadata->getMapper();
+  class_store = boost::make_shared<SparseMinibatchFeatureStore>(
+      num_classes,
+      minibatch_feature_indexes->getClassIndexes(),
+      boost::make_shared<ClassContextExtractor>(mapper));
+
+  word_stores.resize(num_classes);
+  for (int i = 0; i < num_classes; ++i) {
+    word_stores[i] = boost::make_shared<SparseMinibatchFeatureStore>(
+       index->getClassSize(i),
+       minibatch_feature_indexes->getWordIndexes(i),
+       boost::make_shared<WordContextExtractor>(i, mapper));
+  }
+}
+
+void MinibatchFactoredMaxentWeights::initCollisionStores() {
+  int num_classes = index->getNumClasses();
+  boost::shared_ptr<FeatureContextMapper> mapper = metadata->getMapper();
+  boost::shared_ptr<BloomFilterPopulator> populator =
+      metadata->getPopulator();
+  boost::shared_ptr<FeatureMatcher> matcher = metadata->getMatcher();
+  boost::shared_ptr<CompactFilterPopulator> compact_populator =
+      metadata->getCompactPopulator();
+
+  boost::shared_ptr<FeatureContextHasher> hasher =
+      boost::make_shared<ClassContextHasher>(config->hash_space);
+  // It's fine to use the global feature indexes here because the stores are
+  // not constructed based on these indices. At filtering time, we just want
+  // to know which feature indexes match which contexts.
+  GlobalFeatureIndexesPairPtr feature_indexes_pair;
+  boost::shared_ptr<BloomFilter<NGram>> bloom_filter;
+  boost::shared_ptr<BlockedBloomFilter<NGram>> blocked_bloom_filter;
+  boost::shared_ptr<FeatureFilter> filter;
+  if (config->filter_contexts) {
+    if (config->compact_filter) {
+      filter = compact_populator->getClassFilter();
+    } else if (config->filter_error_rate > 0) {
+      if (config->blocked_bloom_filter) {
+        blocked_bloom_filter = populator->getBlocked();
+        filter = boost::make_shared<FeatureApproximateFilter>(
+            num_classes, hasher, blocked_bloom_filter);
+      } else {
+        bloom_filter = populator->get();
+        filter = boost::make_shared<FeatureApproximateFilter>(
+            num_classes, hasher, bloom_filter);
       }
     } else {
-      auto feature_indexes_pair = matcher->getMinibatchFeatures(
-          corpus, config->feature_context_size, minibatch_indices);
-      U = boost::make_shared<SparseMinibatchFeatureStore>(
-          num_classes,
+      feature_indexes_pair = matcher->getGlobalFeatures();
+      filter = boost::make_shared<FeatureExactFilter>(
           feature_indexes_pair->getClassIndexes(),
           boost::make_shared<ClassContextExtractor>(mapper));
+    }
+  } else {
+    filter = boost::make_shared<FeatureNoOpFilter>(num_classes);
+  }
+  U = boost::make_shared<CollisionMinibatchFeatureStore>(
+      num_classes, config->hash_space, config->feature_context_size,
+      hasher, filter);
 
-      for (int i = 0; i < num_classes; ++i) {
-        V[i] = boost::make_shared<SparseMinibatchFeatureStore>(
-           index->getClassSize(i),
-           feature_indexes_pair->getWordIndexes(i),
-           boost::make_shared<WordContextExtractor>(i, mapper));
+  for (int i = 0; i < num_classes; ++i) {
+    int class_size = index->getClassSize(i);
+    hasher = boost::make_shared<WordContextHasher>(
+        i, config->hash_space);
+    if (config->filter_contexts) {
+      if (config->compact_filter) {
+        filter = compact_populator->getWordFilter(i);
+      } else if (config->filter_error_rate) {
+        if (config->blocked_bloom_filter) {
+          filter = boost::make_shared<FeatureApproximateFilter>(
+              class_size, hasher, blocked_bloom_filter);
+        } else {
+          filter = boost::make_shared<FeatureApproximateFilter>(
+              class_size, hasher, bloom_filter);
+        }
+      } else {
+        filter = boost::make_shared<FeatureExactFilter>(
+            feature_indexes_pair->getWordIndexes(i),
+            boost::make_shared<WordContextExtractor>(i, mapper));
       }
+    } else {
+      filter = boost::make_shared<FeatureNoOpFilter>(class_size);
     }
+    V[i] = boost::make_shared<CollisionMinibatchFeatureStore>(
+        class_size, config->hash_space, config->feature_context_size,
+        hasher, filter);
   }
 }
 
@@ -2,6 +2,7 @@
 
 #include "lbl/factored_maxent_metadata.h"
 #include "lbl/factored_weights.h"
+#include "lbl/minibatch_feature_indexes_pair.h"
 #include "lbl/minibatch_feature_store.h"
 
 namespace oxlm {
@@ -15,15 +16,41 @@ class MinibatchFactoredMaxentWeights : public FactoredWeights {
   MinibatchFactoredMaxentWeights(
       int num_classes, const boost::shared_ptr<FactoredWeights>& base_gradient);
 
+  virtual void reportMemory(MemoryReport& report) const;
+
+  /**
+   * Computes the feature indexes of the minibatch contexts and builds the
+   * (empty) sparse feature stores of this gradient (if the feature stores are
+   * sparse).
+   */
+  virtual void prepare(PreparedMinibatch& minibatch) const;
+
   void init(
       const boost::shared_ptr<Corpus>& corpus,
       const vector<int>& minibatch);
 
+  /**
+   * Resets the feature stores for the given minibatch. Unlike the base
+   * weights, the stores are not partitioned between threads, so each gradient
+   * must be initialized by a single thread.
+   */
+  void init(const PreparedMinibatch& minibatch);
+
   void syncUpdate(
       const MinibatchWords& words,
       const boost::shared_ptr<MinibatchFactoredMaxentWeights>& gradient);
 
  private:
+  void initFeatureStores(
+      const MinibatchFeatureIndexesPairPtr& feature_indexes_pair);
+
+  void initCollisionStores();
+
+  void buildSparseStores(
+      const MinibatchFeatureIndexesPairPtr& feature_indexes_pair,
+      boost::shared_ptr<MinibatchFeatureStore>& class_store,
+      vector<boost::shared_ptr<MinibatchFeatureStore>>& word_stores) const;
+
   friend class GlobalFactoredMaxentWeights;
 
  protected:
@@ -12,8 +12,20 @@ class MinibatchFeatureStore : virtual public FeatureStore {
   virtual void update(
       const boost::shared_ptr<MinibatchFeatureStore>& base_minibatch_store) = 0;
 
+  /**
+   * Adds value to a single feature for all the feature contexts of context.
+   * Features which are not defined for a feature context are skipped.
+   */
+  virtual void updateValue(
+      int feature_index, const vector<int>& context, Real value) = 0;
+
   virtual void clear() = 0;
 
+  /**
+   * Preallocates room for the given number of feature weights.
+   */
+  virtual void reserve(size_t size) = 0;
+
   virtual Real getFeature(const pair<int, int>& index) const = 0;
 
   virtual ~MinibatchFeatureStore();
@@ -0,0 +1,128 @@
+#include "lbl/minibatch_pipeline.h"
+
+#include <boost/make_shared.hpp>
+
+#include "lbl/minibatch_corpus.h"
+#include "lbl/parallel_corpus.h"
+#include "lbl/tracer.h"
+
+namespace oxlm {
+
+MinibatchPipeline::MinibatchPipeline(
+    const boost::shared_ptr<ModelData>& config,
+    const boost::shared_ptr<Corpus>& training_corpus,
+    const boost::shared_ptr<Weights>& gradient)
+    : config(config), trainingCorpus(training_corpus), gradient(gradient),
+      nextStart(0), numPrepared(0), numTaken(0), stopped(true) {
+  compact = config->noise_samples == 0
+      && dynamic_pointer_cast<ParallelCorpus>(training_corpus) == nullptr;
+  int context_width = max(
+      config->ngram_order - 1, config->feature_context_size);
+
+  // One more buffer holds the minibatch being trained.
+  buffers.resize(config->prefetch_minibatches + 1);
+  for (auto& buffer: buffers) {
+    if (compact) {
+      buffer.corpus = boost::make_shared<MinibatchCorpus>(
+          training_corpus, context_width);
+    } else {
+      buffer.corpus = training_corpus;
+    }
+  }
+}
+
+void MinibatchPipeline::start(const vector<int>& indices, size_t start) {
+  stop();
+
+  this->indices = indices;
+  nextStart = start;
+  numPrepared = numTaken = 0;
+  stopped = false;
+  if (config->prefetch_minibatches > 0) {
+    worker = thread(&MinibatchPipeline::run, this, start);
+  }
+}
+
+const PreparedMinibatch& MinibatchPipeline::next() {
+  if (config->prefetch_minibatches == 0) {
+    prepare(nextStart, buffers[0]);
+    nextStart += config->minibatch_size;
+    return buffers[0];
+  }
+
+  size_t minibatch;
+  {
+    unique_lock<mutex> lock(buffersMutex);
+    minibatchPrepared.wait(lock, [this] {
+      return numPrepared > numTaken;
+    });
+    // The buffer of the previous minibatch can now be reused.
+    minibatch = numTaken++;
+  }
+  bufferReleased.notify_one();
+
+  return buffers[minibatch % buffers.size()];
+}
+
+void MinibatchPipeline::stop() {
+  {
+    lock_guard<mutex> lock(buffersMutex);
+    stopped = true;
+  }
+  bufferReleased.notify_one();
+
+  if (worker.joinable()) {
+    worker.join();
+  }
+}
+
+MinibatchPipeline::~MinibatchPipeline() {
+  stop();
+}
+
+void MinibatchPipeline::run(size_t start) {
+  for (; start < indices.size(); start += config->minibatch_size) {
+    size_t minibatch;
+    {
+      unique_lock<mutex> lock(buffersMutex);
+      bufferReleased.wait(lock, [this] {
+        return stopped
+            || numPrepared < numTaken + config->prefetch_minibatches;
+      });
+      if (stopped) {
+        return;
+      }
+      minibatch = numPrepared;
+    }
+
+    prepare(start, buffers[minibatch % buffers.size()]);
+
+    {
+      lock_guard<mutex> lock(buffersMutex);
+      ++numPrepared;
+    }
+    minibatchPrepared.notify_one();
+  }
+}
+
+void MinibatchPipeline::prepare(
+    size_t start, PreparedMinibatch& minibatch) const {
+  TraceScope scope("prepare_minibatch");
+
+  size_t end = min(indices.size(), start + config->minibatch_size);
+  if (compact) {
+    boost::shared_ptr<MinibatchCorpus> corpus =
+        boost::static_pointer_cast<MinibatchCorpus>(minibatch.corpus);
+    corpus->clear();
+    minibatch.indices.clear();
+    for (size_t i = start; i < end; ++i) {
+      minibatch.indices.push_back(corpus->add(indices[i]));
+    }
+  } else {
+    minibatch.indices.assign(indices.begin() + start, indices.begin() + end);
+  }
+
+  gradient->prepare(minibatch);
+}
+
+} // namespace oxlm
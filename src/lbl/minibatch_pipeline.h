@@ -0,0 +1,77 @@
+#pragma once
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "lbl/config.h"
+#include "lbl/corpus.h"
+#include "lbl/prepared_minibatch.h"
+#include "lbl/weights.h"
+
+namespace oxlm {
+
+/**
+ * Prepares the minibatches of a training iteration in a background thread,
+ * while the previous minibatches are trained. At most
+ * config->prefetch_minibatches minibatches are prepared ahead, and their
+ * buffers are reused for the following minibatches. If prefetching is
+ * disabled, the minibatches are prepared by next() on the calling thread.
+ *
+ * Unless noise contrastive estimation is used (the noise words are sampled
+ * from the training corpus) or the model is conditioned on a source sentence
+ * (the contexts depend on the alignments), the minibatch tokens are copied
+ * together with their contexts into a MinibatchCorpus. The model specific
+ * data (e.g. the maxent feature indexes) is prepared by gradient->prepare().
+ */
+class MinibatchPipeline {
+ public:
+  MinibatchPipeline(
+      const boost::shared_ptr<ModelData>& config,
+      const boost::shared_ptr<Corpus>& training_corpus,
+      const boost::shared_ptr<Weights>& gradient);
+
+  /**
+   * Starts preparing the minibatches starting at position start of indices
+   * (the order in which the training tokens are visited). The minibatches
+   * prepared for the previous iteration are discarded.
+   */
+  void start(const vector<int>& indices, size_t start);
+
+  /**
+   * Returns the next minibatch, waiting until it is prepared. The minibatch
+   * remains valid until the next call to next(), start() or stop().
+   */
+  const PreparedMinibatch& next();
+
+  /**
+   * Stops preparing minibatches (e.g. if training stops early).
+   */
+  void stop();
+
+  ~MinibatchPipeline();
+
+ private:
+  void run(size_t start);
+
+  void prepare(size_t start, PreparedMinibatch& minibatch) const;
+
+  boost::shared_ptr<ModelData> config;
+  boost::shared_ptr<Corpus> trainingCorpus;
+  boost::shared_ptr<Weights> gradient;
+  bool compact;
+  vector<int> indices;
+  // Position of the next minibatch (if minibatches are not prefetched).
+  size_t nextStart;
+
+  vector<PreparedMinibatch> buffers;
+  // Number of minibatches prepared and returned by next() respectively.
+  size_t numPrepared, numTaken;
+  bool stopped;
+  mutex buffersMutex;
+  condition_variable minibatchPrepared, bufferReleased;
+  thread worker;
+};
+
+} // namespace oxlm
@@ -1,20 +1,26 @@
 #include "lbl/model.h"
 
 #include <iomanip>
+#include <sstream>
 
+#include <boost/filesystem.hpp>
 #include <boost/make_shared.hpp>
 #include <boost/archive/binary_iarchive.hpp>
 #include <boost/archive/binary_oarchive.hpp>
 #include <boost/serialization/shared_ptr.hpp>
 
+#include "lbl/exceptions.h"
 #include "lbl/factored_metadata.h"
 #include "lbl/factored_maxent_metadata.h"
 #include "lbl/factored_weights.h"
 #include "lbl/global_factored_maxent_weights.h"
 #include "lbl/metadata.h"
 #include "lbl/minibatch_factored_maxent_weights.h"
+#include "lbl/minibatch_pipeline.h"
 #include "lbl/model_utils.h"
 #include "lbl/operators.h"
+#include "lbl/tracer.h"
+#include "lbl/training_stats.h"
 #include "lbl/weights.h"
 #include "utils/conditional_omp.h"
 
@@ -41,6 +47,11 @@ boost::shared_ptr<ModelData> Model<GlobalWeights, MinibatchWeights, Metadata>::g
   return config;
 }
 
+template<class GlobalWeights, class MinibatchWeights, class Metadata>
+boost::shared_ptr<GlobalWeights> Model<GlobalWeights, MinibatchWeights, Metadata>::getWeights() const {
+  return weights;
+}
+
 
 template<class GlobalWeights, class MinibatchWeights, class Metadata>
 MatrixReal Model<GlobalWeights, MinibatchWeights, Metadata>::getWordVectors() const {
@@ -49,19 +60,43 @@ MatrixReal Model<GlobalWeights, MinibatchWeights, Metadata>::getWordVectors() co
 
 template<class GlobalWeights, class MinibatchWeights, class Metadata>
 void Model<GlobalWeights, MinibatchWeights, Metadata>::learn() {
+  // Restore the model before reading the corpora, so that the words are
+  // mapped to the same ids.
+  boost::shared_ptr<GlobalWeights> adagrad;
+  TrainingState state;
+  vector<int> indices;
+  // Number of delta checkpoints written since the last full checkpoint.
+  int num_deltas = 0;
+  bool resume = config->checkpoint_file.size() > 0
+      && boost::filesystem::exists(config->checkpoint_file);
+  if (resume) {
+    num_deltas = loadCheckpoint(adagrad, state, indices);
+  }
+
   // Initialize the vocabulary now, if it hasn't been initialized when the
   // vocabulary was partitioned in classes.
-  boost::shared_ptr<Corpus> training_corpus =
-      readTrainingCorpus(config, vocab);
-
-  boost::shared_ptr<Corpus> test_corpus;
-  if (config->test_file.size()) {
-    test_corpus = readTestCorpus(config, vocab);
+  boost::shared_ptr<Corpus> training_corpus, test_corpus;
+  {
+    TraceScope scope("read_corpus");
+    training_corpus = readTrainingCorpus(config, vocab);
+    if (config->test_file.size()) {
+      test_corpus = readTestCorpus(config, vocab);
+    }
   }
 
-  if (config->model_input_file.size() == 0) {
+  // The metadata is also initialized in parallel.
+  omp_set_num_threads(config->threads);
+  if (resume) {
+    cout << "Resuming training from " << config->checkpoint_file
+         << " at iteration " << state.iteration << ", minibatch "
+         << state.minibatch_counter << "..." << endl;
+  } else if (config->model_input_file.size() == 0) {
     // Train a new model.
-    metadata->initialize(training_corpus);
+    {
+      TraceScope scope("initialize_metadata");
+      metadata->initialize(training_corpus);
+    }
+    TraceScope scope("initialize_weights");
     weights = boost::make_shared<GlobalWeights>(
         config, metadata, training_corpus);
     weights->printInfo();
@@ -73,67 +108,115 @@ void Model<GlobalWeights, MinibatchWeights, Metadata>::learn() {
          << perplexity(log_likelihood, test_corpus->size()) << endl;
   }
 
-  vector<int> indices(training_corpus->size());
-  iota(indices.begin(), indices.end(), 0);
+  if (!resume) {
+    indices.resize(training_corpus->size());
+    iota(indices.begin(), indices.end(), 0);
+    adagrad = boost::make_shared<GlobalWeights>(
+        config, metadata, config->row_wise_adagrad);
+  }
+
+  // The parameters updated since the last checkpoint are only tracked for
+  // delta checkpoints.
+  ParameterUpdates updates;
+  bool track_updates = config->checkpoint_file.size() > 0
+      && config->delta_checkpoints > 0;
 
-  int best_minibatch = 0;
-  Real best_perplexity = numeric_limits<Real>::infinity();
+  int best_minibatch = state.best_minibatch;
+  Real best_perplexity = state.best_perplexity;
   Real global_objective = 0, test_objective = 0;
   boost::shared_ptr<MinibatchWeights> global_gradient =
       boost::make_shared<MinibatchWeights>(config, metadata);
-  boost::shared_ptr<GlobalWeights> adagrad =
-      boost::make_shared<GlobalWeights>(config, metadata);
   MinibatchWords global_words;
 
+  MemoryReport memory_report = getMemoryReport();
+  MemoryReport adagrad_report, gradient_report;
+  adagrad->reportMemory(adagrad_report);
+  memory_report.add("adagrad: ", adagrad_report);
+  // Every thread has its own gradient, besides the global gradient.
+  global_gradient->reportMemory(gradient_report);
+  memory_report.add("gradients: ", gradient_report, config->threads + 1);
+  memory_report.add("training corpus", training_corpus->memoryUsage());
+  if (test_corpus != nullptr) {
+    memory_report.add("test corpus", test_corpus->memoryUsage());
+  }
+  memory_report.print(cout);
+
   int shared_index = 0;
   // For no particular reason. It just looks like this works best.
   int task_size = sqrt(config->minibatch_size);
 
-  omp_set_num_threads(config->threads);
+  // The minibatches are prepared ahead by a background thread.
+  MinibatchPipeline pipeline(config, training_corpus, global_gradient);
+  const PreparedMinibatch* minibatch = nullptr;
+
+  TrainingStats stats(config->threads, config->stats_file);
+
   #pragma omp parallel
   {
-    int minibatch_counter = 1;
+    int minibatch_counter = state.minibatch_counter;
     int minibatch_size = config->minibatch_size;
     int minibatch_threshold = config->minibatch_threshold;
     boost::shared_ptr<MinibatchWeights> gradient =
         boost::make_shared<MinibatchWeights>(config, metadata);
 
-    int iter = 0;
+    int iter = state.iteration;
+    // Only the first iteration may resume from the middle of the data.
+    size_t resume_start = state.start;
     while (iter < config->iterations &&
            minibatch_counter - best_minibatch <= minibatch_threshold) {
       auto iteration_start = GetTime();
+      auto phase_start = iteration_start;
+      size_t start = resume_start;
+      resume_start = 0;
 
       #pragma omp master
       {
-        if (config->randomise) {
-          random_shuffle(indices.begin(), indices.end());
+        if (start == 0) {
+          if (config->randomise) {
+            shuffle(indices.begin(), indices.end(), state.generator);
+            updates.shuffled = true;
+          }
+          global_objective = 0;
+        } else {
+          global_objective = state.objective;
         }
-        global_objective = 0;
+        pipeline.start(indices, start);
       }
+      phase_start = stats.record(INIT, phase_start);
       // Wait until the master thread finishes shuffling the indices.
       #pragma omp barrier
+      phase_start = stats.record(
+          BARRIER_WAIT, phase_start, "barrier_after_shuffle");
 
-      size_t start = 0;
       while (start < training_corpus->size() &&
              minibatch_counter - best_minibatch <= minibatch_threshold) {
         size_t end = min(training_corpus->size(), start + minibatch_size);
 
-        vector<int> minibatch(
-            indices.begin() + start,
-            min(indices.begin() + end, indices.end()));
-        global_gradient->init(training_corpus, minibatch);
         // Reset the set of minibatch words shared across all threads.
         #pragma omp master
         {
+          minibatch = &pipeline.next();
           global_words = MinibatchWords();
           shared_index = 0;
         }
+        phase_start = stats.record(INIT, phase_start);
 
-        gradient->init(training_corpus, minibatch);
+        // Wait until the master thread receives the prepared minibatch.
+        #pragma omp barrier
+        phase_start = stats.record(
+            BARRIER_WAIT, phase_start, "barrier_after_next_minibatch");
+
+        // Every gradient is initialized by the thread which owns it.
+        #pragma omp master
+        global_gradient->init(*minibatch);
+        gradient->init(*minibatch);
+        phase_start = stats.record(INIT, phase_start);
 
         // Wait until the global gradient is initialized. Otherwise, some
         // gradient updates may be ignored.
         #pragma omp barrier
+        phase_start = stats.record(
+            BARRIER_WAIT, phase_start, "barrier_after_init");
 
         Real objective = 0;
         MinibatchWords words;
@@ -144,72 +227,130 @@ void Model<GlobalWeights, MinibatchWeights, Metadata>::learn() {
             task_start = shared_index;
             shared_index += task_size;
           }
+          phase_start = stats.record(LOCK_WAIT, phase_start);
 
-          if (task_start < minibatch.size()) {
-            size_t task_end = min(task_start + task_size, minibatch.size());
+          const vector<int>& minibatch_indices = minibatch->indices;
+          if (task_start < minibatch_indices.size()) {
+            size_t task_end =
+                min(task_start + task_size, minibatch_indices.size());
             vector<int> task(
-                minibatch.begin() + task_start, minibatch.begin() + task_end);
+                minibatch_indices.begin() + task_start,
+                minibatch_indices.begin() + task_end);
             if (config->noise_samples > 0) {
               weights->estimateGradient(
-                  training_corpus, task, gradient, objective, words);
+                  minibatch->corpus, task, gradient, objective, words);
             } else {
               weights->getGradient(
-                  training_corpus, task, gradient, objective, words);
+                  minibatch->corpus, task, gradient, objective, words);
             }
+            phase_start = stats.record(GRADIENT, phase_start);
           } else {
             break;
           }
         }
 
         global_gradient->syncUpdate(words, gradient);
+        phase_start = stats.record(SYNC_UPDATE, phase_start);
         #pragma omp critical
         {
           global_objective += objective;
           global_words.merge(words);
         }
+        phase_start = stats.record(LOCK_WAIT, phase_start);
 
         // Wait until the global gradient is fully updated by all threads and
         // the global words are fully merged.
         #pragma omp barrier
+        phase_start = stats.record(
+            BARRIER_WAIT, phase_start, "barrier_after_sync");
 
         // Prepare minibatch words for parallel processing.
         #pragma omp master
-        global_words.transform();
+        {
+          global_words.transform();
+          if (track_updates) {
+            weights->trackUpdates(global_words, global_gradient, updates);
+          }
+          stats.addTokens(end - start);
+          stats.addRows(global_words.getContextWords().size()
+              + global_words.getOutputWords().size()
+              + global_words.getSourceWords().size());
+        }
+        phase_start = stats.record(SYNC_UPDATE, phase_start);
 
         // Wait until the minibatch words are fully prepared for parallel
         // processing.
         #pragma omp barrier
+        phase_start = stats.record(
+            BARRIER_WAIT, phase_start, "barrier_after_words");
 
         update(global_words, global_gradient, adagrad);
+        phase_start = stats.record(ADAGRAD_UPDATE, phase_start);
 
         // Wait for all threads to finish making the model gradient update.
         #pragma omp barrier
+        phase_start = stats.record(
+            BARRIER_WAIT, phase_start, "barrier_after_update");
 
         Real minibatch_factor =
             static_cast<Real>(end - start) / training_corpus->size();
         objective = regularize(global_gradient, minibatch_factor);
+        if (track_updates) {
+          #pragma omp master
+          updates.regularizerSigmas.push_back(
+              minibatch_factor * config->step_size * config->l2_lbl);
+        }
+        phase_start = stats.record(REGULARIZE, phase_start);
         #pragma omp critical
         global_objective += objective;
+        phase_start = stats.record(LOCK_WAIT, phase_start);
 
         // Clear gradients.
         gradient->clear(words, false);
         global_gradient->clear(global_words, true);
+        phase_start = stats.record(CLEAR, phase_start);
 
         // Wait the regularization update to finish and make sure the global
         // words are reset only after the global gradient is fully cleared.
         #pragma omp barrier
+        phase_start = stats.record(
+            BARRIER_WAIT, phase_start, "barrier_after_clear");
 
         if (minibatch_counter % config->evaluate_frequency == 0) {
           evaluate(test_corpus, iteration_start, minibatch_counter,
                    test_objective, best_perplexity, best_minibatch);
+          phase_start = stats.record(EVALUATE, phase_start);
+        }
+
+        if (config->stats_frequency > 0 &&
+            minibatch_counter % config->stats_frequency == 0) {
+          #pragma omp master
+          stats.report(iter, minibatch_counter);
         }
 
         ++minibatch_counter;
         start = end;
+
+        if (config->checkpoint_frequency > 0 &&
+            (minibatch_counter - 1) % config->checkpoint_frequency == 0 &&
+            start < training_corpus->size()) {
+          #pragma omp master
+          {
+            state.iteration = iter;
+            state.start = start;
+            state.minibatch_counter = minibatch_counter;
+            state.best_perplexity = best_perplexity;
+            state.best_minibatch = best_minibatch;
+            state.objective = global_objective;
+            saveCheckpoint(adagrad, state, indices, updates, num_deltas);
+          }
+          phase_start = stats.record(CHECKPOINT, phase_start);
+        }
       }
 
       evaluate(test_corpus, iteration_start, minibatch_counter,
                test_objective, best_perplexity, best_minibatch);
+      stats.record(EVALUATE, phase_start);
       #pragma omp master
       {
         Real iteration_time = GetDuration(iteration_start, GetTime());
@@ -218,6 +359,17 @@ void Model<GlobalWeights, MinibatchWeights, Metadata>::learn() {
              << "Objective: " << global_objective / training_corpus->size()
              << endl;
         cout << endl;
+
+        // If training stopped early, the last checkpoint is kept as is.
+        if (start >= training_corpus->size()) {
+          state.iteration = iter + 1;
+          state.start = 0;
+          state.minibatch_counter = minibatch_counter;
+          state.best_perplexity = best_perplexity;
+          state.best_minibatch = best_minibatch;
+          state.objective = 0;
+          saveCheckpoint(adagrad, state, indices, updates, num_deltas);
+        }
       }
 
       ++iter;
@@ -247,6 +399,7 @@ template<class GlobalWeights, class MinibatchWeights, class Metadata>
 void Model<GlobalWeights, MinibatchWeights, Metadata>::evaluate(
     const boost::shared_ptr<Corpus>& test_corpus, Real& accumulator) const {
   if (test_corpus != nullptr) {
+    TraceScope scope("evaluate");
     #pragma omp master
     {
       cout << "Calculating perplexity for " << test_corpus->size()
@@ -277,6 +430,7 @@ void Model<GlobalWeights, MinibatchWeights, Metadata>::evaluate(
 
     // Wait for all the threads to compute the perplexity for their slice of
     // test data.
+    TraceScope barrier_scope("evaluate_barrier_wait");
     #pragma omp barrier
   }
 }
@@ -316,6 +470,12 @@ Real Model<GlobalWeights, MinibatchWeights, Metadata>::getLogProb(
   return weights->getLogProb(word_id, context);
 }
 
+template<class GlobalWeights, class MinibatchWeights, class Metadata>
+VectorReal Model<GlobalWeights, MinibatchWeights, Metadata>::getLogProbs(
+    const boost::shared_ptr<Corpus>& corpus, const vector<int>& indices) const {
+  return weights->getLogProbs(corpus, indices);
+}
+
 template<class GlobalWeights, class MinibatchWeights, class Metadata>
 Real Model<GlobalWeights, MinibatchWeights, Metadata>::getUnnormalizedScore(
     int word_id, const vector<int>& context) const {
@@ -325,38 +485,235 @@ Real Model<GlobalWeights, MinibatchWeights, Metadata>::getUnnormalizedScore(
 template<class GlobalWeights, class MinibatchWeights, class Metadata>
 void Model<GlobalWeights, MinibatchWeights, Metadata>::save() const {
   if (config->model_output_file.size()) {
+    TraceScope scope("save");
     cout << "Writing model to " << config->model_output_file << "..." << endl;
     ofstream fout(config->model_output_file);
     boost::archive::binary_oarchive oar(fout);
-    oar << config;
-    oar << vocab;
-    oar << weights;
-    oar << metadata;
+    saveModel(oar);
     cout << "Done..." << endl;
   }
 }
 
+template<class GlobalWeights, class MinibatchWeights, class Metadata>
+void Model<GlobalWeights, MinibatchWeights, Metadata>::saveModel(
+    boost::archive::binary_oarchive& oar) const {
+  oar << config;
+  oar << vocab;
+  oar << weights;
+  oar << metadata;
+}
+
+template<class GlobalWeights, class MinibatchWeights, class Metadata>
+void Model<GlobalWeights, MinibatchWeights, Metadata>::saveCheckpoint(
+    const boost::shared_ptr<GlobalWeights>& adagrad,
+    const TrainingState& state, const vector<int>& indices,
+    ParameterUpdates& updates, int& num_deltas) const {
+  if (config->checkpoint_file.size()) {
+    if (num_deltas < config->delta_checkpoints &&
+        boost::filesystem::exists(config->checkpoint_file)) {
+      saveDelta(adagrad, state, indices, updates);
+      ++num_deltas;
+    } else {
+      TraceScope scope("checkpoint");
+      cout << "Writing checkpoint to " << config->checkpoint_file << "..."
+           << endl;
+      // Write to a temporary file first, so that an interrupted write does
+      // not destroy the previous checkpoint.
+      string temp_file = config->checkpoint_file + ".tmp";
+      {
+        ofstream fout(temp_file);
+        boost::archive::binary_oarchive oar(fout);
+        saveModel(oar);
+        oar << adagrad;
+        oar << state;
+        oar << indices;
+      }
+      // The delta checkpoints are relative to the previous full checkpoint.
+      // They are removed before the previous checkpoint is replaced, so an
+      // interruption in between leaves a consistent (older) checkpoint.
+      boost::filesystem::remove(getDeltaFile(config->checkpoint_file));
+      boost::filesystem::rename(temp_file, config->checkpoint_file);
+      num_deltas = 0;
+      cout << "Done..." << endl;
+    }
+
+    updates.clear();
+  }
+}
+
+template<class GlobalWeights, class MinibatchWeights, class Metadata>
+void Model<GlobalWeights, MinibatchWeights, Metadata>::saveDelta(
+    const boost::shared_ptr<GlobalWeights>& adagrad,
+    const TrainingState& state, const vector<int>& indices,
+    const ParameterUpdates& updates) const {
+  TraceScope scope("delta_checkpoint");
+  string delta_file = getDeltaFile(config->checkpoint_file);
+  cout << "Appending delta checkpoint to " << delta_file << "..." << endl;
+  ostringstream stream(ios_base::binary);
+  {
+    boost::archive::binary_oarchive oar(stream);
+    oar << state;
+    oar << updates.regularizerSigmas;
+    oar << updates.shuffled;
+    if (updates.shuffled) {
+      oar << indices;
+    }
+    weights->saveDelta(oar, updates);
+    adagrad->saveDelta(oar, updates);
+  }
+
+  // Every delta is prefixed by its size, so that a delta which was only
+  // partially written can be detected when the deltas are read.
+  string delta = stream.str();
+  size_t delta_size = delta.size();
+  ofstream fout(delta_file, ios_base::binary | ios_base::app);
+  fout.write(reinterpret_cast<const char*>(&delta_size), sizeof(delta_size));
+  fout.write(delta.data(), delta_size);
+  cout << "Done..." << endl;
+}
+
+template<class GlobalWeights, class MinibatchWeights, class Metadata>
+string Model<GlobalWeights, MinibatchWeights, Metadata>::getDeltaFile(
+    const string& checkpoint_file) {
+  return checkpoint_file + ".deltas";
+}
+
 template<class GlobalWeights, class MinibatchWeights, class Metadata>
 void Model<GlobalWeights, MinibatchWeights, Metadata>::load(const string& filename) {
   if (filename.size() > 0) {
+    TraceScope scope("load");
     auto start_time = GetTime();
     cerr << "Loading model from " << filename << "..." << endl;
     ifstream fin(filename);
     boost::archive::binary_iarchive iar(fin);
-    iar >> config;
-    iar >> vocab;
-    iar >> weights;
-    iar >> metadata;
+    loadModel(iar);
     cerr << "Reading model took " << GetDuration(start_time, GetTime())
          << " seconds..." << endl;
   }
 }
 
+template<class GlobalWeights, class MinibatchWeights, class Metadata>
+void Model<GlobalWeights, MinibatchWeights, Metadata>::loadModel(
+    boost::archive::binary_iarchive& iar) {
+  iar >> config;
+  iar >> vocab;
+  iar >> weights;
+  iar >> metadata;
+}
+
+template<class GlobalWeights, class MinibatchWeights, class Metadata>
+void Model<GlobalWeights, MinibatchWeights, Metadata>::loadFromCheckpoint(
+    const string& filename) {
+  boost::shared_ptr<GlobalWeights> adagrad;
+  TrainingState state;
+  vector<int> indices;
+  size_t valid_size;
+  // The checkpoint files are only read: training may still be appending
+  // deltas to them.
+  restoreCheckpoint(filename, adagrad, state, indices, valid_size);
+}
+
+template<class GlobalWeights, class MinibatchWeights, class Metadata>
+int Model<GlobalWeights, MinibatchWeights, Metadata>::loadCheckpoint(
+    boost::shared_ptr<GlobalWeights>& adagrad, TrainingState& state,
+    vector<int>& indices) {
+  boost::shared_ptr<ModelData> training_config = config;
+  size_t valid_size;
+  int num_deltas = restoreCheckpoint(
+      config->checkpoint_file, adagrad, state, indices, valid_size);
+
+  // Drop a delta which was only partially written (e.g. because training was
+  // interrupted), so that new deltas are appended after the last valid one.
+  string delta_file = getDeltaFile(config->checkpoint_file);
+  if (boost::filesystem::exists(delta_file) &&
+      boost::filesystem::file_size(delta_file) > valid_size) {
+    boost::filesystem::resize_file(delta_file, valid_size);
+  }
+
+  if (!(*config == *training_config)) {
+    throw IncompatibleCheckpointException();
+  }
+  // The restored weights and metadata share the restored configuration, which
+  // only contains the serialized options. Replace it with the configuration
+  // of the current run (e.g. the number of threads).
+  *config = *training_config;
+
+  return num_deltas;
+}
+
+template<class GlobalWeights, class MinibatchWeights, class Metadata>
+int Model<GlobalWeights, MinibatchWeights, Metadata>::restoreCheckpoint(
+    const string& filename, boost::shared_ptr<GlobalWeights>& adagrad,
+    TrainingState& state, vector<int>& indices, size_t& valid_size) {
+  TraceScope scope("load_checkpoint");
+  cout << "Loading checkpoint from " << filename << "..." << endl;
+  {
+    ifstream fin(filename);
+    boost::archive::binary_iarchive iar(fin);
+    loadModel(iar);
+    iar >> adagrad;
+    iar >> state;
+    iar >> indices;
+  }
+
+  valid_size = 0;
+  string delta_file = getDeltaFile(filename);
+  if (!boost::filesystem::exists(delta_file)) {
+    return 0;
+  }
+
+  int num_deltas = 0;
+  size_t file_size = boost::filesystem::file_size(delta_file), delta_size;
+  ifstream fin(delta_file, ios_base::binary);
+  while (fin.read(reinterpret_cast<char*>(&delta_size), sizeof(delta_size))) {
+    // Stop at a partially written delta without trusting its length prefix.
+    if (delta_size > file_size - valid_size - sizeof(delta_size)) {
+      break;
+    }
+
+    string delta(delta_size, 0);
+    if (!fin.read(&delta[0], delta_size)) {
+      break;
+    }
+
+    istringstream stream(delta, ios_base::binary);
+    boost::archive::binary_iarchive iar(stream);
+    vector<Real> regularizer_sigmas;
+    bool shuffled;
+    iar >> state;
+    iar >> regularizer_sigmas;
+    iar >> shuffled;
+    if (shuffled) {
+      iar >> indices;
+    }
+    weights->loadDelta(iar, regularizer_sigmas);
+    // The AdaGrad state is not regularized.
+    adagrad->loadDelta(iar, vector<Real>());
+
+    valid_size += sizeof(delta_size) + delta_size;
+    ++num_deltas;
+  }
+  fin.close();
+  cout << "Applied " << num_deltas << " delta checkpoints..." << endl;
+
+  return num_deltas;
+}
+
 template<class GlobalWeights, class MinibatchWeights, class Metadata>
 void Model<GlobalWeights, MinibatchWeights, Metadata>::clearCache() {
   weights->clearCache();
 }
 
+template<class GlobalWeights, class MinibatchWeights, class Metadata>
+MemoryReport Model<GlobalWeights, MinibatchWeights, Metadata>::getMemoryReport() const {
+  MemoryReport report, weights_report, metadata_report;
+  weights->reportMemory(weights_report);
+  report.add("weights: ", weights_report);
+  metadata->reportMemory(metadata_report);
+  report.add("metadata: ", metadata_report);
+  return report;
+}
+
 template<class GlobalWeights, class MinibatchWeights, class Metadata>
 bool Model<GlobalWeights, MinibatchWeights, Metadata>::operator==(
     const Model<GlobalWeights, MinibatchWeights, Metadata>& other) const {
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <boost/archive/binary_iarchive.hpp>
+#include <boost/archive/binary_oarchive.hpp>
 #include <boost/shared_ptr.hpp>
 
 #include "corpus/corpus.h"
@@ -9,12 +11,15 @@
 #include "lbl/factored_weights.h"
 #include "lbl/factored_tree_weights.h"
 #include "lbl/global_factored_maxent_weights.h"
+#include "lbl/memory_report.h"
 #include "lbl/metadata.h"
 #include "lbl/minibatch_factored_maxent_weights.h"
 #include "lbl/minibatch_words.h"
 #include "lbl/model_utils.h"
 #include "lbl/parallel_vocabulary.h"
+#include "lbl/parameter_updates.h"
 #include "lbl/source_factored_weights.h"
+#include "lbl/training_state.h"
 #include "lbl/tree_metadata.h"
 #include "lbl/utils.h"
 #include "lbl/vocabulary.h"
@@ -42,6 +47,8 @@ class Model {
 
   boost::shared_ptr<ModelData> getConfig() const;
 
+  boost::shared_ptr<GlobalWeights> getWeights() const;
+
   void learn();
 
   void update(
@@ -58,6 +65,10 @@ class Model {
 
   Real getLogProb(int word_id, const vector<int>& context) const;
 
+  VectorReal getLogProbs(
+      const boost::shared_ptr<Corpus>& corpus,
+      const vector<int>& indices) const;
+
   Real getUnnormalizedScore(int word_id, const vector<int>& context) const;
 
   MatrixReal getWordVectors() const;
@@ -66,8 +77,20 @@ class Model {
 
   void load(const string& filename);
 
+  /**
+   * Restores the model from a training checkpoint, including the delta
+   * checkpoints written after it. The checkpoint files are not modified, so
+   * this is safe while training is still writing checkpoints.
+   */
+  void loadFromCheckpoint(const string& filename);
+
   void clearCache();
 
+  /**
+   * Returns the memory used by the weights and the metadata of the model.
+   */
+  MemoryReport getMemoryReport() const;
+
   bool operator==(
       const Model<GlobalWeights, MinibatchWeights, Metadata>& other) const;
 
@@ -77,6 +100,49 @@ class Model {
       int minibatch_counter, Real& objective,
       Real& best_perplexity, int& best_minibatch) const;
 
+  void saveModel(boost::archive::binary_oarchive& oar) const;
+
+  void loadModel(boost::archive::binary_iarchive& iar);
+
+  /**
+   * Writes the model together with the AdaGrad state and the position of the
+   * training algorithm to config->checkpoint_file (if set). While fewer than
+   * config->delta_checkpoints deltas were written since the last full
+   * checkpoint, only the parameters in updates are appended to the delta
+   * file. The updates are cleared afterwards.
+   */
+  void saveCheckpoint(
+      const boost::shared_ptr<GlobalWeights>& adagrad,
+      const TrainingState& state, const vector<int>& indices,
+      ParameterUpdates& updates, int& num_deltas) const;
+
+  void saveDelta(
+      const boost::shared_ptr<GlobalWeights>& adagrad,
+      const TrainingState& state, const vector<int>& indices,
+      const ParameterUpdates& updates) const;
+
+  static string getDeltaFile(const string& checkpoint_file);
+
+  /**
+   * Restores the model, the AdaGrad state and the position of the training
+   * algorithm from config->checkpoint_file. Throws
+   * IncompatibleCheckpointException if the checkpoint was created for a
+   * different model configuration. Returns the number of delta checkpoints
+   * applied.
+   */
+  int loadCheckpoint(
+      boost::shared_ptr<GlobalWeights>& adagrad, TrainingState& state,
+      vector<int>& indices);
+
+  /**
+   * Reads the full checkpoint and applies the complete delta checkpoints
+   * following it without modifying the files. valid_size is set to the size
+   * of the complete deltas. Returns the number of delta checkpoints applied.
+   */
+  int restoreCheckpoint(
+      const string& filename, boost::shared_ptr<GlobalWeights>& adagrad,
+      TrainingState& state, vector<int>& indices, size_t& valid_size);
+
   boost::shared_ptr<ModelData> config;
   boost::shared_ptr<Vocabulary> vocab;
   boost::shared_ptr<Metadata> metadata;
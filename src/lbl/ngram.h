@@ -5,6 +5,7 @@
 #include <boost/serialization/serialization.hpp>
 #include <boost/serialization/vector.hpp>
 
+#include "lbl/prefix_hash.h"
 #include "lbl/utils.h"
 
 using namespace std;
@@ -44,12 +45,28 @@ template<> class hash<oxlm::NGram> {
  public:
   hash<oxlm::NGram>(int seed = 0) : seed(seed) {}
 
-  inline size_t operator()(const oxlm::NGram query) const {
-    vector<int> data;
-    data.push_back(query.word);
-    data.push_back(query.classId);
-    data.insert(data.end(), query.context.begin(), query.context.end());
-    return oxlm::MurmurHash(data, seed);
+  inline size_t operator()(const oxlm::NGram& query) const {
+    return getPrefixHash(query).getHash();
+  }
+
+  /**
+   * Returns the full 128-bit hash of the n-gram. The first half agrees with
+   * operator().
+   */
+  inline pair<size_t, size_t> getFullHash(const oxlm::NGram& query) const {
+    return getPrefixHash(query).getFullHash();
+  }
+
+  /**
+   * Returns the hash state of an n-gram with the given word and class id and
+   * an empty context. Appending the context to it gives the same hash as
+   * operator(), without building the n-gram.
+   */
+  inline oxlm::PrefixHash getPrefixHash(int word, int class_id) const {
+    oxlm::PrefixHash prefix_hash(seed);
+    prefix_hash.append(word);
+    prefix_hash.append(class_id);
+    return prefix_hash;
   }
 
   bool operator==(const hash<oxlm::NGram>& other) const {
@@ -57,6 +74,12 @@ template<> class hash<oxlm::NGram> {
   }
 
  private:
+  inline oxlm::PrefixHash getPrefixHash(const oxlm::NGram& query) const {
+    oxlm::PrefixHash prefix_hash = getPrefixHash(query.word, query.classId);
+    prefix_hash.append(query.context);
+    return prefix_hash;
+  }
+
   friend class boost::serialization::access;
 
   template<class Archive>
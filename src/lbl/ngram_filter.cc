@@ -1,44 +1,48 @@
 #include "lbl/ngram_filter.h"
 
+#include <queue>
+#include <unordered_set>
+
+#include <boost/make_shared.hpp>
+
+#include "utils/conditional_omp.h"
+
 namespace oxlm {
 
+const int NGramFilter::SKETCH_DEPTH;
+
 NGramFilter::NGramFilter(
     const boost::shared_ptr<Corpus>& corpus,
     const boost::shared_ptr<WordToClassIndex>& index,
     const boost::shared_ptr<ContextProcessor>& processor,
     const boost::shared_ptr<FeatureContextGenerator>& generator,
-    int max_ngrams, int min_ngram_freq) {
+    int max_ngrams, int min_ngram_freq, size_t sketch_memory)
+    : minFrequency(min_ngram_freq) {
   enabled = max_ngrams > 0 || min_ngram_freq > 1;
   if (!enabled) {
     return;
   }
 
-  for (size_t i = 0; i < corpus->size(); ++i) {
-    int word_id = corpus->at(i);
-    int class_id = index->getClass(word_id);
-    vector<int> context = processor->extract(i);
-    for (const auto& feature_context: generator->getFeatureContexts(context)) {
-      NGram ngram(word_id, class_id, feature_context.data);
-      size_t ngram_hash = hashFunction(ngram);
-      ++ngramFrequencies[ngram_hash];
-    }
-  }
-
-  cout << "Total number of n-grams: " << ngramFrequencies.size()
-       << "..." << endl;
-
   vector<pair<int, size_t>> ngrams;
-  for (const auto& ngram_frequency: ngramFrequencies) {
-    if (ngram_frequency.second >= min_ngram_freq) {
-      ngrams.push_back(make_pair(
-          ngram_frequency.second, ngram_frequency.first));
+  if (sketch_memory > 0) {
+    sketch = boost::make_shared<CountMinSketch>(sketch_memory, SKETCH_DEPTH);
+    countApproximate(corpus, index, processor, generator);
+    cout << "Total number of n-gram occurrences: " << sketch->size()
+         << "..." << endl;
+
+    if (max_ngrams == 0) {
+      cout << "n-gram minimum frequency " << min_ngram_freq << endl;
+      return;
     }
-  }
 
-  cout << "Number of n-grams above minimum frequency threshold: "
-       << ngrams.size() << endl;
+    ngrams = getHeavyHitters(
+        corpus, index, processor, generator, max_ngrams, min_ngram_freq);
+    sketch.reset();
+  } else {
+    ngrams = countExact(corpus, index, processor, generator, min_ngram_freq);
+  }
 
-  if (max_ngrams != 0 && ngrams.size() > max_ngrams) {
+  if (max_ngrams != 0 && ngrams.size() >= max_ngrams) {
     partial_sort(ngrams.begin(), ngrams.begin() + max_ngrams, ngrams.end(),
         greater<pair<int, size_t>>());
     ngrams.resize(max_ngrams);
@@ -47,7 +51,6 @@ NGramFilter::NGramFilter(
     cout << "n-gram minimum frequency " << min_ngram_freq << endl;
   }
 
-
   ngramFrequencies.clear();
   for (const auto& ngram: ngrams) {
     ngramFrequencies[ngram.second] = ngram.first;
@@ -61,11 +64,12 @@ vector<FeatureContext> NGramFilter::filter(
     return feature_contexts;
   }
 
+  PrefixHash prefix = hashFunction.getPrefixHash(word_id, class_id);
   vector<FeatureContext> ret;
   for (const auto& feature_context: feature_contexts) {
-    NGram ngram(word_id, class_id, feature_context.data);
-    size_t ngram_hash = hashFunction(ngram);
-    if (ngramFrequencies.count(ngram_hash)) {
+    PrefixHash ngram_hash = prefix;
+    ngram_hash.append(feature_context.data);
+    if (contains(ngram_hash.getHash())) {
       ret.push_back(feature_context);
     }
   }
@@ -73,4 +77,152 @@ vector<FeatureContext> NGramFilter::filter(
   return ret;
 }
 
+vector<size_t> NGramFilter::getNGramHashes(
+    const boost::shared_ptr<Corpus>& corpus,
+    const boost::shared_ptr<WordToClassIndex>& index,
+    const boost::shared_ptr<ContextProcessor>& processor,
+    const boost::shared_ptr<FeatureContextGenerator>& generator,
+    size_t position) const {
+  int word_id = corpus->at(position);
+  int class_id = index->getClass(word_id);
+  vector<int> context = processor->extract(position);
+  PrefixHash prefix = hashFunction.getPrefixHash(word_id, class_id);
+  return generator->getPrefixHashes(prefix, context);
+}
+
+vector<pair<int, size_t>> NGramFilter::countExact(
+    const boost::shared_ptr<Corpus>& corpus,
+    const boost::shared_ptr<WordToClassIndex>& index,
+    const boost::shared_ptr<ContextProcessor>& processor,
+    const boost::shared_ptr<FeatureContextGenerator>& generator,
+    int min_ngram_freq) const {
+  // Every thread counts the n-grams of a slice of the corpus. The partial
+  // counts are added up afterwards.
+  vector<unordered_map<size_t, int>> partial_frequencies(omp_get_max_threads());
+  #pragma omp parallel
+  {
+    int thread_id = omp_get_thread_num();
+    pair<size_t, size_t> range =
+        GetSlice(corpus->size(), thread_id, omp_get_num_threads());
+
+    unordered_map<size_t, int>& frequencies = partial_frequencies[thread_id];
+    for (size_t i = range.first; i < range.second; ++i) {
+      for (size_t ngram_hash:
+          getNGramHashes(corpus, index, processor, generator, i)) {
+        ++frequencies[ngram_hash];
+      }
+    }
+  }
+
+  unordered_map<size_t, int> frequencies;
+  frequencies.swap(partial_frequencies[0]);
+  for (size_t i = 1; i < partial_frequencies.size(); ++i) {
+    for (const auto& ngram_frequency: partial_frequencies[i]) {
+      frequencies[ngram_frequency.first] += ngram_frequency.second;
+    }
+    unordered_map<size_t, int>().swap(partial_frequencies[i]);
+  }
+
+  cout << "Total number of n-grams: " << frequencies.size() << "..." << endl;
+
+  vector<pair<int, size_t>> ngrams;
+  for (const auto& ngram_frequency: frequencies) {
+    if (ngram_frequency.second >= min_ngram_freq) {
+      ngrams.push_back(make_pair(
+          ngram_frequency.second, ngram_frequency.first));
+    }
+  }
+
+  cout << "Number of n-grams above minimum frequency threshold: "
+       << ngrams.size() << endl;
+
+  return ngrams;
+}
+
+void NGramFilter::countApproximate(
+    const boost::shared_ptr<Corpus>& corpus,
+    const boost::shared_ptr<WordToClassIndex>& index,
+    const boost::shared_ptr<ContextProcessor>& processor,
+    const boost::shared_ptr<FeatureContextGenerator>& generator) {
+  // All the threads update the same sketch, so the memory does not grow with
+  // the number of threads.
+  #pragma omp parallel
+  {
+    pair<size_t, size_t> range = GetSlice(
+        corpus->size(), omp_get_thread_num(), omp_get_num_threads());
+    for (size_t i = range.first; i < range.second; ++i) {
+      for (size_t ngram_hash:
+          getNGramHashes(corpus, index, processor, generator, i)) {
+        sketch->increment(ngram_hash);
+      }
+    }
+  }
+}
+
+vector<pair<int, size_t>> NGramFilter::getHeavyHitters(
+    const boost::shared_ptr<Corpus>& corpus,
+    const boost::shared_ptr<WordToClassIndex>& index,
+    const boost::shared_ptr<ContextProcessor>& processor,
+    const boost::shared_ptr<FeatureContextGenerator>& generator,
+    int max_ngrams, int min_ngram_freq) const {
+  // Every thread keeps the max_ngrams n-grams of its slice with the highest
+  // approximate frequencies in a min-heap. The n-grams are ordered by
+  // (frequency, hash), as in the exact selection.
+  typedef pair<int, size_t> Entry;
+  vector<vector<Entry>> partial_ngrams(omp_get_max_threads());
+  #pragma omp parallel
+  {
+    int thread_id = omp_get_thread_num();
+    pair<size_t, size_t> range =
+        GetSlice(corpus->size(), thread_id, omp_get_num_threads());
+
+    priority_queue<Entry, vector<Entry>, greater<Entry>> heap;
+    unordered_set<size_t> heap_ngrams;
+    for (size_t i = range.first; i < range.second; ++i) {
+      for (size_t ngram_hash:
+          getNGramHashes(corpus, index, processor, generator, i)) {
+        Entry entry(sketch->estimate(ngram_hash), ngram_hash);
+        if (entry.first < min_ngram_freq || heap_ngrams.count(ngram_hash)) {
+          continue;
+        }
+
+        if (heap.size() < static_cast<size_t>(max_ngrams)) {
+          heap.push(entry);
+          heap_ngrams.insert(ngram_hash);
+        } else if (heap.top() < entry) {
+          heap_ngrams.erase(heap.top().second);
+          heap.pop();
+          heap.push(entry);
+          heap_ngrams.insert(ngram_hash);
+        }
+      }
+    }
+
+    vector<Entry>& ngrams = partial_ngrams[thread_id];
+    ngrams.reserve(heap.size());
+    while (!heap.empty()) {
+      ngrams.push_back(heap.top());
+      heap.pop();
+    }
+  }
+
+  vector<Entry> ngrams;
+  for (const auto& thread_ngrams: partial_ngrams) {
+    ngrams.insert(ngrams.end(), thread_ngrams.begin(), thread_ngrams.end());
+  }
+  // An n-gram may be among the heavy hitters of several slices.
+  sort(ngrams.begin(), ngrams.end());
+  ngrams.erase(unique(ngrams.begin(), ngrams.end()), ngrams.end());
+
+  return ngrams;
+}
+
+bool NGramFilter::contains(size_t ngram_hash) const {
+  if (sketch) {
+    return sketch->estimate(ngram_hash) >= minFrequency;
+  }
+
+  return ngramFrequencies.count(ngram_hash);
+}
+
 } // namespace oxlm
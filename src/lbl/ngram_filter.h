@@ -1,6 +1,7 @@
 #pragma once
 
 #include "lbl/context_processor.h"
+#include "lbl/count_min_sketch.h"
 #include "lbl/feature_context_generator.h"
 #include "lbl/ngram.h"
 #include "lbl/word_to_class_index.h"
@@ -8,6 +9,19 @@
 
 namespace oxlm {
 
+/**
+ * Selects the n-grams used to define maxent features: the max_ngrams most
+ * frequent n-grams in the corpus, if max_ngrams is set, and only n-grams
+ * observed at least min_ngram_freq times.
+ *
+ * By default, the n-gram frequencies are counted exactly. If sketch_memory
+ * (in bytes) is set, they are approximated with a count-min sketch of that
+ * size instead. The top max_ngrams n-grams are then selected with a bounded
+ * heap in a second pass over the corpus, while a min_ngram_freq threshold
+ * alone is checked directly against the sketch. The approximate frequencies
+ * are never smaller than the true ones, so a few infrequent n-grams may be
+ * selected, but no frequent one is dropped because of the threshold.
+ */
 class NGramFilter {
  public:
   NGramFilter(
@@ -15,16 +29,57 @@ class NGramFilter {
       const boost::shared_ptr<WordToClassIndex>& index,
       const boost::shared_ptr<ContextProcessor>& processor,
       const boost::shared_ptr<FeatureContextGenerator>& generator,
-      int max_ngrams = 0, int min_ngram_freq = 1);
+      int max_ngrams = 0, int min_ngram_freq = 1, size_t sketch_memory = 0);
 
   vector<FeatureContext> filter(
       int word_id, int class_id,
       const vector<FeatureContext>& feature_contexts) const;
 
  private:
+  /**
+   * Returns the hashes of the n-grams ending at the given corpus position.
+   */
+  vector<size_t> getNGramHashes(
+      const boost::shared_ptr<Corpus>& corpus,
+      const boost::shared_ptr<WordToClassIndex>& index,
+      const boost::shared_ptr<ContextProcessor>& processor,
+      const boost::shared_ptr<FeatureContextGenerator>& generator,
+      size_t position) const;
+
+  vector<pair<int, size_t>> countExact(
+      const boost::shared_ptr<Corpus>& corpus,
+      const boost::shared_ptr<WordToClassIndex>& index,
+      const boost::shared_ptr<ContextProcessor>& processor,
+      const boost::shared_ptr<FeatureContextGenerator>& generator,
+      int min_ngram_freq) const;
+
+  void countApproximate(
+      const boost::shared_ptr<Corpus>& corpus,
+      const boost::shared_ptr<WordToClassIndex>& index,
+      const boost::shared_ptr<ContextProcessor>& processor,
+      const boost::shared_ptr<FeatureContextGenerator>& generator);
+
+  /**
+   * Returns (at least) the max_ngrams n-grams with the highest approximate
+   * frequencies above min_ngram_freq.
+   */
+  vector<pair<int, size_t>> getHeavyHitters(
+      const boost::shared_ptr<Corpus>& corpus,
+      const boost::shared_ptr<WordToClassIndex>& index,
+      const boost::shared_ptr<ContextProcessor>& processor,
+      const boost::shared_ptr<FeatureContextGenerator>& generator,
+      int max_ngrams, int min_ngram_freq) const;
+
+  bool contains(size_t ngram_hash) const;
+
+  static const int SKETCH_DEPTH = 4;
+
   bool enabled;
   hash<NGram> hashFunction;
   unordered_map<size_t, int> ngramFrequencies;
+  // Only set when the n-grams are filtered directly with the sketch.
+  boost::shared_ptr<CountMinSketch> sketch;
+  int minFrequency;
 };
 
 } // namespace oxlm
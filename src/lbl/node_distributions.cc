@@ -0,0 +1,45 @@
+#include "lbl/node_distributions.h"
+
+namespace oxlm {
+
+NodeDistributions::NodeDistributions(
+    const VectorReal& node_unigram,
+    const boost::shared_ptr<ClassTree>& tree,
+    unsigned int seed)
+    : tree(tree), gen(seed), dists(tree->size()),
+      logProbs(VectorReal::Zero(tree->size())) {
+  for (size_t node = 0; node < tree->size(); ++node) {
+    const vector<int>& children = tree->getChildren(node);
+    if (children.size() == 0) {
+      continue;
+    }
+
+    if (node_unigram(node) > 0) {
+      dists[node] = discrete_distribution<int>(
+          node_unigram.data() + children[0],
+          node_unigram.data() + children[0] + children.size());
+      for (int child: children) {
+        logProbs(child) = log(node_unigram(child) / node_unigram(node));
+      }
+    } else {
+      // Subtrees without unigram mass (e.g. containing only <s> or words
+      // missing from the training data) are sampled uniformly, instead of
+      // using the undefined 0 / 0 probabilities.
+      vector<Real> weights(children.size(), 1);
+      dists[node] = discrete_distribution<int>(weights.begin(), weights.end());
+      for (int child: children) {
+        logProbs(child) = -log(children.size());
+      }
+    }
+  }
+}
+
+int NodeDistributions::sample(int node) {
+  return tree->getChildren(node)[0] + dists[node](gen);
+}
+
+Real NodeDistributions::logProb(int node) const {
+  return logProbs(node);
+}
+
+} // namespace oxlm
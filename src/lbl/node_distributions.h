@@ -0,0 +1,42 @@
+#pragma once
+
+#include <random>
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+
+#include "lbl/class_tree.h"
+#include "lbl/utils.h"
+
+namespace oxlm {
+
+/**
+ * Samples the children of the internal nodes of a class tree proportionally
+ * to the unigram mass of their subtrees. The children of a node without
+ * unigram mass are sampled uniformly.
+ *
+ * Every thread owns its own instance, seeded differently (e.g. with the
+ * thread id), so that the threads draw independent samples.
+ */
+class NodeDistributions {
+ public:
+  NodeDistributions(
+      const VectorReal& node_unigram,
+      const boost::shared_ptr<ClassTree>& tree,
+      unsigned int seed = 0);
+
+  // Samples one of the children of node.
+  int sample(int node);
+
+  // Returns the log probability of sampling node from its parent.
+  Real logProb(int node) const;
+
+ private:
+  boost::shared_ptr<ClassTree> tree;
+
+  mt19937 gen;
+  vector<discrete_distribution<int>> dists;
+  VectorReal logProbs;
+};
+
+} // namespace oxlm
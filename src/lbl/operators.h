@@ -31,6 +31,21 @@ struct CwiseAdagradUpdateOp {
   Scalar step_size, eps;
 };
 
+/**
+ * Soft thresholding: shrinks x towards 0 by shrinkage, stopping at 0 (the
+ * proximal step of L1 regularization).
+ */
+template<class Scalar>
+struct CwiseShrinkOp {
+  CwiseShrinkOp(const Scalar& shrinkage) : shrinkage(shrinkage) {}
+
+  Scalar operator()(const Scalar& x) const {
+    return x > shrinkage ? x - shrinkage : (x < -shrinkage ? x + shrinkage : 0);
+  }
+
+  Scalar shrinkage;
+};
+
 template<class Scalar>
 struct CwiseRectifierOp {
   const Scalar operator()(const Scalar& x) const {
@@ -15,7 +15,7 @@ using namespace std;
 
 namespace oxlm {
 
-ParallelCorpus::ParallelCorpus() {}
+ParallelCorpus::ParallelCorpus() : sourceEndId(1) {}
 
 ParallelCorpus::ParallelCorpus(
 		const string& training_file,
@@ -30,9 +30,9 @@ ParallelCorpus::ParallelCorpus(
   // <s> and </s> and therefore has size > 2), make them immutable.
   bool immutable_vocab = vocab->size() > 2;
   bool immutable_source_vocab = vocab->sourceSize() > 2;
-	int src_end_id = convertSource(
+	sourceEndId = convertSource(
       "</s>", vocab, immutable_source_vocab, convert_unknowns);
-	int end_id = convert("</s>", vocab, immutable_vocab, convert_unknowns);
+	endId = convert("</s>", vocab, immutable_vocab, convert_unknowns);
 
 	ifstream tin(training_file);
 	ifstream ain(alignment_file);
@@ -50,13 +50,13 @@ ParallelCorpus::ParallelCorpus(
           token, vocab, immutable_source_vocab, convert_unknowns);
       srcData.push_back(word_id);
     }
-    srcData.push_back(src_end_id);
+    srcData.push_back(sourceEndId);
 
     while (stream >> token) {
       int word_id = convert(token, vocab, immutable_vocab, convert_unknowns);
       data.push_back(word_id);
     }
-    data.push_back(end_id);
+    data.push_back(endId);
 
     alignments.resize(data.size());
     stringstream astream(alignment_line);
@@ -77,13 +77,20 @@ ParallelCorpus::ParallelCorpus(
   for (auto& links: alignments) {
     sort(links.begin(), links.end());
   }
+
+  indexSentences();
+  indexAlignments();
 }
 
 ParallelCorpus::ParallelCorpus(
     const vector<int>& source_data,
     const vector<int>& target_data,
-    const vector<vector<long long>>& links)
-    : Corpus(target_data), srcData(source_data), alignments(links) {}
+    const vector<vector<long long>>& links,
+    int end_id, int source_end_id)
+    : Corpus(target_data, end_id), srcData(source_data), alignments(links),
+      sourceEndId(source_end_id) {
+  indexAlignments();
+}
 
 size_t ParallelCorpus::sourceSize() const {
   return srcData.size();
@@ -101,6 +108,99 @@ bool ParallelCorpus::isAligned(long long index) const {
   return alignments[index].size() > 0;
 }
 
+int ParallelCorpus::getSourceEndId() const {
+  return sourceEndId;
+}
+
+long long ParallelCorpus::getAffinity(long long index) const {
+  return affinities[index];
+}
+
+int ParallelCorpus::getSourceSentencePosition(long long source_index) const {
+  return sourcePositions[source_index];
+}
+
+int ParallelCorpus::getSourceWordsLeft(long long source_index) const {
+  return sourceWordsLeft[source_index];
+}
+
+size_t ParallelCorpus::memoryUsage() const {
+  size_t memory = Corpus::memoryUsage() + srcData.size() * sizeof(int);
+  for (const auto& links: alignments) {
+    memory += sizeof(links) + links.size() * sizeof(long long);
+  }
+  return memory + affinities.size() * sizeof(long long)
+      + sourcePositions.size() + sourceWordsLeft.size();
+}
+
+/**
+ * Finds the closest target word that is aligned to at least one source word. In
+ * case of a tie, the preference is given to the right. Returns -1 if no word
+ * is aligned.
+ */
+long long ParallelCorpus::findClosestAlignedWord(long long index) const {
+  long long size = data.size();
+  bool overlaps_start = false, overlaps_end = false;
+  // In every sentence the end-of-sentence markers are aligned, so the search
+  // stops within the sentence.
+  for (long long delta = 0; index - delta >= 0 || index + delta < size;
+       ++delta) {
+    long long relative_index = index + delta;
+    if (relative_index < size) {
+      if (!overlaps_end && isAligned(relative_index)) {
+        return relative_index;
+      }
+
+      if (data[relative_index] == endId) {
+        overlaps_end = true;
+      }
+    }
+
+    relative_index = index - delta;
+    if (relative_index >= 0) {
+      if (data[relative_index] == endId) {
+        overlaps_start = true;
+      }
+
+      if (!overlaps_start && isAligned(relative_index)) {
+        return relative_index;
+      }
+    }
+  }
+
+  return -1;
+}
+
+void ParallelCorpus::indexAlignments() {
+  affinities.resize(data.size());
+  for (size_t i = 0; i < data.size(); ++i) {
+    long long aligned_index = findClosestAlignedWord(i);
+    if (aligned_index < 0) {
+      affinities[i] = -1;
+    } else {
+      const vector<long long>& links = alignments[aligned_index];
+      // Round down just like in the BBN paper.
+      affinities[i] = links[(links.size() - 1) / 2];
+    }
+  }
+
+  sourcePositions.resize(srcData.size());
+  int position = 0;
+  for (size_t i = 0; i < srcData.size(); ++i) {
+    sourcePositions[i] = position;
+    position = srcData[i] == sourceEndId
+        ? 0 : min(position + 1, MAX_SENTENCE_POSITION);
+  }
+
+  sourceWordsLeft.resize(srcData.size());
+  int words_left = 0;
+  for (long long i = srcData.size() - 1; i >= 0; --i) {
+    words_left = srcData[i] == sourceEndId
+        ? 0 : min(words_left + 1, MAX_SENTENCE_POSITION);
+    sourceWordsLeft[i] = words_left;
+  }
+}
+
 } // namespace oxlm
 
 BOOST_CLASS_EXPORT_IMPLEMENT(oxlm::ParallelCorpus)
@@ -24,7 +24,8 @@ class ParallelCorpus : public Corpus {
   ParallelCorpus(
       const vector<int>& source_data,
       const vector<int>& target_data,
-      const vector<vector<long long>>& links);
+      const vector<vector<long long>>& links,
+      int end_id = 1, int source_end_id = 1);
 
   size_t sourceSize() const;
 
@@ -34,22 +35,68 @@ class ParallelCorpus : public Corpus {
 
   bool isAligned(long long index) const;
 
+  int getSourceEndId() const;
+
+  /**
+   * Returns the source position used to condition the target word at index:
+   * the middle link of the closest aligned target word (precomputed).
+   */
+  long long getAffinity(long long index) const;
+
+  /**
+   * Returns the number of words preceding source_index in its source sentence,
+   * capped at MAX_SENTENCE_POSITION.
+   */
+  int getSourceSentencePosition(long long source_index) const;
+
+  /**
+   * Returns the number of words from source_index to the end of its source
+   * sentence (excluding the end of sentence marker), capped at
+   * MAX_SENTENCE_POSITION.
+   */
+  int getSourceWordsLeft(long long source_index) const;
+
+  virtual size_t memoryUsage() const;
+
  private:
+  long long findClosestAlignedWord(long long index) const;
+
+  void indexAlignments();
+
 	friend class boost::serialization::access;
 
-	template<class Archive>
-	void serialize(Archive& ar, const unsigned int version) {
-    ar & boost::serialization::base_object<Corpus>(*this);
+  template<class Archive>
+  void save(Archive& ar, const unsigned int version) const {
+    ar << boost::serialization::base_object<Corpus>(*this);
+
+    ar << srcData;
+    ar << alignments;
+    ar << sourceEndId;
+  }
+
+  template<class Archive>
+  void load(Archive& ar, const unsigned int version) {
+    ar >> boost::serialization::base_object<Corpus>(*this);
+
+    ar >> srcData;
+    ar >> alignments;
+    if (version > 0) {
+      ar >> sourceEndId;
+    }
+    indexAlignments();
+  }
 
-	  ar & srcData;
-	  ar & alignments;
-	}
+  BOOST_SERIALIZATION_SPLIT_MEMBER();
 
  protected:
   vector<int> srcData;
   vector<vector<long long>> alignments;
+  int sourceEndId;
+  vector<long long> affinities;
+  vector<unsigned char> sourcePositions, sourceWordsLeft;
 };
 
 } // namespace oxlm
 
 BOOST_CLASS_EXPORT_KEY(oxlm::ParallelCorpus)
+BOOST_CLASS_VERSION(oxlm::ParallelCorpus, 1)
@@ -7,104 +7,56 @@ ParallelProcessor::ParallelProcessor(
     int context_width, int source_context_width,
     int start_id, int end_id, int source_start_id, int source_end_id)
     : ContextProcessor(corpus, context_width, start_id, end_id),
+      parallelCorpus(dynamic_pointer_cast<ParallelCorpus>(corpus)),
       sourceContextSize(source_context_width), sourceStartId(source_start_id),
-      sourceEndId(source_end_id) {}
+      sourceEndId(source_end_id) {
+  assert(parallelCorpus != nullptr);
+  assert(source_end_id == parallelCorpus->getSourceEndId());
+  assert(source_context_width / 2 < Corpus::MAX_SENTENCE_POSITION);
+}
+
+int ParallelProcessor::getContextWidth() const {
+  return contextSize + 2 * (sourceContextSize / 2) + 1;
+}
 
 /**
- * Returns the parallel conditioning context in the following format:
+ * Writes the parallel conditioning context in the following format:
  * [t_{n-1}, ..., t_{n-m}, s_{a_n-sm}, s_{a_n-sm+1}, .., s_{a_n+sm}]
  * where n = current target index, a_n = t_n affinity, m = target n-gram order,
  * and sm = source order.
  */
-vector<int> ParallelProcessor::extract(long long index) const {
-  vector<int> context = ContextProcessor::extract(index);
-
-  long long aligned_index = findClosestAlignedWord(index);
-
-  boost::shared_ptr<ParallelCorpus> parallel_corpus =
-      dynamic_pointer_cast<ParallelCorpus>(corpus);
-  assert(parallel_corpus != nullptr);
+void ParallelProcessor::extract(long long index, WordId* context) const {
+  ContextProcessor::extract(index, context);
 
-  vector<long long> source_links = parallel_corpus->getLinks(aligned_index);
-  // Round down just like in the BBN paper.
-  long long affinity = source_links[(source_links.size() - 1) / 2];
-
-  vector<int> source_context = extractSource(affinity);
-  context.insert(context.end(), source_context.begin(), source_context.end());
-
-  return context;
+  long long affinity = parallelCorpus->getAffinity(index);
+  assert(affinity >= 0);
+  extractSource(affinity, context + contextSize);
 }
 
-/**
- * Finds the closest target word that is aligned to at least one source word. In
- * case of a tie, the preference is given to the right.
- */
-long long ParallelProcessor::findClosestAlignedWord(long long index) const {
-  boost::shared_ptr<ParallelCorpus> parallel_corpus =
-      dynamic_pointer_cast<ParallelCorpus>(corpus);
-  assert(parallel_corpus != nullptr);
-
-  int delta = 0;
-  long long relative_index = index;
-  bool overlaps_start = false, overlaps_end = false;
-  // This loop is guaranteed to finish because in every sentence the
-  // end-of-sentence markers are aligned.
-  while (true) {
-    if (index + delta < parallel_corpus->size()) {
-      relative_index = index + delta;
-      if (!overlaps_end && parallel_corpus->isAligned(relative_index)) {
-        break;
-      }
-
-      if (parallel_corpus->at(relative_index) == endId) {
-        overlaps_end = true;
-      }
-    }
-
-    if (index - delta >= 0) {
-      relative_index = index - delta;
-      if (parallel_corpus->at(relative_index) == endId) {
-        overlaps_start = true;
-      }
-
-      if (!overlaps_start && parallel_corpus->isAligned(relative_index)) {
-        break;
-      }
-    }
-    ++delta;
+void ParallelProcessor::extractSource(
+    long long source_index, WordId* source_context) const {
+  int half_width = sourceContextSize / 2;
+
+  // The words before the start of the source sentence are replaced by the
+  // start symbol.
+  int num_words = min(
+      parallelCorpus->getSourceSentencePosition(source_index), half_width);
+  int offset = half_width - num_words;
+  fill(source_context, source_context + offset, sourceStartId);
+  for (int i = offset; i < half_width; ++i) {
+    source_context[i] = parallelCorpus->sourceAt(source_index - half_width + i);
   }
 
-  return relative_index;
-}
-
-vector<int> ParallelProcessor::extractSource(long long source_index) const {
-  boost::shared_ptr<ParallelCorpus> parallel_corpus =
-      dynamic_pointer_cast<ParallelCorpus>(corpus);
-  assert(corpus != nullptr);
-
-  vector<int> source_context;
-  bool sentence_start = false;
-  for (int i = 1; i <= sourceContextSize / 2; ++i) {
-    long long index = source_index - i;
-    sentence_start |=
-        index < 0 || parallel_corpus->sourceAt(index) == sourceEndId;
-    int word_id = sentence_start ?
-        sourceStartId : parallel_corpus->sourceAt(index);
-    source_context.push_back(word_id);
-  }
-  reverse(source_context.begin(), source_context.end());
-
-  bool sentence_end = false;
-  for (int i = 0; i <= sourceContextSize / 2; ++i) {
-    long long index = source_index + i;
-    sentence_end |=
-        index >= parallel_corpus->sourceSize() ||
-        parallel_corpus->sourceAt(index) == sourceEndId;
-    int word_id = sentence_end ? sourceEndId : parallel_corpus->sourceAt(index);
-    source_context.push_back(word_id);
+  // The words after the end of the source sentence are replaced by the end
+  // symbol.
+  source_context += half_width;
+  num_words = min(
+      parallelCorpus->getSourceWordsLeft(source_index), half_width + 1);
+  for (int i = 0; i < num_words; ++i) {
+    source_context[i] = parallelCorpus->sourceAt(source_index + i);
   }
-
-  return source_context;
+  fill(source_context + num_words, source_context + half_width + 1,
+       sourceEndId);
 }
 
 } // namespace oxlm
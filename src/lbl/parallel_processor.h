@@ -6,19 +6,26 @@ namespace oxlm {
 
 class ParallelProcessor : public ContextProcessor {
  public:
+  /**
+   * end_id and source_end_id must match the end of sentence ids of the
+   * corpus.
+   */
   ParallelProcessor(
       const boost::shared_ptr<Corpus>& corpus,
       int context_width, int source_context_width,
       int start_id = 0, int end_id = 1,
       int source_start_id = 0, int source_end_id = 1);
 
-  virtual vector<int> extract(long long index) const;
+  virtual int getContextWidth() const;
 
- private:
-  long long findClosestAlignedWord(long long index) const;
+  using ContextProcessor::extract;
+
+  virtual void extract(long long index, WordId* context) const;
 
-  vector<int> extractSource(long long source_index) const;
+ private:
+  void extractSource(long long source_index, WordId* source_context) const;
 
+  boost::shared_ptr<ParallelCorpus> parallelCorpus;
   int sourceContextSize, sourceStartId, sourceEndId;
 };
 
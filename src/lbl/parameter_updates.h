@@ -0,0 +1,48 @@
+#pragma once
+
+#include <algorithm>
+#include <unordered_set>
+#include <vector>
+
+#include "lbl/minibatch_words.h"
+#include "lbl/utils.h"
+
+namespace oxlm {
+
+/**
+ * Parameters updated since the last checkpoint. Delta checkpoints only store
+ * these parameters, together with the (small) dense parameters which are not
+ * indexed by words or feature contexts.
+ */
+struct ParameterUpdates {
+  ParameterUpdates() : shuffled(false) {}
+
+  void clear() {
+    words = MinibatchWords();
+    featureEntries.clear();
+    regularizerSigmas.clear();
+    shuffled = false;
+  }
+
+  /**
+   * Returns the elements of entries in increasing order.
+   */
+  static vector<int> sorted(const unordered_set<int>& entries) {
+    vector<int> result(entries.begin(), entries.end());
+    sort(result.begin(), result.end());
+    return result;
+  }
+
+  // Words whose vectors were updated.
+  MinibatchWords words;
+  // Updated entries of each maxent feature store (U followed by V).
+  vector<unordered_set<int>> featureEntries;
+  // The L2 regularizer shrinks all the word vectors after every minibatch
+  // (w -= w * sigma). The sigmas are stored so that the regularization updates
+  // can be replayed for the word vectors which are not part of the delta.
+  vector<Real> regularizerSigmas;
+  // Whether the training data was shuffled.
+  bool shuffled;
+};
+
+} // namespace oxlm
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+namespace oxlm {
+
+/**
+ * Incremental version of MurmurHash3_x64_128 over a sequence of ints.
+ *
+ * Appending the ints one at a time and calling getHash() after each of them
+ * returns the hashes of all the prefixes of the sequence in a single pass,
+ * without materializing the prefixes. The hashes are identical to the ones
+ * returned by MurmurHash(prefix, seed).
+ *
+ * Copying a PrefixHash is cheap, so a common prefix (e.g. a class id) can be
+ * hashed once and shared by many sequences.
+ */
+class PrefixHash {
+ public:
+  PrefixHash() : PrefixHash(0) {}
+
+  PrefixHash(int seed)
+      : h1(static_cast<uint32_t>(seed)), h2(static_cast<uint32_t>(seed)),
+        k1(0), k2(0), numValues(0) {}
+
+  inline void append(int value) {
+    uint64_t bits = static_cast<uint32_t>(value);
+    int pos = numValues & 3;
+    if (pos < 2) {
+      k1 |= bits << (32 * pos);
+    } else {
+      k2 |= bits << (32 * (pos - 2));
+    }
+
+    ++numValues;
+    if ((numValues & 3) == 0) {
+      h1 ^= mixK1(k1);
+      h1 = rotl(h1, 27); h1 += h2; h1 = h1 * 5 + 0x52dce729;
+      h2 ^= mixK2(k2);
+      h2 = rotl(h2, 31); h2 += h1; h2 = h2 * 5 + 0x38495ab5;
+      k1 = k2 = 0;
+    }
+  }
+
+  inline void append(const vector<int>& values) {
+    for (int value: values) {
+      append(value);
+    }
+  }
+
+  /**
+   * Returns the first half of the 128-bit hash of the values appended so far.
+   */
+  inline size_t getHash() const {
+    return getFullHash().first;
+  }
+
+  inline pair<size_t, size_t> getFullHash() const {
+    uint64_t r1 = h1, r2 = h2;
+    int pos = numValues & 3;
+    if (pos > 2) {
+      r2 ^= mixK2(k2);
+    }
+    if (pos > 0) {
+      r1 ^= mixK1(k1);
+    }
+
+    uint64_t length = static_cast<uint64_t>(numValues) * sizeof(int);
+    r1 ^= length; r2 ^= length;
+    r1 += r2; r2 += r1;
+    r1 = fmix(r1); r2 = fmix(r2);
+    r1 += r2; r2 += r1;
+    return make_pair(r1, r2);
+  }
+
+ private:
+  static inline uint64_t rotl(uint64_t x, int r) {
+    return (x << r) | (x >> (64 - r));
+  }
+
+  static inline uint64_t mixK1(uint64_t k) {
+    k *= 0x87c37b91114253d5ULL; k = rotl(k, 31); k *= 0x4cf5ad432745937fULL;
+    return k;
+  }
+
+  static inline uint64_t mixK2(uint64_t k) {
+    k *= 0x4cf5ad432745937fULL; k = rotl(k, 33); k *= 0x87c37b91114253d5ULL;
+    return k;
+  }
+
+  static inline uint64_t fmix(uint64_t k) {
+    k ^= k >> 33;
+    k *= 0xff51afd7ed558ccdULL;
+    k ^= k >> 33;
+    k *= 0xc4ceb9fe1a85ec53ULL;
+    k ^= k >> 33;
+    return k;
+  }
+
+  uint64_t h1, h2;
+  // The values of the current (incomplete) 16-byte block.
+  uint64_t k1, k2;
+  size_t numValues;
+};
+
+} // namespace oxlm
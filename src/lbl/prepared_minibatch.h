@@ -0,0 +1,35 @@
+#pragma once
+
+#include <vector>
+
+#include "lbl/corpus.h"
+#include "lbl/minibatch_feature_indexes_pair.h"
+#include "lbl/minibatch_feature_store.h"
+
+namespace oxlm {
+
+class Weights;
+
+/**
+ * The data of a minibatch which does not depend on the weights, prepared by
+ * MinibatchPipeline before the minibatch is trained.
+ */
+struct PreparedMinibatch {
+  // The corpus and the positions of the minibatch tokens used for training.
+  // These are either the training corpus and the positions of the tokens in
+  // the training corpus or a MinibatchCorpus and the positions of the copied
+  // tokens.
+  boost::shared_ptr<Corpus> corpus;
+  vector<int> indices;
+  // Feature indexes of the minibatch contexts (only for maxent models with
+  // sparse feature stores).
+  MinibatchFeatureIndexesPairPtr featureIndexes;
+  // Empty sparse feature stores (for the classes and for the words of each
+  // class) built for the gradient which prepared the minibatch. The other
+  // gradients build their own stores from the feature indexes.
+  const Weights* featureStoresOwner = nullptr;
+  boost::shared_ptr<MinibatchFeatureStore> classFeatureStore;
+  vector<boost::shared_ptr<MinibatchFeatureStore>> wordFeatureStores;
+};
+
+} // namespace oxlm
@@ -0,0 +1,102 @@
+#include <iostream>
+#include <sstream>
+
+#include <boost/algorithm/string.hpp>
+#include <boost/archive/binary_oarchive.hpp>
+#include <boost/program_options.hpp>
+
+#include "lbl/model.h"
+#include "lbl/model_utils.h"
+#include "lbl/utils.h"
+
+using namespace boost::program_options;
+using namespace oxlm;
+using namespace std;
+
+size_t GetSerializedSize(const FactoredMaxentLM& model) {
+  ostringstream stream(ios_base::binary);
+  boost::archive::binary_oarchive oar(stream);
+  boost::shared_ptr<GlobalFactoredMaxentWeights> weights = model.getWeights();
+  oar << weights;
+  return stream.tellp();
+}
+
+int main(int argc, char** argv) {
+  options_description desc("Command line options");
+  desc.add_options()
+      ("help,h", "Print help message.")
+      ("model,m", value<string>()->required(),
+          "File containing the (factored maxent) model.")
+      ("data,d", value<string>(),
+          "Test set used to report the perplexity of the pruned models.")
+      ("thresholds", value<string>()->default_value("0"),
+          "Comma separated list of pruning thresholds. Maxent weights with "
+          "a smaller absolute value (after shrinkage) are dropped. Pruning "
+          "does not shrink models trained with --hash-space: the dropped "
+          "weights are set to 0, but the collision space keeps its size.")
+      ("shrinkage", value<Real>()->default_value(0),
+          "Shrink all the maxent weights towards 0 by this amount before "
+          "pruning (L1 style).")
+      ("model-out,o", value<string>(),
+          "Write the model pruned with the last threshold to this file.")
+      ("threads", value<int>()->default_value(1),
+          "Number of threads for evaluation.");
+
+  variables_map vm;
+  store(parse_command_line(argc, argv, desc), vm);
+
+  if (vm.count("help")) {
+    cout << desc << endl;
+    return 0;
+  }
+
+  notify(vm);
+
+  string model_file = vm["model"].as<string>();
+  Real shrinkage = vm["shrinkage"].as<Real>();
+  int num_threads = vm["threads"].as<int>();
+  vector<string> thresholds;
+  boost::split(thresholds, vm["thresholds"].as<string>(), boost::is_any_of(","));
+
+  boost::shared_ptr<Corpus> test_corpus;
+  cout << "threshold\tshrinkage\tmaxent weights\tweights size (bytes)"
+       << (vm.count("data") ? "\tperplexity" : "") << endl;
+  for (const string& threshold_str: thresholds) {
+    Real threshold = stof(threshold_str);
+
+    // Every threshold starts from the original model, so that the shrinkage
+    // is applied only once.
+    FactoredMaxentLM model;
+    model.load(model_file);
+    size_t num_weights = model.getWeights()->prune(threshold, shrinkage);
+
+    size_t weights_size = GetSerializedSize(model);
+    Real test_perplexity = 0;
+    if (vm.count("data")) {
+      boost::shared_ptr<ModelData> config = model.getConfig();
+      config->test_file = vm["data"].as<string>();
+      if (test_corpus == nullptr) {
+        test_corpus = readTestCorpus(config, model.getVocab(), true);
+      }
+
+      Real accumulator = 0;
+      #pragma omp parallel num_threads(num_threads)
+      model.evaluate(test_corpus, accumulator);
+      test_perplexity = perplexity(accumulator, test_corpus->size());
+    }
+
+    cout << threshold << "\t" << shrinkage << "\t" << num_weights << "\t"
+         << weights_size;
+    if (vm.count("data")) {
+      cout << "\t" << test_perplexity;
+    }
+    cout << endl;
+
+    if (vm.count("model-out") && &threshold_str == &thresholds.back()) {
+      model.getConfig()->model_output_file = vm["model-out"].as<string>();
+      model.save();
+    }
+  }
+
+  return 0;
+}
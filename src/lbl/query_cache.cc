@@ -15,6 +15,10 @@ size_t QueryCache::size() const {
   return cache.size();
 }
 
+size_t QueryCache::memoryUsage() const {
+  return cache.memoryUsage();
+}
+
 void QueryCache::clear() {
   cache.clear();
 }
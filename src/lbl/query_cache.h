@@ -3,7 +3,10 @@
 #include <unordered_map>
 
 #include <boost/serialization/serialization.hpp>
+#include <boost/serialization/split_member.hpp>
+#include <boost/serialization/version.hpp>
 
+#include "lbl/flat_hash_map.h"
 #include "lbl/ngram.h"
 #include "lbl/utils.h"
 #include "utils/serialization_helpers.h"
@@ -20,6 +23,8 @@ class QueryCache {
 
   size_t size() const;
 
+  size_t memoryUsage() const;
+
   void clear();
 
   bool operator==(const QueryCache& other) const;
@@ -28,13 +33,33 @@ class QueryCache {
   friend class boost::serialization::access;
 
   template<class Archive>
-  void serialize(Archive& ar, const unsigned int version) {
-    ar & cache;
+  void save(Archive& ar, const unsigned int version) const {
+    ar << cache;
+  }
+
+  template<class Archive>
+  void load(Archive& ar, const unsigned int version) {
+    cache.clear();
+    if (version > 0) {
+      ar >> cache;
+    } else {
+      // Caches saved before version 1 used an unordered_map.
+      unordered_map<size_t, Real> old_cache;
+      ar >> old_cache;
+      cache.reserve(old_cache.size());
+      for (const auto& entry: old_cache) {
+        cache.insert(entry);
+      }
+    }
   }
 
+  BOOST_SERIALIZATION_SPLIT_MEMBER();
+
  public:
   hash<NGram> hashFunction;
-  unordered_map<size_t, Real> cache;
+  FlatHashMap<size_t, Real> cache;
 };
 
 } // namespace oxlm
+
+BOOST_CLASS_VERSION(oxlm::QueryCache, 1)
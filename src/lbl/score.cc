@@ -1,7 +1,7 @@
 #include <boost/program_options.hpp>
 
-#include "lbl/context_processor.h"
 #include "lbl/model.h"
+#include "lbl/sentence_scorer.h"
 #include "lbl/utils.h"
 
 using namespace boost::program_options;
@@ -9,34 +9,30 @@ using namespace oxlm;
 using namespace std;
 
 template<class Model>
-void score(const string& model_file, const string& data_file) {
+void score(
+    const string& model_file, const string& data_file,
+    const string& alignment_file, int num_threads, bool summary_only) {
   Model model;
   model.load(model_file);
 
   boost::shared_ptr<ModelData> config = model.getConfig();
   config->test_file = data_file;
+  config->test_alignment_file = alignment_file;
   boost::shared_ptr<Vocabulary> vocab = model.getVocab();
   boost::shared_ptr<Corpus> test_corpus =
       readTestCorpus(config, vocab, true);
 
-  double sentence_log_likelihood = 0, total_log_likelihood = 0;
-  int eos = vocab->convert("</s>");
-  ContextProcessor processor(test_corpus, config->ngram_order - 1);
-  for (size_t i = 0; i < test_corpus->size(); ++i) {
-    int word_id = test_corpus->at(i);
-    vector<int> context = processor.extract(i);
-    double log_prob = model.getLogProb(word_id, context);
-    sentence_log_likelihood += log_prob;
-    total_log_likelihood += log_prob;
-    cout << "(" << vocab->convert(word_id) << " " << log_prob << ") ";
-    if (word_id == eos) {
-      cout << "Sentence log likelihood: " << sentence_log_likelihood << endl;
-      sentence_log_likelihood = 0;
-    }
-  }
+  SentenceScorer<Model> scorer(model, test_corpus, num_threads);
+  double total_log_likelihood =
+      scorer.score(cout, "Sentence log likelihood", summary_only);
 
-  cerr << "Overall perplexity: "
-       << perplexity(-total_log_likelihood, test_corpus->size()) << endl;
+  Real test_perplexity =
+      perplexity(-total_log_likelihood, test_corpus->size());
+  if (summary_only) {
+    cout << "Overall perplexity: " << test_perplexity << endl;
+  } else {
+    cerr << "Overall perplexity: " << test_perplexity << endl;
+  }
 }
 
 int main(int argc, char** argv) {
@@ -45,7 +41,12 @@ int main(int argc, char** argv) {
       ("help,h", "Print help message.")
       ("model,m", value<string>()->required(), "File containing the model")
       ("type,t", value<int>()->required(), "Model type")
-      ("data,d", value<string>()->required(), "File containing the test corpus");
+      ("data,d", value<string>()->required(), "File containing the test corpus")
+      ("alignment,a", value<string>()->default_value(""),
+          "File containing the word alignments (source conditioned models)")
+      ("threads", value<int>()->required()->default_value(1),
+          "Number of threads for scoring.")
+      ("summary-only", "Only print the overall perplexity.");
 
   variables_map vm;
   store(parse_command_line(argc, argv, desc), vm);
@@ -57,22 +58,39 @@ int main(int argc, char** argv) {
 
   notify(vm);
 
+  ios_base::sync_with_stdio(false);
+
   string model_file = vm["model"].as<string>();
   string data_file = vm["data"].as<string>();
+  string alignment_file = vm["alignment"].as<string>();
+  int num_threads = vm["threads"].as<int>();
+  bool summary_only = vm.count("summary-only");
   ModelType model_type = static_cast<ModelType>(vm["type"].as<int>());
 
   switch (model_type) {
     case NLM:
-      score<LM>(model_file, data_file);
+      score<LM>(
+          model_file, data_file, alignment_file, num_threads, summary_only);
       return 0;
     case FACTORED_NLM:
-      score<FactoredLM>(model_file, data_file);
+      score<FactoredLM>(
+          model_file, data_file, alignment_file, num_threads, summary_only);
       return 0;
     case FACTORED_MAXENT_NLM:
-      score<FactoredMaxentLM>(model_file, data_file);
+      score<FactoredMaxentLM>(
+          model_file, data_file, alignment_file, num_threads, summary_only);
+      return 0;
+    case SOURCE_FACTORED_NLM:
+      if (alignment_file.empty()) {
+        cout << "Source conditioned models require --alignment" << endl;
+        return 1;
+      }
+      score<SourceFactoredLM>(
+          model_file, data_file, alignment_file, num_threads, summary_only);
       return 0;
     case FACTORED_TREE_NLM:
-      score<FactoredTreeLM>(model_file, data_file);
+      score<FactoredTreeLM>(
+          model_file, data_file, alignment_file, num_threads, summary_only);
       return 0;
     default:
       cout << "Unknown model type" << endl;
@@ -1,7 +1,7 @@
 #include <boost/program_options.hpp>
 
 #include "lbl/model.h"
-#include "lbl/parallel_processor.h"
+#include "lbl/sentence_scorer.h"
 
 using namespace boost::program_options;
 using namespace std;
@@ -15,7 +15,10 @@ int main(int argc, char** argv) {
       ("test,t", value<string>()->required(),
           "File containing parallel test corpus.")
       ("alignment,a", value<string>()->required(),
-          "File containing the alignments");
+          "File containing the alignments")
+      ("threads", value<int>()->required()->default_value(1),
+          "Number of threads for scoring.")
+      ("summary-only", "Only print the overall perplexity.");
 
   variables_map vm;
   store(parse_command_line(argc, argv, desc), vm);
@@ -27,6 +30,8 @@ int main(int argc, char** argv) {
 
   notify(vm);
 
+  ios_base::sync_with_stdio(false);
+
   SourceFactoredLM model;
   model.load(vm["model"].as<string>());
   boost::shared_ptr<Vocabulary> vocab = model.getVocab();
@@ -37,22 +42,14 @@ int main(int argc, char** argv) {
   boost::shared_ptr<Corpus> test_corpus =
       readTestCorpus(config, vocab, true);
 
-  int context_width = config->ngram_order - 1;
-  int source_context_width = 2 * config->source_order - 1;
-  ParallelProcessor processor(test_corpus, context_width, source_context_width);
-
-  double total = 0;
-  int eos = vocab->convert("</s>");
-  for (size_t i = 0; i < test_corpus->size(); ++i) {
-    int word_id = test_corpus->at(i);
-    vector<int> context = processor.extract(i);
-    double log_prob = model.getLogProb(word_id, context);
-    total += log_prob;
-    cout << "(" << vocab->convert(word_id) << " " << log_prob << ") ";
-    if (word_id == eos) {
-      cout << "Total: " << total << endl;
-      total = 0;
-    }
+  bool summary_only = vm.count("summary-only");
+  SentenceScorer<SourceFactoredLM> scorer(
+      model, test_corpus, vm["threads"].as<int>());
+  double total = scorer.score(cout, "Total", summary_only);
+
+  if (summary_only) {
+    cout << "Overall perplexity: "
+         << perplexity(-total, test_corpus->size()) << endl;
   }
 
   return 0;
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <numeric>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+
+#include "lbl/corpus.h"
+#include "lbl/utils.h"
+#include "lbl/vocabulary.h"
+#include "utils/conditional_omp.h"
+
+using namespace std;
+
+namespace oxlm {
+
+/**
+ * Scores a test corpus sentence by sentence using a pool of threads.
+ *
+ * Sentences are processed in windows of bufferSize sentences. Within a window,
+ * every sentence is scored with a single batched call to Model::getLogProbs
+ * and its output is rendered into a slot of the reorder buffer. Once the whole
+ * window is scored, the slots are written out in corpus order, so the output
+ * does not depend on the number of threads or on the thread scheduling.
+ */
+template<class Model>
+class SentenceScorer {
+ public:
+  SentenceScorer(
+      const Model& model, const boost::shared_ptr<Corpus>& corpus,
+      int num_threads, int buffer_size = 10000)
+      : model(model), corpus(corpus), vocab(model.getVocab()),
+        numThreads(num_threads), bufferSize(buffer_size) {
+    int eos = vocab->convert("</s>");
+    sentenceStarts.push_back(0);
+    for (size_t i = 0; i < corpus->size(); ++i) {
+      if (corpus->at(i) == eos) {
+        sentenceStarts.push_back(i + 1);
+      }
+    }
+    if (sentenceStarts.back() != corpus->size()) {
+      sentenceStarts.push_back(corpus->size());
+    }
+  }
+
+  size_t numSentences() const {
+    return sentenceStarts.size() - 1;
+  }
+
+  /**
+   * Writes "(word log_prob) " for every token, followed by
+   * "<label>: <sentence log likelihood>" at the end of each sentence. If
+   * summary_only is set, nothing is written.
+   *
+   * Returns the total log likelihood of the corpus.
+   */
+  double score(ostream& out, const string& label, bool summary_only) const {
+    double total = 0;
+    vector<double> totals(bufferSize);
+    vector<string> lines(bufferSize);
+    for (size_t start = 0; start < numSentences(); start += bufferSize) {
+      size_t end = min(start + bufferSize, numSentences());
+
+      #pragma omp parallel for schedule(dynamic) num_threads(numThreads)
+      for (long long i = start; i < static_cast<long long>(end); ++i) {
+        vector<int> indices(sentenceStarts[i + 1] - sentenceStarts[i]);
+        iota(indices.begin(), indices.end(), sentenceStarts[i]);
+
+        VectorReal log_probs = model.getLogProbs(corpus, indices);
+        double sentence_total = 0;
+        for (int j = 0; j < log_probs.size(); ++j) {
+          sentence_total += log_probs(j);
+        }
+        totals[i - start] = sentence_total;
+
+        if (!summary_only) {
+          ostringstream line;
+          for (size_t j = 0; j < indices.size(); ++j) {
+            line << "(" << vocab->convert(corpus->at(indices[j])) << " "
+                 << log_probs(j) << ") ";
+          }
+          line << label << ": " << sentence_total << "\n";
+          lines[i - start] = line.str();
+        }
+      }
+
+      // Drain the reorder buffer in corpus order.
+      for (size_t i = 0; i < end - start; ++i) {
+        total += totals[i];
+        if (!summary_only) {
+          out << lines[i];
+        }
+      }
+    }
+
+    out.flush();
+    return total;
+  }
+
+ private:
+  const Model& model;
+  boost::shared_ptr<Corpus> corpus;
+  boost::shared_ptr<Vocabulary> vocab;
+  int numThreads;
+  size_t bufferSize;
+  vector<size_t> sentenceStarts;
+};
+
+} // namespace oxlm
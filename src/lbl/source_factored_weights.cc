@@ -10,8 +10,9 @@ SourceFactoredWeights::SourceFactoredWeights()
 
 SourceFactoredWeights::SourceFactoredWeights(
     const boost::shared_ptr<ModelData>& config,
-    const boost::shared_ptr<FactoredMetadata>& metadata)
-    : FactoredWeights(config, metadata),
+    const boost::shared_ptr<FactoredMetadata>& metadata,
+    bool row_wise_adagrad)
+    : FactoredWeights(config, metadata, row_wise_adagrad),
       data(NULL), size(0), SQ(0, 0, 0), SW(0, 0) {
   allocate();
   SW.setZero();
@@ -45,7 +46,7 @@ void SourceFactoredWeights::allocate() {
   int num_source_words = config->source_vocab_size;
   int source_context_width = 2 * config->source_order - 1;
 
-  int SQ_size = word_width * num_source_words;
+  int SQ_size = getWordVectorWidth() * num_source_words;
   int SC_size = config->diagonal_contexts ? word_width : word_width * word_width;
 
   size = SQ_size + source_context_width * SC_size;
@@ -67,12 +68,12 @@ void SourceFactoredWeights::setModelParameters() {
   int num_source_words = config->source_vocab_size;
   int source_context_width = 2 * config->source_order - 1;
 
-  int SQ_size = word_width * num_source_words;
+  int SQ_size = getWordVectorWidth() * num_source_words;
   int SC_size = config->diagonal_contexts ? word_width : word_width * word_width;
 
   new (&SW) WeightsType(data, size);
 
-  new (&SQ) WordVectorsType(data, word_width, num_source_words);
+  new (&SQ) WordVectorsType(data, getWordVectorWidth(), num_source_words);
 
   Real* start = data + SQ_size;
   for (int i = 0; i < source_context_width; ++i) {
@@ -89,6 +90,18 @@ size_t SourceFactoredWeights::numParameters() const {
   return FactoredWeights::numParameters() + size;
 }
 
+void SourceFactoredWeights::reportMemory(MemoryReport& report) const {
+  FactoredWeights::reportMemory(report);
+  report.add("SQ", SQ.size() * sizeof(Real));
+  size_t SC_size = 0;
+  for (const auto& context_transform: SC) {
+    SC_size += context_transform.size();
+  }
+  report.add("SC", SC_size * sizeof(Real));
+  report.add("source mutexes",
+      (mutexesSQ.size() + mutexesSC.size()) * (sizeof(Mutex) + sizeof(mutex)));
+}
+
 void SourceFactoredWeights::printInfo() const {
   cout << "===============================" << endl;
   cout << " Model parameters: " << endl;
@@ -105,6 +118,10 @@ void SourceFactoredWeights::init(
   FactoredWeights::init(corpus, minibatch);
 }
 
+void SourceFactoredWeights::init(const PreparedMinibatch& minibatch) {
+  FactoredWeights::init(minibatch);
+}
+
 void SourceFactoredWeights::getContextVectors(
     const boost::shared_ptr<Corpus>& corpus,
     const vector<int>& indices,
@@ -115,16 +132,15 @@ void SourceFactoredWeights::getContextVectors(
   int source_context_width = 2 * config->source_order - 1;
   int total_width = context_width + source_context_width;
 
-  boost::shared_ptr<ParallelProcessor> processor =
-      boost::make_shared<ParallelProcessor>(
-          corpus, context_width, source_context_width);
+  ParallelProcessor processor(corpus, context_width, source_context_width);
+  assert(processor.getContextWidth() == total_width);
 
   contexts.resize(indices.size());
   context_vectors.resize(
       total_width, MatrixReal::Zero(word_width, indices.size()));
   for (size_t i = 0; i < indices.size(); ++i) {
-    contexts[i] = processor->extract(indices[i]);
-    assert(contexts[i].size() == total_width);
+    contexts[i].resize(total_width);
+    processor.extract(indices[i], contexts[i].data());
     for (int j = 0; j < context_width; ++j) {
       context_vectors[j].col(i) = Q.col(contexts[i][j]);
     }
@@ -280,12 +296,15 @@ void SourceFactoredWeights::updateSquared(
   FactoredWeights::updateSquared(global_words, global_gradient);
 
   for (int word_id: global_words.getSourceWords()) {
-    SQ.col(word_id).array() += global_gradient->SQ.col(word_id).array().square();
+    updateSquaredVector(SQ, global_gradient->SQ, word_id);
   }
 
-  Block block = getBlock(SQ.size(), SW.size() - SQ.size());
-  SW.segment(block.first, block.second).array() +=
-      global_gradient->SW.segment(block.first, block.second).array().square();
+  size_t offset = SQ.size();
+  size_t gradient_offset = global_gradient->SQ.size();
+  Block block = getBlock(0, SW.size() - offset);
+  SW.segment(offset + block.first, block.second).array() +=
+      global_gradient->SW.segment(gradient_offset + block.first, block.second)
+          .array().square();
 }
 
 void SourceFactoredWeights::updateAdaGrad(
@@ -296,14 +315,15 @@ void SourceFactoredWeights::updateAdaGrad(
       global_words, global_gradient, adagrad);
 
   for (int word_id: global_words.getSourceWords()) {
-    SQ.col(word_id) -= global_gradient->SQ.col(word_id).binaryExpr(
-        adagrad->SQ.col(word_id), CwiseAdagradUpdateOp<Real>(config->step_size));
+    updateAdaGradVector(SQ, global_gradient->SQ, adagrad->SQ, word_id);
   }
 
-  Block block = getBlock(SQ.size(), SW.size() - SQ.size());
-  SW.segment(block.first, block.second) -=
-      global_gradient->SW.segment(block.first, block.second).binaryExpr(
-          adagrad->SW.segment(block.first, block.second),
+  size_t offset = SQ.size();
+  size_t adagrad_offset = adagrad->SQ.size();
+  Block block = getBlock(0, SW.size() - offset);
+  SW.segment(offset + block.first, block.second) -=
+      global_gradient->SW.segment(offset + block.first, block.second).binaryExpr(
+          adagrad->SW.segment(adagrad_offset + block.first, block.second),
           CwiseAdagradUpdateOp<Real>(config->step_size));
 }
 
@@ -364,7 +384,7 @@ VectorReal SourceFactoredWeights::getPredictionVector(
     if (config->diagonal_contexts) {
       prediction_vector += SC[i].asDiagonal() * SQ.col(context[j]);
     } else {
-      prediction_vector += SC[i] * Q.col(context[j]);
+      prediction_vector += SC[i] * SQ.col(context[j]);
     }
   }
 
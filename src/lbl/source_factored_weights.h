@@ -10,7 +10,8 @@ class SourceFactoredWeights : public FactoredWeights {
 
   SourceFactoredWeights(
       const boost::shared_ptr<ModelData>& config,
-      const boost::shared_ptr<FactoredMetadata>& metadata);
+      const boost::shared_ptr<FactoredMetadata>& metadata,
+      bool row_wise_adagrad = false);
 
   SourceFactoredWeights(
       const boost::shared_ptr<ModelData>& config,
@@ -28,12 +29,16 @@ class SourceFactoredWeights : public FactoredWeights {
 
   virtual size_t numParameters() const;
 
+  virtual void reportMemory(MemoryReport& report) const;
+
   virtual void printInfo() const;
 
   void init(
       const boost::shared_ptr<Corpus>& corpus,
       const vector<int>& minibatch);
 
+  void init(const PreparedMinibatch& minibatch);
+
   void syncUpdate(
       const MinibatchWords& words,
       const boost::shared_ptr<SourceFactoredWeights>& gradient);
@@ -53,6 +58,30 @@ class SourceFactoredWeights : public FactoredWeights {
 
   void clear(const MinibatchWords& words, bool parallel_update);
 
+  template<class Archive>
+  void saveDelta(Archive& ar, const ParameterUpdates& updates) const {
+    FactoredWeights::saveDelta(ar, updates);
+
+    saveColumns(ar, SQ, updates.words.getSourceWordsSet());
+
+    int offset = SQ.size();
+    ar << boost::serialization::make_array(data + offset, size - offset);
+  }
+
+  template<class Archive>
+  void loadDelta(Archive& ar, const vector<Real>& regularizer_sigmas) {
+    FactoredWeights::loadDelta(ar, regularizer_sigmas);
+
+    for (Real sigma: regularizer_sigmas) {
+      SW -= SW * sigma;
+    }
+
+    loadColumns(ar, SQ);
+
+    int offset = SQ.size();
+    ar >> boost::serialization::make_array(data + offset, size - offset);
+  }
+
   ~SourceFactoredWeights();
 
  protected:
@@ -1,5 +1,12 @@
 #include "lbl/sparse_global_feature_store.h"
 
+#include <algorithm>
+#include <limits>
+
+#include <boost/make_shared.hpp>
+
+#include "lbl/exceptions.h"
+#include "lbl/memory_report.h"
 #include "lbl/operators.h"
 #include "lbl/sparse_minibatch_feature_store.h"
 #include "utils/constants.h"
@@ -11,23 +18,31 @@ SparseGlobalFeatureStore::SparseGlobalFeatureStore() {}
 SparseGlobalFeatureStore::SparseGlobalFeatureStore(
     int vector_max_size, int num_contexts,
     const boost::shared_ptr<FeatureContextExtractor>& extractor)
-    : vectorMaxSize(vector_max_size), extractor(extractor) {
-  featureWeights = vector<SparseVectorReal>(
-      num_contexts, SparseVectorReal(vectorMaxSize));
-}
+    : vectorMaxSize(vector_max_size), extractor(extractor),
+      offsets(num_contexts + 1, 0) {}
 
 SparseGlobalFeatureStore::SparseGlobalFeatureStore(
     int vector_max_size,
     GlobalFeatureIndexesPtr feature_indexes,
     const boost::shared_ptr<FeatureContextExtractor>& extractor)
     : vectorMaxSize(vector_max_size), extractor(extractor) {
-  featureWeights = vector<SparseVectorReal>(
-      feature_indexes->size(), SparseVectorReal(vectorMaxSize));
-  for (size_t i = 0; i < feature_indexes->size(); ++i) {
-    for (int feature_index: feature_indexes->at(i)) {
-      hintFeatureIndex(i, feature_index);
+  offsets.reserve(feature_indexes->size() + 1);
+  offsets.push_back(0);
+  for (const auto& feature_context_indexes: *feature_indexes) {
+    size_t start = indexes.size();
+    indexes.insert(
+        indexes.end(),
+        feature_context_indexes.begin(), feature_context_indexes.end());
+    sort(indexes.begin() + start, indexes.end());
+    indexes.erase(unique(indexes.begin() + start, indexes.end()), indexes.end());
+    if (indexes.size() > numeric_limits<int>::max()) {
+      throw FeatureStoreOverflowException();
     }
+    offsets.push_back(indexes.size());
   }
+
+  indexes.shrink_to_fit();
+  values.resize(indexes.size(), 0);
 }
 
 VectorReal SparseGlobalFeatureStore::get(const vector<int>& context) const {
@@ -35,7 +50,10 @@ VectorReal SparseGlobalFeatureStore::get(const vector<int>& context) const {
   for (int feature_context_id: extractor->getFeatureContextIds(context)) {
     // We do not extract feature context ids for contexts that have not been
     // observed.
-    result += featureWeights[feature_context_id];
+    for (int k = offsets[feature_context_id];
+         k < offsets[feature_context_id + 1]; ++k) {
+      result(indexes[k]) += values[k];
+    }
   }
   return result;
 }
@@ -44,7 +62,10 @@ Real SparseGlobalFeatureStore::getValue(
     int feature_index, const vector<int>& context) const {
   Real result = 0;
   for (int feature_context_id: extractor->getFeatureContextIds(context)) {
-    result += featureWeights[feature_context_id].coeff(feature_index);
+    int pos = getPosition(feature_context_id, feature_index);
+    if (pos != -1) {
+      result += values[pos];
+    }
   }
   return result;
 }
@@ -56,7 +77,9 @@ void SparseGlobalFeatureStore::l2GradientUpdate(
       SparseMinibatchFeatureStore::cast(base_minibatch_store);
 
   for (const auto& entry: minibatch_store->featureWeights) {
-    featureWeights[entry.first] -= sigma * featureWeights[entry.first];
+    for (int k = offsets[entry.first]; k < offsets[entry.first + 1]; ++k) {
+      values[k] -= sigma * values[k];
+    }
   }
 }
 
@@ -68,7 +91,9 @@ Real SparseGlobalFeatureStore::l2Objective(
 
   Real result = 0;
   for (const auto& entry: minibatch_store->featureWeights) {
-    result += featureWeights[entry.first].cwiseAbs2().sum();
+    for (int k = offsets[entry.first]; k < offsets[entry.first + 1]; ++k) {
+      result += values[k] * values[k];
+    }
   }
 
   return factor * result;
@@ -92,38 +117,67 @@ void SparseGlobalFeatureStore::updateAdaGrad(
       SparseMinibatchFeatureStore::cast(base_gradient_store);
   boost::shared_ptr<SparseGlobalFeatureStore> adagrad_store =
       cast(base_adagrad_store);
+  // The AdaGrad store is constructed from the same feature indexes, so the
+  // positions in the values arrays match.
+  assert(indexes == adagrad_store->indexes);
 
+  CwiseAdagradUpdateOp<Real> op(step_size);
   for (const auto& entry: gradient_store->featureWeights) {
-    SparseVectorReal& weights = featureWeights.at(entry.first);
-    const SparseVectorReal& gradient = entry.second;
-    const SparseVectorReal& adagrad =
-        adagrad_store->featureWeights.at(entry.first);
-    weights -= gradient.binaryExpr(
-        adagrad, CwiseAdagradUpdateOp<Real>(step_size));
+    int k = offsets[entry.first], end = offsets[entry.first + 1];
+    for (SparseVectorReal::InnerIterator it(entry.second); it; ++it) {
+      while (k < end && indexes[k] < it.index()) {
+        ++k;
+      }
+      if (k == end || indexes[k] != it.index()) {
+        throw UndefinedFeatureException();
+      }
+      values[k] -= op(it.value(), adagrad_store->values[k]);
+    }
   }
 }
 
 size_t SparseGlobalFeatureStore::size() const {
-  return featureWeights.size();
+  return offsets.size() - 1;
+}
+
+size_t SparseGlobalFeatureStore::memoryUsage() const {
+  return MemoryReport::getContainerBytes(offsets)
+      + MemoryReport::getContainerBytes(indexes)
+      + MemoryReport::getContainerBytes(values);
+}
+
+size_t SparseGlobalFeatureStore::getNumFeatures() const {
+  return values.size();
 }
 
 void SparseGlobalFeatureStore::hintFeatureIndex(
     int feature_context_id, int feature_index) {
-  assert(0 <= feature_index &&
-         feature_index < featureWeights[feature_context_id].size());
-  featureWeights[feature_context_id].coeffRef(feature_index) = 0;
+  assert(0 <= feature_index && feature_index < vectorMaxSize);
+  if (getPosition(feature_context_id, feature_index) != -1) {
+    return;
+  }
+
+  auto start = indexes.begin() + offsets[feature_context_id];
+  auto end = indexes.begin() + offsets[feature_context_id + 1];
+  int pos = lower_bound(start, end, feature_index) - indexes.begin();
+  indexes.insert(indexes.begin() + pos, feature_index);
+  values.insert(values.begin() + pos, 0);
+  for (size_t i = feature_context_id + 1; i < offsets.size(); ++i) {
+    ++offsets[i];
+  }
 }
 
 bool SparseGlobalFeatureStore::operator==(
     const SparseGlobalFeatureStore& store) const {
   if (vectorMaxSize != store.vectorMaxSize ||
-      featureWeights.size() != store.featureWeights.size()) {
+      offsets != store.offsets ||
+      indexes != store.indexes) {
     return false;
   }
 
-  for (size_t i = 0; i < featureWeights.size(); ++i) {
-    VectorReal diff = featureWeights[i] - store.featureWeights[i];
-    if (diff.cwiseAbs2().maxCoeff() > EPS) {
+  for (size_t i = 0; i < values.size(); ++i) {
+    Real diff = values[i] - store.values[i];
+    if (diff * diff > EPS) {
       return false;
     }
   }
@@ -138,18 +192,90 @@ bool SparseGlobalFeatureStore::operator==(
 
 vector<pair<int, int>> SparseGlobalFeatureStore::getFeatureIndexes() const {
   vector<pair<int, int>> feature_indexes;
-  for (size_t i = 0; i < featureWeights.size(); ++i) {
-    for (SparseVectorReal::InnerIterator it(featureWeights[i]); it; ++it) {
-      feature_indexes.push_back(make_pair(i, it.index()));
+  for (size_t i = 0; i + 1 < offsets.size(); ++i) {
+    for (int k = offsets[i]; k < offsets[i + 1]; ++k) {
+      feature_indexes.push_back(make_pair(i, indexes[k]));
     }
   }
 
   return feature_indexes;
 }
 
+GlobalFeatureIndexesPtr SparseGlobalFeatureStore::getContextFeatureIndexes()
+    const {
+  GlobalFeatureIndexesPtr feature_indexes =
+      boost::make_shared<GlobalFeatureIndexes>(offsets.size() - 1);
+  for (size_t i = 0; i + 1 < offsets.size(); ++i) {
+    feature_indexes->at(i).assign(
+        indexes.begin() + offsets[i], indexes.begin() + offsets[i + 1]);
+  }
+
+  return feature_indexes;
+}
+
 void SparseGlobalFeatureStore::updateFeature(
     const pair<int, int>& index, Real value) {
-  featureWeights[index.first].coeffRef(index.second) += value;
+  int pos = getPosition(index.first, index.second);
+  assert(pos != -1);
+  values[pos] += value;
+}
+
+void SparseGlobalFeatureStore::getUpdatedEntries(
+    const boost::shared_ptr<MinibatchFeatureStore>& base_minibatch_store,
+    unordered_set<int>& entries) const {
+  boost::shared_ptr<SparseMinibatchFeatureStore> minibatch_store =
+      SparseMinibatchFeatureStore::cast(base_minibatch_store);
+  for (const auto& entry: minibatch_store->featureWeights) {
+    entries.insert(entry.first);
+  }
+}
+
+vector<Real> SparseGlobalFeatureStore::getEntries(
+    const vector<int>& entries) const {
+  vector<Real> result;
+  for (int feature_context_id: entries) {
+    result.insert(result.end(), values.begin() + offsets[feature_context_id],
+                  values.begin() + offsets[feature_context_id + 1]);
+  }
+
+  return result;
+}
+
+void SparseGlobalFeatureStore::setEntries(
+    const vector<int>& entries, const vector<Real>& entry_values) {
+  size_t i = 0;
+  for (int feature_context_id: entries) {
+    for (int k = offsets[feature_context_id];
+         k < offsets[feature_context_id + 1]; ++k) {
+      values[k] = entry_values[i++];
+    }
+  }
+  assert(i == entry_values.size());
+}
+
+size_t SparseGlobalFeatureStore::prune(Real threshold, Real shrinkage) {
+  CwiseShrinkOp<Real> op(shrinkage);
+  int num_features = 0;
+  for (size_t i = 0; i + 1 < offsets.size(); ++i) {
+    // offsets[i + 1] is only overwritten in the next iteration.
+    int start = offsets[i];
+    offsets[i] = num_features;
+    for (int k = start; k < offsets[i + 1]; ++k) {
+      Real value = op(values[k]);
+      if (value != 0 && fabs(value) >= threshold) {
+        indexes[num_features] = indexes[k];
+        values[num_features] = value;
+        ++num_features;
+      }
+    }
+  }
+  offsets.back() = num_features;
+
+  indexes.resize(num_features);
+  indexes.shrink_to_fit();
+  values.resize(num_features);
+  values.shrink_to_fit();
+  return num_features;
 }
 
 SparseGlobalFeatureStore::~SparseGlobalFeatureStore() {}
@@ -158,7 +284,42 @@ void SparseGlobalFeatureStore::update(
     int feature_context_id, const SparseVectorReal& values) {
   // All features involved in gradient updates must be defined since the
   // construction of the sparse feature store.
-  featureWeights[feature_context_id] += values;
+  int k = offsets[feature_context_id], end = offsets[feature_context_id + 1];
+  for (SparseVectorReal::InnerIterator it(values); it; ++it) {
+    while (k < end && indexes[k] < it.index()) {
+      ++k;
+    }
+    if (k == end || indexes[k] != it.index()) {
+      throw UndefinedFeatureException();
+    }
+    this->values[k] += it.value();
+  }
+}
+
+void SparseGlobalFeatureStore::setFeatureWeights(
+    const vector<SparseVectorReal>& feature_weights) {
+  offsets.assign(1, 0);
+  indexes.clear();
+  values.clear();
+  for (const auto& weights: feature_weights) {
+    // The indexes of a sparse vector are sorted.
+    for (SparseVectorReal::InnerIterator it(weights); it; ++it) {
+      indexes.push_back(it.index());
+      values.push_back(it.value());
+    }
+    if (indexes.size() > numeric_limits<int>::max()) {
+      throw FeatureStoreOverflowException();
+    }
+    offsets.push_back(indexes.size());
+  }
+}
+
+int SparseGlobalFeatureStore::getPosition(
+    int feature_context_id, int feature_index) const {
+  auto start = indexes.begin() + offsets[feature_context_id];
+  auto end = indexes.begin() + offsets[feature_context_id + 1];
+  auto it = lower_bound(start, end, feature_index);
+  return it != end && *it == feature_index ? it - indexes.begin() : -1;
 }
 
 boost::shared_ptr<SparseGlobalFeatureStore> SparseGlobalFeatureStore::cast(
@@ -1,12 +1,14 @@
 #pragma once
 
-#include <unordered_map>
-#include <unordered_set>
+#include <vector>
 
 #include <boost/serialization/extended_type_info.hpp>
 #include <boost/serialization/singleton.hpp>
 #include <boost/serialization/type_info_implementation.hpp>
 #include <boost/serialization/shared_ptr.hpp>
+#include <boost/serialization/split_member.hpp>
+#include <boost/serialization/vector.hpp>
+#include <boost/serialization/version.hpp>
 
 #include "lbl/archive_export.h"
 #include "lbl/feature_context_extractor.h"
@@ -18,6 +20,19 @@ using namespace std;
 
 namespace oxlm {
 
+/**
+ * Stores the feature weights of all the feature contexts in compressed sparse
+ * row (CSR) format: the weights of feature context i are values[k] for
+ * offsets[i] <= k < offsets[i + 1], and indexes[k] holds the feature index of
+ * values[k] (sorted for each feature context). The set of features is frozen
+ * when the store is constructed from the global feature indexes, so training
+ * updates only touch the values array. Updating a feature which is not defined
+ * throws an UndefinedFeatureException.
+ *
+ * The offsets are ints (and the positions of the features are ints everywhere
+ * else, e.g. in the delta checkpoints), so a store holds at most 2^31 - 1
+ * features (8GB of weights). The constructor checks this limit.
+ */
 class SparseGlobalFeatureStore : public GlobalFeatureStore {
  public:
   SparseGlobalFeatureStore();
@@ -52,6 +67,18 @@ class SparseGlobalFeatureStore : public GlobalFeatureStore {
 
   virtual size_t size() const;
 
+  virtual size_t memoryUsage() const;
+
+  /**
+   * Returns the number of feature weights in the store.
+   */
+  size_t getNumFeatures() const;
+
+  /**
+   * Defines a new feature. This shifts all the features of the subsequent
+   * feature contexts, so prefer constructing the store from the global feature
+   * indexes.
+   */
   void hintFeatureIndex(int feature_context_id, int feature_index);
 
   static boost::shared_ptr<SparseGlobalFeatureStore> cast(
@@ -63,31 +90,85 @@ class SparseGlobalFeatureStore : public GlobalFeatureStore {
 
   virtual vector<pair<int, int>> getFeatureIndexes() const;
 
+  /**
+   * Returns the features defined for every feature context, in the format the
+   * store is constructed from.
+   */
+  GlobalFeatureIndexesPtr getContextFeatureIndexes() const;
+
+  virtual void getUpdatedEntries(
+      const boost::shared_ptr<MinibatchFeatureStore>& base_minibatch_store,
+      unordered_set<int>& entries) const;
+
+  virtual vector<Real> getEntries(const vector<int>& entries) const;
+
+  virtual void setEntries(
+      const vector<int>& entries, const vector<Real>& values);
+
   void updateFeature(const pair<int, int>& index, Real value);
 
+  /**
+   * Shrinks every weight towards 0 by shrinkage and drops the features whose
+   * absolute weight is below threshold (and the zero weights) afterwards.
+   * Returns the number of features left. Meant for trained models: the
+   * positions of the remaining features no longer match the AdaGrad store.
+   */
+  size_t prune(Real threshold, Real shrinkage);
+
   virtual ~SparseGlobalFeatureStore();
 
  private:
   void update(int feature_context_id, const SparseVectorReal& values);
 
+  // Returns the position of the feature in the values array or -1 if the
+  // feature is not defined.
+  int getPosition(int feature_context_id, int feature_index) const;
+
   friend class boost::serialization::access;
 
   template<class Archive>
-  void serialize(Archive& ar, const unsigned int version) {
-    ar & boost::serialization::base_object<GlobalFeatureStore>(*this);
+  void save(Archive& ar, const unsigned int version) const {
+    ar << boost::serialization::base_object<const GlobalFeatureStore>(*this);
+
+    ar << vectorMaxSize;
+    ar << extractor;
+    ar << offsets;
+    ar << indexes;
+    ar << values;
+  }
 
-    ar & vectorMaxSize;
-    ar & extractor;
-    ar & featureWeights;
+  template<class Archive>
+  void load(Archive& ar, const unsigned int version) {
+    ar >> boost::serialization::base_object<GlobalFeatureStore>(*this);
+
+    ar >> vectorMaxSize;
+    ar >> extractor;
+    if (version > 0) {
+      ar >> offsets;
+      ar >> indexes;
+      ar >> values;
+    } else {
+      // Version 0 stored a sparse vector for every feature context.
+      vector<SparseVectorReal> feature_weights;
+      ar >> feature_weights;
+      setFeatureWeights(feature_weights);
+    }
   }
 
+  BOOST_SERIALIZATION_SPLIT_MEMBER();
+
+  void setFeatureWeights(const vector<SparseVectorReal>& feature_weights);
+
   friend class SparseMinibatchFeatureStore;
 
   int vectorMaxSize;
   boost::shared_ptr<FeatureContextExtractor> extractor;
-  vector<SparseVectorReal> featureWeights;
+  vector<int> offsets;
+  vector<int> indexes;
+  vector<Real> values;
 };
 
 } // namespace oxlm
 
 BOOST_CLASS_EXPORT_KEY(oxlm::SparseGlobalFeatureStore)
+BOOST_CLASS_VERSION(oxlm::SparseGlobalFeatureStore, 1)
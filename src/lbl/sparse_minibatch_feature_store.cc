@@ -1,5 +1,8 @@
 #include "lbl/sparse_minibatch_feature_store.h"
 
+#include <algorithm>
+
+#include "lbl/memory_report.h"
 #include "lbl/operators.h"
 #include "utils/constants.h"
 
@@ -17,7 +20,12 @@ SparseMinibatchFeatureStore::SparseMinibatchFeatureStore(
     MinibatchFeatureIndexesPtr feature_indexes,
     const boost::shared_ptr<FeatureContextExtractor>& extractor)
     : vectorMaxSize(vector_max_size), extractor(extractor) {
+  featureWeights.reserve(feature_indexes->size());
   for (const auto& feature_context_indexes: *feature_indexes) {
+    // Feature contexts whose features were all pruned still receive (empty)
+    // gradient updates.
+    featureWeights.insert(make_pair(
+        feature_context_indexes.first, SparseVectorReal(vectorMaxSize)));
     for (int feature_index: feature_context_indexes.second) {
       hintFeatureIndex(feature_context_indexes.first, feature_index);
     }
@@ -50,14 +58,46 @@ void SparseMinibatchFeatureStore::update(
   }
 }
 
+void SparseMinibatchFeatureStore::updateValue(
+    int feature_index, const vector<int>& context, Real value) {
+  for (int feature_context_id: extractor->getFeatureContextIds(context)) {
+    auto it = featureWeights.find(feature_context_id);
+    if (it == featureWeights.end()) {
+      continue;
+    }
+
+    // Only update features which are already defined in the sparse vector.
+    SparseVectorReal& weights = it->second;
+    const auto* start = weights.innerIndexPtr();
+    const auto* end = start + weights.nonZeros();
+    const auto* pos = lower_bound(start, end, feature_index);
+    if (pos != end && *pos == feature_index) {
+      weights.valuePtr()[pos - start] += value;
+    }
+  }
+}
+
 void SparseMinibatchFeatureStore::clear() {
   featureWeights.clear();
 }
 
+void SparseMinibatchFeatureStore::reserve(size_t size) {
+  featureWeights.reserve(size);
+}
+
 size_t SparseMinibatchFeatureStore::size() const {
   return featureWeights.size();
 }
 
+size_t SparseMinibatchFeatureStore::memoryUsage() const {
+  size_t bytes = featureWeights.memoryUsage();
+  for (const auto& entry: featureWeights) {
+    bytes += entry.second.data().allocatedSize() * (sizeof(Real) + sizeof(int));
+  }
+
+  return bytes;
+}
+
 void SparseMinibatchFeatureStore::hintFeatureIndex(
     int feature_context_id, int feature_index) {
   auto it = featureWeights.find(feature_context_id);
@@ -1,9 +1,7 @@
 #pragma once
 
-#include <unordered_map>
-#include <unordered_set>
-
 #include "lbl/feature_context_extractor.h"
+#include "lbl/flat_hash_map.h"
 #include "lbl/minibatch_feature_store.h"
 #include "lbl/utils.h"
 #include "utils/serialization_helpers.h"
@@ -31,12 +29,19 @@ class SparseMinibatchFeatureStore : public MinibatchFeatureStore {
 
   virtual void update(const boost::shared_ptr<MinibatchFeatureStore>& store);
 
+  virtual void updateValue(
+      int feature_index, const vector<int>& context, Real value);
+
   virtual void clear();
 
+  virtual void reserve(size_t size);
+
   virtual Real getFeature(const pair<int, int>& index) const;
 
   virtual size_t size() const;
 
+  virtual size_t memoryUsage() const;
+
   void hintFeatureIndex(int feature_context_id, int feature_index);
 
   static boost::shared_ptr<SparseMinibatchFeatureStore> cast(
@@ -55,7 +60,7 @@ class SparseMinibatchFeatureStore : public MinibatchFeatureStore {
 
   int vectorMaxSize;
   boost::shared_ptr<FeatureContextExtractor> extractor;
-  unordered_map<int, SparseVectorReal> featureWeights;
+  FlatHashMap<int, SparseVectorReal> featureWeights;
 };
 
 } // namespace oxlm
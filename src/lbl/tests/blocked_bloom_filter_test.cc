@@ -0,0 +1,85 @@
+#include "gtest/gtest.h"
+
+#include <boost/archive/binary_iarchive.hpp>
+#include <boost/archive/binary_oarchive.hpp>
+
+#include "lbl/blocked_bloom_filter.h"
+#include "lbl/ngram.h"
+
+namespace ar = boost::archive;
+
+namespace oxlm {
+
+TEST(BlockedBloomFilterTest, TestBasic) {
+  BlockedBloomFilter<NGram> bloom_filter(10, 3, 0.01);
+
+  vector<int> context = {1, 2, 3};
+  for (int j = 0; j < 2; ++j) {
+    for (int i = 0; i < 10; ++i) {
+      NGram query(i, context);
+      bloom_filter.increment(query);
+      EXPECT_FALSE(bloom_filter.contains(query));
+    }
+  }
+
+  for (int i = 0; i < 10; ++i) {
+    NGram query(i, context);
+    bloom_filter.increment(query);
+    EXPECT_TRUE(bloom_filter.contains(query));
+  }
+}
+
+TEST(BlockedBloomFilterTest, TestUnsaturatedCounters) {
+  // 2 does not saturate the 2-bit counters, so lookups compare every counter.
+  BlockedBloomFilter<NGram> bloom_filter(10, 2, 0.01);
+
+  vector<int> context = {1, 2, 3};
+  for (int i = 0; i < 10; ++i) {
+    NGram query(i, context);
+    bloom_filter.increment(query);
+    EXPECT_FALSE(bloom_filter.contains(query));
+  }
+
+  for (int i = 0; i < 10; ++i) {
+    NGram query(i, context);
+    bloom_filter.increment(query);
+    EXPECT_TRUE(bloom_filter.contains(query));
+  }
+}
+
+TEST(BlockedBloomFilterTest, TestFalsePositiveRate) {
+  int num_items = 10000;
+  BlockedBloomFilter<NGram> bloom_filter(num_items, 1, 0.01);
+
+  vector<int> context = {1, 2};
+  for (int i = 0; i < num_items; ++i) {
+    bloom_filter.increment(NGram(i, context));
+  }
+
+  int false_positives = 0;
+  for (int i = num_items; i < 2 * num_items; ++i) {
+    false_positives += bloom_filter.contains(NGram(i, context));
+  }
+  EXPECT_GT(0.02, static_cast<Real>(false_positives) / num_items);
+  EXPECT_NEAR(0.01, bloom_filter.estimateErrorRate(), 0.005);
+}
+
+TEST(BlockedBloomFilterTest, TestSerialization) {
+  BlockedBloomFilter<NGram> bloom_filter(10, 1, 0.01), bloom_filter_copy;
+  vector<int> context = {1, 2};
+  bloom_filter.increment(NGram(1, context));
+  bloom_filter.increment(NGram(3, context));
+
+  stringstream stream(ios_base::binary | ios_base::in | ios_base::out);
+  ar::binary_oarchive oar(stream, ar::no_header);
+  oar << bloom_filter;
+
+  ar::binary_iarchive iar(stream, ar::no_header);
+  iar >> bloom_filter_copy;
+
+  EXPECT_EQ(bloom_filter, bloom_filter_copy);
+  EXPECT_TRUE(bloom_filter_copy.contains(NGram(1, context)));
+  EXPECT_TRUE(bloom_filter_copy.contains(NGram(3, context)));
+}
+
+} // namespace oxlm
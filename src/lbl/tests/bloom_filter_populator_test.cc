@@ -15,10 +15,9 @@ class BloomFilterPopulatorTest : public testing::Test {
   void SetUp() {
     vector<int> data = {2, 3, 3, 1, 2, 2};
     vector<int> classes = {0, 2, 3, 4};
-    boost::shared_ptr<Corpus> corpus = boost::make_shared<Corpus>(data);
-    boost::shared_ptr<WordToClassIndex> index =
-        boost::make_shared<WordToClassIndex>(classes);
-    boost::shared_ptr<ModelData> config = boost::make_shared<ModelData>();
+    corpus = boost::make_shared<Corpus>(data);
+    index = boost::make_shared<WordToClassIndex>(classes);
+    config = boost::make_shared<ModelData>();
     config->ngram_order = 3;
     config->feature_context_size = 2;
     config->filter_error_rate = 0.1;
@@ -28,12 +27,15 @@ class BloomFilterPopulatorTest : public testing::Test {
         boost::make_shared<FeatureContextGenerator>(config->feature_context_size);
     boost::shared_ptr<NGramFilter> filter =
         boost::make_shared<NGramFilter>(corpus, index, processor, generator);
-    boost::shared_ptr<FeatureContextMapper> mapper =
-        boost::make_shared<FeatureContextMapper>(
-            corpus, index, processor, generator, filter);
+    mapper = boost::make_shared<FeatureContextMapper>(
+        corpus, index, processor, generator, filter);
     populator = BloomFilterPopulator(corpus, index, mapper, config);
   }
 
+  boost::shared_ptr<Corpus> corpus;
+  boost::shared_ptr<WordToClassIndex> index;
+  boost::shared_ptr<ModelData> config;
+  boost::shared_ptr<FeatureContextMapper> mapper;
   BloomFilterPopulator populator;
 };
 
@@ -108,4 +110,46 @@ TEST_F(BloomFilterPopulatorTest, TestSerialization) {
   EXPECT_EQ(populator, populator_copy);
 }
 
+TEST_F(BloomFilterPopulatorTest, TestLoadVersion0) {
+  BloomFilterPopulator populator_copy;
+
+  // Version 0 archives only store the (non-blocked) Bloom filter.
+  stringstream stream(ios_base::binary | ios_base::out | ios_base::in);
+  ar::binary_oarchive oar(stream, ar::no_header);
+  boost::serialization::serialize_adl(oar, populator, 0);
+
+  ar::binary_iarchive iar(stream, ar::no_header);
+  boost::serialization::serialize_adl(iar, populator_copy, 0);
+
+  EXPECT_EQ(populator, populator_copy);
+  EXPECT_EQ(nullptr, populator_copy.getBlocked());
+}
+
+TEST_F(BloomFilterPopulatorTest, TestBlockedBloomFilter) {
+  config->blocked_bloom_filter = true;
+  BloomFilterPopulator blocked_populator(corpus, index, mapper, config);
+  EXPECT_EQ(nullptr, blocked_populator.get());
+
+  boost::shared_ptr<BlockedBloomFilter<NGram>> bloom_filter =
+      blocked_populator.getBlocked();
+  vector<int> context = {0};
+  EXPECT_TRUE(bloom_filter->contains(NGram(1, context)));
+  context = {2, 0};
+  EXPECT_TRUE(bloom_filter->contains(NGram(1, context)));
+  context = {3, 2};
+  EXPECT_TRUE(bloom_filter->contains(NGram(0, 2, context)));
+  context = {3};
+  EXPECT_TRUE(bloom_filter->contains(NGram(1, 0, context)));
+
+  BloomFilterPopulator populator_copy;
+  stringstream stream(ios_base::binary | ios_base::out | ios_base::in);
+  ar::binary_oarchive oar(stream, ar::no_header);
+  oar << blocked_populator;
+
+  ar::binary_iarchive iar(stream, ar::no_header);
+  iar >> populator_copy;
+
+  EXPECT_EQ(blocked_populator, populator_copy);
+}
+
 } // namespace oxlm
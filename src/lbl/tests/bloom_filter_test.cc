@@ -24,4 +24,21 @@ TEST(BloomFilterTest, TestBasic) {
   }
 }
 
+TEST(BloomFilterTest, TestEstimateErrorRate) {
+  int num_items = 10000;
+  BloomFilter<NGram> bloom_filter(num_items, 1, 0.01);
+
+  vector<int> context = {1, 2};
+  for (int i = 0; i < num_items; ++i) {
+    bloom_filter.increment(NGram(i, context));
+  }
+
+  int false_positives = 0;
+  for (int i = num_items; i < 2 * num_items; ++i) {
+    false_positives += bloom_filter.contains(NGram(i, context));
+  }
+  EXPECT_GT(0.02, static_cast<Real>(false_positives) / num_items);
+  EXPECT_NEAR(0.01, bloom_filter.estimateErrorRate(), 0.005);
+}
+
 } // namespace oxlm
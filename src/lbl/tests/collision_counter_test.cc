@@ -29,7 +29,9 @@ TEST(CollisionCounterTest, TestBasic) {
       boost::make_shared<FeatureMatcher>(
           corpus, index, processor, generator, filter, mapper);
   boost::shared_ptr<BloomFilterPopulator> populator;
-  CollisionCounter counter(corpus, index, mapper, matcher, populator, config);
+  boost::shared_ptr<CompactFilterPopulator> compact_populator;
+  CollisionCounter counter(
+      corpus, index, mapper, matcher, populator, compact_populator, config);
 
   EXPECT_EQ(33, counter.count());
 }
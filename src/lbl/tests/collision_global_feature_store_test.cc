@@ -15,6 +15,25 @@ namespace ar = boost::archive;
 
 namespace oxlm {
 
+// Maps the feature contexts ending in word 1 to the last but one key of the
+// collision space and all the other feature contexts to key 3.
+class FixedKeyHasher : public FeatureContextHasher {
+ public:
+  FixedKeyHasher(int hash_space) : hashSpace(hash_space) {}
+
+  virtual int getKey(const FeatureContext& feature_context) const {
+    return feature_context.data.back() == 1 ? hashSpace - 2 : 3;
+  }
+
+  virtual NGram getPrediction(
+      int candidate, const FeatureContext& feature_context) const {
+    return NGram(candidate, feature_context.data);
+  }
+
+ private:
+  int hashSpace;
+};
+
 class CollisionGlobalFeatureStoreTest : public testing::Test {
  protected:
   void SetUp() {
@@ -84,6 +103,20 @@ TEST_F(CollisionGlobalFeatureStoreTest, TestUpdateRegularizer) {
   EXPECT_NEAR(140.5, store.getValue(2, context), EPS);
 }
 
+TEST_F(CollisionGlobalFeatureStoreTest, TestPrune) {
+  store.updateSquared(gradient_store);
+
+  VectorReal expected_values(3);
+  expected_values << 216, 262, 281;
+  size_t num_weights = store.getSpace()->prune(0, 0);
+  EXPECT_LT(0, num_weights);
+  EXPECT_GE(10, num_weights);
+  EXPECT_MATRIX_NEAR(expected_values, store.get(context), EPS);
+
+  EXPECT_EQ(0, store.getSpace()->prune(1000, 0));
+  EXPECT_MATRIX_NEAR(VectorReal::Zero(3), store.get(context), EPS);
+}
+
 TEST_F(CollisionGlobalFeatureStoreTest, TestSerialization) {
   store.updateSquared(gradient_store);
   boost::shared_ptr<GlobalFeatureStore> store_ptr =
@@ -111,4 +144,40 @@ TEST_F(CollisionGlobalFeatureStoreTest, TestSerialization) {
   EXPECT_MATRIX_NEAR(expected_values, actual_ptr->get(context), EPS);
 }
 
+TEST(CollisionGlobalFeatureStoreWrapTest, TestBucketWrapsAround) {
+  int vector_size = 5;
+  int hash_space = 10;
+  boost::shared_ptr<GlobalCollisionSpace> space =
+      boost::make_shared<GlobalCollisionSpace>(hash_space);
+  boost::shared_ptr<FeatureNoOpFilter> filter =
+      boost::make_shared<FeatureNoOpFilter>(vector_size);
+  boost::shared_ptr<FeatureContextHasher> hasher =
+      boost::make_shared<FixedKeyHasher>(hash_space);
+
+  // The bucket of the context occupies the positions 8, 9, 0, 1 and 2.
+  vector<int> context = {1};
+  boost::shared_ptr<MinibatchFeatureStore> gradient_store =
+      boost::make_shared<CollisionMinibatchFeatureStore>(
+          vector_size, hash_space, 1, hasher, filter);
+  VectorReal values(vector_size);
+  values << 1, 2, 3, 4, 5;
+  gradient_store->update(context, values);
+
+  CollisionGlobalFeatureStore store(
+      vector_size, hash_space, 1, space, hasher, filter);
+  store.updateSquared(gradient_store);
+
+  VectorReal expected_values(vector_size);
+  expected_values << 1, 4, 9, 16, 25;
+  EXPECT_MATRIX_NEAR(expected_values, store.get(context), EPS);
+  for (int i = 0; i < vector_size; ++i) {
+    EXPECT_NEAR(expected_values(i), store.getValue(i, context), EPS);
+  }
+
+  // The bucket starting at position 3 does not overlap the wrapped bucket.
+  vector<int> other_context = {2};
+  EXPECT_MATRIX_NEAR(
+      VectorReal::Zero(vector_size), store.get(other_context), EPS);
+}
+
 } // namespace oxlm
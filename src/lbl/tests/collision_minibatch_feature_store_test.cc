@@ -59,6 +59,19 @@ TEST_F(CollisionMinibatchFeatureStoreTest, TestGradientUpdate) {
   EXPECT_EQ(4, store->size());
 }
 
+TEST_F(CollisionMinibatchFeatureStoreTest, TestUpdateValue) {
+  store->updateValue(1, context, 2);
+
+  g_store->clear();
+  VectorReal values(3);
+  values << 0, 2, 0;
+  g_store->update(context, values);
+
+  EXPECT_MATRIX_NEAR(g_store->get(context), store->get(context), EPS);
+  // Unlike update, entries for the other features are not created.
+  EXPECT_EQ(2, store->size());
+}
+
 TEST_F(CollisionMinibatchFeatureStoreTest, TestClear) {
   EXPECT_EQ(4, g_store->size());
 
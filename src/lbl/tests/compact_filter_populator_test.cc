@@ -0,0 +1,79 @@
+#include "gtest/gtest.h"
+
+#include <boost/archive/binary_iarchive.hpp>
+#include <boost/archive/binary_oarchive.hpp>
+#include <boost/make_shared.hpp>
+
+#include "lbl/compact_filter_populator.h"
+
+namespace ar = boost::archive;
+
+namespace oxlm {
+
+class CompactFilterPopulatorTest : public testing::Test {
+ protected:
+  void SetUp() {
+    vector<int> data = {2, 3, 3, 1, 2, 2};
+    vector<int> classes = {0, 2, 3, 4};
+    boost::shared_ptr<Corpus> corpus = boost::make_shared<Corpus>(data);
+    boost::shared_ptr<WordToClassIndex> index =
+        boost::make_shared<WordToClassIndex>(classes);
+    boost::shared_ptr<ContextProcessor> processor =
+        boost::make_shared<ContextProcessor>(corpus, 2);
+    boost::shared_ptr<FeatureContextGenerator> generator =
+        boost::make_shared<FeatureContextGenerator>(2);
+    boost::shared_ptr<NGramFilter> filter =
+        boost::make_shared<NGramFilter>(corpus, index, processor, generator);
+    populator = CompactFilterPopulator(
+        corpus, index, processor, generator, filter);
+  }
+
+  CompactFilterPopulator populator;
+};
+
+TEST_F(CompactFilterPopulatorTest, TestBasic) {
+  boost::shared_ptr<FeatureFilter> filter = populator.getClassFilter();
+  vector<int> context = {0};
+  vector<int> expected_indexes = {1};
+  EXPECT_EQ(expected_indexes, filter->getIndexes(context));
+  context = {2, 0};
+  expected_indexes = {1, 2};
+  EXPECT_EQ(expected_indexes, filter->getIndexes(context));
+  context = {3};
+  expected_indexes = {0, 2};
+  EXPECT_EQ(expected_indexes, filter->getIndexes(context));
+  context = {3, 3};
+  expected_indexes = {0};
+  EXPECT_EQ(expected_indexes, filter->getIndexes(context));
+  context = {1};
+  EXPECT_EQ(vector<int>(), filter->getIndexes(context));
+
+  filter = populator.getWordFilter(0);
+  context = {3};
+  expected_indexes = {1};
+  EXPECT_EQ(expected_indexes, filter->getIndexes(context));
+  context = {2};
+  EXPECT_EQ(vector<int>(), filter->getIndexes(context));
+
+  filter = populator.getWordFilter(2);
+  context = {3, 2};
+  expected_indexes = {0};
+  EXPECT_EQ(expected_indexes, filter->getIndexes(context));
+  context = {3, 3};
+  EXPECT_EQ(vector<int>(), filter->getIndexes(context));
+}
+
+TEST_F(CompactFilterPopulatorTest, TestSerialization) {
+  CompactFilterPopulator populator_copy;
+
+  stringstream stream(ios_base::binary | ios_base::out | ios_base::in);
+  ar::binary_oarchive oar(stream, ar::no_header);
+  oar << populator;
+
+  ar::binary_iarchive iar(stream, ar::no_header);
+  iar >> populator_copy;
+
+  EXPECT_EQ(populator, populator_copy);
+}
+
+} // namespace oxlm
@@ -0,0 +1,80 @@
+#include "gtest/gtest.h"
+
+#include <sstream>
+
+#include <boost/archive/binary_iarchive.hpp>
+#include <boost/archive/binary_oarchive.hpp>
+
+#include "lbl/config.h"
+
+namespace ar = boost::archive;
+
+namespace oxlm {
+
+class ConfigTest : public testing::Test {
+ protected:
+  void SetUp() {
+    config.training_file = "training.en";
+    config.ngram_order = 5;
+    config.hash_space = 1000;
+    config.filter_contexts = true;
+    config.compact_filter = true;
+    config.blocked_bloom_filter = true;
+    config.vocab_size = 10;
+    config.hidden_layers = 2;
+  }
+
+  ModelData config;
+};
+
+TEST_F(ConfigTest, TestSerialization) {
+  stringstream stream(ios_base::binary | ios_base::out | ios_base::in);
+  ar::binary_oarchive oar(stream, ar::no_header);
+  oar << config;
+
+  ModelData config_copy;
+  ar::binary_iarchive iar(stream, ar::no_header);
+  iar >> config_copy;
+
+  EXPECT_EQ(config, config_copy);
+  EXPECT_TRUE(config_copy.compact_filter);
+  EXPECT_TRUE(config_copy.blocked_bloom_filter);
+}
+
+TEST_F(ConfigTest, TestLoadVersion0) {
+  // Version 0 configurations do not store the filter types.
+  stringstream stream(ios_base::binary | ios_base::out | ios_base::in);
+  ar::binary_oarchive oar(stream, ar::no_header);
+  boost::serialization::serialize_adl(oar, config, 0);
+
+  ModelData config_copy;
+  ar::binary_iarchive iar(stream, ar::no_header);
+  boost::serialization::serialize_adl(iar, config_copy, 0);
+
+  EXPECT_FALSE(config_copy.compact_filter);
+  EXPECT_FALSE(config_copy.blocked_bloom_filter);
+  EXPECT_EQ("training.en", config_copy.training_file);
+  EXPECT_EQ(5, config_copy.ngram_order);
+  EXPECT_EQ(1000, config_copy.hash_space);
+  EXPECT_TRUE(config_copy.filter_contexts);
+  EXPECT_EQ(10, config_copy.vocab_size);
+  EXPECT_EQ(2, config_copy.hidden_layers);
+}
+
+TEST_F(ConfigTest, TestLoadVersion1) {
+  // Version 1 configurations do not store the blocked Bloom filter flag.
+  stringstream stream(ios_base::binary | ios_base::out | ios_base::in);
+  ar::binary_oarchive oar(stream, ar::no_header);
+  boost::serialization::serialize_adl(oar, config, 1);
+
+  ModelData config_copy;
+  ar::binary_iarchive iar(stream, ar::no_header);
+  boost::serialization::serialize_adl(iar, config_copy, 1);
+
+  EXPECT_TRUE(config_copy.compact_filter);
+  EXPECT_FALSE(config_copy.blocked_bloom_filter);
+  EXPECT_EQ(10, config_copy.vocab_size);
+  EXPECT_EQ(2, config_copy.hidden_layers);
+}
+
+} // namespace oxlm
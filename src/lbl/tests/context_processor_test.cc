@@ -25,4 +25,33 @@ TEST(ContextProcessorTest, TestExtract) {
   EXPECT_EQ(expected_context, processor.extract(5));
 }
 
+TEST(ContextProcessorTest, TestExtractMany) {
+  vector<int> data = {2, 3, 4, 1, 5, 6};
+  boost::shared_ptr<Corpus> corpus = boost::make_shared<Corpus>(data);
+  ContextProcessor processor(corpus, 2, 0, 1);
+  EXPECT_EQ(2, processor.getContextWidth());
+
+  vector<int> positions = {3, 0, 5};
+  vector<WordId> contexts;
+  processor.extractMany(positions, contexts);
+  vector<WordId> expected_contexts = {4, 3, 0, 0, 5, 0};
+  EXPECT_EQ(expected_contexts, contexts);
+
+  WordId context[2];
+  processor.extract(2, context);
+  EXPECT_EQ(3, context[0]);
+  EXPECT_EQ(2, context[1]);
+}
+
+TEST(ContextProcessorTest, TestLongSentence) {
+  vector<int> data(1000, 2);
+  boost::shared_ptr<Corpus> corpus = boost::make_shared<Corpus>(data);
+  ContextProcessor processor(corpus, 4, 0, 1);
+
+  vector<WordId> expected_context = {2, 2, 0, 0};
+  EXPECT_EQ(expected_context, processor.extract(2));
+  expected_context = {2, 2, 2, 2};
+  EXPECT_EQ(expected_context, processor.extract(999));
+}
+
 } // namespace oxlm
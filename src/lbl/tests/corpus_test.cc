@@ -17,6 +17,23 @@ TEST(CorpusTest, TestBasic) {
   EXPECT_EQ(vocab->convert("act"), corpus.at(3));
   EXPECT_EQ(vocab->convert("?"), corpus.at(4));
   EXPECT_EQ(vocab->convert("</s>"), corpus.at(5));
+  EXPECT_EQ(vocab->convert("</s>"), corpus.getEndId());
+}
+
+TEST(CorpusTest, TestSentencePositions) {
+  vector<int> data = {2, 3, 4, 1, 1, 5};
+  Corpus corpus(data);
+
+  vector<int> expected_positions = {0, 1, 2, 3, 0, 0};
+  for (size_t i = 0; i < data.size(); ++i) {
+    EXPECT_EQ(expected_positions[i], corpus.getSentencePosition(i));
+  }
+
+  data.assign(1000, 2);
+  Corpus long_corpus(data);
+  EXPECT_EQ(100, long_corpus.getSentencePosition(100));
+  EXPECT_EQ(
+      Corpus::MAX_SENTENCE_POSITION, long_corpus.getSentencePosition(999));
 }
 
 } // namespace oxlm
@@ -0,0 +1,40 @@
+#include "gtest/gtest.h"
+
+#include "lbl/count_min_sketch.h"
+
+namespace oxlm {
+
+TEST(CountMinSketchTest, TestExact) {
+  CountMinSketch sketch(1 << 16, 4);
+  for (int i = 0; i < 10; ++i) {
+    for (int j = 0; j <= i; ++j) {
+      sketch.increment(MurmurHash({i}));
+    }
+  }
+
+  EXPECT_EQ(55, sketch.size());
+  for (int i = 0; i < 10; ++i) {
+    EXPECT_EQ(i + 1, sketch.estimate(MurmurHash({i})));
+  }
+  EXPECT_EQ(0, sketch.estimate(MurmurHash({10})));
+}
+
+TEST(CountMinSketchTest, TestOverestimate) {
+  // 4 rows of 256 counters for 10000 distinct keys.
+  CountMinSketch sketch(4096, 4);
+  int num_keys = 10000;
+  for (int i = 0; i < num_keys; ++i) {
+    sketch.increment(MurmurHash({i}));
+  }
+
+  int total_error = 0;
+  for (int i = 0; i < num_keys; ++i) {
+    int estimate = sketch.estimate(MurmurHash({i}));
+    EXPECT_LE(1, estimate);
+    total_error += estimate - 1;
+  }
+  // The expected error of a single row is num_keys / 256.
+  EXPECT_GT(num_keys / 256, total_error / num_keys);
+}
+
+} // namespace oxlm
@@ -4,6 +4,7 @@
 #include <boost/archive/binary_oarchive.hpp>
 
 #include "utils/constants.h"
+#include "utils/testing.h"
 
 namespace ar = boost::archive;
 
@@ -38,6 +39,82 @@ TEST_F(FactoredTreeWeightsTest, TestGradientCheckExtraHiddenLayers) {
   EXPECT_TRUE(weights.checkGradient(corpus, indices, gradient, 2e-3));
 }
 
+TEST_F(FactoredTreeWeightsTest, TestGetLogProbs) {
+  FactoredTreeWeights weights(config, metadata, corpus);
+  vector<int> indices = {0, 1, 2, 3, 4, 5, 6};
+  VectorReal log_probs = weights.getLogProbs(corpus, indices);
+
+  EXPECT_NEAR(-log_probs.sum(), getLogProbabilities(weights, indices), EPS);
+  EXPECT_NEAR(
+      -log_probs.sum(), weights.getLogLikelihood(corpus, indices), EPS);
+}
+
+/**
+ * Computes the scores and the gradients of every node with per instance
+ * matrix-vector products.
+ */
+class UnbatchedFactoredTreeWeights : public FactoredTreeWeights {
+ public:
+  UnbatchedFactoredTreeWeights(
+      const boost::shared_ptr<ModelData>& config,
+      const boost::shared_ptr<TreeMetadata>& metadata,
+      const boost::shared_ptr<Corpus>& training_corpus)
+      : FactoredTreeWeights(config, metadata, training_corpus) {}
+
+ protected:
+  virtual bool isBatchedNode(int node, size_t num_instances) const {
+    return false;
+  }
+};
+
+class WideFactoredTreeWeightsTest : public FactoredTreeWeightsTest {
+ protected:
+  void SetUp() {
+    FactoredTreeWeightsTest::SetUp();
+    // The 5 words a-e share a node which is visited by 6 instances, so the
+    // node is processed with matrix-matrix products.
+    config->tree_file = "wide_tree.txt";
+    metadata = boost::make_shared<TreeMetadata>(config, vocab);
+  }
+};
+
+TEST_F(WideFactoredTreeWeightsTest, TestCheckGradient) {
+  FactoredTreeWeights weights(config, metadata, corpus);
+  vector<int> indices = {0, 1, 2, 3, 4, 5, 6};
+  Real log_likelihood;
+  MinibatchWords words;
+  boost::shared_ptr<FactoredTreeWeights> gradient =
+      boost::make_shared<FactoredTreeWeights>(config, metadata);
+  weights.getGradient(corpus, indices, gradient, log_likelihood, words);
+
+  // See comment in weights_test.
+  EXPECT_TRUE(weights.checkGradient(corpus, indices, gradient, 2e-3));
+}
+
+TEST_F(WideFactoredTreeWeightsTest, TestBatchedNodes) {
+  FactoredTreeWeights weights(config, metadata, corpus);
+  UnbatchedFactoredTreeWeights unbatched_weights(config, metadata, corpus);
+  vector<int> indices = {0, 1, 2, 3, 4, 5, 6};
+
+  VectorReal log_probs = weights.getLogProbs(corpus, indices);
+  EXPECT_MATRIX_NEAR(
+      unbatched_weights.getLogProbs(corpus, indices), log_probs, EPS);
+  EXPECT_NEAR(-log_probs.sum(), getLogProbabilities(weights, indices), EPS);
+
+  Real log_likelihood = 0, unbatched_log_likelihood = 0;
+  MinibatchWords words, unbatched_words;
+  boost::shared_ptr<FactoredTreeWeights> gradient =
+      boost::make_shared<FactoredTreeWeights>(config, metadata);
+  boost::shared_ptr<FactoredTreeWeights> unbatched_gradient =
+      boost::make_shared<FactoredTreeWeights>(config, metadata);
+  weights.getGradient(corpus, indices, gradient, log_likelihood, words);
+  unbatched_weights.getGradient(
+      corpus, indices, unbatched_gradient, unbatched_log_likelihood,
+      unbatched_words);
+
+  EXPECT_NEAR(unbatched_log_likelihood, log_likelihood, EPS);
+  EXPECT_EQ(*unbatched_gradient, *gradient);
+}
 
 TEST_F(FactoredTreeWeightsTest, TestSerialization) {
   FactoredTreeWeights weights(config, metadata, corpus), weights_copy;
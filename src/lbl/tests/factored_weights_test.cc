@@ -64,6 +64,14 @@ TEST_F(FactoredWeightsTest, TestPredict) {
   EXPECT_NEAR(log_likelihood, getLogProbabilities(weights, indices), EPS);
 }
 
+TEST_F(FactoredWeightsTest, TestGetLogProbs) {
+  FactoredWeights weights(config, metadata, corpus);
+  vector<int> indices = {0, 1, 2, 3};
+  VectorReal log_probs = weights.getLogProbs(corpus, indices);
+
+  EXPECT_NEAR(-log_probs.sum(), getLogProbabilities(weights, indices), EPS);
+}
+
 TEST_F(FactoredWeightsTest, TestUnnormalizedScores) {
   // Since we only get the sum of the word score and the class score, we can't
   // use this information to uniquely identify the original log probabilities.
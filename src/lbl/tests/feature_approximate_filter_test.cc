@@ -76,4 +76,31 @@ TEST_F(FeatureApproximateFilterTest, TestSerialization) {
   EXPECT_EQ(expected_indexes, filter_copy_ptr->getIndexes(context));
 }
 
+TEST_F(FeatureApproximateFilterTest, TestBlockedBloomFilter) {
+  boost::shared_ptr<BlockedBloomFilter<NGram>> blocked_bloom_filter =
+      boost::make_shared<BlockedBloomFilter<NGram>>(10, 1, 0.01);
+  vector<int> context = {1, 2};
+  blocked_bloom_filter->increment(NGram(1, context));
+  blocked_bloom_filter->increment(NGram(3, context));
+
+  boost::shared_ptr<FeatureFilter> filter_ptr =
+      boost::make_shared<FeatureApproximateFilter>(
+          5, hasher, blocked_bloom_filter);
+  vector<int> expected_indexes = {1, 3};
+  EXPECT_EQ(expected_indexes, filter_ptr->getIndexes(context));
+
+  stringstream stream(ios_base::binary | ios_base::in | ios_base::out);
+  ar::binary_oarchive oar(stream, ar::no_header);
+  oar << filter_ptr;
+
+  boost::shared_ptr<FeatureFilter> filter_copy_ptr;
+  ar::binary_iarchive iar(stream, ar::no_header);
+  iar >> filter_copy_ptr;
+
+  EXPECT_EQ(
+      *dynamic_pointer_cast<FeatureApproximateFilter>(filter_ptr),
+      *dynamic_pointer_cast<FeatureApproximateFilter>(filter_copy_ptr));
+  EXPECT_EQ(expected_indexes, filter_copy_ptr->getIndexes(context));
+}
+
 } // namespace oxlm
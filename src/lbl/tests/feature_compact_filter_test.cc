@@ -0,0 +1,73 @@
+#include "gtest/gtest.h"
+
+#include <boost/archive/binary_iarchive.hpp>
+#include <boost/archive/binary_oarchive.hpp>
+#include <boost/make_shared.hpp>
+
+#include "lbl/feature_compact_filter.h"
+
+namespace ar = boost::archive;
+
+namespace oxlm {
+
+class FeatureCompactFilterTest : public testing::Test {
+ protected:
+  void SetUp() {
+    hash<FeatureContext> hash_function;
+    vector<pair<size_t, int>> matches;
+    vector<int> context = {1, 2};
+    matches.push_back(make_pair(hash_function(FeatureContext(context)), 3));
+    matches.push_back(make_pair(hash_function(FeatureContext(context)), 1));
+    matches.push_back(make_pair(hash_function(FeatureContext(context)), 3));
+    context = {1, 5};
+    matches.push_back(make_pair(hash_function(FeatureContext(context)), 2));
+
+    filter = boost::make_shared<FeatureCompactFilter>(matches);
+  }
+
+  boost::shared_ptr<FeatureCompactFilter> filter;
+};
+
+TEST_F(FeatureCompactFilterTest, TestBasic) {
+  EXPECT_EQ(2, filter->getNumContexts());
+  EXPECT_EQ(3, filter->getNumMatches());
+
+  vector<int> context = {1, 2};
+  vector<int> expected_indexes = {1, 3};
+  EXPECT_EQ(expected_indexes, filter->getIndexes(context));
+  EXPECT_FALSE(filter->hasIndex(context, 0));
+  EXPECT_TRUE(filter->hasIndex(context, 1));
+  EXPECT_FALSE(filter->hasIndex(context, 2));
+  EXPECT_TRUE(filter->hasIndex(context, 3));
+  EXPECT_FALSE(filter->hasIndex(context, 4));
+
+  context = {1, 5};
+  expected_indexes = {2};
+  EXPECT_EQ(expected_indexes, filter->getIndexes(context));
+  EXPECT_FALSE(filter->hasIndex(context, 1));
+  EXPECT_TRUE(filter->hasIndex(context, 2));
+
+  context = {2};
+  EXPECT_EQ(vector<int>(), filter->getIndexes(context));
+  EXPECT_FALSE(filter->hasIndex(context, 1));
+}
+
+TEST_F(FeatureCompactFilterTest, TestSerialization) {
+  boost::shared_ptr<FeatureFilter> filter_ptr = filter;
+
+  stringstream stream(ios_base::binary | ios_base::in | ios_base::out);
+  ar::binary_oarchive oar(stream, ar::no_header);
+  oar << filter_ptr;
+
+  boost::shared_ptr<FeatureFilter> filter_copy_ptr;
+  ar::binary_iarchive iar(stream, ar::no_header);
+  iar >> filter_copy_ptr;
+
+  boost::shared_ptr<FeatureCompactFilter> actual_ptr =
+      dynamic_pointer_cast<FeatureCompactFilter>(filter_copy_ptr);
+
+  EXPECT_NE(nullptr, actual_ptr);
+  EXPECT_EQ(*filter, *actual_ptr);
+}
+
+} // namespace oxlm
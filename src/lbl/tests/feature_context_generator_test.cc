@@ -32,4 +32,26 @@ TEST(FeatureContextGeneratorTest, TestLongerHistory) {
   EXPECT_EQ(expected_data, feature_contexts[1].data);
 }
 
+TEST(FeatureContextGeneratorTest, TestHashes) {
+  FeatureContextGenerator generator(3);
+  vector<int> history = {1, 2, 3, 4};
+
+  hash<FeatureContext> hash_function;
+  vector<FeatureContext> feature_contexts =
+      generator.getFeatureContexts(history);
+  EXPECT_EQ(3, feature_contexts.size());
+  for (const auto& feature_context: feature_contexts) {
+    EXPECT_EQ(
+        MurmurHash(feature_context.data), hash_function(feature_context));
+  }
+
+  PrefixHash prefix;
+  prefix.append(5);
+  vector<size_t> hashes = generator.getPrefixHashes(prefix, history);
+  EXPECT_EQ(3, hashes.size());
+  EXPECT_EQ(MurmurHash({5, 1}), hashes[0]);
+  EXPECT_EQ(MurmurHash({5, 1, 2}), hashes[1]);
+  EXPECT_EQ(MurmurHash({5, 1, 2, 3}), hashes[2]);
+}
+
 } // namespace oxlm
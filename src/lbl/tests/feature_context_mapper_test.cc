@@ -1,9 +1,15 @@
 #include "gtest/gtest.h"
 
+#include <boost/archive/binary_iarchive.hpp>
+#include <boost/archive/binary_oarchive.hpp>
 #include <boost/make_shared.hpp>
+#include <boost/serialization/shared_ptr.hpp>
+#include <boost/serialization/vector.hpp>
 
 #include "lbl/feature_context_mapper.h"
 
+namespace ar = boost::archive;
+
 namespace oxlm {
 
 class FeatureContextMapperTest : public testing::Test {
@@ -66,4 +72,32 @@ TEST_F(FeatureContextMapperTest, TestShorterHistory) {
   EXPECT_EQ(2, word_context_ids[2]);
 }
 
+TEST_F(FeatureContextMapperTest, TestLoadVersion0) {
+  unordered_map<size_t, int> old_class_context_ids = {{11, 0}, {12, 1}};
+  vector<unordered_map<size_t, int>> old_word_context_ids = {
+      {{13, 0}}, {{14, 0}, {15, 1}}, {}};
+  FlatHashMap<size_t, int> class_context_ids;
+  class_context_ids.insert(make_pair(11, 0));
+  class_context_ids.insert(make_pair(12, 1));
+  vector<FlatHashMap<size_t, int>> word_context_ids(3);
+  word_context_ids[0].insert(make_pair(13, 0));
+  word_context_ids[1].insert(make_pair(14, 0));
+  word_context_ids[1].insert(make_pair(15, 1));
+  FeatureContextMapper expected_mapper(
+      index, generator, class_context_ids, word_context_ids);
+
+  // Version 0 archives stored the maps as unordered_maps.
+  stringstream stream(ios_base::binary | ios_base::out | ios_base::in);
+  ar::binary_oarchive oar(stream, ar::no_header);
+  oar << index << generator << old_class_context_ids << old_word_context_ids;
+
+  FeatureContextMapper mapper;
+  ar::binary_iarchive iar(stream, ar::no_header);
+  boost::serialization::serialize_adl(iar, mapper, 0);
+
+  EXPECT_EQ(expected_mapper, mapper);
+  EXPECT_EQ(2, mapper.getNumClassContexts());
+  EXPECT_EQ(2, mapper.getNumWordContexts(1));
+}
+
 } // namespace oxlm
@@ -26,6 +26,14 @@ TEST(FeatureContextTest, TestSerialization) {
   input_stream >> feature_context_copy;
 
   EXPECT_EQ(feature_context, feature_context_copy);
+  // The hash is recomputed when the feature context is loaded.
+  EXPECT_EQ(feature_context.hashCode, feature_context_copy.hashCode);
+}
+
+TEST(FeatureContextTest, TestDefaultHash) {
+  FeatureContext feature_context;
+  EXPECT_EQ(MurmurHash(vector<int>()), feature_context.hashCode);
+  EXPECT_EQ(FeatureContext(vector<int>()).hashCode, feature_context.hashCode);
 }
 
 }
@@ -0,0 +1,98 @@
+#include "gtest/gtest.h"
+
+#include <boost/make_shared.hpp>
+#include <boost/shared_ptr.hpp>
+
+#include "lbl/feature_index_builder.h"
+#include "lbl/feature_matcher.h"
+#include "utils/conditional_omp.h"
+
+namespace oxlm {
+
+class FeatureIndexBuilderTest : public testing::Test {
+ protected:
+  void SetUp() {
+    // The tests change the number of threads, which is global state.
+    numThreads = omp_get_max_threads();
+
+    vector<int> class_markers = {0, 2, 3, 5};
+    vector<int> data;
+    for (int i = 0; i < 100; ++i) {
+      data.push_back((i * i + 3 * i) % 7 % 5);
+    }
+    corpus = boost::make_shared<Corpus>(data);
+    index = boost::make_shared<WordToClassIndex>(class_markers);
+    processor = boost::make_shared<ContextProcessor>(corpus, 3, 0, 1);
+    generator = boost::make_shared<FeatureContextGenerator>(3);
+    filter =
+        boost::make_shared<NGramFilter>(corpus, index, processor, generator);
+  }
+
+  void TearDown() {
+    omp_set_num_threads(numThreads);
+  }
+
+  void checkFeatureIndexes(
+      const GlobalFeatureIndexesPairPtr& expected,
+      const GlobalFeatureIndexesPairPtr& actual) const {
+    EXPECT_EQ(*expected->getClassIndexes(), *actual->getClassIndexes());
+    for (int i = 0; i < index->getNumClasses(); ++i) {
+      EXPECT_EQ(*expected->getWordIndexes(i), *actual->getWordIndexes(i));
+    }
+  }
+
+  boost::shared_ptr<Corpus> corpus;
+  boost::shared_ptr<WordToClassIndex> index;
+  boost::shared_ptr<ContextProcessor> processor;
+  boost::shared_ptr<FeatureContextGenerator> generator;
+  boost::shared_ptr<NGramFilter> filter;
+  int numThreads;
+};
+
+TEST_F(FeatureIndexBuilderTest, TestSequentialPass) {
+  omp_set_num_threads(1);
+  FeatureIndexBuilder builder(
+      corpus, index, processor, generator, filter, true, true);
+
+  boost::shared_ptr<FeatureContextMapper> mapper = builder.getMapper();
+  FeatureMatcher matcher(corpus, index, processor, generator, filter, mapper);
+  checkFeatureIndexes(matcher.getGlobalFeatures(), builder.getFeatureIndexes());
+
+  CompactFilterPopulator populator(corpus, index, processor, generator, filter);
+  EXPECT_EQ(populator, *builder.getCompactPopulator());
+}
+
+TEST_F(FeatureIndexBuilderTest, TestParallelPass) {
+  omp_set_num_threads(1);
+  FeatureIndexBuilder expected_builder(
+      corpus, index, processor, generator, filter, true, true);
+
+  omp_set_num_threads(3);
+  FeatureIndexBuilder builder(
+      corpus, index, processor, generator, filter, true, true);
+
+  EXPECT_EQ(*expected_builder.getMapper(), *builder.getMapper());
+  checkFeatureIndexes(
+      expected_builder.getFeatureIndexes(), builder.getFeatureIndexes());
+  EXPECT_EQ(
+      *expected_builder.getCompactPopulator(), *builder.getCompactPopulator());
+
+  // The corpus based constructors are parallel as well.
+  boost::shared_ptr<FeatureContextMapper> mapper = builder.getMapper();
+  FeatureMatcher matcher(corpus, index, processor, generator, filter, mapper);
+  checkFeatureIndexes(
+      expected_builder.getFeatureIndexes(), matcher.getGlobalFeatures());
+  CompactFilterPopulator populator(corpus, index, processor, generator, filter);
+  EXPECT_EQ(*expected_builder.getCompactPopulator(), populator);
+}
+
+TEST_F(FeatureIndexBuilderTest, TestMapperOnly) {
+  FeatureIndexBuilder builder(
+      corpus, index, processor, generator, filter, false, false);
+
+  EXPECT_NE(nullptr, builder.getMapper());
+  EXPECT_EQ(nullptr, builder.getFeatureIndexes());
+  EXPECT_EQ(nullptr, builder.getCompactPopulator());
+}
+
+} // namespace oxlm
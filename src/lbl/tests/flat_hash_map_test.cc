@@ -0,0 +1,95 @@
+#include "gtest/gtest.h"
+
+#include <sstream>
+
+#include <boost/archive/binary_iarchive.hpp>
+#include <boost/archive/binary_oarchive.hpp>
+
+#include "lbl/flat_hash_map.h"
+
+namespace ar = boost::archive;
+
+namespace oxlm {
+
+TEST(FlatHashMapTest, TestBasic) {
+  FlatHashMap<int, int> map;
+  EXPECT_TRUE(map.empty());
+  EXPECT_TRUE(map.find(1) == map.end());
+
+  map[1] = 2;
+  map[3] += 4;
+  EXPECT_EQ(2, map.size());
+  EXPECT_EQ(2, map.at(1));
+  EXPECT_EQ(4, map.at(3));
+  EXPECT_TRUE(map.find(2) == map.end());
+  EXPECT_THROW(map.at(2), out_of_range);
+
+  auto result = map.insert(make_pair(1, 5));
+  EXPECT_FALSE(result.second);
+  EXPECT_EQ(2, result.first->second);
+  result = map.insert(make_pair(5, 6));
+  EXPECT_TRUE(result.second);
+  EXPECT_EQ(6, map.find(5)->second);
+}
+
+TEST(FlatHashMapTest, TestGrowth) {
+  FlatHashMap<int, int> map;
+  // Consecutive keys, as produced by the collision feature stores.
+  for (int i = 0; i < 1000; ++i) {
+    map[i] = 2 * i;
+  }
+
+  EXPECT_EQ(1000, map.size());
+  for (int i = 0; i < 1000; ++i) {
+    EXPECT_EQ(2 * i, map.at(i));
+  }
+
+  int num_entries = 0, sum = 0;
+  for (const auto& entry: map) {
+    ++num_entries;
+    sum += entry.second - 2 * entry.first;
+  }
+  EXPECT_EQ(1000, num_entries);
+  EXPECT_EQ(0, sum);
+}
+
+TEST(FlatHashMapTest, TestClear) {
+  FlatHashMap<int, int> map;
+  map.reserve(100);
+  size_t capacity = map.capacity();
+  for (int i = 0; i < 100; ++i) {
+    map[i] = i;
+  }
+  EXPECT_EQ(capacity, map.capacity());
+
+  map.clear();
+  EXPECT_EQ(0, map.size());
+  EXPECT_EQ(capacity, map.capacity());
+  EXPECT_TRUE(map.begin() == map.end());
+  EXPECT_TRUE(map.find(5) == map.end());
+
+  // Stale entries must not leak into the new generation.
+  map[5] += 1;
+  EXPECT_EQ(1, map.at(5));
+  EXPECT_EQ(1, map.size());
+}
+
+TEST(FlatHashMapTest, TestSerialization) {
+  FlatHashMap<size_t, float> map, map_copy;
+  map[1] = 0.5;
+  map[100] = 2;
+  map[12345678901] = 3;
+
+  stringstream stream(ios_base::binary | ios_base::out | ios_base::in);
+  ar::binary_oarchive output_stream(stream, ar::no_header);
+  output_stream << map;
+
+  ar::binary_iarchive input_stream(stream, ar::no_header);
+  input_stream >> map_copy;
+
+  EXPECT_TRUE(map == map_copy);
+  map_copy[2] = 1;
+  EXPECT_FALSE(map == map_copy);
+}
+
+} // namespace oxlm
@@ -13,7 +13,7 @@ namespace oxlm {
 
 TEST_F(GlobalFactoredMaxentWeightsTest, TestCheckGradientSparse) {
   metadata = boost::make_shared<FactoredMaxentMetadata>(
-      config, vocab, index, mapper, populator, matcher);
+      config, vocab, index, mapper, populator, matcher, compactPopulator);
   GlobalFactoredMaxentWeights weights(config, metadata, corpus);
 
   vector<int> indices = {0, 1, 2, 3, 4};
@@ -30,10 +30,40 @@ TEST_F(GlobalFactoredMaxentWeightsTest, TestCheckGradientSparse) {
   EXPECT_TRUE(weights.checkGradient(corpus, indices, gradient, 1e-3));
 }
 
+TEST_F(GlobalFactoredMaxentWeightsTest, TestCheckGradientPreparedSparse) {
+  metadata = boost::make_shared<FactoredMaxentMetadata>(
+      config, vocab, index, mapper, populator, matcher, compactPopulator);
+  GlobalFactoredMaxentWeights weights(config, metadata, corpus);
+
+  PreparedMinibatch minibatch;
+  minibatch.corpus = corpus;
+  minibatch.indices = {0, 1, 2, 3, 4};
+
+  Real log_likelihood;
+  MinibatchWords words;
+  boost::shared_ptr<MinibatchFactoredMaxentWeights> gradient =
+       boost::make_shared<MinibatchFactoredMaxentWeights>(config, metadata);
+  boost::shared_ptr<MinibatchFactoredMaxentWeights> thread_gradient =
+       boost::make_shared<MinibatchFactoredMaxentWeights>(config, metadata);
+  gradient->prepare(minibatch);
+  EXPECT_TRUE(minibatch.classFeatureStore != nullptr);
+
+  // The stores prepared for the gradient are used by its init(), the other
+  // gradients build their own stores.
+  gradient->init(minibatch);
+  thread_gradient->init(minibatch);
+  weights.getGradient(
+      corpus, minibatch.indices, thread_gradient, log_likelihood, words);
+  gradient->syncUpdate(words, thread_gradient);
+
+  EXPECT_TRUE(weights.checkGradient(
+      corpus, minibatch.indices, gradient, 1e-3));
+}
+
 TEST_F(GlobalFactoredMaxentWeightsTest, TestCollisionsNoFilter) {
   config->hash_space = 100;
   metadata = boost::make_shared<FactoredMaxentMetadata>(
-      config, vocab, index, mapper, populator, matcher);
+      config, vocab, index, mapper, populator, matcher, compactPopulator);
   GlobalFactoredMaxentWeights weights(config, metadata, corpus);
 
   vector<int> indices = {0, 1, 2, 3, 4};
@@ -50,11 +80,56 @@ TEST_F(GlobalFactoredMaxentWeightsTest, TestCollisionsNoFilter) {
   EXPECT_TRUE(weights.checkGradient(corpus, indices, gradient, 1e-3));
 }
 
+TEST_F(GlobalFactoredMaxentWeightsTest, TestCollisionsReusedStores) {
+  config->hash_space = 100;
+  metadata = boost::make_shared<FactoredMaxentMetadata>(
+      config, vocab, index, mapper, populator, matcher, compactPopulator);
+  GlobalFactoredMaxentWeights weights(config, metadata, corpus);
+
+  Real log_likelihood;
+  MinibatchWords words;
+  boost::shared_ptr<MinibatchFactoredMaxentWeights> gradient =
+       boost::make_shared<MinibatchFactoredMaxentWeights>(config, metadata);
+  vector<int> indices = {0, 1, 2};
+  gradient->init(corpus, indices);
+  weights.getGradient(corpus, indices, gradient, log_likelihood, words);
+
+  // The feature stores of the previous minibatch are cleared and reused.
+  gradient->clear(words, false);
+  indices = {0, 1, 2, 3, 4};
+  words = MinibatchWords();
+  gradient->init(corpus, indices);
+  weights.getGradient(corpus, indices, gradient, log_likelihood, words);
+
+  EXPECT_TRUE(weights.checkGradient(corpus, indices, gradient, 1e-3));
+}
+
 TEST_F(GlobalFactoredMaxentWeightsTest, TestCollisionExactFiltering) {
   config->hash_space = 100;
   config->filter_contexts = true;
   metadata = boost::make_shared<FactoredMaxentMetadata>(
-      config, vocab, index, mapper, populator, matcher);
+      config, vocab, index, mapper, populator, matcher, compactPopulator);
+  GlobalFactoredMaxentWeights weights(config, metadata, corpus);
+
+  vector<int> indices = {0, 1, 2, 3, 4};
+  Real log_likelihood;
+  MinibatchWords words;
+  boost::shared_ptr<MinibatchFactoredMaxentWeights> gradient =
+       boost::make_shared<MinibatchFactoredMaxentWeights>(config, metadata);
+  gradient->init(corpus, indices);
+  weights.getGradient(corpus, indices, gradient, log_likelihood, words);
+
+  // See the comment in weights_test.cc if you suspect the gradient is not
+  // computed correctly.
+  EXPECT_TRUE(weights.checkGradient(corpus, indices, gradient, 1e-3));
+}
+
+TEST_F(GlobalFactoredMaxentWeightsTest, TestCollisionCompactFiltering) {
+  config->hash_space = 100;
+  config->filter_contexts = true;
+  config->compact_filter = true;
+  metadata = boost::make_shared<FactoredMaxentMetadata>(
+      config, vocab, index, mapper, populator, matcher, compactPopulator);
   GlobalFactoredMaxentWeights weights(config, metadata, corpus);
 
   vector<int> indices = {0, 1, 2, 3, 4};
@@ -77,7 +152,7 @@ TEST_F(GlobalFactoredMaxentWeightsTest, TestCollisionApproximateFiltering) {
   populator = boost::make_shared<BloomFilterPopulator>(
       corpus, index, mapper, config);
   metadata = boost::make_shared<FactoredMaxentMetadata>(
-      config, vocab, index, mapper, populator, matcher);
+      config, vocab, index, mapper, populator, matcher, compactPopulator);
   GlobalFactoredMaxentWeights weights(config, metadata, corpus);
 
   vector<int> indices = {0, 1, 2, 3, 4};
@@ -96,7 +171,7 @@ TEST_F(GlobalFactoredMaxentWeightsTest, TestCollisionApproximateFiltering) {
 TEST_F(GlobalFactoredMaxentWeightsTest, TestCheckGradientExtraHiddenLayers) {
   config->hidden_layers = 2;
   metadata = boost::make_shared<FactoredMaxentMetadata>(
-      config, vocab, index, mapper, populator, matcher);
+      config, vocab, index, mapper, populator, matcher, compactPopulator);
   GlobalFactoredMaxentWeights weights(config, metadata, corpus);
 
   vector<int> indices = {0, 1, 2, 3, 4};
@@ -115,7 +190,7 @@ TEST_F(GlobalFactoredMaxentWeightsTest, TestCheckGradientExtraHiddenLayers) {
 
 TEST_F(GlobalFactoredMaxentWeightsTest, TestPredict) {
   metadata = boost::make_shared<FactoredMaxentMetadata>(
-      config, vocab, index, mapper, populator, matcher);
+      config, vocab, index, mapper, populator, matcher, compactPopulator);
   GlobalFactoredMaxentWeights weights(config, metadata, corpus);
   vector<int> indices = {0, 1, 2, 3};
 
@@ -126,13 +201,23 @@ TEST_F(GlobalFactoredMaxentWeightsTest, TestPredict) {
   EXPECT_NEAR(log_likelihood, getLogProbabilities(weights, indices), EPS);
 }
 
+TEST_F(GlobalFactoredMaxentWeightsTest, TestGetLogProbs) {
+  metadata = boost::make_shared<FactoredMaxentMetadata>(
+      config, vocab, index, mapper, populator, matcher, compactPopulator);
+  GlobalFactoredMaxentWeights weights(config, metadata, corpus);
+  vector<int> indices = {0, 1, 2, 3};
+  VectorReal log_probs = weights.getLogProbs(corpus, indices);
+
+  EXPECT_NEAR(-log_probs.sum(), getLogProbabilities(weights, indices), EPS);
+}
+
 TEST_F(GlobalFactoredMaxentWeightsTest, TestUnnormalizedScores) {
   // Since we only get the sum of the word score and the class score, we can't
   // use this information to uniquely identify the original log probabilities.
   // The best I could think of is to check that the relative order of log
   // probabilities and unnormalized scores is the same.
   metadata = boost::make_shared<FactoredMaxentMetadata>(
-      config, vocab, index, mapper, populator, matcher);
+      config, vocab, index, mapper, populator, matcher, compactPopulator);
 
   GlobalFactoredMaxentWeights weights(config, metadata, corpus);
   vector<int> indices = {0, 1, 2, 3};
@@ -140,9 +225,77 @@ TEST_F(GlobalFactoredMaxentWeightsTest, TestUnnormalizedScores) {
   EXPECT_TRUE(checkScoreRelativeOrder(weights, indices));
 }
 
+TEST_F(GlobalFactoredMaxentWeightsTest, TestTrainPrunedSparse) {
+  metadata = boost::make_shared<FactoredMaxentMetadata>(
+      config, vocab, index, mapper, populator, matcher, compactPopulator);
+  GlobalFactoredMaxentWeights weights(config, metadata, corpus);
+
+  vector<int> indices = {0, 1, 2, 3, 4};
+  Real log_likelihood;
+  MinibatchWords words;
+  boost::shared_ptr<MinibatchFactoredMaxentWeights> gradient =
+       boost::make_shared<MinibatchFactoredMaxentWeights>(config, metadata);
+  gradient->init(corpus, indices);
+  weights.getGradient(corpus, indices, gradient, log_likelihood, words);
+  boost::shared_ptr<GlobalFactoredMaxentWeights> adagrad =
+      boost::make_shared<GlobalFactoredMaxentWeights>(config, metadata);
+  adagrad->updateSquared(words, gradient);
+  weights.updateAdaGrad(words, gradient, adagrad);
+
+  EXPECT_EQ(0, weights.prune(1000, 0));
+  // The pruned features are no longer part of the minibatch stores.
+  EXPECT_EQ(0, matcher->getGlobalFeatures()->getClassFeatures(0).size());
+
+  // Continue training the pruned model.
+  gradient = boost::make_shared<MinibatchFactoredMaxentWeights>(
+      config, metadata);
+  words = MinibatchWords();
+  gradient->init(corpus, indices);
+  weights.getGradient(corpus, indices, gradient, log_likelihood, words);
+  adagrad = boost::make_shared<GlobalFactoredMaxentWeights>(config, metadata);
+  adagrad->updateSquared(words, gradient);
+  weights.updateAdaGrad(words, gradient, adagrad);
+
+  EXPECT_TRUE(weights.checkGradient(corpus, indices, gradient, 1e-3));
+}
+
+TEST_F(GlobalFactoredMaxentWeightsTest, TestMemoryUsage) {
+  metadata = boost::make_shared<FactoredMaxentMetadata>(
+      config, vocab, index, mapper, populator, matcher, compactPopulator);
+  GlobalFactoredMaxentWeights weights(config, metadata, corpus);
+  FactoredWeights factored_weights(config, metadata, corpus);
+
+  MemoryReport report;
+  weights.reportMemory(report);
+  size_t dense_bytes = report.getBytes("Q") + report.getBytes("R")
+      + report.getBytes("C") + report.getBytes("H") + report.getBytes("B")
+      + report.getBytes("S") + report.getBytes("T");
+  EXPECT_EQ(factored_weights.numParameters() * sizeof(Real), dense_bytes);
+
+  size_t num_features =
+      weights.numParameters() - factored_weights.numParameters();
+  EXPECT_LT(0, num_features);
+  // Every sparse feature stores a weight and an index.
+  EXPECT_LE(num_features * (sizeof(Real) + sizeof(int)),
+            report.getBytes("U") + report.getBytes("V"));
+  EXPECT_EQ(0, report.getBytes("collision space"));
+
+  config->hash_space = 100;
+  GlobalFactoredMaxentWeights collision_weights(config, metadata, corpus);
+  EXPECT_EQ(factored_weights.numParameters() + 100,
+            collision_weights.numParameters());
+
+  // The collision space is shared by the stores and counted only once.
+  MemoryReport collision_report;
+  collision_weights.reportMemory(collision_report);
+  EXPECT_EQ(100 * sizeof(Real), collision_report.getBytes("collision space"));
+  EXPECT_EQ(0, collision_report.getBytes("U"));
+  EXPECT_EQ(0, collision_report.getBytes("V"));
+}
+
 TEST_F(GlobalFactoredMaxentWeightsTest, TestSerialization) {
   metadata = boost::make_shared<FactoredMaxentMetadata>(
-      config, vocab, index, mapper, populator, matcher);
+      config, vocab, index, mapper, populator, matcher, compactPopulator);
   GlobalFactoredMaxentWeights weights(config, metadata, corpus), weights_copy;
 
   stringstream stream(ios_base::binary | ios_base::out | ios_base::in);
@@ -1,6 +1,7 @@
 #include "lbl/tests/factored_weights_test.h"
 
 #include "lbl/bloom_filter_populator.h"
+#include "lbl/compact_filter_populator.h"
 #include "lbl/context_processor.h"
 #include "lbl/factored_maxent_metadata.h"
 #include "lbl/feature_matcher.h"
@@ -30,11 +31,14 @@ class GlobalFactoredMaxentWeightsTest : public FactoredWeightsTest {
         corpus, index, processor, generator, filter);
     matcher = boost::make_shared<FeatureMatcher>(
         corpus, index, processor, generator, filter, mapper);
+    compactPopulator = boost::make_shared<CompactFilterPopulator>(
+        corpus, index, processor, generator, filter);
   }
 
   boost::shared_ptr<FeatureContextMapper> mapper;
   boost::shared_ptr<BloomFilterPopulator> populator;
   boost::shared_ptr<FeatureMatcher> matcher;
+  boost::shared_ptr<CompactFilterPopulator> compactPopulator;
   boost::shared_ptr<FactoredMaxentMetadata> metadata;
 };
 
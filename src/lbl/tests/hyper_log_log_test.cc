@@ -0,0 +1,50 @@
+#include "gtest/gtest.h"
+
+#include "lbl/hyper_log_log.h"
+#include "lbl/ngram.h"
+
+namespace oxlm {
+
+TEST(HyperLogLogTest, TestSmallRange) {
+  HyperLogLog<NGram> counter(14);
+  EXPECT_NEAR(0, counter.estimate(), 1e-9);
+
+  vector<int> context = {1, 2, 3};
+  for (int j = 0; j < 3; ++j) {
+    for (int i = 0; i < 100; ++i) {
+      counter.increment(NGram(i, context));
+    }
+  }
+
+  EXPECT_NEAR(100, counter.estimate(), 2);
+}
+
+TEST(HyperLogLogTest, TestLargeRange) {
+  HyperLogLog<NGram> counter(14);
+  for (int i = 0; i < 1000; ++i) {
+    for (int j = 0; j < 200; ++j) {
+      counter.increment(NGram(i, {j, 1}));
+    }
+  }
+
+  EXPECT_NEAR(200000, counter.estimate(), 200000 * 0.03);
+}
+
+TEST(HyperLogLogTest, TestMerge) {
+  HyperLogLog<NGram> counter(14), first(14), second(14);
+  for (int i = 0; i < 50000; ++i) {
+    NGram query(i, {i % 7, 2});
+    counter.increment(query);
+    if (i < 30000) {
+      first.increment(query);
+    }
+    if (i >= 20000) {
+      second.increment(query);
+    }
+  }
+
+  first.merge(second);
+  EXPECT_NEAR(counter.estimate(), first.estimate(), 1e-9);
+}
+
+} // namespace oxlm
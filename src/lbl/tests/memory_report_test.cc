@@ -0,0 +1,45 @@
+#include "gtest/gtest.h"
+
+#include <sstream>
+
+#include "lbl/memory_report.h"
+
+namespace oxlm {
+
+TEST(MemoryReportTest, TestAdd) {
+  MemoryReport report;
+  report.add("Q", 1000);
+  report.add("R", 500);
+
+  MemoryReport gradient_report;
+  gradient_report.add("Q", 100);
+  gradient_report.add("R", 50);
+  report.add("gradients: ", gradient_report, 3);
+
+  EXPECT_EQ(1000, report.getBytes("Q"));
+  EXPECT_EQ(150, report.getBytes("gradients: R"));
+  EXPECT_EQ(450, report.getBytes("gradients: "));
+  EXPECT_EQ(0, report.getBytes("S"));
+  EXPECT_EQ(1950, report.getTotalBytes());
+}
+
+TEST(MemoryReportTest, TestPrint) {
+  MemoryReport report;
+  report.add("Q", 3 << 20);
+  report.add("R", 1 << 20);
+
+  stringstream stream;
+  report.print(stream);
+  string output = stream.str();
+  EXPECT_NE(string::npos, output.find("  Q = 3.0 MB (75.0%)\n"));
+  EXPECT_NE(string::npos, output.find("  R = 1.0 MB (25.0%)\n"));
+  EXPECT_NE(string::npos, output.find("  Total = 4.0 MB\n"));
+}
+
+TEST(MemoryReportTest, TestContainerBytes) {
+  vector<int> values;
+  values.reserve(10);
+  EXPECT_EQ(10 * sizeof(int), MemoryReport::getContainerBytes(values));
+}
+
+} // namespace oxlm
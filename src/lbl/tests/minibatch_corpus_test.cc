@@ -0,0 +1,47 @@
+#include "gtest/gtest.h"
+
+#include <boost/make_shared.hpp>
+
+#include "lbl/context_processor.h"
+#include "lbl/minibatch_corpus.h"
+
+namespace oxlm {
+
+TEST(MinibatchCorpusTest, TestContexts) {
+  vector<int> data = {2, 3, 4, 1, 5, 6, 1};
+  boost::shared_ptr<Corpus> corpus = boost::make_shared<Corpus>(data);
+  boost::shared_ptr<MinibatchCorpus> minibatch_corpus =
+      boost::make_shared<MinibatchCorpus>(corpus, 3);
+
+  vector<int> positions = {5, 0, 3, 4, 2};
+  vector<int> indices;
+  for (int position: positions) {
+    indices.push_back(minibatch_corpus->add(position));
+  }
+  EXPECT_EQ(20, minibatch_corpus->size());
+
+  ContextProcessor processor(corpus, 3);
+  ContextProcessor minibatch_processor(minibatch_corpus, 3);
+  for (size_t i = 0; i < positions.size(); ++i) {
+    EXPECT_EQ(corpus->at(positions[i]), minibatch_corpus->at(indices[i]));
+    EXPECT_EQ(
+        processor.extract(positions[i]),
+        minibatch_processor.extract(indices[i]));
+  }
+
+  // Shorter contexts are extracted from the same positions.
+  ContextProcessor short_processor(corpus, 2);
+  ContextProcessor short_minibatch_processor(minibatch_corpus, 2);
+  for (size_t i = 0; i < positions.size(); ++i) {
+    EXPECT_EQ(
+        short_processor.extract(positions[i]),
+        short_minibatch_processor.extract(indices[i]));
+  }
+
+  minibatch_corpus->clear();
+  EXPECT_EQ(0, minibatch_corpus->size());
+  EXPECT_EQ(3, minibatch_corpus->add(4));
+  EXPECT_EQ(5, minibatch_corpus->at(3));
+}
+
+} // namespace oxlm
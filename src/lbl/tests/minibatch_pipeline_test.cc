@@ -0,0 +1,97 @@
+#include "gtest/gtest.h"
+
+#include <boost/make_shared.hpp>
+
+#include "lbl/context_processor.h"
+#include "lbl/minibatch_pipeline.h"
+
+namespace oxlm {
+
+class MinibatchPipelineTest : public testing::Test {
+ protected:
+  void SetUp() {
+    config = boost::make_shared<ModelData>();
+    config->ngram_order = 3;
+    config->minibatch_size = 3;
+
+    vector<int> data = {2, 3, 4, 1, 5, 6, 1, 7, 1};
+    corpus = boost::make_shared<Corpus>(data);
+    indices = {4, 0, 8, 2, 7, 1, 3, 6, 5};
+  }
+
+  void checkIteration(int prefetch_minibatches, size_t start) {
+    config->prefetch_minibatches = prefetch_minibatches;
+    MinibatchPipeline pipeline(
+        config, corpus, boost::make_shared<Weights>(config));
+    ContextProcessor processor(corpus, 2);
+
+    // Run the same iteration twice to check that the buffers are reused
+    // correctly.
+    for (int iteration = 0; iteration < 2; ++iteration) {
+      pipeline.start(indices, start);
+      for (size_t i = start; i < indices.size(); i += 3) {
+        const PreparedMinibatch& minibatch = pipeline.next();
+        ContextProcessor minibatch_processor(minibatch.corpus, 2);
+        ASSERT_EQ(min<size_t>(3, indices.size() - i), minibatch.indices.size());
+        for (size_t j = 0; j < minibatch.indices.size(); ++j) {
+          EXPECT_EQ(
+              corpus->at(indices[i + j]),
+              minibatch.corpus->at(minibatch.indices[j]));
+          EXPECT_EQ(
+              processor.extract(indices[i + j]),
+              minibatch_processor.extract(minibatch.indices[j]));
+        }
+      }
+    }
+  }
+
+  boost::shared_ptr<ModelData> config;
+  boost::shared_ptr<Corpus> corpus;
+  vector<int> indices;
+};
+
+TEST_F(MinibatchPipelineTest, TestPrefetch) {
+  checkIteration(1, 0);
+  checkIteration(2, 0);
+  checkIteration(5, 0);
+}
+
+TEST_F(MinibatchPipelineTest, TestNoPrefetch) {
+  checkIteration(0, 0);
+}
+
+TEST_F(MinibatchPipelineTest, TestResume) {
+  checkIteration(0, 3);
+  checkIteration(1, 3);
+  checkIteration(1, 9);
+}
+
+TEST_F(MinibatchPipelineTest, TestStopEarly) {
+  MinibatchPipeline pipeline(
+      config, corpus, boost::make_shared<Weights>(config));
+  pipeline.start(indices, 0);
+  const PreparedMinibatch& minibatch = pipeline.next();
+  EXPECT_EQ(3, minibatch.indices.size());
+  pipeline.stop();
+
+  pipeline.start(indices, 6);
+  const PreparedMinibatch& last_minibatch = pipeline.next();
+  ASSERT_EQ(3, last_minibatch.indices.size());
+  EXPECT_EQ(
+      corpus->at(indices[6]),
+      last_minibatch.corpus->at(last_minibatch.indices[0]));
+}
+
+TEST_F(MinibatchPipelineTest, TestNoiseSamples) {
+  // Noise contrastive estimation reads the training corpus directly.
+  config->noise_samples = 2;
+  MinibatchPipeline pipeline(
+      config, corpus, boost::make_shared<Weights>(config));
+  pipeline.start(indices, 0);
+  const PreparedMinibatch& minibatch = pipeline.next();
+  EXPECT_EQ(corpus, minibatch.corpus);
+  vector<int> expected_indices = {4, 0, 8};
+  EXPECT_EQ(expected_indices, minibatch.indices);
+}
+
+} // namespace oxlm
@@ -98,4 +98,27 @@ TEST_F(NGramFilterTest, TestDisabled) {
   EXPECT_EQ(1, filter.filter(4, 2, feature_contexts).size());
 }
 
+TEST_F(NGramFilterTest, TestSketch) {
+  // With enough memory, the sketch counts are exact.
+  vector<pair<int, int>> params = {{3, 1}, {0, 2}, {2, 2}};
+  for (const auto& param: params) {
+    NGramFilter exact_filter(
+        corpus, index, processor, generator, param.first, param.second);
+    NGramFilter sketch_filter(
+        corpus, index, processor, generator, param.first, param.second,
+        1 << 16);
+
+    for (int word_id = 1; word_id <= 4; ++word_id) {
+      int class_id = index->getClass(word_id);
+      for (int context_word = 1; context_word <= 4; ++context_word) {
+        vector<FeatureContext> feature_contexts = {
+            FeatureContext({context_word})};
+        EXPECT_EQ(
+            exact_filter.filter(word_id, class_id, feature_contexts).size(),
+            sketch_filter.filter(word_id, class_id, feature_contexts).size());
+      }
+    }
+  }
+}
+
 } // namespace oxlm
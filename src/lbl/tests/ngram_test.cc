@@ -24,4 +24,18 @@ TEST(NGramTest, TestSerialization) {
   EXPECT_EQ(query, query_copy);
 }
 
+TEST(NGramTest, TestHash) {
+  vector<int> context = {2, 3, 4, 5};
+  NGram query(1, 7, context);
+
+  hash<NGram> hash_function(2);
+  EXPECT_EQ(MurmurHash({1, 7, 2, 3, 4, 5}, 2), hash_function(query));
+  EXPECT_EQ(
+      MurmurHash128({1, 7, 2, 3, 4, 5}, 2), hash_function.getFullHash(query));
+
+  PrefixHash prefix_hash = hash_function.getPrefixHash(1, 7);
+  prefix_hash.append(context);
+  EXPECT_EQ(hash_function(query), prefix_hash.getHash());
+}
+
 } // namespace oxlm
@@ -0,0 +1,76 @@
+#include "gtest/gtest.h"
+
+#include <boost/make_shared.hpp>
+
+#include "lbl/node_distributions.h"
+#include "utils/constants.h"
+
+namespace oxlm {
+
+TEST(NodeDistributionsTest, TestBasic) {
+  boost::shared_ptr<Vocabulary> vocab = boost::make_shared<Vocabulary>();
+  boost::shared_ptr<ClassTree> tree =
+      boost::make_shared<ClassTree>("tree.txt", vocab);
+  VectorReal node_unigram = VectorReal::Zero(12);
+  node_unigram << 1, 0, 1, 0.8, 0.2, 0.6, 0.2, 0.2, 0, 0, 0.2, 0.4;
+
+  NodeDistributions dists(node_unigram, tree);
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_EQ(2, dists.sample(0));
+    EXPECT_EQ(7, dists.sample(4));
+  }
+
+  for (int i = 0; i < 100; ++i) {
+    int node = dists.sample(5);
+    EXPECT_TRUE(node == 10 || node == 11);
+  }
+
+  EXPECT_NEAR(0, dists.logProb(2), EPS);
+  EXPECT_NEAR(log(0.25), dists.logProb(6), EPS);
+  EXPECT_NEAR(log(2.0 / 3), dists.logProb(11), EPS);
+}
+
+TEST(NodeDistributionsTest, TestZeroMassSubtree) {
+  boost::shared_ptr<Vocabulary> vocab = boost::make_shared<Vocabulary>();
+  boost::shared_ptr<ClassTree> tree =
+      boost::make_shared<ClassTree>("tree.txt", vocab);
+  // The leaves 7, 8 and 9 (and their parent 4) have no unigram mass.
+  VectorReal node_unigram = VectorReal::Zero(12);
+  node_unigram << 1, 0, 1, 1, 0, 0.6, 0.4, 0, 0, 0, 0.2, 0.4;
+
+  NodeDistributions dists(node_unigram, tree);
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_EQ(3, dists.sample(2));
+    int node = dists.sample(4);
+    EXPECT_TRUE(node >= 7 && node <= 9);
+  }
+
+  for (int node = 1; node < 12; ++node) {
+    EXPECT_FALSE(std::isnan(dists.logProb(node)));
+  }
+  EXPECT_NEAR(log(1.0 / 3), dists.logProb(7), EPS);
+  EXPECT_NEAR(log(1.0 / 3), dists.logProb(9), EPS);
+}
+
+TEST(NodeDistributionsTest, TestSeed) {
+  boost::shared_ptr<Vocabulary> vocab = boost::make_shared<Vocabulary>();
+  boost::shared_ptr<ClassTree> tree =
+      boost::make_shared<ClassTree>("tree.txt", vocab);
+  VectorReal node_unigram = VectorReal::Zero(12);
+  node_unigram << 1, 0, 1, 0.8, 0.2, 0.6, 0.2, 0.2, 0, 0, 0.2, 0.4;
+
+  NodeDistributions dists(node_unigram, tree, 1);
+  NodeDistributions same_dists(node_unigram, tree, 1);
+  NodeDistributions other_dists(node_unigram, tree, 2);
+  vector<int> samples, same_samples, other_samples;
+  for (int i = 0; i < 100; ++i) {
+    samples.push_back(dists.sample(5));
+    same_samples.push_back(same_dists.sample(5));
+    other_samples.push_back(other_dists.sample(5));
+  }
+
+  EXPECT_EQ(samples, same_samples);
+  EXPECT_NE(samples, other_samples);
+}
+
+} // namespace oxlm
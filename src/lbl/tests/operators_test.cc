@@ -26,6 +26,15 @@ TEST(OperatorsTest, TestAdagradUpdateOp) {
   EXPECT_MATRIX_NEAR(expected_result, result, EPS);
 }
 
+TEST(OperatorsTest, TestCwiseShrinkOp) {
+  VectorReal v(5);
+  v << -2, 0.5, 0, 2, -0.5;
+  VectorReal result = v.unaryExpr(CwiseShrinkOp<Real>(1));
+  VectorReal expected_result(5);
+  expected_result << -1, 0, 0, 1, 0;
+  EXPECT_MATRIX_NEAR(expected_result, result, EPS);
+}
+
 TEST(OperatorsTest, TestCwiseRectifierOp) {
   VectorReal v(5);
   v << -2, 1, 0, 2, -1;
@@ -43,4 +43,25 @@ TEST(ParallelCorpusTest, TestBasic) {
   }
 }
 
+TEST(ParallelCorpusTest, TestAlignmentIndex) {
+  vector<int> source_data = {10, 11, 12, 1, 13, 14, 15, 16, 1};
+  vector<int> target_data = {20, 21, 22, 1, 23, 24, 25, 1};
+  vector<vector<long long>> links =
+      {{1}, {0, 2}, {}, {3}, {}, {4, 6, 7}, {5}, {8}};
+  ParallelCorpus corpus(source_data, target_data, links);
+
+  // Unaligned words use the closest aligned word (preferring the right).
+  vector<long long> expected_affinities = {1, 0, 3, 3, 6, 6, 5, 8};
+  for (size_t i = 0; i < target_data.size(); ++i) {
+    EXPECT_EQ(expected_affinities[i], corpus.getAffinity(i));
+  }
+
+  vector<int> expected_positions = {0, 1, 2, 3, 0, 1, 2, 3, 4};
+  vector<int> expected_words_left = {3, 2, 1, 0, 4, 3, 2, 1, 0};
+  for (size_t i = 0; i < source_data.size(); ++i) {
+    EXPECT_EQ(expected_positions[i], corpus.getSourceSentencePosition(i));
+    EXPECT_EQ(expected_words_left[i], corpus.getSourceWordsLeft(i));
+  }
+}
+
 } // namespace oxlm
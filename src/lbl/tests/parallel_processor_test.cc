@@ -31,6 +31,26 @@ TEST(ParallelProcessorTest, TestBasic) {
   EXPECT_EQ(expected_context, processor.extract(7));
 }
 
+TEST(ParallelProcessorTest, TestExtractMany) {
+  vector<int> source_data = {10, 11, 12, 1, 13, 14, 15, 16, 1};
+  vector<int> target_data = {20, 21, 22, 1, 23, 24, 25, 1};
+  vector<vector<long long>> links =
+      {{1}, {0, 2}, {}, {3}, {}, {4, 6, 7}, {5}, {8}};
+  boost::shared_ptr<ParallelCorpus> corpus =
+      boost::make_shared<ParallelCorpus>(source_data, target_data, links);
+
+  ParallelProcessor processor(corpus, 2, 5);
+  EXPECT_EQ(7, processor.getContextWidth());
+
+  vector<int> positions = {6, 2};
+  vector<WordId> contexts;
+  processor.extractMany(positions, contexts);
+  vector<WordId> expected_contexts = {
+      24, 23, 0, 13, 14, 15, 16,
+      21, 20, 11, 12, 1, 1, 1};
+  EXPECT_EQ(expected_contexts, contexts);
+}
+
 TEST(ParallelProcessorTest, TestUnaligned) {
   vector<int> source_data = {2, 3, 4, 5, 6, 1};
   vector<int> target_data = {2, 3, 4, 5, 6, 1};
@@ -0,0 +1,40 @@
+#include "gtest/gtest.h"
+
+#include "lbl/prefix_hash.h"
+#include "lbl/utils.h"
+
+namespace oxlm {
+
+TEST(PrefixHashTest, TestEmpty) {
+  vector<int> data;
+  EXPECT_EQ(MurmurHash(data), PrefixHash().getHash());
+  EXPECT_EQ(MurmurHash(data, 3), PrefixHash(3).getHash());
+}
+
+TEST(PrefixHashTest, TestPrefixes) {
+  vector<int> data = {1, -2, 3, 1 << 30, 5, 0, -7, 8, 9, 10, 11};
+  for (int seed = 0; seed < 3; ++seed) {
+    PrefixHash prefix_hash(seed);
+    vector<int> prefix;
+    for (int value: data) {
+      prefix_hash.append(value);
+      prefix.push_back(value);
+      EXPECT_EQ(MurmurHash(prefix, seed), prefix_hash.getHash());
+      EXPECT_EQ(MurmurHash128(prefix, seed), prefix_hash.getFullHash());
+    }
+  }
+}
+
+TEST(PrefixHashTest, TestCopy) {
+  PrefixHash prefix_hash;
+  prefix_hash.append(5);
+
+  PrefixHash first = prefix_hash, second = prefix_hash;
+  first.append(vector<int>{1, 2});
+  second.append(vector<int>{1, 3});
+
+  EXPECT_EQ(MurmurHash({5, 1, 2}), first.getHash());
+  EXPECT_EQ(MurmurHash({5, 1, 3}), second.getHash());
+}
+
+} // namespace oxlm
@@ -45,4 +45,24 @@ TEST(QueryCacheTest, TestSerialization) {
   EXPECT_EQ(make_pair(Real(0.5), true), cache_copy.get(query));
 }
 
+TEST(QueryCacheTest, TestLoadVersion0) {
+  vector<int> context = {2, 3, 4, 5};
+  NGram query(1, context);
+  hash<NGram> hash_function;
+  unordered_map<size_t, Real> old_cache;
+  old_cache[hash_function(query)] = 0.5;
+
+  // Version 0 archives stored the unordered_map directly.
+  stringstream stream(ios_base::binary | ios_base::out | ios_base::in);
+  ar::binary_oarchive oar(stream, ar::no_header);
+  oar << old_cache;
+
+  QueryCache cache;
+  ar::binary_iarchive iar(stream, ar::no_header);
+  boost::serialization::serialize_adl(iar, cache, 0);
+
+  EXPECT_EQ(1, cache.size());
+  EXPECT_EQ(make_pair(Real(0.5), true), cache.get(query));
+}
+
 } // namespace olxm
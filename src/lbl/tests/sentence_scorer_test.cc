@@ -0,0 +1,86 @@
+#include "gtest/gtest.h"
+
+#include <chrono>
+#include <thread>
+
+#include <boost/make_shared.hpp>
+
+#include "lbl/sentence_scorer.h"
+
+namespace oxlm {
+
+// Scores every token with a value derived from its position, and makes the
+// short sentences slow, so that the threads finish out of corpus order.
+class FakeModel {
+ public:
+  FakeModel(const boost::shared_ptr<Vocabulary>& vocab) : vocab(vocab) {}
+
+  boost::shared_ptr<Vocabulary> getVocab() const {
+    return vocab;
+  }
+
+  VectorReal getLogProbs(
+      const boost::shared_ptr<Corpus>& corpus,
+      const vector<int>& indices) const {
+    this_thread::sleep_for(chrono::microseconds(200 / indices.size()));
+    VectorReal log_probs(indices.size());
+    for (size_t i = 0; i < indices.size(); ++i) {
+      log_probs(i) = -0.25 * (indices[i] % 7 + 1);
+    }
+    return log_probs;
+  }
+
+ private:
+  boost::shared_ptr<Vocabulary> vocab;
+};
+
+TEST(SentenceScorerTest, TestOutputOrder) {
+  boost::shared_ptr<Vocabulary> vocab = boost::make_shared<Vocabulary>();
+  vocab->convert("<s>");
+  int eos = vocab->convert("</s>");
+  vector<int> words = {vocab->convert("a"), vocab->convert("b")};
+
+  // Sentences of shuffled lengths (including the end of sentence tokens).
+  vector<int> lengths = {9, 1, 5, 12, 3, 7, 2, 10, 4, 8, 6, 11, 1, 13};
+  vector<int> data;
+  vector<double> expected_totals;
+  for (int length: lengths) {
+    double total = 0;
+    for (int i = 0; i < length; ++i) {
+      total += -0.25 * (data.size() % 7 + 1);
+      data.push_back(i + 1 < length ? words[i % words.size()] : eos);
+    }
+    expected_totals.push_back(total);
+  }
+  boost::shared_ptr<Corpus> corpus = boost::make_shared<Corpus>(data, eos);
+  FakeModel model(vocab);
+
+  // A window smaller than the corpus, so the reorder buffer is drained more
+  // than once.
+  SentenceScorer<FakeModel> serial_scorer(model, corpus, 1, 4);
+  EXPECT_EQ(lengths.size(), serial_scorer.numSentences());
+  ostringstream serial_out;
+  double serial_total = serial_scorer.score(serial_out, "Total", false);
+
+  double expected_total = 0;
+  istringstream lines(serial_out.str());
+  string line;
+  for (size_t i = 0; i < lengths.size(); ++i) {
+    ASSERT_TRUE(static_cast<bool>(getline(lines, line)));
+    size_t pos = line.find("Total: ");
+    ASSERT_NE(string::npos, pos);
+    EXPECT_NEAR(expected_totals[i], stod(line.substr(pos + 7)), 1e-4);
+    expected_total += expected_totals[i];
+  }
+  EXPECT_FALSE(static_cast<bool>(getline(lines, line)));
+  EXPECT_NEAR(expected_total, serial_total, 1e-4);
+
+  for (int num_threads: {2, 4}) {
+    SentenceScorer<FakeModel> scorer(model, corpus, num_threads, 4);
+    ostringstream out;
+    EXPECT_EQ(serial_total, scorer.score(out, "Total", false));
+    EXPECT_EQ(serial_out.str(), out.str());
+  }
+}
+
+} // namespace oxlm
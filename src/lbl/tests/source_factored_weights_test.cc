@@ -1,5 +1,6 @@
 #include "gtest/gtest.h"
 
+#include "lbl/parallel_processor.h"
 #include "lbl/source_factored_weights.h"
 
 #include "utils/constants.h"
@@ -78,4 +79,18 @@ TEST_F(SourceFactoredWeightsTest, TestCheckGradientExtraHiddenLayers) {
   EXPECT_TRUE(weights.checkGradient(corpus, indices, gradient, 1e-3));
 }
 
+TEST_F(SourceFactoredWeightsTest, TestGetLogProbs) {
+  SourceFactoredWeights weights(config, metadata, corpus);
+  vector<int> indices = {0, 1, 2, 3, 4};
+  VectorReal log_probs = weights.getLogProbs(corpus, indices);
+
+  ParallelProcessor processor(
+      corpus, config->ngram_order - 1, 2 * config->source_order - 1);
+  for (size_t i = 0; i < indices.size(); ++i) {
+    vector<int> context = processor.extract(indices[i]);
+    EXPECT_NEAR(
+        weights.getLogProb(corpus->at(indices[i]), context), log_probs(i), EPS);
+  }
+}
+
 } // namespace oxlm
@@ -38,8 +38,7 @@ class SparseGlobalFeatureStoreTest : public ::testing::Test {
     boost::shared_ptr<FeatureContextMapper> mapper =
         boost::make_shared<FeatureContextMapper>(
             corpus, index, processor, generator, filter);
-    boost::shared_ptr<FeatureContextExtractor> extractor =
-        boost::make_shared<ClassContextExtractor>(mapper);
+    extractor = boost::make_shared<ClassContextExtractor>(mapper);
 
     store = SparseGlobalFeatureStore(5, 4, extractor);
     SparseMinibatchFeatureStore g_store(5, extractor);
@@ -72,6 +71,7 @@ class SparseGlobalFeatureStoreTest : public ::testing::Test {
     gradient_store = boost::make_shared<SparseMinibatchFeatureStore>(g_store);
   }
 
+  boost::shared_ptr<FeatureContextExtractor> extractor;
   SparseGlobalFeatureStore store;
   boost::shared_ptr<MinibatchFeatureStore> gradient_store;
   vector<int> context1, context2;
@@ -125,6 +125,45 @@ TEST_F(SparseGlobalFeatureStoreTest, TestUpdateAdaGrad) {
   EXPECT_NEAR(0, store.getValue(4, context2), EPS);
 }
 
+TEST_F(SparseGlobalFeatureStoreTest, TestUpdateUndefinedFeature) {
+  // Feature 4 is not defined for the first context. Without the check, the
+  // update would be written to the first feature of the second context.
+  SparseMinibatchFeatureStore g_store(5, extractor);
+  SparseVectorReal values(5);
+  values.insert(4) = 1;
+  g_store.hintFeatureIndex(1, 4);
+  g_store.update(context1, values);
+  boost::shared_ptr<MinibatchFeatureStore> undefined_gradient =
+      boost::make_shared<SparseMinibatchFeatureStore>(g_store);
+
+  EXPECT_THROW(store.updateSquared(undefined_gradient), exception);
+  EXPECT_NEAR(0, store.getValue(2, context2), EPS);
+
+  boost::shared_ptr<GlobalFeatureStore> adagrad_store =
+      boost::make_shared<SparseGlobalFeatureStore>(store);
+  EXPECT_THROW(
+      store.updateAdaGrad(undefined_gradient, adagrad_store, 1), exception);
+  EXPECT_NEAR(0, store.getValue(2, context2), EPS);
+}
+
+TEST_F(SparseGlobalFeatureStoreTest, TestPrune) {
+  store.updateSquared(gradient_store);
+
+  EXPECT_EQ(3, store.prune(2, 1));
+  EXPECT_EQ(4, store.size());
+  EXPECT_EQ(3, store.getFeatureIndexes().size());
+  VectorReal expected_values(5);
+  expected_values << 24, 8, 0, 0, 0;
+  EXPECT_MATRIX_NEAR(expected_values, store.get(context1), EPS);
+  expected_values << 0, 0, 3, 0, 0;
+  EXPECT_MATRIX_NEAR(expected_values, store.get(context2), EPS);
+  EXPECT_NEAR(3, store.getValue(2, context2), EPS);
+  EXPECT_NEAR(0, store.getValue(3, context2), EPS);
+
+  EXPECT_EQ(0, store.prune(100, 0));
+  EXPECT_MATRIX_NEAR(VectorReal::Zero(5), store.get(context1), EPS);
+}
+
 TEST_F(SparseGlobalFeatureStoreTest, TestUpdateRegularizer) {
   store.updateSquared(gradient_store);
   store.l2GradientUpdate(gradient_store, 0.5);
@@ -148,6 +187,27 @@ TEST_F(SparseGlobalFeatureStoreTest, TestUpdateRegularizer) {
   EXPECT_NEAR(0, store.getValue(4, context2), EPS);
 }
 
+TEST_F(SparseGlobalFeatureStoreTest, TestFeatureIndexes) {
+  GlobalFeatureIndexesPtr feature_indexes =
+      boost::make_shared<GlobalFeatureIndexes>(4);
+  // Feature indexes are not necessarily sorted or unique.
+  feature_indexes->at(1) = {1, 0, 1};
+  feature_indexes->at(2) = {3, 2};
+  SparseGlobalFeatureStore feature_store(5, feature_indexes, extractor);
+
+  EXPECT_EQ(store, feature_store);
+  vector<pair<int, int>> expected_indexes = {{1, 0}, {1, 1}, {2, 2}, {2, 3}};
+  EXPECT_EQ(expected_indexes, feature_store.getFeatureIndexes());
+
+  feature_store.updateSquared(gradient_store);
+  feature_store.updateFeature(make_pair(2, 3), 2);
+  VectorReal expected_values(5);
+  expected_values << 25, 9, 0, 0, 0;
+  EXPECT_MATRIX_NEAR(expected_values, feature_store.get(context1), EPS);
+  expected_values << 0, 0, 4, 3, 0;
+  EXPECT_MATRIX_NEAR(expected_values, feature_store.get(context2), EPS);
+}
+
 TEST_F(SparseGlobalFeatureStoreTest, TestSerialization) {
   boost::shared_ptr<GlobalFeatureStore> store_ptr =
       boost::make_shared<SparseGlobalFeatureStore>(store);
@@ -170,4 +230,31 @@ TEST_F(SparseGlobalFeatureStoreTest, TestSerialization) {
   EXPECT_EQ(*expected_ptr, *actual_ptr);
 }
 
+TEST_F(SparseGlobalFeatureStoreTest, TestLoadVersion0) {
+  store.updateSquared(gradient_store);
+
+  // Version 0 archives stored a sparse vector for every feature context.
+  vector<SparseVectorReal> feature_weights(4, SparseVectorReal(5));
+  feature_weights[1].coeffRef(0) = 25;
+  feature_weights[1].coeffRef(1) = 9;
+  feature_weights[2].coeffRef(2) = 4;
+  feature_weights[2].coeffRef(3) = 1;
+  int vector_max_size = 5;
+
+  stringstream stream(ios_base::binary | ios_base::out | ios_base::in);
+  ar::binary_oarchive output_stream(stream, ar::no_header);
+  output_stream << boost::serialization::base_object<GlobalFeatureStore>(store);
+  output_stream << vector_max_size << extractor << feature_weights;
+
+  SparseGlobalFeatureStore store_copy;
+  ar::binary_iarchive input_stream(stream, ar::no_header);
+  boost::serialization::serialize_adl(input_stream, store_copy, 0);
+
+  EXPECT_EQ(store, store_copy);
+  EXPECT_EQ(4, store_copy.getNumFeatures());
+  VectorReal expected_values(5);
+  expected_values << 25, 9, 0, 0, 0;
+  EXPECT_MATRIX_NEAR(expected_values, store_copy.get(context1), EPS);
+}
+
 }
@@ -120,6 +120,18 @@ TEST_F(SparseMinibatchFeatureStoreTest, TestUpdateStore) {
   EXPECT_MATRIX_NEAR(expected_values, store.get(context3), EPS);
 }
 
+TEST_F(SparseMinibatchFeatureStoreTest, TestUpdateValue) {
+  store.updateValue(4, context2, 2);
+  // Feature 2 is not defined for context2.
+  store.updateValue(2, context2, 5);
+
+  VectorReal expected_values(5);
+  expected_values << 1, 0, 0, 0, 5;
+  EXPECT_MATRIX_NEAR(expected_values, store.get(context2), EPS);
+  expected_values << 0, 2, 0, 0, 4;
+  EXPECT_MATRIX_NEAR(expected_values, store.get(context1), EPS);
+}
+
 TEST_F(SparseMinibatchFeatureStoreTest, TestClear) {
   store.clear();
   EXPECT_EQ(0, store.size());
@@ -0,0 +1,61 @@
+#include "gtest/gtest.h"
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+#include "lbl/tracer.h"
+
+namespace oxlm {
+
+class TracerTest : public testing::Test {
+ protected:
+  int countOccurrences(const string& pattern) const {
+    ifstream fin(traceFile);
+    stringstream buffer;
+    buffer << fin.rdbuf();
+    string content = buffer.str();
+
+    int count = 0;
+    for (size_t pos = content.find(pattern); pos != string::npos;
+         pos = content.find(pattern, pos + 1)) {
+      ++count;
+    }
+    return count;
+  }
+
+  void TearDown() {
+    Tracer::disable();
+    remove(traceFile.c_str());
+  }
+
+  string traceFile = "tracer_test.json";
+};
+
+TEST_F(TracerTest, TestDump) {
+  EXPECT_FALSE(Tracer::isEnabled());
+  {
+    // Tracing is disabled, so nothing is recorded.
+    TraceScope scope("disabled_event");
+  }
+
+  Tracer::enable(traceFile);
+  EXPECT_TRUE(Tracer::isEnabled());
+  for (size_t i = 0; i < Tracer::BUFFER_SIZE + 10; ++i) {
+    TraceScope scope("serial_event");
+  }
+
+  #pragma omp parallel num_threads(2)
+  {
+    TraceScope scope("parallel_event");
+  }
+
+  Tracer::dump();
+  EXPECT_EQ(0, countOccurrences("disabled_event"));
+  EXPECT_EQ(2, countOccurrences("\"parallel_event\""));
+  // Only the most recent events fit in the ring buffer of the main thread.
+  EXPECT_EQ(Tracer::BUFFER_SIZE - 1, countOccurrences("\"serial_event\""));
+  EXPECT_EQ(1, countOccurrences("\"traceEvents\""));
+}
+
+} // namespace oxlm
@@ -29,6 +29,20 @@ TEST_F(ConditionalSGDTest, TestTrainConditionalSGD) {
   EXPECT_NEAR(28.1909008, perplexity(log_likelihood, test_corpus->size()), EPS);
 }
 
+TEST_F(ConditionalSGDTest, TestTrainConditionalRowWiseAdaGrad) {
+  config->row_wise_adagrad = true;
+
+  SourceFactoredLM model(config);
+  model.learn();
+  config->test_file = "test.fr-en";
+  config->test_alignment_file = "test.gdfa";
+  boost::shared_ptr<Vocabulary> vocab = model.getVocab();
+  boost::shared_ptr<Corpus> test_corpus = readTestCorpus(config, vocab);
+  Real log_likelihood = 0;
+  model.evaluate(test_corpus, log_likelihood);
+  EXPECT_NEAR(27.1228408, perplexity(log_likelihood, test_corpus->size()), EPS);
+}
+
 TEST_F(ConditionalSGDTest, TestTrainConditionalNCE) {
   config->noise_samples = 10;
 
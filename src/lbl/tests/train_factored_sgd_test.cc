@@ -1,5 +1,9 @@
 #include "gtest/gtest.h"
 
+#include <fstream>
+
+#include <boost/filesystem.hpp>
+
 #include "lbl/factored_weights.h"
 #include "lbl/model.h"
 #include "lbl/model_utils.h"
@@ -19,6 +23,85 @@ TEST_F(FactoredSGDTest, TestTrainFactoredSGD) {
   EXPECT_NEAR(61.6432151, perplexity(log_likelihood, test_corpus->size()), EPS);
 }
 
+TEST_F(FactoredSGDTest, TestTrainFactoredRowWiseAdaGrad) {
+  config->row_wise_adagrad = true;
+  FactoredLM model(config);
+  model.learn();
+  config->test_file = "test.en";
+  boost::shared_ptr<Vocabulary> vocab = model.getVocab();
+  boost::shared_ptr<Corpus> test_corpus = readTestCorpus(config, vocab);
+  Real log_likelihood = 0;
+  model.evaluate(test_corpus, log_likelihood);
+  EXPECT_NEAR(60.5466461, perplexity(log_likelihood, test_corpus->size()), EPS);
+}
+
+TEST_F(FactoredSGDTest, TestTrainFactoredResumeFromCheckpoint) {
+  config->checkpoint_file = "factored_checkpoint.bin";
+  config->checkpoint_frequency = 1;
+  // Stop in the middle of the first iteration, right after the first
+  // checkpoint is written.
+  config->minibatch_threshold = 1;
+  {
+    FactoredLM model(config);
+    model.learn();
+  }
+
+  config->minibatch_threshold = 20000;
+  FactoredLM model(config);
+  model.learn();
+  remove(config->checkpoint_file.c_str());
+
+  config->test_file = "test.en";
+  boost::shared_ptr<Vocabulary> vocab = model.getVocab();
+  boost::shared_ptr<Corpus> test_corpus = readTestCorpus(config, vocab);
+  Real log_likelihood = 0;
+  model.evaluate(test_corpus, log_likelihood);
+  // Same perplexity as training without interruptions.
+  EXPECT_NEAR(61.6432151, perplexity(log_likelihood, test_corpus->size()), EPS);
+}
+
+TEST_F(FactoredSGDTest, TestTrainFactoredDeltaCheckpoints) {
+  config->checkpoint_file = "factored_delta_checkpoint.bin";
+  config->checkpoint_frequency = 1;
+  config->delta_checkpoints = 3;
+  // Stop in the second iteration, after a full checkpoint and two deltas.
+  config->minibatch_threshold = 3;
+  {
+    FactoredLM model(config);
+    model.learn();
+  }
+
+  config->minibatch_threshold = 20000;
+  FactoredLM model(config);
+  model.learn();
+
+  // Simulate a delta which is still being appended by the trainer.
+  string delta_file = config->checkpoint_file + ".deltas";
+  {
+    ofstream fout(delta_file, ios_base::binary | ios_base::app);
+    size_t delta_size = 1 << 20;
+    fout.write(reinterpret_cast<const char*>(&delta_size), sizeof(delta_size));
+    fout.write("partial", 7);
+  }
+  size_t delta_file_size = boost::filesystem::file_size(delta_file);
+
+  // The last checkpoint (a full checkpoint followed by a delta) matches the
+  // trained model. Merging the checkpoint leaves the partial delta in place.
+  FactoredLM restored_model;
+  restored_model.loadFromCheckpoint(config->checkpoint_file);
+  EXPECT_EQ(model, restored_model);
+  EXPECT_EQ(delta_file_size, boost::filesystem::file_size(delta_file));
+  remove(config->checkpoint_file.c_str());
+  remove(delta_file.c_str());
+
+  config->test_file = "test.en";
+  boost::shared_ptr<Vocabulary> vocab = model.getVocab();
+  boost::shared_ptr<Corpus> test_corpus = readTestCorpus(config, vocab);
+  Real log_likelihood = 0;
+  model.evaluate(test_corpus, log_likelihood);
+  EXPECT_NEAR(61.6432151, perplexity(log_likelihood, test_corpus->size()), EPS);
+}
+
 TEST_F(FactoredSGDTest, TestTrainFactoredNCE) {
   config->noise_samples = 10;
   FactoredLM model(config);
@@ -31,6 +31,48 @@ TEST_F(MaxentSGDTest, TestTrainMaxentSGDSparseFeatures) {
   EXPECT_NEAR(56.5158233, perplexity(log_likelihood, test_corpus->size()), EPS);
 }
 
+TEST_F(MaxentSGDTest, TestTrainMaxentSGDThreads) {
+  config->threads = 2;
+
+  FactoredMaxentLM model(config);
+  model.learn();
+  config->test_file = "test.en";
+  boost::shared_ptr<Vocabulary> vocab = model.getVocab();
+  boost::shared_ptr<Corpus> test_corpus = readTestCorpus(config, vocab);
+  Real log_likelihood = 0;
+  model.evaluate(test_corpus, log_likelihood);
+  // The gradients of the threads are summed in a different order.
+  EXPECT_NEAR(56.5158233, perplexity(log_likelihood, test_corpus->size()), 1e-3);
+}
+
+TEST_F(MaxentSGDTest, TestTrainMaxentDeltaCheckpoints) {
+  config->checkpoint_file = "maxent_delta_checkpoint.bin";
+  config->checkpoint_frequency = 1;
+  config->delta_checkpoints = 3;
+  config->minibatch_threshold = 3;
+  {
+    FactoredMaxentLM model(config);
+    model.learn();
+  }
+
+  config->minibatch_threshold = 20000;
+  FactoredMaxentLM model(config);
+  model.learn();
+
+  FactoredMaxentLM restored_model;
+  restored_model.loadFromCheckpoint(config->checkpoint_file);
+  EXPECT_EQ(model, restored_model);
+  remove(config->checkpoint_file.c_str());
+  remove((config->checkpoint_file + ".deltas").c_str());
+
+  config->test_file = "test.en";
+  boost::shared_ptr<Vocabulary> vocab = model.getVocab();
+  boost::shared_ptr<Corpus> test_corpus = readTestCorpus(config, vocab);
+  Real log_likelihood = 0;
+  model.evaluate(test_corpus, log_likelihood);
+  EXPECT_NEAR(56.5158233, perplexity(log_likelihood, test_corpus->size()), EPS);
+}
+
 TEST_F(MaxentSGDTest, TestTrainMaxentSGDCollisions) {
   config->hash_space = 1000000;
 
@@ -70,7 +112,34 @@ TEST_F(MaxentSGDTest, TestTrainMaxentSGDApproximateFiltering) {
   boost::shared_ptr<Corpus> test_corpus = readTestCorpus(config, vocab);
   Real log_likelihood = 0;
   model.evaluate(test_corpus, log_likelihood);
-  EXPECT_NEAR(56.4237861, perplexity(log_likelihood, test_corpus->size()), EPS);
+  EXPECT_NEAR(56.4958572, perplexity(log_likelihood, test_corpus->size()), EPS);
+}
+
+TEST_F(MaxentSGDTest, TestTrainMaxentNCESparseFeatures) {
+  config->noise_samples = 10;
+
+  FactoredMaxentLM model(config);
+  model.learn();
+  config->test_file = "test.en";
+  boost::shared_ptr<Vocabulary> vocab = model.getVocab();
+  boost::shared_ptr<Corpus> test_corpus = readTestCorpus(config, vocab);
+  Real log_likelihood = 0;
+  model.evaluate(test_corpus, log_likelihood);
+  EXPECT_NEAR(61.6740875, perplexity(log_likelihood, test_corpus->size()), EPS);
+}
+
+TEST_F(MaxentSGDTest, TestTrainMaxentNCECollisions) {
+  config->noise_samples = 10;
+  config->hash_space = 1000000;
+
+  FactoredMaxentLM model(config);
+  model.learn();
+  config->test_file = "test.en";
+  boost::shared_ptr<Vocabulary> vocab = model.getVocab();
+  boost::shared_ptr<Corpus> test_corpus = readTestCorpus(config, vocab);
+  Real log_likelihood = 0;
+  model.evaluate(test_corpus, log_likelihood);
+  EXPECT_NEAR(57.2712173, perplexity(log_likelihood, test_corpus->size()), EPS);
 }
 
 } // namespace oxlm
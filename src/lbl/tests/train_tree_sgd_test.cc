@@ -19,4 +19,28 @@ TEST_F(TreeSGDTest, TestTrainTreeSGD) {
   EXPECT_NEAR(68.05413818, perplexity(log_likelihood, test_corpus->size()), EPS);
 }
 
+TEST_F(TreeSGDTest, TestTrainTreeRowWiseAdaGrad) {
+  config->row_wise_adagrad = true;
+  FactoredTreeLM model(config);
+  model.learn();
+  config->test_file = "test.en";
+  boost::shared_ptr<Vocabulary> vocab = model.getVocab();
+  boost::shared_ptr<Corpus> test_corpus = readTestCorpus(config, vocab);
+  Real log_likelihood = 0;
+  model.evaluate(test_corpus, log_likelihood);
+  EXPECT_NEAR(67.2864990, perplexity(log_likelihood, test_corpus->size()), EPS);
+}
+
+TEST_F(TreeSGDTest, TestTrainTreeNCE) {
+  config->noise_samples = 10;
+  FactoredTreeLM model(config);
+  model.learn();
+  config->test_file = "test.en";
+  boost::shared_ptr<Vocabulary> vocab = model.getVocab();
+  boost::shared_ptr<Corpus> test_corpus = readTestCorpus(config, vocab);
+  Real log_likelihood = 0;
+  model.evaluate(test_corpus, log_likelihood);
+  EXPECT_NEAR(66.42832947, perplexity(log_likelihood, test_corpus->size()), EPS);
+}
+
 } // namespace oxlm
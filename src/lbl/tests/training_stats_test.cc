@@ -0,0 +1,75 @@
+#include "gtest/gtest.h"
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+#include "lbl/tracer.h"
+#include "lbl/training_stats.h"
+
+namespace oxlm {
+
+TEST(TrainingStatsTest, TestReport) {
+  string log_file = "training_stats_test.log";
+  remove(log_file.c_str());
+
+  {
+    TrainingStats stats(1, log_file);
+    Time start_time = GetTime() - chrono::milliseconds(20);
+    Time end_time = stats.record(GRADIENT, start_time);
+    stats.record(BARRIER_WAIT, end_time - chrono::milliseconds(10));
+    stats.addTokens(100);
+    stats.addRows(5);
+    stats.report(0, 1);
+
+    // Only the time elapsed since the previous report is reported.
+    stats.addTokens(50);
+    stats.report(0, 2);
+  }
+
+  ifstream fin(log_file);
+  string line;
+  ASSERT_TRUE(static_cast<bool>(getline(fin, line)));
+  EXPECT_NE(string::npos, line.find("\"minibatch\": 1,"));
+  EXPECT_NE(string::npos, line.find("\"tokens\": 100,"));
+  EXPECT_NE(string::npos, line.find("\"rows\": 5,"));
+  size_t pos = line.find("\"gradient\": ");
+  ASSERT_NE(string::npos, pos);
+  EXPECT_LE(0.02, stof(line.substr(pos + 12)));
+  pos = line.find("\"barrier_wait\": ");
+  ASSERT_NE(string::npos, pos);
+  EXPECT_LE(0.01, stof(line.substr(pos + 16)));
+
+  ASSERT_TRUE(static_cast<bool>(getline(fin, line)));
+  EXPECT_NE(string::npos, line.find("\"tokens\": 50,"));
+  EXPECT_NE(string::npos, line.find("\"rows\": 0,"));
+  EXPECT_NE(string::npos, line.find("\"gradient\": 0,"));
+  EXPECT_FALSE(static_cast<bool>(getline(fin, line)));
+
+  remove(log_file.c_str());
+}
+
+TEST(TrainingStatsTest, TestTraceEventNames) {
+  string trace_file = "training_stats_test.json";
+  Tracer::enable(trace_file);
+  {
+    TrainingStats stats(1, "");
+    Time start_time = stats.record(GRADIENT, GetTime());
+    stats.record(BARRIER_WAIT, start_time, "barrier_after_sync");
+  }
+  Tracer::dump();
+  Tracer::disable();
+
+  ifstream fin(trace_file);
+  stringstream buffer;
+  buffer << fin.rdbuf();
+  string content = buffer.str();
+  EXPECT_NE(string::npos, content.find("\"gradient\""));
+  // The barrier is traced under its own name instead of the phase name.
+  EXPECT_NE(string::npos, content.find("\"barrier_after_sync\""));
+  EXPECT_EQ(string::npos, content.find("\"barrier_wait\""));
+
+  remove(trace_file.c_str());
+}
+
+} // namespace oxlm
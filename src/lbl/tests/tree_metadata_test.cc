@@ -41,6 +41,10 @@ TEST(TreeMetadataTest, TestBasic) {
   for (size_t i = 1; i < tree->size(); ++i) {
     EXPECT_EQ(expected_child_index[i - 1], tree->childIndex(i));
   }
+
+  VectorReal expected_node_unigram = VectorReal::Zero(12);
+  expected_node_unigram << 1, 0, 1, 0.8, 0.2, 0.6, 0.2, 0.2, 0, 0, 0.2, 0.4;
+  EXPECT_MATRIX_NEAR(expected_node_unigram, metadata.getNodeUnigram(), EPS);
 }
 
 TEST(TreeMetadataTest, TestSerialization) {
@@ -104,6 +104,19 @@ TEST_F(WeightsTest, TestGetLogProb) {
   EXPECT_NEAR(log_likelihood, getLogProbabilities(weights, indices), EPS);
 }
 
+TEST_F(WeightsTest, TestGetLogProbs) {
+  Weights weights(config, metadata, corpus);
+  vector<int> indices = {0, 1, 2, 3};
+  VectorReal log_probs = weights.getLogProbs(corpus, indices);
+
+  ContextProcessor processor(corpus, config->ngram_order - 1);
+  for (size_t i = 0; i < indices.size(); ++i) {
+    vector<int> context = processor.extract(indices[i]);
+    EXPECT_NEAR(
+        weights.getLogProb(corpus->at(indices[i]), context), log_probs(i), EPS);
+  }
+}
+
 TEST_F(WeightsTest, TestUnnormalizedScores) {
   Weights weights(config, metadata, corpus);
   vector<int> indices = {0, 1, 2, 3};
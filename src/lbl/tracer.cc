@@ -0,0 +1,110 @@
+#include "lbl/tracer.h"
+
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+
+#include <unistd.h>
+
+#include <boost/make_shared.hpp>
+
+namespace oxlm {
+
+// The state used by initialize() must be defined before enabled.
+string Tracer::filename;
+Time Tracer::origin;
+mutex Tracer::buffersLock;
+vector<boost::shared_ptr<Tracer::Buffer>> Tracer::buffers;
+bool Tracer::enabled = Tracer::initialize();
+
+const size_t Tracer::BUFFER_SIZE;
+
+Tracer::Buffer::Buffer(int thread_id)
+    : threadId(thread_id), numEvents(0), events(BUFFER_SIZE) {}
+
+bool Tracer::initialize() {
+  const char* trace_file = getenv("OXLM_TRACE_FILE");
+  if (trace_file != nullptr && *trace_file) {
+    enable(trace_file);
+    return true;
+  }
+
+  return false;
+}
+
+void Tracer::enable(const string& trace_file) {
+  bool first_call = filename.empty();
+  filename = trace_file;
+  origin = GetTime();
+  if (first_call) {
+    atexit(Tracer::dump);
+  }
+  enabled = true;
+}
+
+void Tracer::disable() {
+  enabled = false;
+  lock_guard<mutex> lock(buffersLock);
+  for (const auto& buffer: buffers) {
+    buffer->numEvents = 0;
+  }
+}
+
+Tracer::Buffer* Tracer::getThreadBuffer() {
+  // Registering the buffer is the only step which takes a lock and it happens
+  // once per thread.
+  static thread_local Buffer* buffer = nullptr;
+  if (buffer == nullptr) {
+    lock_guard<mutex> lock(buffersLock);
+    buffers.push_back(boost::make_shared<Buffer>(buffers.size()));
+    buffer = buffers.back().get();
+  }
+
+  return buffer;
+}
+
+void Tracer::record(const char* name, const Time& start, const Time& end) {
+  Buffer* buffer = getThreadBuffer();
+  Event& event = buffer->events[buffer->numEvents++ & (BUFFER_SIZE - 1)];
+  event.name = name;
+  event.start = chrono::duration_cast<chrono::nanoseconds>(
+      start - origin).count();
+  event.duration = chrono::duration_cast<chrono::nanoseconds>(
+      end - start).count();
+}
+
+void Tracer::dump() {
+  if (!enabled) {
+    return;
+  }
+
+  ofstream fout(filename);
+  fout << fixed << setprecision(3);
+  fout << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [" << endl;
+  bool first_event = true;
+  int pid = getpid();
+  lock_guard<mutex> lock(buffersLock);
+  for (const auto& buffer: buffers) {
+    fout << (first_event ? "" : ",\n")
+         << "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": " << pid
+         << ", \"tid\": " << buffer->threadId
+         << ", \"args\": {\"name\": \"thread " << buffer->threadId << "\"}}";
+    first_event = false;
+
+    size_t num_events = min(buffer->numEvents, BUFFER_SIZE);
+    for (size_t i = buffer->numEvents - num_events;
+         i < buffer->numEvents; ++i) {
+      const Event& event = buffer->events[i & (BUFFER_SIZE - 1)];
+      fout << ",\n{\"name\": \"" << event.name << "\", \"cat\": \"oxlm\", "
+           << "\"ph\": \"X\", \"pid\": " << pid
+           << ", \"tid\": " << buffer->threadId
+           << ", \"ts\": " << event.start / 1e3
+           << ", \"dur\": " << event.duration / 1e3 << "}";
+    }
+  }
+  fout << endl << "]}" << endl;
+
+  cerr << "Trace written to " << filename << "..." << endl;
+}
+
+} // namespace oxlm
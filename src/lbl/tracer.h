@@ -0,0 +1,104 @@
+#pragma once
+
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+
+#include "lbl/utils.h"
+
+using namespace std;
+
+namespace oxlm {
+
+/**
+ * Records timed events (e.g. training phases, model loading, decoder calls)
+ * and writes them as a Chrome trace (JSON), which can be viewed with
+ * chrome://tracing or https://ui.perfetto.dev.
+ *
+ * Tracing is enabled by setting the OXLM_TRACE_FILE environment variable
+ * to the output file (or by calling enable()). The events are written when
+ * the process exits (or when dump() is called).
+ *
+ * Every thread appends its events to its own fixed size ring buffer, so
+ * recording an event takes no locks. If a thread records more than
+ * BUFFER_SIZE events, only the most recent ones are kept. When tracing is
+ * disabled, recording an event costs a single branch.
+ *
+ * Event names must be string literals (only the pointers are stored).
+ */
+class Tracer {
+ public:
+  static void enable(const string& filename);
+
+  /**
+   * Stops recording events. The events recorded so far are discarded.
+   */
+  static void disable();
+
+  static inline bool isEnabled() {
+    return enabled;
+  }
+
+  static void record(const char* name, const Time& start, const Time& end);
+
+  /**
+   * Writes the events recorded so far. Must not run concurrently with
+   * record().
+   */
+  static void dump();
+
+  static const size_t BUFFER_SIZE = 1 << 18;
+
+ private:
+  struct Event {
+    const char* name;
+    // Nanoseconds since the tracer was enabled.
+    long long start;
+    long long duration;
+  };
+
+  struct Buffer {
+    Buffer(int thread_id);
+
+    int threadId;
+    size_t numEvents;
+    vector<Event> events;
+  };
+
+  static bool initialize();
+
+  static Buffer* getThreadBuffer();
+
+  static string filename;
+  static Time origin;
+  static mutex buffersLock;
+  static vector<boost::shared_ptr<Buffer>> buffers;
+  static bool enabled;
+};
+
+/**
+ * Records an event spanning the lifetime of the object.
+ */
+class TraceScope {
+ public:
+  TraceScope(const char* name) : name(name), active(Tracer::isEnabled()) {
+    if (active) {
+      start = GetTime();
+    }
+  }
+
+  ~TraceScope() {
+    if (active) {
+      Tracer::record(name, start, GetTime());
+    }
+  }
+
+ private:
+  const char* name;
+  bool active;
+  Time start;
+};
+
+} // namespace oxlm
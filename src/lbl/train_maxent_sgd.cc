@@ -26,6 +26,21 @@ int main(int argc, char **argv) {
         "Maximum number of passes through the data.")
     ("evaluate-frequency", value<int>()->default_value(1000),
         "Evaluate models every N minibatches")
+    ("stats-frequency", value<int>()->default_value(0),
+        "Report tokens/sec and the time spent in each training phase every "
+        "N minibatches (0 disables the reports).")
+    ("stats-file", value<string>(),
+        "Append the training stats to this file as JSON lines.")
+    ("checkpoint-file", value<string>(),
+        "Write the full training state (including the AdaGrad state) to this "
+        "file at the end of every iteration. If the file exists, training "
+        "resumes from it.")
+    ("checkpoint-frequency", value<int>()->default_value(0),
+        "Also write a checkpoint every N minibatches (0 disables this).")
+    ("delta-checkpoints", value<int>()->default_value(0),
+        "Number of delta checkpoints written between two full checkpoints. "
+        "Delta checkpoints only contain the parameters updated since the "
+        "previous checkpoint and are appended to <checkpoint-file>.deltas.")
     ("minibatch-size", value<int>()->default_value(100),
         "number of sentences per minibatch")
     ("minibatch-threshold", value<int>()->default_value(20000),
@@ -48,8 +63,14 @@ int main(int argc, char **argv) {
         "Width of word representation vectors.")
     ("threads", value<int>()->default_value(1),
         "number of worker threads.")
+    ("prefetch-minibatches", value<int>()->default_value(1),
+        "Number of minibatches prepared in the background while training "
+        "(0 prepares them on the training threads).")
     ("step-size", value<float>()->default_value(0.05),
         "SGD batch stepsize, it is normalised by the number of minibatches.")
+    ("row-wise-adagrad", value<bool>()->default_value(false),
+        "Keep a single AdaGrad accumulator per word vector instead of one "
+        "per weight (roughly halves the memory used during training).")
     ("classes", value<int>()->default_value(100),
         "number of classes for factored output.")
     ("class-file", value<string>(),
@@ -62,10 +83,16 @@ int main(int argc, char **argv) {
     ("activation", value<int>()->default_value(2),
         "Activation function for the prediction (hidden) layer. "
         "0: Identity, 1: Sigmoid, 2: Rectifier.")
+    ("noise-samples", value<int>()->default_value(0),
+        "Number of noise samples for noise contrastive estimation. "
+        "If zero, minibatch gradient descent is used instead.")
     ("max-ngrams", value<int>()->default_value(0),
         "Define maxent features only for the most frequent max-ngrams ngrams.")
     ("min-ngram-freq", value<int>()->default_value(1),
         "Define maxent features only for n-grams above this frequency.")
+    ("ngram-sketch-memory", value<int>()->default_value(0),
+        "Count the n-grams for max-ngrams and min-ngram-freq approximately "
+        "with a count-min sketch of this size (in MB). 0 = exact counts.")
     ("hash-space", value<Real>()->default_value(0),
         "The size of the space in which the maxent features are mapped to "
         "(in millions).")
@@ -73,6 +100,11 @@ int main(int argc, char **argv) {
         "Prevent false contexts from being hashed.")
     ("filter-error-rate", value<Real>()->default_value(0),
         "Error rate for filtering false contexts (in bloom filter)")
+    ("compact-filter", value<bool>()->default_value(false),
+        "Filter false contexts with a compact index from contexts to the "
+        "observed words and classes (ignores filter-error-rate).")
+    ("blocked-bloom-filter", value<bool>()->default_value(false),
+        "Use a cache-line-blocked Bloom filter (with filter-error-rate).")
     ("count-collisions", value<bool>()->default_value(true),
         "Print collision statistics (leads to a memory usage spike)");
 
@@ -101,6 +133,15 @@ int main(int argc, char **argv) {
   }
   config->iterations = vm["iterations"].as<int>();
   config->evaluate_frequency = vm["evaluate-frequency"].as<int>();
+  config->stats_frequency = vm["stats-frequency"].as<int>();
+  if (vm.count("stats-file")) {
+    config->stats_file = vm["stats-file"].as<string>();
+  }
+  if (vm.count("checkpoint-file")) {
+    config->checkpoint_file = vm["checkpoint-file"].as<string>();
+  }
+  config->checkpoint_frequency = vm["checkpoint-frequency"].as<int>();
+  config->delta_checkpoints = vm["delta-checkpoints"].as<int>();
   config->minibatch_size = vm["minibatch-size"].as<int>();
   config->minibatch_threshold = vm["minibatch-threshold"].as<int>();
   config->ngram_order = vm["order"].as<int>();
@@ -124,18 +165,24 @@ int main(int argc, char **argv) {
   config->l2_maxent = vm["lambda-maxent"].as<float>();
   config->word_representation_size = vm["word-width"].as<int>();
   config->threads = vm["threads"].as<int>();
+  config->prefetch_minibatches = vm["prefetch-minibatches"].as<int>();
   config->step_size = vm["step-size"].as<float>();
+  config->row_wise_adagrad = vm["row-wise-adagrad"].as<bool>();
   config->randomise = vm["randomise"].as<bool>();
   config->diagonal_contexts = vm["diagonal-contexts"].as<bool>();
   config->classes = vm["classes"].as<int>();
   config->activation = static_cast<Activation>(vm["activation"].as<int>());
 
+  config->noise_samples = vm["noise-samples"].as<int>();
   config->max_ngrams = vm["max-ngrams"].as<int>();
   config->min_ngram_freq = vm["min-ngram-freq"].as<int>();
+  config->ngram_sketch_memory = vm["ngram-sketch-memory"].as<int>();
 
   config->hash_space = vm["hash-space"].as<Real>() * 1000000;
   config->filter_contexts = vm["filter-contexts"].as<bool>();
   config->filter_error_rate = vm["filter-error-rate"].as<Real>();
+  config->compact_filter = vm["compact-filter"].as<bool>();
+  config->blocked_bloom_filter = vm["blocked-bloom-filter"].as<bool>();
   config->count_collisions = vm["count-collisions"].as<bool>();
 
   cout << "################################" << endl;
@@ -155,17 +202,29 @@ int main(int argc, char **argv) {
   cout << "# lambda LBL = " << config->l2_lbl << endl;
   cout << "# lambda maxent = " << config->l2_maxent << endl;
   cout << "# step size = " << config->step_size << endl;
+  cout << "# row-wise adagrad = " << config->row_wise_adagrad << endl;
   cout << "# iterations = " << config->iterations << endl;
   cout << "# evaluate frequency = " << config->evaluate_frequency << endl;
+  cout << "# stats frequency = " << config->stats_frequency << endl;
+  if (config->checkpoint_file.size()) {
+    cout << "# checkpoint file = " << config->checkpoint_file << endl;
+    cout << "# checkpoint frequency = " << config->checkpoint_frequency << endl;
+    cout << "# delta checkpoints = " << config->delta_checkpoints << endl;
+  }
   cout << "# threads = " << config->threads << endl;
+  cout << "# prefetch minibatches = " << config->prefetch_minibatches << endl;
   cout << "# randomise = " << config->randomise << endl;
   cout << "# diagonal contexts = " << config->diagonal_contexts << endl;
   cout << "# activation = " << config->activation << endl;
+  cout << "# noise samples = " << config->noise_samples << endl;
   cout << "# max n-grams = " << config->max_ngrams << endl;
   cout << "# min n-gram frequency = " << config->min_ngram_freq << endl;
+  cout << "# n-gram sketch memory = " << config->ngram_sketch_memory << endl;
   cout << "# hash space = " << config->hash_space << endl;
   cout << "# filter contexts = " << config->filter_contexts << endl;
   cout << "# filter error rate = " << config->filter_error_rate << endl;
+  cout << "# compact filter = " << config->compact_filter << endl;
+  cout << "# blocked bloom filter = " << config->blocked_bloom_filter << endl;
   cout << "################################" << endl;
 
   if (config->model_input_file.size() == 0) {
@@ -176,6 +235,11 @@ int main(int argc, char **argv) {
     model.load(config->model_input_file);
     boost::shared_ptr<ModelData> model_config = model.getConfig();
     model_config->model_input_file = config->model_input_file;
+    model_config->row_wise_adagrad = config->row_wise_adagrad;
+    model_config->checkpoint_file = config->checkpoint_file;
+    model_config->checkpoint_frequency = config->checkpoint_frequency;
+    model_config->delta_checkpoints = config->delta_checkpoints;
+    model_config->prefetch_minibatches = config->prefetch_minibatches;
     assert(*config == *model_config);
     model.learn();
   }
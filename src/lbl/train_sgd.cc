@@ -25,6 +25,21 @@ int main(int argc, char** argv) {
         "Maximum number of passes through the data.")
     ("evaluate-frequency", value<int>()->default_value(1000),
         "Evaluate models every N minibatches")
+    ("stats-frequency", value<int>()->default_value(0),
+        "Report tokens/sec and the time spent in each training phase every "
+        "N minibatches (0 disables the reports).")
+    ("stats-file", value<string>(),
+        "Append the training stats to this file as JSON lines.")
+    ("checkpoint-file", value<string>(),
+        "Write the full training state (including the AdaGrad state) to this "
+        "file at the end of every iteration. If the file exists, training "
+        "resumes from it.")
+    ("checkpoint-frequency", value<int>()->default_value(0),
+        "Also write a checkpoint every N minibatches (0 disables this).")
+    ("delta-checkpoints", value<int>()->default_value(0),
+        "Number of delta checkpoints written between two full checkpoints. "
+        "Delta checkpoints only contain the parameters updated since the "
+        "previous checkpoint and are appended to <checkpoint-file>.deltas.")
     ("minibatch-size", value<int>()->default_value(10000),
         "number of sentences per minibatch")
     ("minibatch-threshold", value<int>()->default_value(20000),
@@ -41,8 +56,14 @@ int main(int argc, char** argv) {
         "Width of word representation vectors.")
     ("threads", value<int>()->default_value(1),
         "number of worker threads.")
+    ("prefetch-minibatches", value<int>()->default_value(1),
+        "Number of minibatches prepared in the background while training "
+        "(0 prepares them on the training threads).")
     ("step-size", value<float>()->default_value(0.05),
         "SGD batch stepsize, it is normalised by the number of minibatches.")
+    ("row-wise-adagrad", value<bool>()->default_value(false),
+        "Keep a single AdaGrad accumulator per word vector instead of one "
+        "per weight (roughly halves the memory used during training).")
     ("randomise", value<bool>()->default_value(true),
         "Visit the training tokens in random order.")
     ("diagonal-contexts", value<bool>()->default_value(true),
@@ -80,6 +101,15 @@ int main(int argc, char** argv) {
   }
   config->iterations = vm["iterations"].as<int>();
   config->evaluate_frequency = vm["evaluate-frequency"].as<int>();
+  config->stats_frequency = vm["stats-frequency"].as<int>();
+  if (vm.count("stats-file")) {
+    config->stats_file = vm["stats-file"].as<string>();
+  }
+  if (vm.count("checkpoint-file")) {
+    config->checkpoint_file = vm["checkpoint-file"].as<string>();
+  }
+  config->checkpoint_frequency = vm["checkpoint-frequency"].as<int>();
+  config->delta_checkpoints = vm["delta-checkpoints"].as<int>();
   config->minibatch_size = vm["minibatch-size"].as<int>();
   config->minibatch_threshold = vm["minibatch-threshold"].as<int>();
   config->ngram_order = vm["order"].as<int>();
@@ -94,7 +124,9 @@ int main(int argc, char** argv) {
   config->l2_lbl = vm["lambda-lbl"].as<float>();
   config->word_representation_size = vm["word-width"].as<int>();
   config->threads = vm["threads"].as<int>();
+  config->prefetch_minibatches = vm["prefetch-minibatches"].as<int>();
   config->step_size = vm["step-size"].as<float>();
+  config->row_wise_adagrad = vm["row-wise-adagrad"].as<bool>();
   config->randomise = vm["randomise"].as<bool>();
   config->diagonal_contexts = vm["diagonal-contexts"].as<bool>();
   config->activation = static_cast<Activation>(vm["activation"].as<int>());
@@ -118,9 +150,17 @@ int main(int argc, char** argv) {
   cout << "# minibatch threshold = " << config->minibatch_threshold << endl;
   cout << "# lambda = " << config->l2_lbl << endl;
   cout << "# step size = " << config->step_size << endl;
+  cout << "# row-wise adagrad = " << config->row_wise_adagrad << endl;
   cout << "# iterations = " << config->iterations << endl;
   cout << "# evaluate frequency = " << config->evaluate_frequency << endl;
+  cout << "# stats frequency = " << config->stats_frequency << endl;
+  if (config->checkpoint_file.size()) {
+    cout << "# checkpoint file = " << config->checkpoint_file << endl;
+    cout << "# checkpoint frequency = " << config->checkpoint_frequency << endl;
+    cout << "# delta checkpoints = " << config->delta_checkpoints << endl;
+  }
   cout << "# threads = " << config->threads << endl;
+  cout << "# prefetch minibatches = " << config->prefetch_minibatches << endl;
   cout << "# randomise = " << config->randomise << endl;
   cout << "# diagonal contexts = " << config->diagonal_contexts << endl;
   cout << "# activation = " << config->activation << endl;
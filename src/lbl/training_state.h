@@ -0,0 +1,73 @@
+#pragma once
+
+#include <limits>
+#include <random>
+#include <sstream>
+
+#include <boost/serialization/serialization.hpp>
+#include <boost/serialization/split_member.hpp>
+#include <boost/serialization/string.hpp>
+
+#include "lbl/utils.h"
+
+namespace oxlm {
+
+/**
+ * Position of the training algorithm, stored in checkpoints together with the
+ * weights, the AdaGrad state and the order of the training data so that
+ * training resumes exactly where it stopped.
+ */
+struct TrainingState {
+  TrainingState()
+      : iteration(0), start(0), minibatch_counter(1),
+        best_perplexity(numeric_limits<Real>::infinity()), best_minibatch(0),
+        objective(0), generator(1) {}
+
+  // The iteration in progress.
+  int         iteration;
+  // The position of the next minibatch in the shuffled training data.
+  size_t      start;
+  int         minibatch_counter;
+  Real        best_perplexity;
+  int         best_minibatch;
+  // The training objective accumulated during the current iteration.
+  Real        objective;
+  // Generator used for shuffling the training data.
+  mt19937     generator;
+
+  friend class boost::serialization::access;
+
+  template<class Archive>
+  void save(Archive& ar, const unsigned int version) const {
+    ar << iteration;
+    ar << start;
+    ar << minibatch_counter;
+    ar << best_perplexity;
+    ar << best_minibatch;
+    ar << objective;
+
+    ostringstream generator_state;
+    generator_state << generator;
+    string state = generator_state.str();
+    ar << state;
+  }
+
+  template<class Archive>
+  void load(Archive& ar, const unsigned int version) {
+    ar >> iteration;
+    ar >> start;
+    ar >> minibatch_counter;
+    ar >> best_perplexity;
+    ar >> best_minibatch;
+    ar >> objective;
+
+    string state;
+    ar >> state;
+    istringstream generator_state(state);
+    generator_state >> generator;
+  }
+
+  BOOST_SERIALIZATION_SPLIT_MEMBER();
+};
+
+} // namespace oxlm
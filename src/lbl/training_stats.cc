@@ -0,0 +1,114 @@
+#include "lbl/training_stats.h"
+
+#include <iomanip>
+#include <sstream>
+
+#include "lbl/tracer.h"
+#include "utils/conditional_omp.h"
+
+namespace oxlm {
+
+TrainingStats::TrainingStats(int num_threads, const string& log_file)
+    : threadTimes(num_threads),
+      reportedNanoseconds(num_threads * NUM_TRAINING_PHASES, 0),
+      numTokens(0), numRows(0), reportTime(GetTime()) {
+  for (auto& times: threadTimes) {
+    for (int phase = 0; phase < NUM_TRAINING_PHASES; ++phase) {
+      times.nanoseconds[phase].store(0, memory_order_relaxed);
+    }
+  }
+
+  if (log_file.size()) {
+    logStream.open(log_file, ios_base::app);
+  }
+}
+
+Time TrainingStats::record(TrainingPhase phase, const Time& start_time) {
+  return record(phase, start_time, getPhaseName(phase));
+}
+
+Time TrainingStats::record(
+    TrainingPhase phase, const Time& start_time, const char* event_name) {
+  Time now = GetTime();
+  atomic<long long>& counter =
+      threadTimes[omp_get_thread_num()].nanoseconds[phase];
+  // Only the owning thread writes the counter, so load + store is enough.
+  counter.store(
+      counter.load(memory_order_relaxed)
+          + chrono::duration_cast<chrono::nanoseconds>(now - start_time).count(),
+      memory_order_relaxed);
+
+  if (Tracer::isEnabled()) {
+    Tracer::record(event_name, start_time, now);
+  }
+
+  return now;
+}
+
+void TrainingStats::addTokens(size_t num_tokens) {
+  numTokens += num_tokens;
+}
+
+void TrainingStats::addRows(size_t num_rows) {
+  numRows += num_rows;
+}
+
+void TrainingStats::report(int iteration, int minibatch) {
+  Time now = GetTime();
+  double duration = chrono::duration_cast<chrono::nanoseconds>(
+      now - reportTime).count() / 1e9;
+
+  // Phase times are averaged over the threads.
+  vector<double> phase_times(NUM_TRAINING_PHASES, 0);
+  for (size_t i = 0; i < threadTimes.size(); ++i) {
+    for (int phase = 0; phase < NUM_TRAINING_PHASES; ++phase) {
+      long long value =
+          threadTimes[i].nanoseconds[phase].load(memory_order_relaxed);
+      long long& reported = reportedNanoseconds[i * NUM_TRAINING_PHASES + phase];
+      phase_times[phase] += (value - reported) / 1e9 / threadTimes.size();
+      reported = value;
+    }
+  }
+
+  double tokens_per_second = duration > 0 ? numTokens / duration : 0;
+  cout << "Minibatch: " << minibatch << ", "
+       << "Tokens/sec: " << static_cast<long long>(tokens_per_second) << ", "
+       << "Rows: " << numRows << ", Phases:";
+  for (int phase = 0; phase < NUM_TRAINING_PHASES; ++phase) {
+    cout << " " << getPhaseName(phase) << " " << fixed << setprecision(1)
+         << (duration > 0 ? 100 * phase_times[phase] / duration : 0) << "%";
+  }
+  cout.unsetf(ios_base::floatfield);
+  cout << setprecision(6) << endl;
+
+  if (logStream.is_open()) {
+    ostringstream line;
+    line << setprecision(9);
+    line << "{\"iteration\": " << iteration
+         << ", \"minibatch\": " << minibatch
+         << ", \"threads\": " << threadTimes.size()
+         << ", \"seconds\": " << duration
+         << ", \"tokens\": " << numTokens
+         << ", \"tokens_per_second\": " << tokens_per_second
+         << ", \"rows\": " << numRows
+         << ", \"phases\": {";
+    for (int phase = 0; phase < NUM_TRAINING_PHASES; ++phase) {
+      line << (phase ? ", " : "") << "\"" << getPhaseName(phase) << "\": "
+           << phase_times[phase];
+    }
+    line << "}}";
+    logStream << line.str() << endl;
+  }
+
+  numTokens = numRows = 0;
+  reportTime = now;
+}
+
+const char* TrainingStats::getPhaseName(int phase) {
+  static const char* names[NUM_TRAINING_PHASES] = {
+      "init", "gradient", "sync_update", "lock_wait", "barrier_wait",
+      "adagrad_update", "regularize", "clear", "evaluate", "checkpoint"};
+  return names[phase];
+}
+
+} // namespace oxlm
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <atomic>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <boost/align/aligned_allocator.hpp>
+
+#include "lbl/utils.h"
+
+using namespace std;
+
+namespace oxlm {
+
+enum TrainingPhase {
+  INIT,
+  GRADIENT,
+  SYNC_UPDATE,
+  LOCK_WAIT,
+  BARRIER_WAIT,
+  ADAGRAD_UPDATE,
+  REGULARIZE,
+  CLEAR,
+  EVALUATE,
+  CHECKPOINT,
+  NUM_TRAINING_PHASES,
+};
+
+/**
+ * Per thread timers for the phases of a training minibatch, plus counters for
+ * the number of tokens processed and the number of word vectors (rows)
+ * touched by the updates.
+ *
+ * Every thread only writes to its own cache line, so recording a phase costs
+ * a clock read and a couple of relaxed atomic operations. report() may run
+ * concurrently with record(): it reports the difference from the values seen
+ * by the previous report.
+ */
+class TrainingStats {
+ public:
+  TrainingStats(int num_threads, const string& log_file);
+
+  /**
+   * Adds the time elapsed since start_time to the phase for the calling
+   * thread and returns the current time, so that consecutive phases can be
+   * chained.
+   */
+  Time record(TrainingPhase phase, const Time& start_time);
+
+  /**
+   * Same as above, but the trace event is named event_name instead of the
+   * phase (e.g. to tell apart the barriers of a minibatch). event_name must be
+   * a string literal.
+   */
+  Time record(
+      TrainingPhase phase, const Time& start_time, const char* event_name);
+
+  void addTokens(size_t num_tokens);
+
+  void addRows(size_t num_rows);
+
+  /**
+   * Prints the tokens/sec and the phase breakdown since the previous report
+   * and appends them as a JSON line to the log file (if any). Must not be
+   * called by more than one thread at a time.
+   */
+  void report(int iteration, int minibatch);
+
+ private:
+  static const char* getPhaseName(int phase);
+
+  struct alignas(64) ThreadTimes {
+    atomic<long long> nanoseconds[NUM_TRAINING_PHASES];
+  };
+
+  vector<ThreadTimes, boost::alignment::aligned_allocator<ThreadTimes, 64>>
+      threadTimes;
+  vector<long long> reportedNanoseconds;
+  size_t numTokens, numRows;
+  Time reportTime;
+  ofstream logStream;
+};
+
+} // namespace oxlm
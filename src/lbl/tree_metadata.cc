@@ -18,6 +18,20 @@ boost::shared_ptr<ClassTree> TreeMetadata::getTree() const {
   return classTree;
 }
 
+VectorReal TreeMetadata::getNodeUnigram() const {
+  VectorReal node_unigram = VectorReal::Zero(classTree->size());
+  for (int word_id = 0; word_id < unigram.size(); ++word_id) {
+    int node = classTree->getNode(word_id);
+    node_unigram(node) += unigram(word_id);
+    while (node != classTree->getRoot()) {
+      node = classTree->getParent(node);
+      node_unigram(node) += unigram(word_id);
+    }
+  }
+
+  return node_unigram;
+}
+
 bool TreeMetadata::operator==(const TreeMetadata& other) const {
   return Metadata::operator==(other)
       && *classTree == *other.classTree;
@@ -21,6 +21,12 @@ class TreeMetadata : public Metadata {
 
   boost::shared_ptr<ClassTree> getTree() const;
 
+  /**
+   * Returns the unigram probability mass of every node in the tree, i.e. the
+   * total unigram probability of the words in its subtree.
+   */
+  VectorReal getNodeUnigram() const;
+
   bool operator==(const TreeMetadata& other) const;
 
  private:
@@ -116,6 +116,16 @@ inline Real LogAdd(Real log_a, Real log_b) {
   }
 }
 
+/**
+ * Returns the [start, end) range of the thread_id-th of num_threads
+ * contiguous, equally sized slices of [0, size).
+ */
+inline pair<size_t, size_t> GetSlice(
+    size_t size, int thread_id, int num_threads) {
+  return make_pair(
+      size * thread_id / num_threads, size * (thread_id + 1) / num_threads);
+}
+
 // Helper functions for time measurement.
 
 Time GetTime();
@@ -128,6 +138,15 @@ inline size_t MurmurHash(const vector<int>& data, int seed = 0) {
   return result[0];
 }
 
+/**
+ * Returns both 64-bit halves of the 128-bit Murmur hash.
+ */
+inline pair<size_t, size_t> MurmurHash128(const vector<int>& data, int seed = 0) {
+  size_t result[2] = {0, 0};
+  MurmurHash3_x64_128(data.data(), data.size() * sizeof(int), seed, result);
+  return make_pair(result[0], result[1]);
+}
+
 class NotImplementedException : public exception {
   virtual const char* what() const throw() {
     return "This method was not implemented";
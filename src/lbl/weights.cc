@@ -10,14 +10,20 @@
 
 namespace oxlm {
 
-Weights::Weights() : data(NULL), Q(0, 0, 0), R(0, 0, 0), B(0, 0), W(0, 0) {}
+Weights::Weights()
+    : rowWiseAdaGrad(false),
+      data(NULL), Q(0, 0, 0), R(0, 0, 0), B(0, 0), W(0, 0) {}
 
-Weights::Weights(const boost::shared_ptr<ModelData>& config)
-    : data(NULL), Q(0, 0, 0), R(0, 0, 0), B(0, 0), W(0, 0), config(config) {}
+Weights::Weights(
+    const boost::shared_ptr<ModelData>& config, bool row_wise_adagrad)
+    : data(NULL), Q(0, 0, 0), R(0, 0, 0), B(0, 0), W(0, 0), config(config),
+      rowWiseAdaGrad(row_wise_adagrad) {}
 
 Weights::Weights(
-    const boost::shared_ptr<ModelData>& config, const boost::shared_ptr<Metadata>& metadata)
-    : config(config), metadata(metadata),
+    const boost::shared_ptr<ModelData>& config,
+    const boost::shared_ptr<Metadata>& metadata,
+    bool row_wise_adagrad)
+    : config(config), metadata(metadata), rowWiseAdaGrad(row_wise_adagrad),
       data(NULL), Q(0, 0, 0), R(0, 0, 0), B(0, 0), W(0, 0) {
   allocate();
   W.setZero();
@@ -27,7 +33,7 @@ Weights::Weights(
     const boost::shared_ptr<ModelData>& config,
     const boost::shared_ptr<Metadata>& metadata,
     const boost::shared_ptr<Corpus>& training_corpus)
-    : config(config), metadata(metadata),
+    : config(config), metadata(metadata), rowWiseAdaGrad(false),
       data(NULL), Q(0, 0, 0), R(0, 0, 0), B(0, 0), W(0, 0) {
   allocate();
 
@@ -48,6 +54,7 @@ Weights::Weights(
 
 Weights::Weights(const Weights& other)
     : config(other.config), metadata(other.metadata),
+      rowWiseAdaGrad(other.rowWiseAdaGrad),
       data(NULL), Q(0, 0, 0), R(0, 0, 0), B(0, 0), W(0, 0) {
   allocate();
   memcpy(data, other.data, size * sizeof(Real));
@@ -57,10 +64,11 @@ void Weights::allocate() {
   int num_context_words = config->vocab_size;
   int num_output_words = config->vocab_size;
   int word_width = config->word_representation_size;
+  int vector_width = getWordVectorWidth();
   int context_width = config->ngram_order - 1;
 
-  int Q_size = word_width * num_context_words;
-  int R_size = word_width * num_output_words;
+  int Q_size = vector_width * num_context_words;
+  int R_size = vector_width * num_output_words;
   int C_size = config->diagonal_contexts ? word_width : word_width * word_width;
   int H_size = word_width * word_width;
   int B_size = num_output_words;
@@ -90,18 +98,19 @@ void Weights::setModelParameters() {
   int num_context_words = config->vocab_size;
   int num_output_words = config->vocab_size;
   int word_width = config->word_representation_size;
+  int vector_width = getWordVectorWidth();
   int context_width = config->ngram_order - 1;
 
-  int Q_size = word_width * num_context_words;
-  int R_size = word_width * num_output_words;
+  int Q_size = vector_width * num_context_words;
+  int R_size = vector_width * num_output_words;
   int C_size = config->diagonal_contexts ? word_width : word_width * word_width;
   int H_size = word_width * word_width;
   int B_size = num_output_words;
 
   new (&W) WeightsType(data, size);
 
-  new (&Q) WordVectorsType(data, word_width, num_context_words);
-  new (&R) WordVectorsType(data + Q_size, word_width, num_output_words);
+  new (&Q) WordVectorsType(data, vector_width, num_context_words);
+  new (&R) WordVectorsType(data + Q_size, vector_width, num_output_words);
 
   Real* start = data + Q_size + R_size;
   for (int i = 0; i < context_width; ++i) {
@@ -121,10 +130,35 @@ void Weights::setModelParameters() {
   new (&B) WeightsType(start, B_size);
 }
 
+int Weights::getWordVectorWidth() const {
+  return rowWiseAdaGrad ? 1 : config->word_representation_size;
+}
+
 size_t Weights::numParameters() const {
   return size;
 }
 
+void Weights::reportMemory(MemoryReport& report) const {
+  report.add("Q", Q.size() * sizeof(Real));
+  report.add("R", R.size() * sizeof(Real));
+  size_t C_size = 0;
+  for (const auto& context_transform: C) {
+    C_size += context_transform.size();
+  }
+  report.add("C", C_size * sizeof(Real));
+  size_t H_size = 0;
+  for (const auto& hidden_layer: H) {
+    H_size += hidden_layer.size();
+  }
+  report.add("H", H_size * sizeof(Real));
+  report.add("B", B.size() * sizeof(Real));
+
+  size_t num_mutexes = mutexesC.size() + mutexesQ.size() + mutexesR.size()
+      + mutexesH.size() + 1;
+  report.add("mutexes", num_mutexes * (sizeof(Mutex) + sizeof(mutex)));
+  report.add("normalizer cache", normalizerCache.memoryUsage());
+}
+
 void Weights::printInfo() const {
   cout << "===============================" << endl;
   cout << " Model parameters: " << endl;
@@ -134,10 +168,16 @@ void Weights::printInfo() const {
   cout << "===============================" << endl;
 }
 
+void Weights::prepare(PreparedMinibatch& minibatch) const {}
+
 void Weights::init(
     const boost::shared_ptr<Corpus>& corpus,
     const vector<int>& minibatch) {}
 
+void Weights::init(const PreparedMinibatch& minibatch) {
+  init(minibatch.corpus, minibatch.indices);
+}
+
 void Weights::getGradient(
     const boost::shared_ptr<Corpus>& corpus,
     const vector<int>& indices,
@@ -165,14 +205,14 @@ void Weights::getContextVectors(
     vector<MatrixReal>& context_vectors) const {
   int context_width = config->ngram_order - 1;
   int word_width = config->word_representation_size;
-  boost::shared_ptr<ContextProcessor> processor =
-      boost::make_shared<ContextProcessor>(corpus, context_width);
+  ContextProcessor processor(corpus, context_width);
 
   contexts.resize(indices.size());
   context_vectors.resize(
       context_width, MatrixReal::Zero(word_width, indices.size()));
   for (size_t i = 0; i < indices.size(); ++i) {
-    contexts[i] = processor->extract(indices[i]);
+    contexts[i].resize(context_width);
+    processor.extract(indices[i], contexts[i].data());
     for (int j = 0; j < context_width; ++j) {
       context_vectors[j].col(i) = Q.col(contexts[i][j]);
     }
@@ -358,6 +398,23 @@ Real Weights::getLogLikelihood(
       corpus, indices, contexts, context_vectors, forward_weights, word_probs);
 }
 
+VectorReal Weights::getLogProbs(
+    const boost::shared_ptr<Corpus>& corpus, const vector<int>& indices) const {
+  vector<vector<int>> contexts;
+  vector<MatrixReal> context_vectors;
+  vector<MatrixReal> forward_weights;
+  MatrixReal word_probs;
+  getObjective(
+      corpus, indices, contexts, context_vectors, forward_weights, word_probs);
+
+  VectorReal log_probs(indices.size());
+  for (size_t i = 0; i < indices.size(); ++i) {
+    log_probs(i) = log(word_probs(corpus->at(indices[i]), i));
+  }
+
+  return log_probs;
+}
+
 Real Weights::getObjective(
     const boost::shared_ptr<Corpus>& corpus,
     const vector<int>& indices,
@@ -527,20 +584,48 @@ Block Weights::getBlock(int start, int size) const {
   return make_pair(block_start, block_size);
 }
 
+void Weights::updateSquaredVector(
+    WordVectorsType& state, const WordVectorsType& gradient, int word_id) {
+  if (state.rows() == gradient.rows()) {
+    state.col(word_id).array() += gradient.col(word_id).array().square();
+  } else {
+    state(0, word_id) += gradient.col(word_id).squaredNorm() / gradient.rows();
+  }
+}
+
+void Weights::updateAdaGradVector(
+    WordVectorsType& weights, const WordVectorsType& gradient,
+    const WordVectorsType& state, int word_id) const {
+  CwiseAdagradUpdateOp<Real> op(config->step_size);
+  if (state.rows() == gradient.rows()) {
+    weights.col(word_id) -=
+        gradient.col(word_id).binaryExpr(state.col(word_id), op);
+  } else {
+    // The update is linear in the gradient, so the scaling factor is the
+    // update of a unit gradient.
+    weights.col(word_id) -= gradient.col(word_id) * op(1, state(0, word_id));
+  }
+}
+
 void Weights::updateSquared(
     const MinibatchWords& global_words,
     const boost::shared_ptr<Weights>& global_gradient) {
   for (int word_id: global_words.getContextWords()) {
-    Q.col(word_id).array() += global_gradient->Q.col(word_id).array().square();
+    updateSquaredVector(Q, global_gradient->Q, word_id);
   }
 
   for (int word_id: global_words.getOutputWords()) {
-    R.col(word_id).array() += global_gradient->R.col(word_id).array().square();
+    updateSquaredVector(R, global_gradient->R, word_id);
   }
 
-  Block block = getBlock(Q.size() + R.size(), W.size() - (Q.size() + R.size()));
-  W.segment(block.first, block.second).array() +=
-      global_gradient->W.segment(block.first, block.second).array().square();
+  // The remaining weights start at different offsets if the AdaGrad state is
+  // row-wise.
+  size_t offset = Q.size() + R.size();
+  size_t gradient_offset = global_gradient->Q.size() + global_gradient->R.size();
+  Block block = getBlock(0, W.size() - offset);
+  W.segment(offset + block.first, block.second).array() +=
+      global_gradient->W.segment(gradient_offset + block.first, block.second)
+          .array().square();
 }
 
 void Weights::updateAdaGrad(
@@ -548,19 +633,19 @@ void Weights::updateAdaGrad(
     const boost::shared_ptr<Weights>& global_gradient,
     const boost::shared_ptr<Weights>& adagrad) {
   for (int word_id: global_words.getContextWords()) {
-    Q.col(word_id) -= global_gradient->Q.col(word_id).binaryExpr(
-        adagrad->Q.col(word_id), CwiseAdagradUpdateOp<Real>(config->step_size));
+    updateAdaGradVector(Q, global_gradient->Q, adagrad->Q, word_id);
   }
 
   for (int word_id: global_words.getOutputWords()) {
-    R.col(word_id) -= global_gradient->R.col(word_id).binaryExpr(
-        adagrad->R.col(word_id), CwiseAdagradUpdateOp<Real>(config->step_size));
+    updateAdaGradVector(R, global_gradient->R, adagrad->R, word_id);
   }
 
-  Block block = getBlock(Q.size() + R.size(), W.size() - (Q.size() + R.size()));
-  W.segment(block.first, block.second) -=
-      global_gradient->W.segment(block.first, block.second).binaryExpr(
-          adagrad->W.segment(block.first, block.second),
+  size_t offset = Q.size() + R.size();
+  size_t adagrad_offset = adagrad->Q.size() + adagrad->R.size();
+  Block block = getBlock(0, W.size() - offset);
+  W.segment(offset + block.first, block.second) -=
+      global_gradient->W.segment(offset + block.first, block.second).binaryExpr(
+          adagrad->W.segment(adagrad_offset + block.first, block.second),
           CwiseAdagradUpdateOp<Real>(config->step_size));
 }
 
@@ -576,6 +661,13 @@ Real Weights::regularizerUpdate(
   return 0.5 * minibatch_factor * config->l2_lbl * sum;
 }
 
+void Weights::trackUpdates(
+    const MinibatchWords& global_words,
+    const boost::shared_ptr<Weights>& global_gradient,
+    ParameterUpdates& updates) const {
+  updates.words.merge(global_words);
+}
+
 void Weights::clear(const MinibatchWords& words, bool parallel_update) {
   if (parallel_update) {
     for (int word_id: words.getContextWords()) {
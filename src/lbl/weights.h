@@ -9,12 +9,17 @@
 #include <boost/serialization/singleton.hpp>
 #include <boost/serialization/type_info_implementation.hpp>
 #include <boost/serialization/shared_ptr.hpp>
+#include <boost/serialization/vector.hpp>
 #include <boost/thread/tss.hpp>
 
 #include "lbl/context_cache.h"
+#include "lbl/memory_report.h"
 #include "lbl/metadata.h"
 #include "lbl/minibatch_words.h"
+#include "lbl/parameter_updates.h"
+#include "lbl/prepared_minibatch.h"
 #include "lbl/utils.h"
+#include "utils/serialization_helpers.h"
 
 namespace oxlm {
 
@@ -32,11 +37,18 @@ class Weights {
  public:
   Weights();
 
-  Weights(const boost::shared_ptr<ModelData>& config);
+  Weights(
+      const boost::shared_ptr<ModelData>& config,
+      bool row_wise_adagrad = false);
 
+  /**
+   * If row_wise_adagrad is set, the weights hold row-wise AdaGrad state: Q
+   * and R keep a single accumulator per word instead of one per weight.
+   */
   Weights(
       const boost::shared_ptr<ModelData>& config,
-      const boost::shared_ptr<Metadata>& metadata);
+      const boost::shared_ptr<Metadata>& metadata,
+      bool row_wise_adagrad = false);
 
   Weights(
       const boost::shared_ptr<ModelData>& config,
@@ -47,12 +59,27 @@ class Weights {
 
   virtual size_t numParameters() const;
 
+  /**
+   * Adds the memory used by the weights to report. Only the caches of the
+   * calling thread are included.
+   */
+  virtual void reportMemory(MemoryReport& report) const;
+
   virtual void printInfo() const;
 
+  /**
+   * Prepares the minibatch data needed by init() which does not depend on the
+   * weights. Runs in a background thread while the previous minibatch is
+   * trained (see MinibatchPipeline).
+   */
+  virtual void prepare(PreparedMinibatch& minibatch) const;
+
   void init(
       const boost::shared_ptr<Corpus>& corpus,
       const vector<int>& minibatch);
 
+  void init(const PreparedMinibatch& minibatch);
+
   void getGradient(
       const boost::shared_ptr<Corpus>& corpus,
       const vector<int>& indices,
@@ -64,6 +91,10 @@ class Weights {
       const boost::shared_ptr<Corpus>& corpus,
       const vector<int>& indices) const;
 
+  virtual VectorReal getLogProbs(
+      const boost::shared_ptr<Corpus>& corpus,
+      const vector<int>& indices) const;
+
   bool checkGradient(
       const boost::shared_ptr<Corpus>& corpus,
       const vector<int>& indices,
@@ -96,6 +127,45 @@ class Weights {
 
   void clear(const MinibatchWords& words, bool parallel_update);
 
+  /**
+   * Adds the parameters updated with global_gradient to updates.
+   */
+  void trackUpdates(
+      const MinibatchWords& global_words,
+      const boost::shared_ptr<Weights>& global_gradient,
+      ParameterUpdates& updates) const;
+
+  /**
+   * Writes the word vectors listed in updates and all the parameters which
+   * are not indexed by words (context transforms, hidden layers, biases).
+   */
+  template<class Archive>
+  void saveDelta(Archive& ar, const ParameterUpdates& updates) const {
+    saveColumns(ar, Q, updates.words.getContextWordsSet());
+    saveColumns(ar, R, updates.words.getOutputWordsSet());
+
+    int offset = Q.size() + R.size();
+    ar << boost::serialization::make_array(data + offset, size - offset);
+  }
+
+  /**
+   * Applies a delta written by saveDelta. The regularization updates of the
+   * minibatches covered by the delta are replayed first, so that the word
+   * vectors which are not part of the delta are also up to date.
+   */
+  template<class Archive>
+  void loadDelta(Archive& ar, const vector<Real>& regularizer_sigmas) {
+    for (Real sigma: regularizer_sigmas) {
+      W -= W * sigma;
+    }
+
+    loadColumns(ar, Q);
+    loadColumns(ar, R);
+
+    int offset = Q.size() + R.size();
+    ar >> boost::serialization::make_array(data + offset, size - offset);
+  }
+
   virtual Real getLogProb(int word_id, vector<int> context) const;
 
   virtual Real getUnnormalizedScore(int word, const vector<int>& context) const;
@@ -199,6 +269,52 @@ class Weights {
 
   virtual VectorReal getPredictionVector(const vector<int>& context) const;
 
+  /**
+   * Returns the number of rows of the word vector matrices (1 for row-wise
+   * AdaGrad state).
+   */
+  int getWordVectorWidth() const;
+
+  /**
+   * Adds the squared gradient of a word vector to its AdaGrad state. Row-wise
+   * state (a single row) accumulates the mean squared gradient of the vector.
+   */
+  static void updateSquaredVector(
+      WordVectorsType& state, const WordVectorsType& gradient, int word_id);
+
+  /**
+   * Applies the AdaGrad update to a word vector, given full or row-wise state.
+   */
+  void updateAdaGradVector(
+      WordVectorsType& weights, const WordVectorsType& gradient,
+      const WordVectorsType& state, int word_id) const;
+
+  template<class Archive>
+  static void saveColumns(
+      Archive& ar, const WordVectorsType& matrix,
+      const unordered_set<int>& column_set) {
+    vector<int> column_ids = ParameterUpdates::sorted(column_set);
+    MatrixReal columns(matrix.rows(), column_ids.size());
+    for (size_t i = 0; i < column_ids.size(); ++i) {
+      columns.col(i) = matrix.col(column_ids[i]);
+    }
+
+    ar << column_ids;
+    ar << columns;
+  }
+
+  template<class Archive>
+  static void loadColumns(Archive& ar, WordVectorsType& matrix) {
+    vector<int> column_ids;
+    MatrixReal columns;
+    ar >> column_ids;
+    ar >> columns;
+
+    for (size_t i = 0; i < column_ids.size(); ++i) {
+      matrix.col(column_ids[i]) = columns.col(i);
+    }
+  }
+
  private:
   void allocate();
 
@@ -212,6 +328,7 @@ class Weights {
   void save(Archive& ar, const unsigned int version) const {
     ar << config;
     ar << metadata;
+    ar << rowWiseAdaGrad;
 
     ar << size;
     ar << boost::serialization::make_array(data, size);
@@ -223,6 +340,12 @@ class Weights {
 
     ar >> metadata;
 
+    // AdaGrad state is only serialized as part of training checkpoints.
+    rowWiseAdaGrad = false;
+    if (version > 0) {
+      ar >> rowWiseAdaGrad;
+    }
+
     ar >> size;
     data = new Real[size];
     ar >> boost::serialization::make_array(data, size);
@@ -235,6 +358,7 @@ class Weights {
  protected:
   boost::shared_ptr<ModelData> config;
   boost::shared_ptr<Metadata> metadata;
+  bool rowWiseAdaGrad;
 
   ContextTransformsType C;
   WordVectorsType       Q;
@@ -257,3 +381,5 @@ class Weights {
 };
 
 } // namespace oxlm
+
+BOOST_CLASS_VERSION(oxlm::Weights, 1)
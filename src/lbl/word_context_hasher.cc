@@ -9,11 +9,12 @@ WordContextHasher::WordContextHasher(
     : classId(class_id), hashSpaceSize(hash_space_size) {}
 
 int WordContextHasher::getKey(const FeatureContext& feature_context) const {
-  // Note: Here we pass the class_id as the n-gram's word_id.
+  // Note: Here we hash the n-gram having the class_id as its word_id.
   // The goal is to produce a different hashcode for [context] and
   // [class_id, context].
-  NGram query(classId, feature_context.data);
-  return hash_function(query) % hashSpaceSize;
+  PrefixHash key = hash_function.getPrefixHash(classId, -1);
+  key.append(feature_context.data);
+  return key.getHash() % hashSpaceSize;
 }
 
 NGram WordContextHasher::getPrediction(
@@ -1,5 +1,7 @@
 #include "lbl/word_to_class_index.h"
 
+#include "lbl/memory_report.h"
+
 namespace oxlm {
 
 WordToClassIndex::WordToClassIndex() {}
@@ -33,6 +35,11 @@ int WordToClassIndex::getWordIndexInClass(int word_id) const {
   return word_id - classMarkers[wordToClass[word_id]];
 }
 
+size_t WordToClassIndex::memoryUsage() const {
+  return MemoryReport::getContainerBytes(classMarkers)
+      + MemoryReport::getContainerBytes(wordToClass);
+}
+
 bool WordToClassIndex::operator==(const WordToClassIndex& index) const {
   return classMarkers == index.classMarkers && wordToClass == index.wordToClass;
 }
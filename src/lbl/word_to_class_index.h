@@ -25,6 +25,8 @@ class WordToClassIndex {
 
   int getWordIndexInClass(int word_id) const;
 
+  size_t memoryUsage() const;
+
   bool operator==(const WordToClassIndex& index) const;
 
  private: